@@ -0,0 +1,192 @@
+// Convert an on-disk rule table to the memory mapped format, see MappedLayout.h
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "OnDiskWrapper.h"
+#include "MappedLayout.h"
+#include "SourcePhrase.h"
+#include "TargetPhrase.h"
+#include "TargetPhraseCollection.h"
+#include "util/exception.hh"
+
+using namespace std;
+using namespace OnDiskPt;
+
+namespace
+{
+
+class Converter
+{
+public:
+  Converter(OnDiskWrapper &in, const string &outDir)
+    : m_in(in)
+    , m_numScores(in.GetNumScores())
+    , m_numNodes(0)
+    , m_numRules(0) {
+    Open(m_source, outDir + "/Source.dat");
+    Open(m_targetColl, outDir + "/TargetColl.dat");
+  }
+
+  //! write the node and everything below it. returns its offset in Source.dat
+  UINT64 WriteNode(const PhraseNode &node) {
+    vector<MappedChild> children(node.GetNumChildren());
+    for (size_t ind = 0; ind < children.size(); ++ind) {
+      Word word;
+      UINT64 childFilePos;
+      node.GetChild(word, childFilePos, ind, m_in);
+
+      PhraseNode child(childFilePos, m_in);
+      children[ind].word = MappedWordKey(word);
+      children[ind].node = WriteNode(child);
+    }
+    // the old format orders children by Word, which compares factors before non-terminal-ness
+    sort(children.begin(), children.end());
+
+    MappedNode mapped;
+    mapped.numChildren = children.size();
+    mapped.targetColl = (node.GetValue() > 0) ? WriteRules(node) : 0;
+    mapped.count = node.GetCount(0);
+    mapped.unused = 0;
+
+    UINT64 ret = m_source.tellp();
+    m_source.write(reinterpret_cast<const char*>(&mapped), sizeof(mapped));
+    if (!children.empty()) {
+      m_source.write(reinterpret_cast<const char*>(&children[0]), sizeof(MappedChild) * children.size());
+    }
+    UTIL_THROW_IF2(!m_source, "Couldn't write Source.dat");
+
+    if (++m_numNodes % 100000 == 0) {
+      cerr << "." << flush;
+    }
+    return ret;
+  }
+
+  size_t GetNumNodes() const {
+    return m_numNodes;
+  }
+  size_t GetNumRules() const {
+    return m_numRules;
+  }
+
+private:
+  OnDiskWrapper &m_in;
+  size_t m_numScores;
+  size_t m_numNodes, m_numRules;
+  ofstream m_source, m_targetColl;
+
+  static void Open(ofstream &file, const string &path) {
+    file.open(path.c_str(), ios::out | ios::binary);
+    UTIL_THROW_IF2(!file.is_open(), "Couldn't open file " << path);
+    // offset 0 means "none"
+    UINT64 zero = 0;
+    file.write(reinterpret_cast<const char*>(&zero), sizeof(zero));
+  }
+
+  UINT64 WriteRules(const PhraseNode &node) {
+    const TargetPhraseCollection *coll = node.GetTargetPhraseCollection(0, m_in);
+
+    UINT64 ret = m_targetColl.tellp();
+    UINT64 numRules = coll->GetSize();
+    m_targetColl.write(reinterpret_cast<const char*>(&numRules), sizeof(numRules));
+
+    vector<char> mem;
+    for (size_t ind = 0; ind < coll->GetSize(); ++ind) {
+      const TargetPhrase &tp = coll->GetTargetPhrase(ind);
+      const Phrase &sourcePhrase = *tp.GetSourcePhrase();
+      const AlignType &align = tp.GetAlign();
+
+      size_t size = MappedRule::GetSize(tp.GetSize(), sourcePhrase.GetSize(), align.size(), m_numScores);
+      mem.assign(size, 0);
+      MappedRule *rule = reinterpret_cast<MappedRule*>(&mem[0]);
+      rule->size = size;
+      rule->numWords = tp.GetSize();
+      rule->numSourceWords = sourcePhrase.GetSize();
+      rule->numAlign = align.size();
+
+      UINT64 *words = const_cast<UINT64*>(rule->GetWords());
+      for (size_t pos = 0; pos < tp.GetSize(); ++pos) {
+        words[pos] = MappedWordKey(tp.GetWord(pos));
+      }
+      UINT64 *sourceWords = const_cast<UINT64*>(rule->GetSourceWords());
+      for (size_t pos = 0; pos < sourcePhrase.GetSize(); ++pos) {
+        sourceWords[pos] = MappedWordKey(sourcePhrase.GetWord(pos));
+      }
+      UINT32 *alignMem = const_cast<UINT32*>(rule->GetAlign());
+      for (size_t pos = 0; pos < align.size(); ++pos) {
+        alignMem[2 * pos] = align[pos].first;
+        alignMem[2 * pos + 1] = align[pos].second;
+      }
+      float *scores = const_cast<float*>(rule->GetScores());
+      for (size_t pos = 0; pos < m_numScores; ++pos) {
+        scores[pos] = tp.GetScore(pos);
+      }
+
+      m_targetColl.write(&mem[0], size);
+    }
+    UTIL_THROW_IF2(!m_targetColl, "Couldn't write TargetColl.dat");
+
+    m_numRules += coll->GetSize();
+    delete coll;
+    return ret;
+  }
+};
+
+void CopyFile(const string &from, const string &to)
+{
+  ifstream in(from.c_str(), ios::in | ios::binary);
+  UTIL_THROW_IF2(!in.is_open(), "Couldn't open file " << from);
+  ofstream out(to.c_str(), ios::out | ios::binary);
+  UTIL_THROW_IF2(!out.is_open(), "Couldn't open file " << to);
+  out << in.rdbuf();
+}
+
+void usage()
+{
+  cerr << "Usage: convertOnDiskPt <in-dir> <out-dir>\n"
+       "Converts a table made by CreateOnDiskPt to the memory mapped format (version "
+       << OnDiskWrapper::MAPPED_VERSION_NUM << ").\n"
+       "out-dir must exist.\n";
+  exit(1);
+}
+
+}
+
+int main(int argc, char **argv)
+{
+  if (argc != 3)
+    usage();
+  const string inDir(argv[1]), outDir(argv[2]);
+
+  OnDiskWrapper in;
+  in.BeginLoad(inDir);
+  UTIL_THROW_IF2(in.GetMisc("Version") != (UINT64) OnDiskWrapper::VERSION_NUM,
+                 "Can only convert tables of version " << OnDiskWrapper::VERSION_NUM
+                 << ", " << inDir << " is version " << in.GetMisc("Version"));
+
+  UINT64 root;
+  size_t numNodes, numRules;
+  {
+    Converter converter(in, outDir);
+    root = converter.WriteNode(in.GetRootSourceNode());
+    numNodes = converter.GetNumNodes();
+    numRules = converter.GetNumRules();
+  }
+
+  CopyFile(inDir + "/Vocab.dat", outDir + "/Vocab.dat");
+
+  ofstream misc((outDir + "/Misc.dat").c_str());
+  UTIL_THROW_IF2(!misc.is_open(), "Couldn't open file " << outDir << "/Misc.dat");
+  misc << "Version " << OnDiskWrapper::MAPPED_VERSION_NUM << endl;
+  misc << "NumSourceFactors " << in.GetMisc("NumSourceFactors") << endl;
+  misc << "NumTargetFactors " << in.GetMisc("NumTargetFactors") << endl;
+  misc << "NumScores " << in.GetMisc("NumScores") << endl;
+  misc << "RootNodeOffset " << root << endl;
+
+  cerr << endl << "Converted " << numNodes << " nodes, " << numRules << " rules" << endl;
+  return 0;
+}
@@ -0,0 +1,112 @@
+#pragma once
+/***********************************************************************
+ Moses - factored phrase-based, hierarchical and syntactic language decoder
+ Copyright (C) 2013 University of Edinburgh
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***********************************************************************/
+#include <cstddef>
+#include "moses/TypeDef.h"
+#include "Word.h"
+
+namespace OnDiskPt
+{
+
+/* Layout of the memory mapped rule table (OnDiskWrapper::MAPPED_VERSION_NUM),
+ * made from an existing table by convertOnDiskPt.
+ *
+ * Misc.dat and Vocab.dat are as in the old format.  Source.dat holds the
+ * nodes of the source trie, TargetColl.dat the rules of each node, and the
+ * files are mapped into memory and read in place.  Everything is 8 byte
+ * aligned and offset 0 of each file is unused, so 0 means "none".
+ *
+ * A node is a MappedNode followed by numChildren MappedChild entries, sorted
+ * by word key for binary search.  A rule collection is a UINT64 count
+ * followed by that many MappedRule records, best first.  Scores are stored
+ * as they are used, ie. after TransformScore() and FloorScore().
+ */
+
+//! a word as one number: vocab id, and whether it is a non-terminal in the lowest bit
+inline UINT64 MappedWordKey(const Word &word)
+{
+  return (word.GetVocabId() << 1) | (word.IsNonTerminal() ? 1 : 0);
+}
+
+inline Word MappedKeyToWord(UINT64 key)
+{
+  Word word(key & 1);
+  word.SetVocabId(key >> 1);
+  return word;
+}
+
+struct MappedNode {
+  UINT64 numChildren;
+  UINT64 targetColl; // offset in TargetColl.dat. 0 if the node has no rules
+  float count;
+  float unused;
+};
+
+struct MappedChild {
+  UINT64 word; // MappedWordKey()
+  UINT64 node; // offset in Source.dat
+
+  bool operator<(const MappedChild &other) const {
+    return word < other.word;
+  }
+};
+
+/* One rule: the header, then target words (lhs last, for syntax models) and
+ * source words as word keys, alignment points as (source, target) pairs,
+ * and the scores.
+ */
+struct MappedRule {
+  UINT32 size; // bytes, including padding. the next rule follows
+  UINT32 numWords;
+  UINT32 numSourceWords;
+  UINT32 numAlign;
+
+  const UINT64 *GetWords() const {
+    return reinterpret_cast<const UINT64*>(this + 1);
+  }
+  const UINT64 *GetSourceWords() const {
+    return GetWords() + numWords;
+  }
+  const UINT32 *GetAlign() const {
+    return reinterpret_cast<const UINT32*>(GetSourceWords() + numSourceWords);
+  }
+  const float *GetScores() const {
+    return reinterpret_cast<const float*>(GetAlign() + 2 * numAlign);
+  }
+  const MappedRule *Next() const {
+    return reinterpret_cast<const MappedRule*>(reinterpret_cast<const char*>(this) + size);
+  }
+
+  static size_t GetSize(size_t numWords, size_t numSourceWords, size_t numAlign, size_t numScores) {
+    size_t ret = sizeof(MappedRule)
+                 + sizeof(UINT64) * (numWords + numSourceWords)
+                 + sizeof(UINT32) * 2 * numAlign
+                 + sizeof(float) * numScores;
+    return (ret + 7) & ~static_cast<size_t>(7);
+  }
+};
+
+//! first rule of the collection at mem, and how many there are
+inline const MappedRule *GetMappedRules(const char *mem, UINT64 &numRules)
+{
+  numRules = *reinterpret_cast<const UINT64*>(mem);
+  return reinterpret_cast<const MappedRule*>(mem + sizeof(UINT64));
+}
+
+}
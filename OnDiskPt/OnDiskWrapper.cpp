@@ -25,6 +25,7 @@
 #include "OnDiskWrapper.h"
 #include "moses/Factor.h"
 #include "util/exception.hh"
+#include "util/file.hh"
 
 using namespace std;
 
@@ -32,8 +33,11 @@ namespace OnDiskPt
 {
 
 int OnDiskWrapper::VERSION_NUM = 5;
+int OnDiskWrapper::MAPPED_VERSION_NUM = 6;
 
 OnDiskWrapper::OnDiskWrapper()
+  :m_mapped(false)
+  ,m_rootSourceNode(NULL)
 {
 }
 
@@ -57,6 +61,28 @@ void OnDiskWrapper::BeginLoad(const std::string &filePath)
 
 bool OnDiskWrapper::OpenForLoad(const std::string &filePath)
 {
+  m_fileMisc.open((filePath + "/Misc.dat").c_str(), ios::in);
+  UTIL_THROW_IF(!m_fileMisc.is_open(),
+		  util::FileOpenException,
+		  "Couldn't open file " << filePath << "/Misc.dat");
+  LoadMisc();
+
+  m_fileVocab.open((filePath + "/Vocab.dat").c_str(), ios::in);
+  UTIL_THROW_IF(!m_fileVocab.is_open(),
+		  util::FileOpenException,
+		  "Couldn't open file " << filePath << "/Vocab.dat");
+
+  m_numSourceFactors = GetMisc("NumSourceFactors");
+  m_numTargetFactors = GetMisc("NumTargetFactors");
+  m_numScores = GetMisc("NumScores");
+
+  if (GetMisc("Version") == (UINT64) MAPPED_VERSION_NUM) {
+    m_mapped = true;
+    MapFile(filePath + "/Source.dat", m_mappedSource);
+    MapFile(filePath + "/TargetColl.dat", m_mappedTargetColl);
+    return true;
+  }
+
   m_fileSource.open((filePath + "/Source.dat").c_str(), ios::in | ios::binary);
   UTIL_THROW_IF(!m_fileSource.is_open(),
 		  util::FileOpenException,
@@ -72,25 +98,15 @@ bool OnDiskWrapper::OpenForLoad(const std::string &filePath)
 		  util::FileOpenException,
 		  "Couldn't open file " << filePath << "/TargetColl.dat");
 
-  m_fileVocab.open((filePath + "/Vocab.dat").c_str(), ios::in);
-  UTIL_THROW_IF(!m_fileVocab.is_open(),
-		  util::FileOpenException,
-		  "Couldn't open file " << filePath << "/Vocab.dat");
-
-  m_fileMisc.open((filePath + "/Misc.dat").c_str(), ios::in);
-  UTIL_THROW_IF(!m_fileMisc.is_open(),
-		  util::FileOpenException,
-		  "Couldn't open file " << filePath << "/Misc.dat");
-
-  // set up root node
-  LoadMisc();
-  m_numSourceFactors = GetMisc("NumSourceFactors");
-  m_numTargetFactors = GetMisc("NumTargetFactors");
-  m_numScores = GetMisc("NumScores");
-
   return true;
 }
 
+void OnDiskWrapper::MapFile(const std::string &filePath, util::scoped_memory &to)
+{
+  util::scoped_fd file(util::OpenReadOrThrow(filePath.c_str()));
+  util::MapRead(util::LAZY, file.get(), 0, util::SizeOrThrow(file.get()), to);
+}
+
 bool OnDiskWrapper::LoadMisc()
 {
   char line[100000];
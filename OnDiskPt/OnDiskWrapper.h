@@ -23,6 +23,7 @@
 #include "Vocab.h"
 #include "PhraseNode.h"
 #include "moses/Word.h"
+#include "util/mmap.hh"
 
 namespace OnDiskPt
 {
@@ -40,6 +41,10 @@ protected:
   int m_numSourceFactors, m_numTargetFactors, m_numScores;
   std::fstream m_fileMisc, m_fileVocab, m_fileSource, m_fileTarget, m_fileTargetInd, m_fileTargetColl;
 
+  // tables in the mapped format are read in place
+  bool m_mapped;
+  util::scoped_memory m_mappedSource, m_mappedTargetColl;
+
   size_t m_defaultNodeSize;
   PhraseNode *m_rootSourceNode;
 
@@ -48,9 +53,11 @@ protected:
   void SaveMisc();
   bool OpenForLoad(const std::string &filePath);
   bool LoadMisc();
+  void MapFile(const std::string &filePath, util::scoped_memory &to);
 
 public:
   static int VERSION_NUM;
+  static int MAPPED_VERSION_NUM; //!< see MappedLayout.h
 
   OnDiskWrapper();
   ~OnDiskWrapper();
@@ -105,6 +112,17 @@ public:
 
   UINT64 GetMisc(const std::string &key) const;
 
+  //! true if the table was loaded from the mapped format. it can then be shared between threads
+  bool IsMapped() const {
+    return m_mapped;
+  }
+  const char *GetMappedSource() const {
+    return m_mappedSource.begin();
+  }
+  const char *GetMappedTargetColl() const {
+    return m_mappedTargetColl.begin();
+  }
+
   Word *ConvertFromMoses(const std::vector<Moses::FactorType> &factorsVec
                          , const Moses::Word &origWord) const;
 
@@ -17,10 +17,13 @@
  License along with this library; if not, write to the Free Software
  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  ***********************************************************************/
+#include <algorithm>
 #include "PhraseNode.h"
 #include "OnDiskWrapper.h"
 #include "TargetPhraseCollection.h"
 #include "SourcePhrase.h"
+#include "MappedLayout.h"
+#include "moses/TargetPhraseCollection.h"
 #include "moses/Util.h"
 #include "util/exception.hh"
 
@@ -42,15 +45,26 @@ PhraseNode::PhraseNode()
   ,m_currChild(NULL)
   ,m_saved(false)
   ,m_memLoad(NULL)
+  ,m_mappedNode(NULL)
 {
 }
 
 PhraseNode::PhraseNode(UINT64 filePos, OnDiskWrapper &onDiskWrapper)
   :m_counts(onDiskWrapper.GetNumCounts())
+  ,m_memLoad(NULL)
+  ,m_mappedNode(NULL)
 {
   // load saved node
   m_filePos = filePos;
 
+  if (onDiskWrapper.IsMapped()) {
+    m_mappedNode = reinterpret_cast<const MappedNode*>(onDiskWrapper.GetMappedSource() + filePos);
+    m_numChildrenLoad = m_mappedNode->numChildren;
+    m_value = m_mappedNode->targetColl;
+    m_counts[0] = m_mappedNode->count;
+    return;
+  }
+
   size_t countSize = onDiskWrapper.GetNumCounts();
 
   std::fstream &file = onDiskWrapper.GetFileSource();
@@ -196,6 +210,18 @@ void PhraseNode::AddTargetPhrase(size_t pos, const SourcePhrase &sourcePhrase
 
 const PhraseNode *PhraseNode::GetChild(const Word &wordSought, OnDiskWrapper &onDiskWrapper) const
 {
+  if (m_mappedNode) {
+    const MappedChild *begin = reinterpret_cast<const MappedChild*>(m_mappedNode + 1);
+    const MappedChild *end = begin + m_numChildrenLoad;
+    MappedChild sought;
+    sought.word = MappedWordKey(wordSought);
+    const MappedChild *found = std::lower_bound(begin, end, sought);
+    if (found == end || found->word != sought.word) {
+      return NULL;
+    }
+    return new PhraseNode(found->node, onDiskWrapper);
+  }
+
   const PhraseNode *ret = NULL;
 
   int l = 0;
@@ -224,6 +250,12 @@ const PhraseNode *PhraseNode::GetChild(const Word &wordSought, OnDiskWrapper &on
 
 void PhraseNode::GetChild(Word &wordFound, UINT64 &childFilePos, size_t ind, OnDiskWrapper &onDiskWrapper) const
 {
+  if (m_mappedNode) {
+    const MappedChild &child = reinterpret_cast<const MappedChild*>(m_mappedNode + 1)[ind];
+    wordFound = MappedKeyToWord(child.word);
+    childFilePos = child.node;
+    return;
+  }
 
   size_t wordSize = onDiskWrapper.GetSourceWordSize();
   size_t childSize = wordSize + sizeof(UINT64);
@@ -262,6 +294,26 @@ const TargetPhraseCollection *PhraseNode::GetTargetPhraseCollection(size_t table
   return ret;
 }
 
+Moses::TargetPhraseCollection *PhraseNode::GetMosesTargetPhraseCollection(size_t tableLimit
+    , const std::vector<Moses::FactorType> &inputFactors
+    , const std::vector<Moses::FactorType> &outputFactors
+    , const Moses::PhraseDictionary &phraseDict
+    , const std::vector<float> &weightT
+    , bool isSyntax
+    , OnDiskWrapper &onDiskWrapper) const
+{
+  if (m_mappedNode) {
+    return TargetPhraseCollection::ConvertMappedToMoses(m_value, tableLimit, inputFactors, outputFactors
+           , phraseDict, weightT, isSyntax, onDiskWrapper);
+  }
+
+  const TargetPhraseCollection *onDisk = GetTargetPhraseCollection(tableLimit, onDiskWrapper);
+  Moses::TargetPhraseCollection *ret = onDisk->ConvertToMoses(inputFactors, outputFactors
+                                       , phraseDict, weightT, onDiskWrapper.GetVocab(), isSyntax);
+  delete onDisk;
+  return ret;
+}
+
 std::ostream& operator<<(std::ostream &out, const PhraseNode &node)
 {
   out << "node (" << node.GetFilePos() << "," << node.GetValue() << "," << node.m_pos << ")";
@@ -25,11 +25,18 @@
 #include "TargetPhraseCollection.h"
 #include "Phrase.h"
 
+namespace Moses
+{
+class PhraseDictionary;
+class TargetPhraseCollection;
+}
+
 namespace OnDiskPt
 {
 
 class OnDiskWrapper;
 class SourcePhrase;
+struct MappedNode;
 
 /** A node in the source tree trie */
 class PhraseNode
@@ -49,12 +56,12 @@ protected:
 
   char *m_memLoad, *m_memLoadLast;
   UINT64 m_numChildrenLoad;
+  const MappedNode *m_mappedNode; // in place of m_memLoad for mapped tables
 
   void AddTargetPhrase(size_t pos, const SourcePhrase &sourcePhrase
                        , TargetPhrase *targetPhrase, OnDiskWrapper &onDiskWrapper
                        , size_t tableLimit, const std::vector<float> &counts, OnDiskPt::PhrasePtr spShort);
   size_t ReadChild(Word &wordFound, UINT64 &childFilePos, const char *mem) const;
-  void GetChild(Word &wordFound, UINT64 &childFilePos, size_t ind, OnDiskWrapper &onDiskWrapper) const;
 
 public:
   static size_t GetNodeSize(size_t numChildren, size_t wordSize, size_t countSize);
@@ -94,6 +101,21 @@ public:
   const PhraseNode *GetChild(const Word &wordSought, OnDiskWrapper &onDiskWrapper) const;
   const TargetPhraseCollection *GetTargetPhraseCollection(size_t tableLimit, OnDiskWrapper &onDiskWrapper) const;
 
+  //! rules of this node as moses target phrases. decoded in place for mapped tables
+  Moses::TargetPhraseCollection *GetMosesTargetPhraseCollection(size_t tableLimit
+      , const std::vector<Moses::FactorType> &inputFactors
+      , const std::vector<Moses::FactorType> &outputFactors
+      , const Moses::PhraseDictionary &phraseDict
+      , const std::vector<float> &weightT
+      , bool isSyntax
+      , OnDiskWrapper &onDiskWrapper) const;
+
+  //! children of a loaded node, in the order they are stored
+  UINT64 GetNumChildren() const {
+    return m_numChildrenLoad;
+  }
+  void GetChild(Word &wordFound, UINT64 &childFilePos, size_t ind, OnDiskWrapper &onDiskWrapper) const;
+
   void AddCounts(const std::vector<float> &counts) {
     m_counts = counts;
   }
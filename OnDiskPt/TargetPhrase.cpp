@@ -25,6 +25,7 @@
 #include "moses/TranslationModel/PhraseDictionary.h"
 #include "TargetPhrase.h"
 #include "OnDiskWrapper.h"
+#include "MappedLayout.h"
 #include "util/exception.hh"
 
 #include <boost/algorithm/string.hpp>
@@ -334,6 +335,89 @@ UINT64 TargetPhrase::ReadFromFile(std::fstream &fileTP)
   return bytesRead;
 }
 
+void TargetPhrase::ReadFromMapped(const MappedRule &rule)
+{
+  const UINT64 *words = rule.GetWords();
+  for (size_t ind = 0; ind < rule.numWords; ++ind) {
+    AddWord(WordPtr(new Word(MappedKeyToWord(words[ind]))));
+  }
+
+  const UINT64 *sourceWords = rule.GetSourceWords();
+  PhrasePtr sp(new SourcePhrase());
+  for (size_t ind = 0; ind < rule.numSourceWords; ++ind) {
+    sp->AddWord(WordPtr(new Word(MappedKeyToWord(sourceWords[ind]))));
+  }
+  SetSourcePhrase(sp);
+
+  const UINT32 *align = rule.GetAlign();
+  for (size_t ind = 0; ind < rule.numAlign; ++ind) {
+    m_align.push_back(AlignPair(align[2 * ind], align[2 * ind + 1]));
+  }
+
+  // stored transformed and floored already
+  const float *scores = rule.GetScores();
+  std::copy(scores, scores + m_scores.size(), m_scores.begin());
+}
+
+Moses::TargetPhrase *TargetPhrase::ConvertMappedToMoses(const MappedRule &rule
+    , size_t numScores
+    , const std::vector<Moses::FactorType> &inputFactors
+    , const std::vector<Moses::FactorType> &outputFactors
+    , const Vocab &vocab
+    , const Moses::PhraseDictionary &phraseDict
+    , bool isSyntax)
+{
+  Moses::TargetPhrase *ret = new Moses::TargetPhrase();
+
+  // words
+  const UINT64 *words = rule.GetWords();
+  size_t phraseSize = rule.numWords;
+  UTIL_THROW_IF2(phraseSize == 0, "Target phrase cannot be empty"); // last word is lhs
+  if (isSyntax) {
+    --phraseSize;
+  }
+
+  for (size_t pos = 0; pos < phraseSize; ++pos) {
+    MappedKeyToWord(words[pos]).ConvertToMoses(outputFactors, vocab, ret->AddWord());
+  }
+
+  // alignments
+  Moses::AlignmentInfo::CollType alignTerm, alignNonTerm;
+  const UINT32 *align = rule.GetAlign();
+  for (size_t ind = 0; ind < rule.numAlign; ++ind) {
+    size_t sourcePos = align[2 * ind];
+    size_t targetPos = align[2 * ind + 1];
+
+    if (words[targetPos] & 1) {
+      alignNonTerm.insert(std::pair<size_t,size_t>(sourcePos, targetPos));
+    } else {
+      alignTerm.insert(std::pair<size_t,size_t>(sourcePos, targetPos));
+    }
+  }
+  ret->SetAlignTerm(alignTerm);
+  ret->SetAlignNonTerm(alignNonTerm);
+
+  if (isSyntax) {
+    Moses::Word *lhsTarget = new Moses::Word(true);
+    MappedKeyToWord(words[rule.numWords - 1]).ConvertToMoses(outputFactors, vocab, *lhsTarget);
+    ret->SetTargetLHS(lhsTarget);
+  }
+
+  // set source phrase
+  const UINT64 *sourceWords = rule.GetSourceWords();
+  Moses::Phrase mosesSP(Moses::Input);
+  for (size_t pos = 0; pos < rule.numSourceWords; ++pos) {
+    MappedKeyToWord(sourceWords[pos]).ConvertToMoses(inputFactors, vocab, mosesSP.AddWord());
+  }
+
+  // scores
+  const float *scores = rule.GetScores();
+  ret->GetScoreBreakdown().Assign(&phraseDict, std::vector<float>(scores, scores + numScores));
+  ret->Evaluate(mosesSP, phraseDict.GetFeaturesToApply());
+
+  return ret;
+}
+
 UINT64 TargetPhrase::ReadAlignFromFile(std::fstream &fileTPColl)
 {
   UINT64 bytesRead = 0;
@@ -40,6 +40,7 @@ typedef std::pair<UINT64, UINT64>  AlignPair;
 typedef std::vector<AlignPair> AlignType;
 
 class Vocab;
+struct MappedRule;
 
 /** A target phrase, with the score breakdowns, alignment info and assorted other information it need.
  *  Readable and writeable to disk
@@ -107,6 +108,16 @@ public:
                                       , bool isSyntax) const;
   UINT64 ReadOtherInfoFromFile(UINT64 filePos, std::fstream &fileTPColl);
   UINT64 ReadFromFile(std::fstream &fileTP);
+  void ReadFromMapped(const MappedRule &rule);
+
+  //! like ConvertToMoses(), straight from a rule of a mapped table
+  static Moses::TargetPhrase *ConvertMappedToMoses(const MappedRule &rule
+      , size_t numScores
+      , const std::vector<Moses::FactorType> &inputFactors
+      , const std::vector<Moses::FactorType> &outputFactors
+      , const Vocab &vocab
+      , const Moses::PhraseDictionary &phraseDict
+      , bool isSyntax);
 
   virtual void DebugPrint(std::ostream &out, const Vocab &vocab) const;
 
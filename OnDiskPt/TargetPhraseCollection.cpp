@@ -26,6 +26,7 @@
 #include "TargetPhraseCollection.h"
 #include "Vocab.h"
 #include "OnDiskWrapper.h"
+#include "MappedLayout.h"
 
 using namespace std;
 
@@ -147,13 +148,58 @@ Moses::TargetPhraseCollection *TargetPhraseCollection::ConvertToMoses(const std:
 
 }
 
+Moses::TargetPhraseCollection *TargetPhraseCollection::ConvertMappedToMoses(UINT64 filePos
+    , size_t tableLimit
+    , const std::vector<Moses::FactorType> &inputFactors
+    , const std::vector<Moses::FactorType> &outputFactors
+    , const Moses::PhraseDictionary &phraseDict
+    , const std::vector<float> &/*weightT*/
+    , bool isSyntax
+    , OnDiskWrapper &onDiskWrapper)
+{
+  Moses::TargetPhraseCollection *ret = new Moses::TargetPhraseCollection();
+  if (filePos == 0) {
+    return ret;
+  }
+
+  UINT64 numPhrases;
+  const MappedRule *rule = GetMappedRules(onDiskWrapper.GetMappedTargetColl() + filePos, numPhrases);
+  if (tableLimit) {
+    numPhrases = std::min(numPhrases, (UINT64) tableLimit);
+  }
+
+  const size_t numScores = onDiskWrapper.GetNumScores();
+  for (size_t ind = 0; ind < numPhrases; ++ind, rule = rule->Next()) {
+    ret->Add(TargetPhrase::ConvertMappedToMoses(*rule, numScores, inputFactors, outputFactors
+             , onDiskWrapper.GetVocab(), phraseDict, isSyntax));
+  }
+
+  ret->Sort(true, phraseDict.GetTableLimit());
+
+  return ret;
+}
+
 void TargetPhraseCollection::ReadFromFile(size_t tableLimit, UINT64 filePos, OnDiskWrapper &onDiskWrapper)
 {
+  size_t numScores = onDiskWrapper.GetNumScores();
+
+  if (onDiskWrapper.IsMapped()) {
+    UINT64 numPhrases;
+    const MappedRule *rule = GetMappedRules(onDiskWrapper.GetMappedTargetColl() + filePos, numPhrases);
+    if (tableLimit) {
+      numPhrases = std::min(numPhrases, (UINT64) tableLimit);
+    }
+    for (size_t ind = 0; ind < numPhrases; ++ind, rule = rule->Next()) {
+      TargetPhrase *tp = new TargetPhrase(numScores);
+      tp->ReadFromMapped(*rule);
+      m_coll.push_back(tp);
+    }
+    return;
+  }
+
   fstream &fileTPColl = onDiskWrapper.GetFileTargetColl();
   fstream &fileTP = onDiskWrapper.GetFileTargetInd();
 
-  size_t numScores = onDiskWrapper.GetNumScores();
-
 
   UINT64 numPhrases;
 
@@ -77,6 +77,16 @@ public:
       , bool isSyntax) const;
   void ReadFromFile(size_t tableLimit, UINT64 filePos, OnDiskWrapper &onDiskWrapper);
 
+  //! convert the collection at filePos of a mapped table without reading it into a TargetPhraseCollection first
+  static Moses::TargetPhraseCollection *ConvertMappedToMoses(UINT64 filePos
+      , size_t tableLimit
+      , const std::vector<Moses::FactorType> &inputFactors
+      , const std::vector<Moses::FactorType> &outputFactors
+      , const Moses::PhraseDictionary &phraseDict
+      , const std::vector<float> &weightT
+      , bool isSyntax
+      , OnDiskWrapper &onDiskWrapper);
+
   const std::string GetDebugStr() const;
   void SetDebugStr(const std::string &str);
 
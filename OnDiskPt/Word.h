@@ -70,6 +70,9 @@ public:
   void SetVocabId(UINT32 vocabId) {
     m_vocabId = vocabId;
   }
+  UINT64 GetVocabId() const {
+    return m_vocabId;
+  }
 
   void ConvertToMoses(
     const std::vector<Moses::FactorType> &outputFactorsVec,
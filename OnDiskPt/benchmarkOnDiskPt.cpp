@@ -0,0 +1,171 @@
+// Compare lookup speed of an on-disk rule table and its conversion by convertOnDiskPt
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "moses/Timer.h"
+#include "OnDiskWrapper.h"
+#include "MappedLayout.h"
+#include "TargetPhrase.h"
+#include "TargetPhraseCollection.h"
+#include "util/exception.hh"
+
+using namespace std;
+using namespace OnDiskPt;
+using Moses::Timer;
+
+namespace
+{
+
+typedef vector<Word> Path;
+
+//! source phrases found by random walks down the trie
+void SamplePaths(OnDiskWrapper &table, size_t numPaths, vector<Path> &paths)
+{
+  const PhraseNode &root = table.GetRootSourceNode();
+  UTIL_THROW_IF2(root.GetNumChildren() == 0, "Table is empty");
+
+  while (paths.size() < numPaths) {
+    Path path;
+    const PhraseNode *node = &root;
+    do {
+      Word word;
+      UINT64 childFilePos;
+      node->GetChild(word, childFilePos, rand() % node->GetNumChildren(), table);
+      path.push_back(word);
+
+      if (node != &root) delete node;
+      node = new PhraseNode(childFilePos, table);
+    } while (node->GetNumChildren() > 0 && rand() % 3);
+    delete node;
+
+    paths.push_back(path);
+  }
+}
+
+const PhraseNode *Find(OnDiskWrapper &table, const Path &path)
+{
+  const PhraseNode *node = &table.GetRootSourceNode();
+  for (size_t pos = 0; pos < path.size() && node; ++pos) {
+    const PhraseNode *child = node->GetChild(path[pos], table);
+    if (pos) delete node;
+    node = child;
+  }
+  return node;
+}
+
+//! look up every path and read its rules. returns the sum of all scores
+double LookupCollections(OnDiskWrapper &table, const vector<Path> &paths, size_t tableLimit)
+{
+  double sum = 0;
+  for (size_t ind = 0; ind < paths.size(); ++ind) {
+    const PhraseNode *node = Find(table, paths[ind]);
+    UTIL_THROW_IF2(!node, "Sampled phrase not found");
+    const TargetPhraseCollection *coll = node->GetTargetPhraseCollection(tableLimit, table);
+    for (size_t i = 0; i < coll->GetSize(); ++i) {
+      const vector<float> &scores = coll->GetTargetPhrase(i).GetScores();
+      for (size_t j = 0; j < scores.size(); ++j) {
+        sum += scores[j];
+      }
+    }
+    delete coll;
+    delete node;
+  }
+  return sum;
+}
+
+//! the same, reading the rules of a mapped table in place
+double LookupInPlace(OnDiskWrapper &table, const vector<Path> &paths, size_t tableLimit)
+{
+  double sum = 0;
+  for (size_t ind = 0; ind < paths.size(); ++ind) {
+    const PhraseNode *node = Find(table, paths[ind]);
+    UTIL_THROW_IF2(!node, "Sampled phrase not found");
+    if (node->GetValue()) {
+      UINT64 numRules;
+      const MappedRule *rule = GetMappedRules(table.GetMappedTargetColl() + node->GetValue(), numRules);
+      if (tableLimit) {
+        numRules = std::min(numRules, (UINT64) tableLimit);
+      }
+      for (size_t i = 0; i < numRules; ++i, rule = rule->Next()) {
+        const float *scores = rule->GetScores();
+        for (size_t j = 0; j < table.GetNumScores(); ++j) {
+          sum += scores[j];
+        }
+      }
+    }
+    delete node;
+  }
+  return sum;
+}
+
+void Report(const string &name, Timer &timer, size_t numLookups, double checksum)
+{
+  timer.stop();
+  double seconds = timer.get_elapsed_time();
+  cout << name << "\t" << seconds << " s\t" << 1e6 * seconds / numLookups << " us/lookup\tchecksum "
+       << checksum << endl;
+}
+
+void usage()
+{
+  cerr << "Usage: benchmarkOnDiskPt <old-table> <mapped-table> [-lookups N] [-tlimit L]\n"
+       "-lookups N   number of source phrases to look up (default: 100000)\n"
+       "-tlimit L    max number of rules per source phrase, 0 for all (default: 20)\n";
+  exit(1);
+}
+
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 3)
+    usage();
+  size_t numLookups = 100000, tableLimit = 20;
+  for (int i = 3; i < argc; i++) {
+    if (!strcmp(argv[i], "-lookups") && i + 1 < argc) {
+      numLookups = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-tlimit") && i + 1 < argc) {
+      tableLimit = atoi(argv[++i]);
+    } else {
+      usage();
+    }
+  }
+
+  OnDiskWrapper oldTable, mappedTable;
+  oldTable.BeginLoad(argv[1]);
+  mappedTable.BeginLoad(argv[2]);
+  UTIL_THROW_IF2(oldTable.IsMapped() || !mappedTable.IsMapped(),
+                 "Expected a table of version " << OnDiskWrapper::VERSION_NUM
+                 << " and its conversion to version " << OnDiskWrapper::MAPPED_VERSION_NUM);
+
+  // both share Vocab.dat, so the words of one can be looked up in the other
+  vector<Path> paths;
+  srand(1);
+  SamplePaths(oldTable, numLookups, paths);
+
+  Timer oldTimer;
+  oldTimer.start();
+  double oldSum = LookupCollections(oldTable, paths, tableLimit);
+  Report("old", oldTimer, numLookups, oldSum);
+
+  Timer mappedTimer;
+  mappedTimer.start();
+  double mappedSum = LookupCollections(mappedTable, paths, tableLimit);
+  Report("mapped", mappedTimer, numLookups, mappedSum);
+
+  Timer inPlaceTimer;
+  inPlaceTimer.start();
+  double inPlaceSum = LookupInPlace(mappedTable, paths, tableLimit);
+  Report("in-place", inPlaceTimer, numLookups, inPlaceSum);
+
+  if (oldSum != mappedSum || oldSum != inPlaceSum) {
+    cerr << "Checksums differ" << endl;
+    return 1;
+  }
+  return 0;
+}
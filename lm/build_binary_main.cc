@@ -1,8 +1,13 @@
 #include "lm/model.hh"
 #include "lm/sizes.hh"
+#include "lm/read_arpa.hh"
 #include "util/file_piece.hh"
 #include "util/usage.hh"
 
+#ifndef NTHREAD
+#include "lm/parallel_arpa.hh"
+#endif
+
 #include <algorithm>
 #include <cstdlib>
 #include <exception>
@@ -24,7 +29,7 @@ namespace ngram {
 namespace {
 
 void Usage(const char *name, const char *default_mem) {
-  std::cerr << "Usage: " << name << " [-u log10_unknown_probability] [-s] [-i] [-w mmap|after] [-p probing_multiplier] [-T trie_temporary] [-S trie_building_mem] [-q bits] [-b bits] [-a bits] [type] input.arpa [output.mmap]\n\n"
+  std::cerr << "Usage: " << name << " [-u log10_unknown_probability] [-s] [-i] [-w mmap|after] [-p probing_multiplier] [-T trie_temporary] [-S trie_building_mem] [-q bits] [-b bits] [-a bits] [-j threads] [type] input.arpa [output.mmap]\n\n"
 "-u sets the log10 probability for <unk> if the ARPA file does not have one.\n"
 "   Default is -100.  The ARPA file will always take precedence.\n"
 "-s allows models to be built even if they do not have <s> and </s>.\n"
@@ -52,6 +57,10 @@ void Usage(const char *name, const char *default_mem) {
 "-a compresses pointers using an array of offsets.  The parameter is the\n"
 "   maximum number of bits encoded by the array.  Memory is minimized subject\n"
 "   to the maximum, so pick 255 to minimize memory.\n\n"
+#ifndef NTHREAD
+"-j parses the ARPA file with this many threads while another builds the model.\n"
+"   The binary file is the same.  Default is 1, which parses while building.\n\n"
+#endif
 "-h print this help message.\n\n"
 "Get a memory estimate by passing an ARPA file without an output file name.\n";
   exit(1);
@@ -91,6 +100,20 @@ void ParseFileList(const char *from, std::vector<std::string> &to) {
   }
 }
 
+template <class Model> void Build(const char *from_file, const Config &config, std::size_t threads) {
+#ifndef NTHREAD
+  if (threads > 1) {
+    util::FilePiece f(from_file, config.ProgressMessages());
+    std::vector<uint64_t> counts;
+    ReadARPACounts(f, counts);
+    ParallelARPA source(f, counts, threads);
+    Model(source, config);
+    return;
+  }
+#endif
+  Model(from_file, config);
+}
+
 void ProbingQuantizationUnsupported() {
   std::cerr << "Quantization is only implemented in the trie data structure." << std::endl;
   exit(1);
@@ -110,10 +133,11 @@ int main(int argc, char *argv[]) {
 
   try {
     bool quantize = false, set_backoff_bits = false, bhiksha = false, set_write_method = false, rest = false;
+    std::size_t threads = 1;
     lm::ngram::Config config;
     config.building_memory = util::ParseSize(default_mem);
     int opt;
-    while ((opt = getopt(argc, argv, "q:b:a:u:p:t:T:m:S:w:sir:h")) != -1) {
+    while ((opt = getopt(argc, argv, "q:b:a:u:p:t:T:m:S:w:sir:j:h")) != -1) {
       switch(opt) {
         case 'q':
           config.prob_bits = ParseBitCount(optarg);
@@ -165,6 +189,9 @@ int main(int argc, char *argv[]) {
           ParseFileList(optarg, config.rest_lower_files);
           config.rest_function = Config::REST_LOWER;
           break;
+        case 'j':
+          threads = ParseUInt(optarg);
+          break;
         case 'h': // help
         default:
           Usage(argv[0], default_mem);
@@ -197,9 +224,9 @@ int main(int argc, char *argv[]) {
       if (!set_write_method) config.write_method = Config::WRITE_AFTER;
       if (quantize || set_backoff_bits) ProbingQuantizationUnsupported();
       if (rest) {
-        RestProbingModel(from_file, config);
+        Build<RestProbingModel>(from_file, config, threads);
       } else {
-        ProbingModel(from_file, config);
+        Build<ProbingModel>(from_file, config, threads);
       }
     } else if (!strcmp(model_type, "trie")) {
       if (rest) {
@@ -209,15 +236,15 @@ int main(int argc, char *argv[]) {
       if (!set_write_method) config.write_method = Config::WRITE_MMAP;
       if (quantize) {
         if (bhiksha) {
-          QuantArrayTrieModel(from_file, config);
+          Build<QuantArrayTrieModel>(from_file, config, threads);
         } else {
-          QuantTrieModel(from_file, config);
+          Build<QuantTrieModel>(from_file, config, threads);
         }
       } else {
         if (bhiksha) {
-          ArrayTrieModel(from_file, config);
+          Build<ArrayTrieModel>(from_file, config, threads);
         } else {
-          TrieModel(from_file, config);
+          Build<TrieModel>(from_file, config, threads);
         }
       }
     } else {
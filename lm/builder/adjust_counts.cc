@@ -21,60 +21,24 @@ const WordIndex* FindDifference(const NGram &full, const NGram &lower_last) {
 
 class StatCollector {
   public:
-    StatCollector(std::size_t order, std::vector<uint64_t> &counts, std::vector<Discount> &discounts) 
-      : orders_(order), full_(orders_.back()), counts_(counts), discounts_(discounts) {
-      memset(&orders_[0], 0, sizeof(OrderStat) * order);
-    }
-
-    ~StatCollector() {}
-
-    void CalculateDiscounts() {
-      counts_.resize(orders_.size());
-      discounts_.resize(orders_.size());
-      for (std::size_t i = 0; i < orders_.size(); ++i) {
-        const OrderStat &s = orders_[i];
-        counts_[i] = s.count;
-
-        for (unsigned j = 1; j < 4; ++j) {
-          // TODO: Specialize error message for j == 3, meaning 3+
-          UTIL_THROW_IF(s.n[j] == 0, BadDiscountException, "Could not calculate Kneser-Ney discounts for "
-              << (i+1) << "-grams with adjusted count " << (j+1) << " because we didn't observe any "
-              << (i+1) << "-grams with adjusted count " << j << "; Is this small or artificial data?");
-        }
-
-        // See equation (26) in Chen and Goodman.
-        discounts_[i].amount[0] = 0.0;
-        float y = static_cast<float>(s.n[1]) / static_cast<float>(s.n[1] + 2.0 * s.n[2]);
-        for (unsigned j = 1; j < 4; ++j) {
-          discounts_[i].amount[j] = static_cast<float>(j) - static_cast<float>(j + 1) * y * static_cast<float>(s.n[j+1]) / static_cast<float>(s.n[j]);
-          UTIL_THROW_IF(discounts_[i].amount[j] < 0.0 || discounts_[i].amount[j] > j, BadDiscountException, "ERROR: " << (i+1) << "-gram discount out of range for adjusted count " << j << ": " << discounts_[i].amount[j]);
-        }
-      }
+    StatCollector(std::size_t order, std::vector<AdjustedStats> &orders)
+      : orders_(orders) {
+      orders_.resize(order);
+      memset(&orders_[0], 0, sizeof(AdjustedStats) * order);
     }
 
     void Add(std::size_t order_minus_1, uint64_t count) {
-      OrderStat &stat = orders_[order_minus_1];
+      AdjustedStats &stat = orders_[order_minus_1];
       ++stat.count;
       if (count < 5) ++stat.n[count];
     }
 
     void AddFull(uint64_t count) {
-      ++full_.count;
-      if (count < 5) ++full_.n[count];
+      Add(orders_.size() - 1, count);
     }
 
   private:
-    struct OrderStat {
-      // n_1 in equation 26 of Chen and Goodman etc
-      uint64_t n[5];
-      uint64_t count;
-    };
-
-    std::vector<OrderStat> orders_;
-    OrderStat &full_;
-
-    std::vector<uint64_t> &counts_;
-    std::vector<Discount> &discounts_;
+    std::vector<AdjustedStats> &orders_;
 };
 
 // Reads all entries in order like NGramStream does.  
@@ -138,16 +102,42 @@ class CollapseStream {
 
 } // namespace
 
+void CalculateDiscounts(const std::vector<AdjustedStats> &stats, std::vector<uint64_t> &counts, std::vector<Discount> &discounts) {
+  counts.resize(stats.size());
+  discounts.resize(stats.size());
+  for (std::size_t i = 0; i < stats.size(); ++i) {
+    const AdjustedStats &s = stats[i];
+    counts[i] = s.count;
+
+    for (unsigned j = 1; j < 4; ++j) {
+      // TODO: Specialize error message for j == 3, meaning 3+
+      UTIL_THROW_IF(s.n[j] == 0, BadDiscountException, "Could not calculate Kneser-Ney discounts for "
+          << (i+1) << "-grams with adjusted count " << (j+1) << " because we didn't observe any "
+          << (i+1) << "-grams with adjusted count " << j << "; Is this small or artificial data?");
+    }
+
+    // See equation (26) in Chen and Goodman.
+    discounts[i].amount[0] = 0.0;
+    float y = static_cast<float>(s.n[1]) / static_cast<float>(s.n[1] + 2.0 * s.n[2]);
+    for (unsigned j = 1; j < 4; ++j) {
+      discounts[i].amount[j] = static_cast<float>(j) - static_cast<float>(j + 1) * y * static_cast<float>(s.n[j+1]) / static_cast<float>(s.n[j]);
+      UTIL_THROW_IF(discounts[i].amount[j] < 0.0 || discounts[i].amount[j] > j, BadDiscountException, "ERROR: " << (i+1) << "-gram discount out of range for adjusted count " << j << ": " << discounts[i].amount[j]);
+    }
+  }
+}
+
 void AdjustCounts::Run(const ChainPositions &positions) {
   UTIL_TIMER("(%w s) Adjusted counts\n");
 
   const std::size_t order = positions.size();
-  StatCollector stats(order, counts_, discounts_);
+  std::vector<AdjustedStats> own_stats;
+  std::vector<AdjustedStats> &stats_out = stats_ ? *stats_ : own_stats;
+  StatCollector stats(order, stats_out);
   if (order == 1) {
     // Only unigrams.  Just collect stats.  
     for (NGramStream full(positions[0]); full; ++full) 
       stats.AddFull(full->Count());
-    stats.CalculateDiscounts();
+    if (!stats_) CalculateDiscounts(stats_out, *counts_, *discounts_);
     return;
   }
 
@@ -208,7 +198,7 @@ void AdjustCounts::Run(const ChainPositions &positions) {
   for (NGramStream *s = streams.begin(); s != streams.end(); ++s)
     s->Poison();
 
-  stats.CalculateDiscounts();
+  if (!stats_) CalculateDiscounts(stats_out, *counts_, *discounts_);
 
   // NOTE: See special early-return case for unigrams near the top of this function
 }
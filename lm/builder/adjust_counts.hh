@@ -19,6 +19,17 @@ class BadDiscountException : public util::Exception {
     ~BadDiscountException() throw();
 };
 
+// Statistics of one order that determine its discounts.  These add up across
+// shards.
+struct AdjustedStats {
+  // n_1 in equation 26 of Chen and Goodman etc
+  uint64_t n[5];
+  uint64_t count;
+};
+
+// Count and discounts of each order from their statistics.
+void CalculateDiscounts(const std::vector<AdjustedStats> &stats, std::vector<uint64_t> &counts, std::vector<Discount> &discounts);
+
 /* Compute adjusted counts.  
  * Input: unique suffix sorted N-grams (and just the N-grams) with raw counts.
  * Output: [1,N]-grams with adjusted counts.  
@@ -28,13 +39,18 @@ class BadDiscountException : public util::Exception {
 class AdjustCounts {
   public:
     AdjustCounts(std::vector<uint64_t> &counts, std::vector<Discount> &discounts)
-      : counts_(counts), discounts_(discounts) {}
+      : counts_(&counts), discounts_(&discounts), stats_(NULL) {}
+
+    // Only collect the statistics, for a shard.  See CalculateDiscounts.
+    explicit AdjustCounts(std::vector<AdjustedStats> &stats)
+      : counts_(NULL), discounts_(NULL), stats_(&stats) {}
 
     void Run(const ChainPositions &positions);
 
   private:
-    std::vector<uint64_t> &counts_;
-    std::vector<Discount> &discounts_;
+    std::vector<uint64_t> *counts_;
+    std::vector<Discount> *discounts_;
+    std::vector<AdjustedStats> *stats_;
 };
 
 } // namespace builder
@@ -0,0 +1,79 @@
+#include "lm/builder/binary.hh"
+
+#include "lm/builder/print.hh"
+#include "lm/model.hh"
+#include "lm/read_arpa.hh"
+#include "util/exception.hh"
+#include "util/stream/timer.hh"
+
+#include <algorithm>
+
+namespace lm { namespace builder {
+namespace {
+
+class ChainSource : public NGramSource {
+  public:
+    ChainSource(const ChainPositions &positions, const VocabReconstitute &vocab, const std::vector<uint64_t> &counts)
+      : NGramSource(counts), streams_(positions), vocab_(vocab), current_(NULL), words_(counts.size()) {}
+
+    void BeginOrder(unsigned int order) {
+      current_ = &streams_[order - 1];
+    }
+
+    const WordIndex *Read(float &prob, float &backoff) {
+      NGramStream &stream = *current_;
+      UTIL_THROW_IF(!stream, util::Exception, "The " << (current_ - streams_.begin() + 1) << "-grams ended before their count.");
+      // Correcting for numerical precision issues, as in PrintARPA.
+      prob = std::min(0.0f, stream->Value().complete.prob);
+      backoff = stream->Value().complete.backoff;
+      std::copy(stream->begin(), stream->end(), words_.begin());
+      ++stream;
+      return &words_[0];
+    }
+
+    StringPiece Word(WordIndex index) const {
+      return vocab_.LookupPiece(index);
+    }
+
+  private:
+    NGramStreams streams_;
+    const VocabReconstitute &vocab_;
+    NGramStream *current_;
+    std::vector<WordIndex> words_;
+};
+
+} // namespace
+
+BinaryOutput::BinaryOutput(const VocabReconstitute &vocab, const std::vector<uint64_t> &counts, ngram::ModelType type, const ngram::Config &config)
+  : vocab_(vocab), counts_(counts), type_(type), config_(config) {
+  UTIL_THROW_IF(!config_.write_mmap, util::Exception, "No binary file name.");
+}
+
+void BinaryOutput::Run(const ChainPositions &positions) {
+  UTIL_TIMER("(%w s) Wrote binary file\n");
+  ChainSource source(positions, vocab_, counts_);
+  switch (type_) {
+    case ngram::PROBING:
+      ngram::ProbingModel(source, config_);
+      break;
+    case ngram::REST_PROBING:
+      ngram::RestProbingModel(source, config_);
+      break;
+    case ngram::TRIE:
+      ngram::TrieModel(source, config_);
+      break;
+    case ngram::QUANT_TRIE:
+      ngram::QuantTrieModel(source, config_);
+      break;
+    case ngram::ARRAY_TRIE:
+      ngram::ArrayTrieModel(source, config_);
+      break;
+    case ngram::QUANT_ARRAY_TRIE:
+      ngram::QuantArrayTrieModel(source, config_);
+      break;
+    default:
+      UTIL_THROW(util::Exception, "Unknown model type " << type_);
+  }
+}
+
+}} // namespaces
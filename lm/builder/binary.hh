@@ -0,0 +1,35 @@
+#ifndef LM_BUILDER_BINARY__
+#define LM_BUILDER_BINARY__
+
+#include "lm/builder/multi_stream.hh"
+#include "lm/config.hh"
+#include "lm/model_type.hh"
+
+#include <vector>
+
+#include <stdint.h>
+
+// Builds a binary file straight from the interpolated n-grams, skipping the
+// ARPA file and build_binary.  Like the print routines, this reads all
+// unigrams before all bigrams etc.
+
+namespace lm { namespace builder {
+
+class VocabReconstitute;
+
+class BinaryOutput {
+  public:
+    // Writes to config.write_mmap, which must be set.
+    BinaryOutput(const VocabReconstitute &vocab, const std::vector<uint64_t> &counts, ngram::ModelType type, const ngram::Config &config);
+
+    void Run(const ChainPositions &positions);
+
+  private:
+    const VocabReconstitute &vocab_;
+    const std::vector<uint64_t> &counts_;
+    ngram::ModelType type_;
+    ngram::Config config_;
+};
+
+}} // namespaces
+#endif // LM_BUILDER_BINARY__
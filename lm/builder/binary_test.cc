@@ -0,0 +1,162 @@
+#include "lm/builder/pipeline.hh"
+
+#include "lm/model.hh"
+#include "util/file.hh"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#define BOOST_TEST_MODULE BinaryTest
+#include <boost/test/unit_test.hpp>
+
+// lmplz --binary must write the same file as build_binary does from the ARPA
+// file that lmplz writes otherwise.
+
+namespace lm { namespace builder { namespace {
+
+// A named temporary file, removed when done.
+class TempFile {
+  public:
+    TempFile() {
+      char name[] = "/tmp/binary_test_XXXXXX";
+      util::scoped_fd fd(mkstemp(name));
+      BOOST_REQUIRE(fd.get() != -1);
+      name_ = name;
+    }
+
+    ~TempFile() {
+      unlink(name_.c_str());
+    }
+
+    const char *Name() const { return name_.c_str(); }
+
+  private:
+    std::string name_;
+};
+
+std::string ReadFile(const char *name) {
+  std::ifstream in(name, std::ios::binary);
+  BOOST_REQUIRE(in);
+  return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Deterministic text with a long tail of rare words, so that every order
+// has enough singletons, doubletons etc. to estimate discounts.
+void WriteText(const char *name) {
+  std::ofstream out(name);
+  uint32_t state = 1;
+  for (unsigned int line = 0; line < 400; ++line) {
+    for (unsigned int word = 0; word < 12; ++word) {
+      state = state * 1103515245 + 12345;
+      unsigned int r = (state >> 16) % 2000;
+      out << (word ? " " : "") << "w" << 2000 / (r + 1);
+    }
+    out << '\n';
+  }
+  BOOST_REQUIRE(out);
+}
+
+PipelineConfig MakeConfig() {
+  PipelineConfig config;
+  config.order = 3;
+  config.sort.temp_prefix = "/tmp/binary_test_sort";
+  config.sort.total_memory = 1 << 24;
+  config.sort.buffer_size = 1 << 16;
+  config.initial_probs.adder_in.total_memory = 32768;
+  config.initial_probs.adder_in.block_count = 2;
+  config.initial_probs.adder_out.total_memory = 32768;
+  config.initial_probs.adder_out.block_count = 2;
+  config.initial_probs.interpolate_unigrams = false;
+  config.read_backoffs = config.initial_probs.adder_out;
+  config.verbose_header = false;
+  config.vocab_estimate = 1000;
+  config.minimum_block = 8192;
+  config.block_count = 2;
+  // as lmplz_main.cc sets them for --binary
+  config.binary_config.temporary_directory_prefix = config.sort.temp_prefix.c_str();
+  config.binary_config.building_memory = config.TotalMemory();
+  return config;
+}
+
+// Builds a model of text both ways and checks that the files are the same.
+void CheckSameAsBuildBinary(ngram::ModelType type, const ngram::Config &binary_config) {
+  TempFile text, arpa, from_arpa, direct;
+  WriteText(text.Name());
+
+  PipelineConfig config(MakeConfig());
+  Pipeline(config, util::OpenReadOrThrow(text.Name()), util::CreateOrThrow(arpa.Name()));
+
+  // what build_binary does
+  ngram::Config load_config(binary_config);
+  load_config.write_mmap = from_arpa.Name();
+  load_config.messages = NULL;
+  switch (type) {
+    case ngram::PROBING:
+      ngram::ProbingModel(arpa.Name(), load_config);
+      break;
+    case ngram::TRIE:
+      ngram::TrieModel(arpa.Name(), load_config);
+      break;
+    case ngram::QUANT_ARRAY_TRIE:
+      ngram::QuantArrayTrieModel(arpa.Name(), load_config);
+      break;
+    default:
+      BOOST_FAIL("model type not covered by the test");
+  }
+
+  config.binary_file = direct.Name();
+  config.binary_type = type;
+  config.binary_config = binary_config;
+  Pipeline(config, util::OpenReadOrThrow(text.Name()), -1);
+
+  std::string expected(ReadFile(from_arpa.Name())), actual(ReadFile(direct.Name()));
+  BOOST_CHECK_GT(expected.size(), 0U);
+  BOOST_CHECK_EQUAL(expected.size(), actual.size());
+  BOOST_CHECK(expected == actual);
+
+  // and the binary file scores like the ARPA file
+  ngram::Config quiet;
+  quiet.messages = NULL;
+  ngram::ProbingModel reference(arpa.Name(), quiet);
+  ngram::ModelType detected;
+  BOOST_REQUIRE(ngram::RecognizeBinary(direct.Name(), detected));
+  BOOST_CHECK_EQUAL(type, detected);
+  if (type != ngram::PROBING) return;
+  ngram::ProbingModel model(direct.Name(), quiet);
+  const char *words[] = {"w1", "w2", "w1", "w3", "w12", "w1", "w49", "unseen", "w2"};
+  ngram::State ref_state(reference.BeginSentenceState()), state(model.BeginSentenceState()), out;
+  for (std::size_t i = 0; i < sizeof(words) / sizeof(const char*); ++i) {
+    float ref_prob = reference.Score(ref_state, reference.GetVocabulary().Index(words[i]), out);
+    ref_state = out;
+    float prob = model.Score(state, model.GetVocabulary().Index(words[i]), out);
+    state = out;
+    BOOST_CHECK_CLOSE(ref_prob, prob, 0.001);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Probing) {
+  ngram::Config config;
+  config.write_method = ngram::Config::WRITE_AFTER;
+  CheckSameAsBuildBinary(ngram::PROBING, config);
+}
+
+BOOST_AUTO_TEST_CASE(Trie) {
+  ngram::Config config;
+  config.write_method = ngram::Config::WRITE_MMAP;
+  CheckSameAsBuildBinary(ngram::TRIE, config);
+}
+
+BOOST_AUTO_TEST_CASE(QuantArrayTrie) {
+  ngram::Config config;
+  config.write_method = ngram::Config::WRITE_MMAP;
+  config.prob_bits = 8;
+  config.backoff_bits = 8;
+  config.pointer_bhiksha_bits = 22;
+  CheckSameAsBuildBinary(ngram::QUANT_ARRAY_TRIE, config);
+}
+
+}}} // namespaces
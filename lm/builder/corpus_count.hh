@@ -1,6 +1,7 @@
 #ifndef LM_BUILDER_CORPUS_COUNT__
 #define LM_BUILDER_CORPUS_COUNT__
 
+#include "lm/builder/shard.hh"
 #include "lm/word_index.hh"
 #include "util/scoped.hh"
 
@@ -28,7 +29,8 @@ class CorpusCount {
 
     // token_count: out.
     // type_count aka vocabulary size.  Initialize to an estimate.  It is set to the exact value.
-    CorpusCount(util::FilePiece &from, int vocab_write, uint64_t &token_count, WordIndex &type_count, std::size_t entries_per_block);
+    // Only the n-grams of shard are written, but the vocabulary is complete.
+    CorpusCount(util::FilePiece &from, int vocab_write, uint64_t &token_count, WordIndex &type_count, std::size_t entries_per_block, const ShardConfig &shard = ShardConfig());
 
     void Run(const util::stream::ChainPosition &position);
 
@@ -40,6 +42,8 @@ class CorpusCount {
 
     std::size_t dedupe_mem_size_;
     util::scoped_malloc dedupe_mem_;
+
+    const ShardConfig shard_;
 };
 
 } // namespace builder
@@ -73,4 +73,43 @@ BOOST_AUTO_TEST_CASE(Short) {
   BOOST_CHECK_EQUAL(sizeof(v) / sizeof(const char*), type_count);
 }
 
+// Sum of the n-gram counts written for shard, checking that they belong to it.
+uint64_t CountShard(const ShardConfig &shard) {
+  util::scoped_fd input_file(util::MakeTemp("corpus_count_test_temp"));
+  const char input[] = "looking on a little more loin\non a little more loin\non foo little more loin\nbar\n\n";
+  util::WriteOrThrow(input_file.get(), input, sizeof(input) - 1);
+  util::FilePiece input_piece(input_file.release(), "temp file");
+
+  util::stream::ChainConfig config;
+  config.entry_size = NGram::TotalSize(3);
+  config.total_memory = config.entry_size * 20;
+  config.block_count = 2;
+
+  util::scoped_fd vocab(util::MakeTemp("corpus_count_test_vocab"));
+
+  util::stream::Chain chain(config);
+  NGramStream stream;
+  uint64_t token_count;
+  WordIndex type_count = 10;
+  CorpusCount counter(input_piece, vocab.get(), token_count, type_count, chain.BlockSize() / chain.EntrySize(), shard);
+  chain >> boost::ref(counter) >> stream >> util::stream::kRecycle;
+
+  uint64_t sum = 0;
+  for (; stream; ++stream) {
+    BOOST_CHECK(shard.Contains(*(stream->end() - 1)));
+    sum += stream->Count();
+  }
+  // The vocabulary is complete in every shard.
+  BOOST_CHECK_EQUAL(11U, type_count);
+  return sum;
+}
+
+BOOST_AUTO_TEST_CASE(Sharded) {
+  uint64_t sum = 0;
+  for (std::size_t i = 0; i < 3; ++i) {
+    sum += CountShard(ShardConfig(i, 3));
+  }
+  BOOST_CHECK_EQUAL(CountShard(ShardConfig()), sum);
+}
+
 }}} // namespaces
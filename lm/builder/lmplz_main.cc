@@ -4,6 +4,8 @@
 #include "util/usage.hh"
 
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include <boost/program_options.hpp>
 #include <boost/version.hpp>
@@ -34,6 +36,12 @@ int main(int argc, char *argv[]) {
     lm::builder::PipelineConfig pipeline;
 
     std::string text, arpa;
+    std::size_t shards;
+    lm::builder::ShardConfig shard;
+    std::string shard_output;
+    std::vector<std::string> merge_shards;
+    std::string binary_type;
+    int prob_bits, backoff_bits, bhiksha_bits;
 
     options.add_options()
       ("help", po::bool_switch(), "Show this help message")
@@ -52,7 +60,17 @@ int main(int argc, char *argv[]) {
       ("vocab_file", po::value<std::string>(&pipeline.vocab_file)->default_value(""), "Location to write vocabulary file")
       ("verbose_header", po::bool_switch(&pipeline.verbose_header), "Add a verbose header to the ARPA file that includes information such as token count, smoothing type, etc.")
       ("text", po::value<std::string>(&text), "Read text from a file instead of stdin")
-      ("arpa", po::value<std::string>(&arpa), "Write ARPA to a file instead of stdout");
+      ("arpa", po::value<std::string>(&arpa), "Write ARPA to a file instead of stdout")
+      ("shards", po::value<std::size_t>(&shards)->default_value(1), "Count this many shards of the text in parallel threads, sharing the memory, then merge them.  Needs --text")
+      ("shard_output", po::value<std::string>(&shard_output), "Only count shard --shard_index of --shard_count, writing it to files starting with this prefix.  Shards can be counted by separate processes or machines")
+      ("shard_index", po::value<std::size_t>(&shard.index)->default_value(0), "Which shard to count with --shard_output, from 0")
+      ("shard_count", po::value<std::size_t>(&shard.count)->default_value(1), "How many shards the text is split into, for --shard_output")
+      ("merge_shards", po::value<std::vector<std::string> >(&merge_shards)->multitoken(), "Build the model from all shards of a text, given by their --shard_output prefixes, instead of reading text")
+      ("binary", po::value<std::string>(&pipeline.binary_file), "Write a binary file, as made by build_binary, here instead of ARPA")
+      ("binary_type", po::value<std::string>(&binary_type)->default_value("probing"), "Data structure of --binary: probing or trie")
+      ("quantize", po::value<int>(&prob_bits)->default_value(0), "Quantize probabilities of a --binary trie to this many bits (build_binary -q)")
+      ("backoff_bits", po::value<int>(&backoff_bits)->default_value(0), "Quantize backoffs to this many bits.  Defaults to --quantize (build_binary -b)")
+      ("bhiksha", po::value<int>(&bhiksha_bits)->default_value(0), "Compress pointers of a --binary trie with at most this many bits (build_binary -a)");
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, options), vm);
 
@@ -105,6 +123,35 @@ int main(int argc, char *argv[]) {
     initial.adder_out.block_count = 2;
     pipeline.read_backoffs = initial.adder_out;
 
+    if (vm.count("binary")) {
+      UTIL_THROW_IF(vm.count("arpa"), util::Exception, "Pass either --arpa or --binary.");
+      lm::ngram::Config &binary = pipeline.binary_config;
+      // Same as build_binary, which sorts with the memory given to -S.
+      binary.temporary_directory_prefix = pipeline.sort.temp_prefix.c_str();
+      binary.building_memory = pipeline.TotalMemory();
+      if (binary_type == "probing") {
+        UTIL_THROW_IF(prob_bits || backoff_bits || bhiksha_bits, util::Exception, "Quantization and pointer compression are only implemented in the trie data structure.");
+        pipeline.binary_type = lm::ngram::PROBING;
+        binary.write_method = lm::ngram::Config::WRITE_AFTER;
+      } else if (binary_type == "trie") {
+        UTIL_THROW_IF(backoff_bits && !prob_bits, util::Exception, "You specified backoff quantization (--backoff_bits) but not probability quantization (--quantize).");
+        UTIL_THROW_IF(prob_bits > 25 || backoff_bits > 25 || bhiksha_bits > 255, util::Exception, "Bit counts are limited to 25, or 255 for --bhiksha.");
+        pipeline.binary_type = lm::ngram::TRIE;
+        if (prob_bits) {
+          pipeline.binary_type = static_cast<lm::ngram::ModelType>(pipeline.binary_type + lm::ngram::kQuantAdd);
+          binary.prob_bits = prob_bits;
+          binary.backoff_bits = backoff_bits ? backoff_bits : prob_bits;
+        }
+        if (bhiksha_bits) {
+          pipeline.binary_type = static_cast<lm::ngram::ModelType>(pipeline.binary_type + lm::ngram::kArrayAdd);
+          binary.pointer_bhiksha_bits = bhiksha_bits;
+        }
+        binary.write_method = lm::ngram::Config::WRITE_MMAP;
+      } else {
+        UTIL_THROW(util::Exception, "Unknown --binary_type " << binary_type << ".  Use probing or trie.");
+      }
+    }
+
     util::scoped_fd in(0), out(1);
     if (vm.count("text")) {
       in.reset(util::OpenReadOrThrow(text.c_str()));
@@ -115,7 +162,16 @@ int main(int argc, char *argv[]) {
 
     // Read from stdin
     try {
-      lm::builder::Pipeline(pipeline, in.release(), out.release());
+      if (vm.count("shard_output")) {
+        lm::builder::CountShard(pipeline, in.release(), shard, shard_output);
+      } else if (!merge_shards.empty()) {
+        lm::builder::MergeShards(pipeline, merge_shards, out.release());
+      } else if (shards > 1) {
+        UTIL_THROW_IF(!vm.count("text"), util::Exception, "--shards reads the text once per shard, so it needs --text");
+        lm::builder::ShardedPipeline(pipeline, text, shards, out.release());
+      } else {
+        lm::builder::Pipeline(pipeline, in.release(), out.release());
+      }
     } catch (const util::MallocException &e) {
       std::cerr << e.what() << std::endl;
       std::cerr << "Try rerunning with a more conservative -S setting than " << vm["memory"].as<std::string>() << std::endl;
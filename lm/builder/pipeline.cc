@@ -1,6 +1,7 @@
 #include "lm/builder/pipeline.hh"
 
 #include "lm/builder/adjust_counts.hh"
+#include "lm/builder/binary.hh"
 #include "lm/builder/corpus_count.hh"
 #include "lm/builder/initial_probabilities.hh"
 #include "lm/builder/interpolate.hh"
@@ -13,10 +14,20 @@
 #include "util/file.hh"
 #include "util/stream/io.hh"
 
+#include <boost/lexical_cast.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/thread/thread.hpp>
+
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <queue>
 #include <vector>
 
+#include <unistd.h>
+
 namespace lm { namespace builder {
 
 namespace {
@@ -30,6 +41,142 @@ void PrintStatistics(const std::vector<uint64_t> &counts, const std::vector<Disc
   }
 }
 
+// Concatenates files of n-grams, closing them.
+class ReadShards {
+  public:
+    explicit ReadShards(const std::vector<int> &files) : files_(files) {}
+
+    void Run(const util::stream::ChainPosition &position) {
+      const std::size_t block_size = position.GetChain().BlockSize();
+      const std::size_t entry_size = position.GetChain().EntrySize();
+      util::stream::Link link(position);
+      for (std::size_t i = 0; i < files_.size(); ++i) {
+        util::scoped_fd file(files_[i]);
+        while (std::size_t got = util::ReadOrEOF(file.get(), link->Get(), block_size)) {
+          UTIL_THROW_IF(got % entry_size, util::stream::ReadSizeException, "Shard file ended with " << got << " bytes, not a multiple of " << entry_size << ".");
+          link->SetValidSize(got);
+          ++link;
+        }
+      }
+      link.Poison();
+    }
+
+  private:
+    std::vector<int> files_;
+};
+
+// Merges the unigrams of shards, which are sorted by word, closing the files.
+// Every shard has <unk> and <s>; they are written once.
+class MergeUnigrams {
+  public:
+    explicit MergeUnigrams(const std::vector<int> &files) : files_(files) {}
+
+    void Run(const util::stream::ChainPosition &position) {
+      const std::size_t entry_size = NGram::TotalSize(1);
+      boost::ptr_vector<Reader> readers;
+      std::priority_queue<Head> heads;
+      for (std::size_t i = 0; i < files_.size(); ++i) {
+        readers.push_back(new Reader(files_[i]));
+        readers.back().Push(i, heads);
+      }
+
+      const std::size_t block_size = position.GetChain().BlockSize();
+      util::stream::Link link(position);
+      uint8_t *out = static_cast<uint8_t*>(link->Get());
+      WordIndex last = 0;
+      bool first = true;
+      while (!heads.empty()) {
+        Head head(heads.top());
+        heads.pop();
+        if (first || head.word != last) {
+          if (out == static_cast<uint8_t*>(link->Get()) + block_size) {
+            link->SetValidSize(block_size);
+            out = static_cast<uint8_t*>((++link)->Get());
+          }
+          memcpy(out, head.entry, entry_size);
+          out += entry_size;
+          last = head.word;
+          first = false;
+        } else {
+          UTIL_THROW_IF(head.word > kBOS, util::Exception, "Word " << head.word << " is in more than one shard.  Were the shards counted with the same shard count?");
+        }
+        readers[head.reader].Push(head.reader, heads);
+      }
+      link->SetValidSize(out - static_cast<uint8_t*>(link->Get()));
+      (++link).Poison();
+    }
+
+  private:
+    struct Head {
+      WordIndex word;
+      const uint8_t *entry;
+      std::size_t reader;
+
+      // Smallest word first.
+      bool operator<(const Head &other) const {
+        return word > other.word;
+      }
+    };
+
+    class Reader {
+      public:
+        explicit Reader(int fd) : file_(fd), buffer_(NGram::TotalSize(1) * 4096), cur_(0), end_(0) {}
+
+        // Add the next unigram, if any, to heads.
+        void Push(std::size_t index, std::priority_queue<Head> &heads) {
+          if (cur_ == end_) {
+            end_ = util::ReadOrEOF(file_.get(), &buffer_[0], buffer_.size());
+            UTIL_THROW_IF(end_ % NGram::TotalSize(1), util::stream::ReadSizeException, "Shard unigram file ended with " << end_ << " bytes, not a multiple of " << NGram::TotalSize(1) << ".");
+            cur_ = 0;
+            if (!end_) return;
+          }
+          Head head;
+          head.entry = &buffer_[cur_];
+          head.word = *NGram(&buffer_[cur_], 1).begin();
+          head.reader = index;
+          heads.push(head);
+          cur_ += NGram::TotalSize(1);
+        }
+
+      private:
+        util::scoped_fd file_;
+        std::vector<uint8_t> buffer_;
+        std::size_t cur_, end_;
+    };
+
+    std::vector<int> files_;
+};
+
+std::string ShardFile(const std::string &prefix, std::size_t order) {
+  return prefix + "." + boost::lexical_cast<std::string>(order);
+}
+
+// Removes the files of shards when it goes out of scope, also when a run
+// fails partway through, unless released.
+class ShardFilesRemover {
+  public:
+    explicit ShardFilesRemover(std::size_t order) : order_(order) {}
+
+    ~ShardFilesRemover() {
+      for (std::size_t i = 0; i < prefixes_.size(); ++i) {
+        std::remove((prefixes_[i] + ".vocab").c_str());
+        std::remove((prefixes_[i] + ".stats").c_str());
+        for (std::size_t order = 1; order <= order_; ++order) {
+          std::remove(ShardFile(prefixes_[i], order).c_str());
+        }
+      }
+    }
+
+    void Add(const std::string &prefix) { prefixes_.push_back(prefix); }
+
+    // Keep the files after all.
+    void Release() { prefixes_.clear(); }
+
+  private:
+    std::size_t order_;
+    std::vector<std::string> prefixes_;
+};
+
 class Master {
   public:
     explicit Master(const PipelineConfig &config) 
@@ -63,6 +210,23 @@ class Master {
       files_.push_back(util::MakeTemp(config_.TempPrefix()));
     }
 
+    // Read the adjusted counts of shards, in place of InitForAdjust and AdjustCounts.
+    void InitForMerge(const std::vector<uint64_t> &counts, const std::vector<std::string> &shard_prefixes) {
+      CreateChains(config_.TotalMemory(), counts);
+      for (std::size_t i = 0; i < config_.order; ++i) {
+        std::vector<int> files;
+        for (std::size_t s = 0; s < shard_prefixes.size(); ++s) {
+          files.push_back(util::OpenReadOrThrow(ShardFile(shard_prefixes[s], i + 1).c_str()));
+        }
+        if (i == 0) {
+          chains_[i] >> MergeUnigrams(files);
+        } else {
+          chains_[i] >> ReadShards(files);
+        }
+      }
+      files_.push_back(util::MakeTemp(config_.TempPrefix()));
+    }
+
     // For initial probabilities, but this is generic.
     void SortAndReadTwice(const std::vector<uint64_t> &counts, Sorts<ContextOrder> &sorts, Chains &second, util::stream::ChainConfig second_config) {
       // Do merge first before allocating chain memory.
@@ -203,7 +367,7 @@ class Master {
     FixedArray<util::stream::FileBuffer> files_;
 };
 
-void CountText(int text_file /* input */, int vocab_file /* output */, Master &master, uint64_t &token_count, std::string &text_file_name) {
+void CountText(int text_file /* input */, int vocab_file /* output */, Master &master, uint64_t &token_count, std::string &text_file_name, const ShardConfig &shard = ShardConfig()) {
   const PipelineConfig &config = master.Config();
   std::cerr << "=== 1/5 Counting and sorting n-grams ===" << std::endl;
 
@@ -221,7 +385,7 @@ void CountText(int text_file /* input */, int vocab_file /* output */, Master &m
   WordIndex type_count = config.vocab_estimate;
   util::FilePiece text(text_file, NULL, &std::cerr);
   text_file_name = text.FileName();
-  CorpusCount counter(text, vocab_file, token_count, type_count, chain.BlockSize() / chain.EntrySize());
+  CorpusCount counter(text, vocab_file, token_count, type_count, chain.BlockSize() / chain.EntrySize(), shard);
   chain >> boost::ref(counter);
 
   util::stream::Sort<SuffixOrder, AddCombiner> sorter(chain, config.sort, SuffixOrder(config.order), AddCombiner());
@@ -274,10 +438,33 @@ void InterpolateProbabilities(const std::vector<uint64_t> &counts, Master &maste
   master.BufferFinal(counts);
 }
 
-} // namespace
+// Steps 3 to 5, from adjusted counts.
+void Estimate(const std::vector<uint64_t> &counts, const std::vector<Discount> &discounts, Master &master, int vocab_file, const HeaderInfo &header_info, int out_arpa) {
+  {
+    FixedArray<util::stream::FileBuffer> gammas;
+    Sorts<SuffixOrder> primary;
+    InitialProbabilities(counts, discounts, master, primary, gammas);
+    InterpolateProbabilities(counts, master, primary, gammas);
+  }
 
-void Pipeline(PipelineConfig config, int text_file, int out_arpa) {
-  // Some fail-fast sanity checks.
+  const PipelineConfig &config = master.Config();
+  VocabReconstitute vocab(vocab_file);
+  UTIL_THROW_IF(vocab.Size() != counts[0], util::Exception, "Vocab words don't match up.  Is there a null byte in the input?");
+  if (config.binary_file.empty()) {
+    std::cerr << "=== 5/5 Writing ARPA model ===" << std::endl;
+    master >> PrintARPA(vocab, counts, (config.verbose_header ? &header_info : NULL), out_arpa) >> util::stream::kRecycle;
+  } else {
+    std::cerr << "=== 5/5 Writing binary model ===" << std::endl;
+    util::scoped_fd unused(out_arpa);
+    ngram::Config binary_config(config.binary_config);
+    binary_config.write_mmap = config.binary_file.c_str();
+    master >> BinaryOutput(vocab, counts, config.binary_type, binary_config) >> util::stream::kRecycle;
+  }
+  master.MutableChains().Wait(true);
+}
+
+// Some fail-fast sanity checks.
+void CheckConfig(PipelineConfig &config) {
   if (config.sort.buffer_size * 4 > config.TotalMemory()) {
     config.sort.buffer_size = config.TotalMemory() / 4;
     std::cerr << "Warning: changing sort block size to " << config.sort.buffer_size << " bytes due to low total memory." << std::endl;
@@ -289,6 +476,69 @@ void Pipeline(PipelineConfig config, int text_file, int out_arpa) {
   UTIL_THROW_IF(config.sort.buffer_size < config.minimum_block, util::Exception, "Sort block size " << config.sort.buffer_size << " is below the minimum block size " << config.minimum_block << ".");
   UTIL_THROW_IF(config.TotalMemory() < config.minimum_block * config.order * config.block_count, util::Exception,
       "Not enough memory to fit " << (config.order * config.block_count) << " blocks with minimum size " << config.minimum_block << ".  Increase memory to " << (config.minimum_block * config.order * config.block_count) << " bytes or decrease the minimum block size.");
+}
+
+// Shard statistics: the shard, token count, the statistics of each order, and the text file name.
+void WriteShardStats(const std::string &name, const ShardConfig &shard, uint64_t token_count, const std::vector<AdjustedStats> &stats, const std::string &text_file_name) {
+  std::ofstream out(name.c_str());
+  out << shard.index << ' ' << shard.count << '\n';
+  out << token_count << '\n';
+  for (std::size_t i = 0; i < stats.size(); ++i) {
+    out << stats[i].count;
+    for (std::size_t j = 0; j < 5; ++j) {
+      out << ' ' << stats[i].n[j];
+    }
+    out << '\n';
+  }
+  out << text_file_name << '\n';
+  UTIL_THROW_IF(!out, util::ErrnoException, "Failed to write " << name);
+}
+
+// Adds the statistics of a shard to stats.
+void ReadShardStats(const std::string &name, ShardConfig &shard, uint64_t &token_count, std::vector<AdjustedStats> &stats, std::string &text_file_name) {
+  std::ifstream in(name.c_str());
+  UTIL_THROW_IF(!in, util::ErrnoException, "Failed to open " << name);
+  in >> shard.index >> shard.count >> token_count;
+  for (std::size_t i = 0; i < stats.size(); ++i) {
+    uint64_t count;
+    in >> count;
+    stats[i].count += count;
+    for (std::size_t j = 0; j < 5; ++j) {
+      in >> count;
+      stats[i].n[j] += count;
+    }
+  }
+  UTIL_THROW_IF(!in, util::Exception, "Failed to read the statistics of a shard from " << name << ".  Was it made with the same order?");
+  in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  std::getline(in, text_file_name);
+}
+
+// For ShardedPipeline.
+class ShardThread {
+  public:
+    ShardThread(const PipelineConfig &config, const std::string &text_name, const ShardConfig &shard, const std::string &out_prefix, std::string &error)
+      : config_(config), text_name_(text_name), shard_(shard), out_prefix_(out_prefix), error_(error) {}
+
+    void operator()() {
+      try {
+        CountShard(config_, util::OpenReadOrThrow(text_name_.c_str()), shard_, out_prefix_);
+      } catch (const std::exception &e) {
+        error_ = e.what();
+      }
+    }
+
+  private:
+    PipelineConfig config_;
+    std::string text_name_;
+    ShardConfig shard_;
+    std::string out_prefix_;
+    std::string &error_;
+};
+
+} // namespace
+
+void Pipeline(PipelineConfig config, int text_file, int out_arpa) {
+  CheckConfig(config);
 
   UTIL_TIMER("(%w s) Total wall time elapsed\n");
   Master master(config);
@@ -304,19 +554,101 @@ void Pipeline(PipelineConfig config, int text_file, int out_arpa) {
   std::vector<Discount> discounts;
   master >> AdjustCounts(counts, discounts);
 
-  {
-    FixedArray<util::stream::FileBuffer> gammas;
-    Sorts<SuffixOrder> primary;
-    InitialProbabilities(counts, discounts, master, primary, gammas);
-    InterpolateProbabilities(counts, master, primary, gammas);
-  }
+  Estimate(counts, discounts, master, vocab_file.get(), HeaderInfo(text_file_name, token_count), out_arpa);
+}
 
-  std::cerr << "=== 5/5 Writing ARPA model ===" << std::endl;
-  VocabReconstitute vocab(vocab_file.get());
-  UTIL_THROW_IF(vocab.Size() != counts[0], util::Exception, "Vocab words don't match up.  Is there a null byte in the input?");
-  HeaderInfo header_info(text_file_name, token_count);
-  master >> PrintARPA(vocab, counts, (config.verbose_header ? &header_info : NULL), out_arpa) >> util::stream::kRecycle;
+void CountShard(PipelineConfig config, int text_file, const ShardConfig &shard, const std::string &out_prefix) {
+  util::scoped_fd text_owner(text_file);
+  UTIL_THROW_IF(config.order < 2, util::Exception, "Sharding needs an order of at least 2.");
+  UTIL_THROW_IF(shard.index >= shard.count, util::Exception, "Shard index " << shard.index << " is not below the shard count " << shard.count << ".");
+  CheckConfig(config);
+
+  UTIL_TIMER("(%w s) Shard wall time elapsed\n");
+  // Declared before the files, so they are closed when it removes them.
+  ShardFilesRemover remove_on_failure(config.order);
+  remove_on_failure.Add(out_prefix);
+  Master master(config);
+
+  util::scoped_fd vocab_file(util::CreateOrThrow((out_prefix + ".vocab").c_str()));
+  uint64_t token_count;
+  std::string text_file_name;
+  CountText(text_owner.release(), vocab_file.get(), master, token_count, text_file_name, shard);
+
+  std::vector<AdjustedStats> stats;
+  master >> AdjustCounts(stats);
+
+  FixedArray<util::scoped_fd> files(config.order);
+  for (std::size_t i = 0; i < config.order; ++i) {
+    files.push_back(util::CreateOrThrow(ShardFile(out_prefix, i + 1).c_str()));
+    master.MutableChains()[i] >> util::stream::Write(files.back().get());
+  }
+  master >> util::stream::kRecycle;
   master.MutableChains().Wait(true);
+
+  WriteShardStats(out_prefix + ".stats", shard, token_count, stats, text_file_name);
+  remove_on_failure.Release();
+}
+
+void MergeShards(PipelineConfig config, const std::vector<std::string> &shard_prefixes, int out_arpa) {
+  util::scoped_fd out_owner(out_arpa);
+  UTIL_THROW_IF(shard_prefixes.empty(), util::Exception, "No shards to merge.");
+  CheckConfig(config);
+
+  UTIL_TIMER("(%w s) Total wall time elapsed\n");
+  std::cerr << "=== 1-2/5 Merging the counts of " << shard_prefixes.size() << " shards ===" << std::endl;
+  AdjustedStats zero;
+  memset(&zero, 0, sizeof(AdjustedStats));
+  std::vector<AdjustedStats> stats(config.order, zero);
+  uint64_t token_count = 0;
+  std::string text_file_name;
+  std::vector<bool> seen(shard_prefixes.size(), false);
+  for (std::size_t i = 0; i < shard_prefixes.size(); ++i) {
+    ShardConfig shard;
+    uint64_t shard_tokens;
+    ReadShardStats(shard_prefixes[i] + ".stats", shard, shard_tokens, stats, text_file_name);
+    UTIL_THROW_IF(shard.count != shard_prefixes.size() || seen[shard.index], util::Exception, "Shard " << shard_prefixes[i] << " is shard " << shard.index << " of " << shard.count << ".  Merge each of the " << shard.count << " shards exactly once.");
+    seen[shard.index] = true;
+    // Every shard counts all tokens.
+    UTIL_THROW_IF(i && shard_tokens != token_count, util::Exception, "Shard " << shard_prefixes[i] << " has " << shard_tokens << " tokens, but " << shard_prefixes[0] << " has " << token_count << ".  Are they shards of the same text?");
+    token_count = shard_tokens;
+  }
+  // Every shard has <unk> and <s> among its unigrams.
+  stats[0].count -= 2 * (shard_prefixes.size() - 1);
+
+  std::vector<uint64_t> counts;
+  std::vector<Discount> discounts;
+  CalculateDiscounts(stats, counts, discounts);
+
+  Master master(config);
+  master.InitForMerge(counts, shard_prefixes);
+
+  // All shards have the same vocabulary.
+  util::scoped_fd vocab_file(util::OpenReadOrThrow((shard_prefixes[0] + ".vocab").c_str()));
+  Estimate(counts, discounts, master, vocab_file.get(), HeaderInfo(text_file_name, token_count), out_owner.release());
+}
+
+void ShardedPipeline(PipelineConfig config, const std::string &text_name, std::size_t shards, int out_arpa) {
+  util::scoped_fd out_owner(out_arpa);
+  UTIL_THROW_IF(shards == 0, util::Exception, "Need at least one shard.");
+
+  // Shards run at the same time, so they share the memory.
+  PipelineConfig shard_config(config);
+  shard_config.sort.total_memory /= shards;
+  std::vector<std::string> prefixes, errors(shards);
+  // The shard files are temporary, whether the run succeeds or not.
+  ShardFilesRemover remover(config.order);
+  boost::thread_group threads;
+  for (std::size_t i = 0; i < shards; ++i) {
+    prefixes.push_back(config.TempPrefix() + "shard" + boost::lexical_cast<std::string>(getpid()) + "_" + boost::lexical_cast<std::string>(i));
+    remover.Add(prefixes.back());
+    threads.create_thread(ShardThread(shard_config, text_name, ShardConfig(i, shards), prefixes.back(), errors[i]));
+  }
+  threads.join_all();
+  for (std::size_t i = 0; i < shards; ++i) {
+    UTIL_THROW_IF(!errors[i].empty(), util::Exception, "Shard " << i << " failed: " << errors[i]);
+  }
+
+  MergeShards(config, prefixes, out_owner.release());
 }
 
 }} // namespaces
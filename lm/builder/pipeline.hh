@@ -3,11 +3,15 @@
 
 #include "lm/builder/initial_probabilities.hh"
 #include "lm/builder/header_info.hh"
+#include "lm/builder/shard.hh"
+#include "lm/config.hh"
+#include "lm/model_type.hh"
 #include "lm/word_index.hh"
 #include "util/stream/config.hh"
 #include "util/file_piece.hh"
 
 #include <string>
+#include <vector>
 #include <cstddef>
 
 namespace lm { namespace builder {
@@ -20,6 +24,12 @@ struct PipelineConfig {
   util::stream::ChainConfig read_backoffs;
   bool verbose_header;
 
+  // If not empty, write a binary file of binary_type with binary_config
+  // here instead of ARPA.  binary_config.write_mmap is ignored.
+  std::string binary_file;
+  lm::ngram::ModelType binary_type;
+  lm::ngram::Config binary_config;
+
   // Estimated vocabulary size.  Used for sizing CorpusCount memory and
   // initial probing hash table sizing, also in CorpusCount.
   lm::WordIndex vocab_estimate;
@@ -34,8 +44,26 @@ struct PipelineConfig {
   std::size_t TotalMemory() const { return sort.total_memory; }
 };
 
-// Takes ownership of text_file and out_arpa.
+// Takes ownership of text_file and out_arpa.  out_arpa is unused if
+// config.binary_file is set.
 void Pipeline(PipelineConfig config, int text_file, int out_arpa);
 
+/* Sharded estimation, see shard.hh.  CountShard counts and adjusts the
+ * n-grams of one shard and writes them to files starting with out_prefix:
+ * out_prefix.vocab, out_prefix.stats and out_prefix.1 to out_prefix.<order>.
+ * Shards of the same text can be counted by separate processes, on separate
+ * machines.  MergeShards then estimates the model from all of them.  The model
+ * is the same as Pipeline's.
+ */
+// Takes ownership of text_file.
+void CountShard(PipelineConfig config, int text_file, const ShardConfig &shard, const std::string &out_prefix);
+
+// Takes ownership of out_arpa.
+void MergeShards(PipelineConfig config, const std::vector<std::string> &shard_prefixes, int out_arpa);
+
+// Count shards of the file text_name in parallel threads, each with an equal
+// part of the memory, then merge them.  Takes ownership of out_arpa.
+void ShardedPipeline(PipelineConfig config, const std::string &text_name, std::size_t shards, int out_arpa);
+
 }} // namespaces
 #endif // LM_BUILDER_PIPELINE__
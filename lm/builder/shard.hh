@@ -0,0 +1,31 @@
+#ifndef LM_BUILDER_SHARD__
+#define LM_BUILDER_SHARD__
+
+#include "lm/word_index.hh"
+
+#include <cstddef>
+
+#include <stdint.h>
+
+namespace lm { namespace builder {
+
+/* N-grams are partitioned into shards by their last word.  Every n-gram that
+ * the adjusted count of an n-gram depends on (its left extensions) ends with
+ * the same word, so each shard can count and adjust its n-grams on its own.
+ * Shards only have to be merged to sort by context for the later steps.
+ */
+struct ShardConfig {
+  ShardConfig() : index(0), count(1) {}
+  ShardConfig(std::size_t in_index, std::size_t in_count) : index(in_index), count(in_count) {}
+
+  std::size_t index;
+  std::size_t count;
+
+  bool Contains(WordIndex last) const {
+    // Vocabulary ids are in order of appearance, so mix them.
+    return (static_cast<uint32_t>(last) * 2654435761U) % count == index;
+  }
+};
+
+}} // namespaces
+#endif // LM_BUILDER_SHARD__
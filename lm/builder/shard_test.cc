@@ -0,0 +1,105 @@
+#include "lm/builder/pipeline.hh"
+
+#include "util/file.hh"
+
+#include <fstream>
+#include <string>
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define BOOST_TEST_MODULE ShardTest
+#include <boost/test/unit_test.hpp>
+
+// Shard files are temporary: a sharded run leaves nothing in the temp
+// prefix, also when it fails partway through.
+
+namespace lm { namespace builder { namespace {
+
+// A temporary directory, removed with what is left in it.
+class TempDir {
+  public:
+    TempDir() {
+      char name[] = "/tmp/shard_test_XXXXXX";
+      BOOST_REQUIRE(mkdtemp(name));
+      name_ = std::string(name) + "/";
+    }
+
+    ~TempDir() {
+      std::vector<std::string> names(Files());
+      for (std::size_t i = 0; i < names.size(); ++i) {
+        unlink((name_ + names[i]).c_str());
+      }
+      rmdir(name_.c_str());
+    }
+
+    const std::string &Name() const { return name_; }
+
+    std::vector<std::string> Files() const {
+      std::vector<std::string> ret;
+      DIR *dir = opendir(name_.c_str());
+      BOOST_REQUIRE(dir);
+      while (struct dirent *entry = readdir(dir)) {
+        std::string name(entry->d_name);
+        if (name != "." && name != "..") ret.push_back(name);
+      }
+      closedir(dir);
+      return ret;
+    }
+
+  private:
+    std::string name_;
+};
+
+PipelineConfig MakeConfig(const std::string &temp_prefix) {
+  PipelineConfig config;
+  config.order = 3;
+  config.sort.temp_prefix = temp_prefix;
+  config.sort.total_memory = 1 << 24;
+  config.sort.buffer_size = 1 << 16;
+  config.initial_probs.adder_in.total_memory = 32768;
+  config.initial_probs.adder_in.block_count = 2;
+  config.initial_probs.adder_out.total_memory = 32768;
+  config.initial_probs.adder_out.block_count = 2;
+  config.initial_probs.interpolate_unigrams = false;
+  config.read_backoffs = config.initial_probs.adder_out;
+  config.verbose_header = false;
+  config.vocab_estimate = 1000;
+  config.minimum_block = 8192;
+  config.block_count = 2;
+  return config;
+}
+
+// Too little text to estimate discounts from: the shards are counted, then
+// the merge fails.
+BOOST_AUTO_TEST_CASE(FailedRunLeavesNothing) {
+  TempDir dir;
+  std::string text(dir.Name() + "text");
+  {
+    std::ofstream out(text.c_str());
+    out << "a b\n";
+  }
+  TempDir temp;
+  util::scoped_fd arpa(util::MakeTemp(dir.Name() + "arpa"));
+  BOOST_CHECK_THROW(ShardedPipeline(MakeConfig(temp.Name()), text, 2, arpa.release()), util::Exception);
+  BOOST_CHECK_EQUAL(0U, temp.Files().size());
+}
+
+// CountShard keeps its output unless it fails.
+BOOST_AUTO_TEST_CASE(CountShardKeepsOutput) {
+  TempDir dir;
+  std::string text(dir.Name() + "text");
+  {
+    std::ofstream out(text.c_str());
+    out << "a b c\nb c d\n";
+  }
+  TempDir temp;
+  CountShard(MakeConfig(temp.Name()), util::OpenReadOrThrow(text.c_str()), ShardConfig(0, 2), dir.Name() + "out");
+  std::vector<std::string> files(dir.Files());
+  // text, out.vocab, out.stats and out.1 to out.3
+  BOOST_CHECK_EQUAL(6U, files.size());
+  BOOST_CHECK_EQUAL(0U, temp.Files().size());
+}
+
+}}} // namespaces
@@ -0,0 +1,83 @@
+#include "lm/filter/filtered_arpa.hh"
+
+#include "lm/lm_exception.hh"
+#include "util/file_piece.hh"
+#include "util/string_piece_hash.hh"
+
+namespace lm {
+
+FilteredARPA::FilteredARPA(util::FilePiece &f, vocab::Single &filter) : order_(0), position_(0) {
+  ReadARPACounts(f, original_);
+  ngrams_.resize(original_.size());
+  weights_.resize(original_.size());
+  std::vector<WordIndex> words;
+  for (unsigned int n = 1; n <= original_.size(); ++n) {
+    ReadNGramHeader(f, n);
+    std::vector<WordIndex> &ngrams = ngrams_[n - 1];
+    std::vector<float> &weights = weights_[n - 1];
+    for (uint64_t i = 0; i < original_[n - 1]; ++i) {
+      try {
+        float prob = f.ReadFloat();
+        bool pass = true;
+        words.clear();
+        if (n == 1) {
+          UTIL_THROW_IF(f.get() != '\t', FormatLoadException, "Expected tab after probability");
+          StringPiece word(f.ReadDelimited(kARPASpaces));
+          pass = filter.PassNGram(&word, &word + 1);
+          if (pass) {
+            words.push_back(words_.size());
+            words_.push_back(word.as_string());
+            indices_[words_.back()] = words.back();
+          }
+        } else {
+          // Only unigrams that passed have an index, so this is the filter.
+          for (unsigned int w = 0; w < n; ++w) {
+            StringPiece word(f.ReadDelimited(kARPASpaces));
+            if (!pass) continue;
+            boost::unordered_map<std::string, WordIndex>::const_iterator found(FindStringPiece(indices_, word));
+            if (found == indices_.end()) {
+              pass = false;
+            } else {
+              words.push_back(found->second);
+            }
+          }
+        }
+        float backoff = 0.0;
+        if (n == original_.size()) {
+          Prob ignored;
+          ReadBackoff(f, ignored);
+        } else {
+          ReadBackoff(f, backoff);
+        }
+        if (pass) {
+          ngrams.insert(ngrams.end(), words.begin(), words.end());
+          weights.push_back(prob);
+          weights.push_back(backoff);
+        }
+      } catch (util::Exception &e) {
+        e << " in the " << n << "-gram at byte " << f.Offset();
+        throw;
+      }
+    }
+  }
+  ReadEnd(f);
+  counts_.resize(original_.size());
+  for (std::size_t i = 0; i < counts_.size(); ++i) {
+    counts_[i] = weights_[i].size() / 2;
+  }
+}
+
+void FilteredARPA::BeginOrder(unsigned int order) {
+  order_ = order;
+  position_ = 0;
+}
+
+const WordIndex *FilteredARPA::Read(float &prob, float &backoff) {
+  UTIL_THROW_IF(position_ == counts_[order_ - 1], FormatLoadException, "Read past the " << order_ << "-grams that passed the filter");
+  const std::vector<float> &weights = weights_[order_ - 1];
+  prob = weights[2 * position_];
+  backoff = weights[2 * position_ + 1];
+  return &ngrams_[order_ - 1][order_ * position_++];
+}
+
+} // namespace lm
@@ -0,0 +1,57 @@
+#ifndef LM_FILTER_FILTERED_ARPA__
+#define LM_FILTER_FILTERED_ARPA__
+
+#include "lm/filter/vocab.hh"
+#include "lm/read_arpa.hh"
+
+#include <boost/unordered_map.hpp>
+
+#include <string>
+#include <vector>
+
+namespace util { class FilePiece; }
+
+namespace lm {
+
+/* Reads an ARPA file and supplies only the n-grams whose words are all in the
+ * vocabulary, like filter's single mode, so that a model can be built directly
+ * from them without writing a filtered ARPA file.  Tags like <s> always pass.
+ * Every prefix and suffix of a passing n-gram passes too, so the result is a
+ * valid model that scores text within the vocabulary as the full model does.
+ *
+ * The n-grams that pass are held in memory until the model is built.
+ */
+class FilteredARPA : public NGramSource {
+  public:
+    // Reads f to the end.
+    FilteredARPA(util::FilePiece &f, vocab::Single &filter);
+
+    void BeginOrder(unsigned int order);
+
+    const WordIndex *Read(float &prob, float &backoff);
+
+    StringPiece Word(WordIndex index) const {
+      return words_[index];
+    }
+
+    // Number of n-grams in the ARPA file, for reporting.
+    const std::vector<uint64_t> &Original() const { return original_; }
+
+  private:
+    std::vector<uint64_t> original_;
+
+    // Unigrams that passed by index.
+    std::vector<std::string> words_;
+    boost::unordered_map<std::string, WordIndex> indices_;
+
+    // By order: words of each n-gram that passed, and prob, backoff pairs.
+    std::vector<std::vector<WordIndex> > ngrams_;
+    std::vector<std::vector<float> > weights_;
+
+    unsigned int order_;
+    std::size_t position_;
+};
+
+} // namespace lm
+
+#endif // LM_FILTER_FILTERED_ARPA__
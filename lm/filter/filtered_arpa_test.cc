@@ -0,0 +1,70 @@
+#include "lm/filter/filtered_arpa.hh"
+#include "lm/model.hh"
+#include "util/file_piece.hh"
+#include "util/tokenize_piece.hh"
+
+#define BOOST_TEST_MODULE FilteredARPATest
+#include <boost/test/unit_test.hpp>
+
+namespace lm {
+namespace {
+
+const char *TestLocation() {
+  if (boost::unit_test::framework::master_test_suite().argc < 2) {
+    return "../test.arpa";
+  }
+  return boost::unit_test::framework::master_test_suite().argv[1];
+}
+
+template <class Model> void CheckSame(const ngram::ProbingModel &full, const Model &filtered, const char *sentence) {
+  ngram::State full_state(full.BeginSentenceState()), filtered_state(filtered.BeginSentenceState()), out;
+  for (util::TokenIter<util::SingleCharacter, true> i(sentence, ' '); i; ++i) {
+    FullScoreReturn full_ret(full.FullScore(full_state, full.GetVocabulary().Index(*i), out));
+    full_state = out;
+    FullScoreReturn filtered_ret(filtered.FullScore(filtered_state, filtered.GetVocabulary().Index(*i), out));
+    filtered_state = out;
+    BOOST_CHECK_CLOSE(full_ret.prob, filtered_ret.prob, 0.001);
+    BOOST_CHECK_EQUAL(full_ret.ngram_length, filtered_ret.ngram_length);
+  }
+}
+
+template <class Model> void FilterTest() {
+  ngram::Config config;
+  config.messages = NULL;
+  config.arpa_complain = ngram::Config::NONE;
+  ngram::ProbingModel full(TestLocation(), config);
+
+  vocab::Single::Words words;
+  const char *kWords[] = {"looking", "on", "a", "little", "more", "loin", "."};
+  words.insert(kWords, kWords + sizeof(kWords) / sizeof(const char*));
+  vocab::Single filter(words);
+  util::FilePiece f(TestLocation());
+  FilteredARPA source(f, filter);
+
+  BOOST_REQUIRE_EQUAL(5U, source.Counts().size());
+  BOOST_CHECK_EQUAL(37U, source.Original()[0]);
+  // The words and <s>, </s>, <unk>.
+  BOOST_CHECK_EQUAL(10U, source.Counts()[0]);
+  // All but "also would consider higher looking".
+  BOOST_CHECK_EQUAL(3U, source.Counts()[4]);
+  BOOST_CHECK_LT(source.Counts()[1], source.Original()[1]);
+
+  Model filtered(source, config);
+  BOOST_CHECK_EQUAL(10U, filtered.GetVocabulary().Bound());
+  BOOST_CHECK_EQUAL(0U, filtered.GetVocabulary().Index("biarritz"));
+
+  CheckSame(full, filtered, "looking on a little more loin . </s>");
+  CheckSame(full, filtered, "on a little . looking more a </s>");
+  CheckSame(full, filtered, "loin loin more little </s>");
+}
+
+BOOST_AUTO_TEST_CASE(probing) {
+  FilterTest<ngram::ProbingModel>();
+}
+
+BOOST_AUTO_TEST_CASE(trie) {
+  FilterTest<ngram::TrieModel>();
+}
+
+} // namespace
+} // namespace lm
@@ -23,6 +23,7 @@
 namespace util { class FilePiece; }
 
 namespace lm {
+class NGramSource;
 namespace ngram {
 namespace detail {
 
@@ -51,6 +52,13 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
      */
     explicit GenericModel(const char *file, const Config &config = Config());
 
+    /* Build the model from n-grams supplied without ARPA text, for example by
+     * the estimation pipeline.  As with ARPA files, set config.write_mmap to
+     * also write a binary file.  The trie puts temporary files at
+     * config.temporary_directory_prefix or else next to config.write_mmap.
+     */
+    GenericModel(NGramSource &source, const Config &config = Config());
+
     /* Score p(new_word | in_state) and incorporate new_word into out_state.
      * Note that in_state and out_state must be different references:
      * &in_state != &out_state.  
@@ -76,6 +84,16 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
      */
     void GetState(const WordIndex *context_rbegin, const WordIndex *context_rend, State &out_state) const;
 
+    /* Hint that FullScoreForgotState (or FullScore with a state holding the
+     * same context) is about to be called with these arguments.  For probing
+     * models this issues prefetches for every hash bucket the query will
+     * probe, so the cache misses of several queries overlap.  Does nothing
+     * for tries.
+     */
+    void Prefetch(const WordIndex *context_rbegin, const WordIndex *context_rend, const WordIndex new_word) const {
+      search_.Prefetch(context_rbegin, std::min(context_rend, context_rbegin + P::Order() - 1), new_word);
+    }
+
     /* More efficient version of FullScore where a partial n-gram has already
      * been scored.  
      * NOTE: THE RETURNED .rest AND .prob ARE RELATIVE TO THE .rest RETURNED BEFORE.  
@@ -114,6 +132,12 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
 
     void InitializeFromARPA(int fd, const char *file, const Config &config);
 
+    // Source is util::FilePiece or NGramSource.
+    template <class Source> void InitializeFromSource(Source &f, const char *file, const Config &config);
+
+    // Shared by the constructors after loading.
+    void InitializeStates();
+
     float InternalUnRest(const uint64_t *pointers_begin, const uint64_t *pointers_end, unsigned char first_length) const;
 
     BinaryFormat backing_;
@@ -132,6 +156,7 @@ template <class Search, class VocabularyT> class GenericModel : public base::Mod
 class name : public from {\
   public:\
     name(const char *file, const Config &config = Config()) : from(file, config) {}\
+    name(NGramSource &source, const Config &config = Config()) : from(source, config) {}\
 };
 
 LM_NAME_MODEL(ProbingModel, detail::GenericModel<detail::HashedSearch<BackoffValue> LM_COMMA() ProbingVocabulary>);
@@ -1,4 +1,6 @@
 #include "lm/model.hh"
+#include "lm/parallel_arpa.hh"
+#include "util/file_piece.hh"
 
 #include <stdlib.h>
 #include <string.h>
@@ -360,6 +362,46 @@ BOOST_AUTO_TEST_CASE(quant_bhiksha_trie) {
   LoadingTest<QuantArrayTrieModel>();
 }
 
+#ifndef NTHREAD
+template <class ModelT> void ParallelTest() {
+  Config config;
+  config.arpa_complain = Config::NONE;
+  config.messages = NULL;
+  {
+    ExpectEnumerateVocab enumerate;
+    config.enumerate_vocab = &enumerate;
+    util::FilePiece f(TestLocation());
+    std::vector<uint64_t> counts;
+    ReadARPACounts(f, counts);
+    ParallelARPA source(f, counts, 3);
+    ModelT m(source, config);
+    enumerate.Check(m.GetVocabulary());
+    Everything(m);
+  }
+  {
+    ExpectEnumerateVocab enumerate;
+    config.enumerate_vocab = &enumerate;
+    util::FilePiece f(TestNoUnkLocation());
+    std::vector<uint64_t> counts;
+    ReadARPACounts(f, counts);
+    ParallelARPA source(f, counts, 3);
+    ModelT m(source, config);
+    enumerate.Check(m.GetVocabulary());
+    NoUnkCheck(m);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(parallel_probing) {
+  ParallelTest<ProbingModel>();
+}
+BOOST_AUTO_TEST_CASE(parallel_trie) {
+  ParallelTest<TrieModel>();
+}
+BOOST_AUTO_TEST_CASE(parallel_quant_array_trie) {
+  ParallelTest<QuantArrayTrieModel>();
+}
+#endif // NTHREAD
+
 template <class ModelT> void BinaryTest(Config::WriteMethod write_method) {
   Config config;
   config.write_mmap = "test.binary";
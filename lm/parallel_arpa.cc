@@ -0,0 +1,274 @@
+#ifndef NTHREAD
+
+#include "lm/parallel_arpa.hh"
+
+#include "lm/lm_exception.hh"
+#include "util/file_piece.hh"
+#include "util/thread_pool.hh"
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/utility/in_place_factory.hpp>
+
+#include <algorithm>
+#include <istream>
+#include <streambuf>
+
+#include <ctype.h>
+
+namespace lm {
+namespace {
+
+// Lines per batch.
+const std::size_t kBatchLines = 65536;
+
+bool IsEntirelyWhiteSpace(const StringPiece &line) {
+  for (size_t i = 0; i < static_cast<size_t>(line.size()); ++i) {
+    if (!isspace(line.data()[i])) return false;
+  }
+  return true;
+}
+
+// Lets a FilePiece parse a batch in memory.
+class BatchBuf : public std::streambuf {
+  public:
+    BatchBuf(const std::string &text) {
+      char *begin = const_cast<char*>(text.data());
+      setg(begin, begin, begin + text.size());
+    }
+};
+
+} // namespace
+
+class ParallelARPA::Batch {
+  public:
+    Batch() : order_(0), count_(0), sequence_(0) {}
+
+    // Reader thread.  Copy lines of n-grams from f.
+    void Fill(util::FilePiece &f, unsigned char order, bool longest, std::size_t lines, uint64_t sequence) {
+      order_ = order;
+      longest_ = longest;
+      sequence_ = sequence;
+      offset_ = f.Offset();
+      count_ = 0;
+      error_.clear();
+      text_.clear();
+      while (count_ < lines) {
+        StringPiece line(f.ReadLine());
+        if (IsEntirelyWhiteSpace(line)) continue;
+        text_.append(line.data(), line.size());
+        text_ += '\n';
+        ++count_;
+      }
+    }
+
+    // Reader thread.  The last batch, which carries any error of the reader.
+    void Finish(uint64_t sequence, const std::string &error) {
+      order_ = 0;
+      count_ = 0;
+      sequence_ = sequence;
+      error_ = error;
+    }
+
+    // Parser thread.
+    void Parse(const Lookup &lookup, WordIndex not_found) {
+      if (!error_.empty()) return;
+      words_.resize(count_ * order_);
+      weights_.resize(count_ * 2);
+      BatchBuf buf(text_);
+      std::istream stream(&buf);
+      util::FilePiece f(stream, NULL, text_.size() + 1);
+      WordIndex *word = words_.empty() ? NULL : &words_[0];
+      try {
+        for (std::size_t i = 0; i < count_; ++i) {
+          weights_[2 * i] = f.ReadFloat();
+          for (unsigned char w = 0; w < order_; ++w, ++word) {
+            Lookup::ConstIterator found;
+            *word = lookup.Find(ngram::detail::HashForVocab(f.ReadDelimited(kARPASpaces)), found) ? found->value : not_found;
+          }
+          if (longest_) {
+            Prob ignored;
+            ReadBackoff(f, ignored);
+            weights_[2 * i + 1] = 0.0;
+          } else {
+            ReadBackoff(f, weights_[2 * i + 1]);
+          }
+        }
+      } catch (util::Exception &e) {
+        e << " in the " << static_cast<unsigned int>(order_) << "-gram at byte " << (offset_ + f.Offset());
+        error_ = e.what();
+      }
+    }
+
+    const WordIndex *Get(std::size_t i, float &prob, float &backoff) const {
+      prob = weights_[2 * i];
+      backoff = weights_[2 * i + 1];
+      return &words_[i * order_];
+    }
+
+    unsigned char Order() const { return order_; }
+
+    std::size_t Size() const { return count_; }
+
+    uint64_t Sequence() const { return sequence_; }
+
+    const std::string &Error() const { return error_; }
+
+  private:
+    unsigned char order_;
+    bool longest_;
+    std::size_t count_;
+    uint64_t sequence_;
+    uint64_t offset_;
+
+    std::string text_;
+    std::string error_;
+
+    std::vector<WordIndex> words_;
+    // prob and backoff of each n-gram.
+    std::vector<float> weights_;
+};
+
+class ParallelARPA::Parser {
+  public:
+    typedef Batch *Request;
+
+    Parser(const Lookup &lookup, WordIndex not_found, util::PCQueue<Batch*> &done)
+      : lookup_(lookup), not_found_(not_found), done_(done) {}
+
+    void operator()(Request batch) {
+      batch->Parse(lookup_, not_found_);
+      done_.Produce(batch);
+    }
+
+  private:
+    const Lookup &lookup_;
+    WordIndex not_found_;
+    util::PCQueue<Batch*> &done_;
+};
+
+ParallelARPA::ParallelARPA(util::FilePiece &f, const std::vector<uint64_t> &counts, std::size_t threads)
+  : NGramSource(counts), f_(f), order_(0), unigram_(0),
+    batches_(new Batch[3 * std::max<std::size_t>(threads, 1)]),
+    free_(3 * std::max<std::size_t>(threads, 1)), done_(3 * std::max<std::size_t>(threads, 1)),
+    sequence_(0), current_(NULL), position_(0), finished_(false),
+    threads_(std::max<std::size_t>(threads, 1)) {
+  words_.reserve(counts[0]);
+  for (std::size_t i = 0; i < 3 * threads_; ++i) {
+    free_.Produce(&batches_[i]);
+  }
+}
+
+ParallelARPA::~ParallelARPA() {
+  if (reader_) {
+    // NULL stops the reader if it is still going.  There is room because the
+    // reader holds a batch, waits for one, or has sent its last one.
+    if (!finished_) free_.Produce(NULL);
+    reader_->join();
+  }
+  // Joins the parsers.
+  parsers_.reset();
+}
+
+void ParallelARPA::BeginOrder(unsigned int order) {
+  order_ = order;
+  if (order == 1) {
+    ReadNGramHeader(f_, 1);
+    return;
+  }
+  if (reader_) return;
+  // All unigrams have been read.  Start reading the rest in parallel.
+  std::size_t allocated = Lookup::Size(words_.size(), 1.5);
+  lookup_memory_.reset(util::CallocOrThrow(allocated));
+  lookup_ = Lookup(lookup_memory_.get(), allocated);
+  for (WordIndex i = 0; i < words_.size(); ++i) {
+    Lookup::MutableIterator ignored;
+    lookup_.FindOrInsert(ngram::ProbingVocabuaryEntry::Make(ngram::detail::HashForVocab(words_[i]), i), ignored);
+  }
+  parsers_.reset(new util::ThreadPool<Parser>(3 * threads_, threads_, boost::in_place(boost::cref(lookup_), static_cast<WordIndex>(words_.size()), boost::ref(done_)), NULL));
+  reader_.reset(new boost::thread(boost::bind(&ParallelARPA::ReadBatches, this)));
+}
+
+const WordIndex *ParallelARPA::Read(float &prob, float &backoff) {
+  if (order_ == 1) return ReadUnigram(prob, backoff);
+  if (!current_ || position_ == current_->Size()) {
+    NextBatch();
+    UTIL_THROW_IF(!current_ || current_->Order() != order_, FormatLoadException, "Expected more " << order_ << "-grams");
+  }
+  return current_->Get(position_++, prob, backoff);
+}
+
+void ParallelARPA::End() {
+  NextBatch();
+  UTIL_THROW_IF(!finished_, FormatLoadException, "More n-grams than counted");
+}
+
+const WordIndex *ParallelARPA::ReadUnigram(float &prob, float &backoff) {
+  try {
+    prob = f_.ReadFloat();
+    if (f_.get() != '\t') UTIL_THROW(FormatLoadException, "Expected tab after probability");
+    words_.push_back(f_.ReadDelimited(kARPASpaces).as_string());
+    ReadBackoff(f_, backoff);
+  } catch(util::Exception &e) {
+    e << " in the 1-gram at byte " << f_.Offset();
+    throw;
+  }
+  return &(unigram_ = words_.size() - 1);
+}
+
+void ParallelARPA::ReadBatches() {
+  uint64_t sequence = 0;
+  Batch *batch = NULL;
+  std::string error;
+  try {
+    const std::vector<uint64_t> &counts = Counts();
+    for (unsigned char order = 2; order <= counts.size(); ++order) {
+      ReadNGramHeader(f_, order);
+      for (uint64_t remaining = counts[order - 1]; remaining; ) {
+        if (!free_.Consume(batch)) return;
+        std::size_t lines = static_cast<std::size_t>(std::min<uint64_t>(remaining, kBatchLines));
+        batch->Fill(f_, order, order == counts.size(), lines, sequence);
+        ++sequence;
+        remaining -= lines;
+        parsers_->Produce(batch);
+        batch = NULL;
+      }
+    }
+    ReadEnd(f_);
+  } catch (const std::exception &e) {
+    error = e.what();
+  }
+  if (!batch && !free_.Consume(batch)) return;
+  batch->Finish(sequence, error);
+  done_.Produce(batch);
+}
+
+void ParallelARPA::NextBatch() {
+  if (current_) {
+    free_.Produce(current_);
+    current_ = NULL;
+  }
+  UTIL_THROW_IF(finished_, FormatLoadException, "Read past the end of the file");
+  while (ahead_.empty() || !ahead_.front()) {
+    Batch *got;
+    done_.Consume(got);
+    std::size_t pos = got->Sequence() - sequence_;
+    if (pos >= ahead_.size()) ahead_.resize(pos + 1, NULL);
+    ahead_[pos] = got;
+  }
+  Batch *batch = ahead_.front();
+  ahead_.pop_front();
+  ++sequence_;
+  position_ = 0;
+  if (batch->Order()) {
+    current_ = batch;
+  } else {
+    // The reader does not use this any more.
+    finished_ = true;
+  }
+  UTIL_THROW_IF(!batch->Error().empty(), FormatLoadException, batch->Error());
+}
+
+} // namespace lm
+
+#endif // NTHREAD
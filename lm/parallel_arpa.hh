@@ -0,0 +1,91 @@
+#ifndef LM_PARALLEL_ARPA__
+#define LM_PARALLEL_ARPA__
+
+#include "lm/read_arpa.hh"
+#include "lm/vocab.hh"
+#include "util/pcqueue.hh"
+#include "util/probing_hash_table.hh"
+#include "util/scoped.hh"
+
+#include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace boost { class thread; }
+namespace util { class FilePiece; template <class HandlerT> class ThreadPool; }
+
+namespace lm {
+
+/* Parses an ARPA file with several threads.  A reader thread cuts the
+ * n-grams into batches of lines, workers parse the numbers and look up the
+ * words of a batch, and Read hands the batches out in file order.  So a
+ * model built from this is the same as one built from the FilePiece.
+ * Unigrams are parsed by the calling thread.
+ *
+ * Not available when compiled with NTHREAD.
+ */
+class ParallelARPA : public NGramSource {
+  public:
+    // f must be positioned after the counts, which ReadARPACounts returned.
+    // It must outlive this object.
+    ParallelARPA(util::FilePiece &f, const std::vector<uint64_t> &counts, std::size_t threads);
+
+    ~ParallelARPA();
+
+    void BeginOrder(unsigned int order);
+
+    const WordIndex *Read(float &prob, float &backoff);
+
+    StringPiece Word(WordIndex index) const {
+      return words_[index];
+    }
+
+    void End();
+
+  private:
+    class Batch;
+    class Parser;
+    typedef util::ProbingHashTable<ngram::ProbingVocabuaryEntry, util::IdentityHash> Lookup;
+
+    const WordIndex *ReadUnigram(float &prob, float &backoff);
+
+    // Reader thread.
+    void ReadBatches();
+
+    // Next batch in file order, from the parsers.
+    void NextBatch();
+
+    util::FilePiece &f_;
+
+    unsigned int order_;
+
+    // Unigram strings by index.
+    std::vector<std::string> words_;
+    WordIndex unigram_;
+
+    util::scoped_malloc lookup_memory_;
+    Lookup lookup_;
+
+    boost::scoped_array<Batch> batches_;
+    util::PCQueue<Batch*> free_, done_;
+    boost::scoped_ptr<util::ThreadPool<Parser> > parsers_;
+    boost::scoped_ptr<boost::thread> reader_;
+
+    // Parsed batches that arrived ahead of their turn.
+    std::deque<Batch*> ahead_;
+    uint64_t sequence_;
+    Batch *current_;
+    std::size_t position_;
+    // The reader's last batch, which ends the file, has been taken.
+    bool finished_;
+
+    std::size_t threads_;
+};
+
+} // namespace lm
+
+#endif // LM_PARALLEL_ARPA__
@@ -130,6 +130,11 @@ void ReadBackoff(util::FilePiece &in, float &backoff) {
   }
 }
 
+void SetBackoff(float from, float &backoff) {
+  // Same as ReadBackoff: zero is negative until an extension is found.
+  backoff = (from == ngram::kExtensionBackoff) ? ngram::kNoExtensionBackoff : from;
+}
+
 void ReadEnd(util::FilePiece &in) {
   StringPiece line;
   do {
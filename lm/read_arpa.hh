@@ -5,6 +5,7 @@
 #include "lm/word_index.hh"
 #include "lm/weights.hh"
 #include "util/file_piece.hh"
+#include "util/string_piece.hh"
 
 #include <cstddef>
 #include <iosfwd>
@@ -26,6 +27,68 @@ inline void ReadBackoff(util::FilePiece &in, RestWeights &weights) {
 
 void ReadEnd(util::FilePiece &in);
 
+/* Supplies the n-grams of a model in the order of an ARPA file, but without
+ * the text: all unigrams, then all bigrams, etc.  This lets the estimation
+ * pipeline build a binary file directly.  Words are identified by an index
+ * below the number of unigrams; Word returns the string of an index.  The
+ * number of unigrams itself stands for a word that is not a unigram, which
+ * ARPA files may have, and maps to <unk>.
+ */
+class NGramSource {
+  public:
+    explicit NGramSource(const std::vector<uint64_t> &counts) : counts_(counts) {}
+
+    virtual ~NGramSource() {}
+
+    const std::vector<uint64_t> &Counts() const { return counts_; }
+
+    // Called before reading the n-grams of the given order.
+    virtual void BeginOrder(unsigned int order) = 0;
+
+    // The next n-gram of the current order, in ARPA order.  The pointer is
+    // valid until the next call.  Backoff is ignored for the highest order.
+    virtual const WordIndex *Read(float &prob, float &backoff) = 0;
+
+    virtual StringPiece Word(WordIndex index) const = 0;
+
+    // Called after the n-grams of all orders have been read.
+    virtual void End() {}
+
+    // Vocabulary ids of the model being built by index.  Set by Read1Grams.
+    std::vector<WordIndex> &Mapping() { return mapping_; }
+
+  protected:
+    // For sources that know the counts only after reading.  They set counts_
+    // in their constructor.
+    NGramSource() {}
+
+    std::vector<uint64_t> counts_;
+
+  private:
+
+    std::vector<WordIndex> mapping_;
+};
+
+inline void ReadARPACounts(NGramSource &in, std::vector<uint64_t> &number) {
+  number = in.Counts();
+}
+inline void ReadNGramHeader(NGramSource &in, unsigned int length) {
+  in.BeginOrder(length);
+}
+inline void ReadEnd(NGramSource &in) {
+  in.End();
+}
+
+// Like ReadBackoff, but from a number.
+void SetBackoff(float from, float &backoff);
+inline void SetBackoff(float /*from*/, Prob &/*weights*/) {}
+inline void SetBackoff(float from, ProbBackoff &weights) {
+  SetBackoff(from, weights.backoff);
+}
+inline void SetBackoff(float from, RestWeights &weights) {
+  SetBackoff(from, weights.backoff);
+}
+
 extern const bool kARPASpaces[256];
 
 // Positive log probability warning.  
@@ -67,6 +130,29 @@ template <class Voc, class Weights> void Read1Grams(util::FilePiece &f, std::siz
   vocab.FinishedLoading(unigrams);
 }
 
+template <class Voc, class Weights> void Read1Grams(NGramSource &in, std::size_t count, Voc &vocab, Weights *unigrams, PositiveProbWarn &warn) {
+  ReadNGramHeader(in, 1);
+  float prob, backoff;
+  for (std::size_t i = 0; i < count; ++i) {
+    WordIndex index = *in.Read(prob, backoff);
+    UTIL_THROW_IF(index >= count, FormatLoadException, "Word index " << index << " is not below the number of unigrams " << count);
+    if (prob > 0.0) {
+      warn.Warn(prob);
+      prob = 0.0;
+    }
+    Weights &value = unigrams[vocab.Insert(in.Word(index))];
+    value.prob = prob;
+    SetBackoff(backoff, value);
+  }
+  vocab.FinishedLoading(unigrams);
+  // FinishedLoading may renumber the vocabulary.
+  in.Mapping().resize(count + 1);
+  for (std::size_t i = 0; i < count; ++i) {
+    in.Mapping()[i] = vocab.Index(in.Word(i));
+  }
+  in.Mapping()[count] = vocab.NotFound();
+}
+
 // Return true if a positive log probability came out.
 template <class Voc, class Weights> void ReadNGram(util::FilePiece &f, const unsigned char n, const Voc &vocab, WordIndex *const reverse_indices, Weights &weights, PositiveProbWarn &warn) {
   try {
@@ -85,6 +171,20 @@ template <class Voc, class Weights> void ReadNGram(util::FilePiece &f, const uns
   }
 }
 
+template <class Voc, class Weights> void ReadNGram(NGramSource &in, const unsigned char n, const Voc &/*vocab*/, WordIndex *const reverse_indices, Weights &weights, PositiveProbWarn &warn) {
+  float backoff;
+  const WordIndex *words = in.Read(weights.prob, backoff);
+  if (weights.prob > 0.0) {
+    warn.Warn(weights.prob);
+    weights.prob = 0.0;
+  }
+  const std::vector<WordIndex> &mapping = in.Mapping();
+  for (WordIndex *vocab_out = reverse_indices + n - 1; vocab_out >= reverse_indices; --vocab_out, ++words) {
+    *vocab_out = mapping[*words];
+  }
+  SetBackoff(backoff, weights);
+}
+
 } // namespace lm
 
 #endif // LM_READ_ARPA__
@@ -86,6 +86,8 @@ template <class Value> class HashedSearch {
 
     void InitializeFromARPA(const char *file, util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing);
 
+    void InitializeFromARPA(const char *file, NGramSource &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing);
+
     unsigned char Order() const {
       return middle_.size() + 2;
     }
@@ -125,6 +127,22 @@ template <class Value> class HashedSearch {
       return LongestPointer(found->value.prob);
     }
 
+    // Prefetch the entries that scoring new_word after [context_rbegin, context_rend) probes.
+    // The hashes depend only on the words, so all orders can be requested at once.
+    void Prefetch(const WordIndex *context_rbegin, const WordIndex *context_rend, WordIndex new_word) const {
+      unigram_.Prefetch(new_word);
+      Node node = static_cast<Node>(new_word);
+      unsigned char order_minus_2 = 0;
+      for (const WordIndex *i = context_rbegin; i != context_rend; ++i, ++order_minus_2) {
+        node = CombineWordHash(node, *i);
+        if (order_minus_2 == middle_.size()) {
+          longest_.Prefetch(node);
+          return;
+        }
+        middle_[order_minus_2].Prefetch(node);
+      }
+    }
+
     // Generate a node without necessarily checking that it actually exists.
     // Optionally return false if it's know to not exist.
     bool FastMakeNode(const WordIndex *begin, const WordIndex *end, Node &node) const {
@@ -138,9 +156,12 @@ template <class Value> class HashedSearch {
 
   private:
     // Interpret config's rest cost build policy and pass the right template argument to ApplyBuild.
-    void DispatchBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn);
+    template <class Source> void DispatchBuild(Source &f, const std::vector<uint64_t> &counts, const Config &config, const ProbingVocabulary &vocab, PositiveProbWarn &warn);
+
+    template <class Source, class Build> void ApplyBuild(Source &f, const std::vector<uint64_t> &counts, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build);
 
-    template <class Build> void ApplyBuild(util::FilePiece &f, const std::vector<uint64_t> &counts, const ProbingVocabulary &vocab, PositiveProbWarn &warn, const Build &build);
+    // Source is util::FilePiece or NGramSource.
+    template <class Source> void Initialize(Source &f, const std::vector<uint64_t> &counts, const Config &config, ProbingVocabulary &vocab, BinaryFormat &backing);
 
     class Unigram {
       public:
@@ -164,6 +185,10 @@ template <class Value> class HashedSearch {
           return unigram_[index];
         }
 
+        void Prefetch(WordIndex index) const {
+          util::PrefetchRead(unigram_ + index);
+        }
+
         typename Value::Weights &Unknown() { return unigram_[0]; }
 
         // For building.
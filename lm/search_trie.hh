@@ -16,6 +16,7 @@
 #include <assert.h>
 
 namespace lm {
+class NGramSource;
 namespace ngram {
 class BinaryFormat;
 class SortedVocabulary;
@@ -62,6 +63,8 @@ template <class Quant, class Bhiksha> class TrieSearch {
 
     void InitializeFromARPA(const char *file, util::FilePiece &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing);
 
+    void InitializeFromARPA(const char *file, NGramSource &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing);
+
     unsigned char Order() const {
       return middle_end_ - middle_begin_ + 2;
     }
@@ -75,6 +78,9 @@ template <class Quant, class Bhiksha> class TrieSearch {
       return ret;
     }
 
+    // Each trie level depends on the one before, so there is nothing to fetch early.
+    void Prefetch(const WordIndex *, const WordIndex *, WordIndex) const {}
+
     MiddlePointer Unpack(uint64_t extend_pointer, unsigned char extend_length, Node &node) const {
       return MiddlePointer(quant_, extend_length - 2, middle_begin_[extend_length - 2].ReadEntry(extend_pointer, node));
     }
@@ -103,6 +109,9 @@ template <class Quant, class Bhiksha> class TrieSearch {
   private:
     friend void BuildTrie<Quant, Bhiksha>(SortedFiles &files, std::vector<uint64_t> &counts, const Config &config, TrieSearch<Quant, Bhiksha> &out, Quant &quant, SortedVocabulary &vocab, BinaryFormat &backing);
 
+    // Source is util::FilePiece or NGramSource.
+    template <class Source> void Initialize(const char *file, Source &f, std::vector<uint64_t> &counts, const Config &config, SortedVocabulary &vocab, BinaryFormat &backing);
+
     // Middles are managed manually so we can delay construction and they don't have to be copyable.
     void FreeMiddles() {
       for (const Middle *i = middle_begin_; i != middle_end_; ++i) {
@@ -180,7 +180,7 @@ void RecordReader::Rewind() {
   }
 }
 
-SortedFiles::SortedFiles(const Config &config, util::FilePiece &f, std::vector<uint64_t> &counts, size_t buffer, const std::string &file_prefix, SortedVocabulary &vocab) {
+template <class Source> SortedFiles::SortedFiles(const Config &config, Source &f, std::vector<uint64_t> &counts, size_t buffer, const std::string &file_prefix, SortedVocabulary &vocab) {
   PositiveProbWarn warn(config.positive_log_probability);
   unigram_.reset(util::MakeTemp(file_prefix));
   {
@@ -230,7 +230,7 @@ class Closer {
 };
 } // namespace
 
-void SortedFiles::ConvertToSorted(util::FilePiece &f, const SortedVocabulary &vocab, const std::vector<uint64_t> &counts, const std::string &file_prefix, unsigned char order, PositiveProbWarn &warn, void *mem, std::size_t mem_size) {
+template <class Source> void SortedFiles::ConvertToSorted(Source &f, const SortedVocabulary &vocab, const std::vector<uint64_t> &counts, const std::string &file_prefix, unsigned char order, PositiveProbWarn &warn, void *mem, std::size_t mem_size) {
   ReadNGramHeader(f, order);
   const size_t count = counts[order - 1];
   // Size of weights.  Does it include backoff?  
@@ -290,6 +290,9 @@ void SortedFiles::ConvertToSorted(util::FilePiece &f, const SortedVocabulary &vo
   }
 }
 
+template SortedFiles::SortedFiles(const Config &, util::FilePiece &, std::vector<uint64_t> &, size_t, const std::string &, SortedVocabulary &);
+template SortedFiles::SortedFiles(const Config &, NGramSource &, std::vector<uint64_t> &, size_t, const std::string &, SortedVocabulary &);
+
 } // namespace trie
 } // namespace ngram
 } // namespace lm
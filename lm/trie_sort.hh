@@ -21,6 +21,7 @@ class FilePiece;
 } // namespace util
 
 namespace lm {
+class NGramSource;
 class PositiveProbWarn;
 namespace ngram {
 class SortedVocabulary;
@@ -84,8 +85,8 @@ class RecordReader {
 
 class SortedFiles {
   public:
-    // Build from ARPA
-    SortedFiles(const Config &config, util::FilePiece &f, std::vector<uint64_t> &counts, std::size_t buffer, const std::string &file_prefix, SortedVocabulary &vocab);
+    // Build from ARPA.  Source is util::FilePiece or NGramSource.
+    template <class Source> SortedFiles(const Config &config, Source &f, std::vector<uint64_t> &counts, std::size_t buffer, const std::string &file_prefix, SortedVocabulary &vocab);
 
     int StealUnigram() {
       return unigram_.release();
@@ -100,7 +101,7 @@ class SortedFiles {
     }
 
   private:
-    void ConvertToSorted(util::FilePiece &f, const SortedVocabulary &vocab, const std::vector<uint64_t> &counts, const std::string &prefix, unsigned char order, PositiveProbWarn &warn, void *mem, std::size_t mem_size);
+    template <class Source> void ConvertToSorted(Source &f, const SortedVocabulary &vocab, const std::vector<uint64_t> &counts, const std::string &prefix, unsigned char order, PositiveProbWarn &warn, void *mem, std::size_t mem_size);
     
     util::scoped_fd unigram_;
 
@@ -0,0 +1,118 @@
+// Measure how fast FactorCollection interns a token stream from several
+// threads, compared with a single reader-writer locked set (the layout
+// FactorCollection used before it was sharded).
+//
+// usage: benchmarkFactorCollection [-threads N] [-passes P] < corpus
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/unordered_set.hpp>
+
+#include "moses/FactorCollection.h"
+#include "moses/Timer.h"
+#include "moses/Util.h"
+
+namespace
+{
+
+// One set behind one shared_mutex, as FactorCollection used to be.
+class SingleLockCollection
+{
+public:
+  const std::string *Add(const std::string &word) {
+    {
+      boost::shared_lock<boost::shared_mutex> read_lock(m_accessLock);
+      boost::unordered_set<std::string>::const_iterator i = m_set.find(word);
+      if (i != m_set.end()) return &*i;
+    }
+    boost::unique_lock<boost::shared_mutex> lock(m_accessLock);
+    return &*m_set.insert(word).first;
+  }
+
+private:
+  boost::unordered_set<std::string> m_set;
+  boost::shared_mutex m_accessLock;
+};
+
+void InternSharded(const std::vector<std::string> *tokens, size_t passes)
+{
+  Moses::FactorCollection &fc = Moses::FactorCollection::Instance();
+  for (size_t p = 0; p < passes; ++p) {
+    for (size_t i = 0; i < tokens->size(); ++i) {
+      fc.AddFactor((*tokens)[i]);
+    }
+  }
+}
+
+void InternSingleLock(SingleLockCollection *collection, const std::vector<std::string> *tokens, size_t passes)
+{
+  for (size_t p = 0; p < passes; ++p) {
+    for (size_t i = 0; i < tokens->size(); ++i) {
+      collection->Add((*tokens)[i]);
+    }
+  }
+}
+
+double Run(const boost::function<void ()> &work, size_t threads)
+{
+  Moses::Timer timer;
+  timer.start();
+  boost::thread_group group;
+  for (size_t t = 0; t < threads; ++t) {
+    group.create_thread(work);
+  }
+  group.join_all();
+  return timer.get_elapsed_time();
+}
+
+void usage()
+{
+  std::cerr << "usage: benchmarkFactorCollection [-threads N] [-passes P] < corpus" << std::endl;
+  exit(1);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  size_t threads = 4;
+  size_t passes = 10;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-threads") && i + 1 < argc) {
+      threads = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-passes") && i + 1 < argc) {
+      passes = atoi(argv[++i]);
+    } else {
+      usage();
+    }
+  }
+
+  std::vector<std::string> tokens;
+  std::string line;
+  while (getline(std::cin, line)) {
+    std::vector<std::string> words = Moses::Tokenize(line);
+    tokens.insert(tokens.end(), words.begin(), words.end());
+  }
+  if (tokens.empty()) usage();
+
+  const double total = static_cast<double>(tokens.size()) * passes * threads;
+  std::cerr << tokens.size() << " tokens, " << passes << " passes, " << threads << " threads" << std::endl;
+
+  SingleLockCollection single;
+  double singleTime = Run(boost::bind(&InternSingleLock, &single, &tokens, passes), threads);
+  std::cout << "single lock:\t" << singleTime << " s\t" << total / singleTime << " tokens/s" << std::endl;
+
+  double shardedTime = Run(boost::bind(&InternSharded, &tokens, passes), threads);
+  std::cout << "FactorCollection:\t" << shardedTime << " s\t" << total / shardedTime << " tokens/s" << std::endl;
+
+  return 0;
+}
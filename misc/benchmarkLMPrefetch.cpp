@@ -0,0 +1,119 @@
+// Measure KenLM query throughput on a probing model when independent
+// queries are scored one after another, against the same queries with the
+// hash buckets of the next few prefetched (as the phrase-based search does,
+// see -lm-prefetch-distance).
+//
+// The queries are the extensions a decoder would try: every state reached
+// in the corpus, extended by words drawn from the corpus, in random order.
+// For end to end decoding speed, run moses on the same input with
+// -lm-prefetch-distance 0 and with the default, and compare the
+// "Decoding took" times.
+//
+// usage: benchmarkLMPrefetch model.binary [-distance D] [-queries N] < corpus
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "lm/model.hh"
+#include "moses/Timer.h"
+#include "moses/Util.h"
+
+namespace
+{
+
+typedef lm::ngram::ProbingModel Model;
+
+struct Query {
+  lm::ngram::State state;
+  lm::WordIndex word;
+};
+
+float ScoreAll(const Model &model, const std::vector<Query> &queries, size_t distance)
+{
+  lm::ngram::State out;
+  float total = 0.0;
+  for (size_t i = 0; i < distance && i < queries.size(); ++i) {
+    model.Prefetch(queries[i].state.words, queries[i].state.words + queries[i].state.length, queries[i].word);
+  }
+  for (size_t i = 0; i < queries.size(); ++i) {
+    if (distance && i + distance < queries.size()) {
+      const Query &ahead = queries[i + distance];
+      model.Prefetch(ahead.state.words, ahead.state.words + ahead.state.length, ahead.word);
+    }
+    total += model.FullScore(queries[i].state, queries[i].word, out).prob;
+  }
+  return total;
+}
+
+void usage()
+{
+  std::cerr << "usage: benchmarkLMPrefetch model.binary [-distance D] [-queries N] < corpus" << std::endl;
+  exit(1);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  if (argc < 2) usage();
+  size_t distance = 4;
+  size_t numQueries = 10000000;
+  for (int i = 2; i < argc; ++i) {
+    if (!strcmp(argv[i], "-distance") && i + 1 < argc) {
+      distance = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-queries") && i + 1 < argc) {
+      numQueries = atoi(argv[++i]);
+    } else {
+      usage();
+    }
+  }
+
+  Model model(argv[1]);
+  const lm::ngram::Vocabulary &vocab = model.GetVocabulary();
+
+  // states reached in the corpus, and the corpus words
+  std::vector<lm::ngram::State> states;
+  std::vector<lm::WordIndex> words;
+  std::string line;
+  while (getline(std::cin, line)) {
+    std::vector<std::string> tokens = Moses::Tokenize(line);
+    lm::ngram::State state(model.BeginSentenceState()), next;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+      lm::WordIndex word = vocab.Index(tokens[i]);
+      states.push_back(state);
+      words.push_back(word);
+      model.FullScore(state, word, next);
+      state = next;
+    }
+  }
+  if (states.empty()) usage();
+
+  std::vector<Query> queries(numQueries);
+  srand(1);
+  for (size_t i = 0; i < numQueries; ++i) {
+    queries[i].state = states[rand() % states.size()];
+    queries[i].word = words[rand() % words.size()];
+  }
+  std::cerr << static_cast<unsigned>(model.Order()) << "-gram model, " << numQueries << " queries, prefetch distance " << distance << std::endl;
+
+  Moses::Timer plainTimer;
+  plainTimer.start();
+  float plain = ScoreAll(model, queries, 0);
+  double plainTime = plainTimer.get_elapsed_time();
+  std::cout << "one at a time:\t" << plainTime << " s\t" << numQueries / plainTime << " queries/s" << std::endl;
+
+  Moses::Timer prefetchTimer;
+  prefetchTimer.start();
+  float prefetched = ScoreAll(model, queries, distance);
+  double prefetchTime = prefetchTimer.get_elapsed_time();
+  std::cout << "prefetched:\t" << prefetchTime << " s\t" << numQueries / prefetchTime << " queries/s" << std::endl;
+
+  if (plain != prefetched) {
+    std::cerr << "scores differ: " << plain << " vs " << prefetched << std::endl;
+    return 1;
+  }
+  return 0;
+}
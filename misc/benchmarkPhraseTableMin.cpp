@@ -0,0 +1,151 @@
+// Measure lookup throughput of a compact phrase table (.minphr) against the
+// number of threads sharing it, as when several decoding threads translate
+// different sentences.
+//
+// Every span (up to -length words) of every input sentence is looked up and
+// decoded; the sentences are dealt out to the threads round robin.
+//
+// usage: benchmarkPhraseTableMin -t ttable [-n nscores] [-threads 1,2,4,8]
+//                                [-length L] [-mmap] < corpus
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include "moses/TranslationModel/CompactPT/PhraseDictionaryCompact.h"
+#include "moses/Phrase.h"
+#include "moses/Sentence.h"
+#include "moses/Timer.h"
+#include "moses/Util.h"
+#include "moses/WordsRange.h"
+
+using namespace Moses;
+
+namespace
+{
+
+class LookupWorker
+{
+public:
+  LookupWorker(PhraseDictionaryCompact &pdc, const std::vector<Phrase> &sentences,
+               size_t first, size_t step, size_t maxLength, size_t &lookups)
+    : m_pdc(pdc), m_sentences(sentences), m_first(first), m_step(step)
+    , m_maxLength(maxLength), m_lookups(lookups) {}
+
+  void operator()() {
+    Sentence dummy;
+    size_t lookups = 0;
+    for(size_t s = m_first; s < m_sentences.size(); s += m_step) {
+      const Phrase &sentence = m_sentences[s];
+      for(size_t start = 0; start < sentence.GetSize(); ++start) {
+        for(size_t end = start; end < sentence.GetSize() && end - start < m_maxLength; ++end) {
+          Phrase sourcePhrase = sentence.GetSubString(WordsRange(start, end));
+          m_pdc.GetTargetPhraseCollectionRaw(sourcePhrase);
+          ++lookups;
+        }
+      }
+      m_pdc.CleanUpAfterSentenceProcessing(dummy);
+    }
+    m_lookups = lookups;
+  }
+
+private:
+  PhraseDictionaryCompact &m_pdc;
+  const std::vector<Phrase> &m_sentences;
+  size_t m_first, m_step, m_maxLength;
+  size_t &m_lookups;
+};
+
+void usage()
+{
+  std::cerr << "usage: benchmarkPhraseTableMin -t ttable [-n nscores] [-threads 1,2,4,8]\n"
+            "                              [-length L] [-mmap] < corpus\n"
+            "-t <ttable>       compact phrase table\n"
+            "-n <nscores>      number of scores in phrase table (default: 5)\n"
+            "-threads <list>   comma-separated thread counts (default: 1,2,4,8)\n"
+            "-length <L>       maximum source phrase length (default: 7)\n"
+            "-mmap             keep the table memory-mapped instead of loading it\n";
+  exit(1);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  int nscores = 5;
+  std::string ttable = "";
+  std::string threadList = "1,2,4,8";
+  size_t maxLength = 7;
+  bool inMemory = true;
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-n") && i + 1 < argc) {
+      nscores = atoi(argv[++i]);
+    } else if(!strcmp(argv[i], "-t") && i + 1 < argc) {
+      ttable = argv[++i];
+    } else if(!strcmp(argv[i], "-threads") && i + 1 < argc) {
+      threadList = argv[++i];
+    } else if(!strcmp(argv[i], "-length") && i + 1 < argc) {
+      maxLength = atoi(argv[++i]);
+    } else if(!strcmp(argv[i], "-mmap")) {
+      inMemory = false;
+    } else
+      usage();
+  }
+
+  if(ttable == "")
+    usage();
+
+  std::vector<FactorType> input(1, 0);
+
+  Parameter *parameter = new Parameter();
+  const_cast<std::vector<std::string>&>(parameter->GetParam("factor-delimiter")).resize(1, "||dummy_string||");
+  const_cast<std::vector<std::string>&>(parameter->GetParam("input-factors")).resize(1, "0");
+  const_cast<std::vector<std::string>&>(parameter->GetParam("verbose")).resize(1, "0");
+
+  StaticData::InstanceNonConst().LoadData(parameter);
+
+  std::stringstream ss;
+  ss << "PhraseDictionaryCompact input-factor=0 output-factor=0 num-features="
+     << nscores << " path=" << ttable << " in-memory=" << inMemory;
+  PhraseDictionaryCompact pdc(ss.str());
+
+  Timer loadTimer;
+  loadTimer.start();
+  pdc.Load();
+  std::cerr << "loaded " << ttable << " in " << loadTimer.get_elapsed_time() << " s" << std::endl;
+
+  std::vector<Phrase> sentences;
+  std::string line;
+  while(getline(std::cin, line)) {
+    sentences.push_back(Phrase());
+    sentences.back().CreateFromString(Input, input, line, "||dummy_string||", NULL);
+  }
+
+  std::cout << "threads\tlookups/s\tlookups/s/thread" << std::endl;
+  std::vector<size_t> threadCounts = Scan<size_t>(Tokenize(threadList, ","));
+  for(size_t t = 0; t < threadCounts.size(); ++t) {
+    size_t numThreads = std::max<size_t>(threadCounts[t], 1);
+    std::vector<size_t> lookups(numThreads, 0);
+
+    Timer timer;
+    timer.start();
+    boost::thread_group threads;
+    for(size_t i = 0; i < numThreads; ++i)
+      threads.create_thread(LookupWorker(pdc, sentences, i, numThreads, maxLength, lookups[i]));
+    threads.join_all();
+    double elapsed = timer.get_elapsed_time();
+
+    size_t total = 0;
+    for(size_t i = 0; i < numThreads; ++i)
+      total += lookups[i];
+    double perSecond = elapsed > 0 ? total / elapsed : 0;
+    std::cout << numThreads << "\t" << perSecond << "\t" << perSecond / numThreads << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,198 @@
+// Compare the trie of PhraseDictionaryNodeMemory nodes that a text rule
+// table is loaded into with the FlatRuleTrie it is flattened into for
+// decoding: load and flattening time, heap memory in use with each (rules
+// included), and the throughput of terminal lookups along every span of a
+// corpus.
+//
+// usage: benchmarkRuleTableMemory -t rule-table [-n nscores] [-length L]
+//                                 < corpus
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "moses/TranslationModel/PhraseDictionaryMemory.h"
+#include "moses/Phrase.h"
+#include "moses/StaticData.h"
+#include "moses/Timer.h"
+#include "moses/Util.h"
+
+using namespace Moses;
+
+namespace
+{
+
+// a PhraseDictionaryMemory that keeps the node trie after loading
+class NodeTrieRuleTable : public PhraseDictionaryMemory
+{
+public:
+  NodeTrieRuleTable(const std::string &line)
+    : PhraseDictionaryMemory(line) {}
+
+  const PhraseDictionaryNodeMemory &GetNodeRoot() const {
+    return m_collection;
+  }
+
+  void Flatten() {
+    m_trie.Build(m_collection);
+  }
+
+  size_t GetFlatMemoryUsage() const {
+    return m_trie.GetMemoryUsage();
+  }
+
+  size_t GetNumNodes() const {
+    return m_trie.GetNumNodes();
+  }
+
+protected:
+  void SortAndPrune() {
+    if (GetTableLimit()) {
+      m_collection.Sort(GetTableLimit());
+    }
+  }
+};
+
+// heap in use, or the resident set size where malloc cannot tell; memory
+// freed by the node trie usually stays with malloc, so the resident set
+// does not shrink
+size_t MemoryMB()
+{
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+  struct mallinfo2 info = mallinfo2();
+  return (info.uordblks + info.hblkhd) >> 20;
+#else
+  size_t size = 0, resident = 0;
+  FILE *statm = fopen("/proc/self/statm", "r");
+  if (statm) {
+    if (fscanf(statm, "%lu %lu", &size, &resident) != 2) {
+      resident = 0;
+    }
+    fclose(statm);
+  }
+  return resident * sysconf(_SC_PAGESIZE) >> 20;
+#endif
+}
+
+// number of spans of up to maxLength words that are a rule prefix
+template <class Node>
+size_t LookupAll(const Node &root, const std::vector<Phrase> &sentences, size_t maxLength)
+{
+  size_t found = 0;
+  for (size_t s = 0; s < sentences.size(); ++s) {
+    const Phrase &sentence = sentences[s];
+    for (size_t start = 0; start < sentence.GetSize(); ++start) {
+      const Node *node = &root;
+      for (size_t end = start; node && end < sentence.GetSize() && end - start < maxLength; ++end) {
+        node = node->GetChild(sentence.GetWord(end));
+        if (node) {
+          ++found;
+        }
+      }
+    }
+  }
+  return found;
+}
+
+void usage()
+{
+  std::cerr << "usage: benchmarkRuleTableMemory -t rule-table [-n nscores] [-length L] < corpus\n"
+            "-t <rule-table>   text rule table (Moses format)\n"
+            "-n <nscores>      number of scores in the rule table (default: 1)\n"
+            "-length <L>       maximum length of looked up spans (default: 7)\n";
+  exit(1);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  int nscores = 1;
+  std::string ruleTable = "";
+  size_t maxLength = 7;
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-n") && i + 1 < argc) {
+      nscores = atoi(argv[++i]);
+    } else if(!strcmp(argv[i], "-t") && i + 1 < argc) {
+      ruleTable = argv[++i];
+    } else if(!strcmp(argv[i], "-length") && i + 1 < argc) {
+      maxLength = atoi(argv[++i]);
+    } else
+      usage();
+  }
+
+  if(ruleTable == "")
+    usage();
+
+  std::vector<FactorType> input(1, 0);
+
+  Parameter *parameter = new Parameter();
+  const_cast<std::vector<std::string>&>(parameter->GetParam("factor-delimiter")).resize(1, "||dummy_string||");
+  const_cast<std::vector<std::string>&>(parameter->GetParam("input-factors")).resize(1, "0");
+  const_cast<std::vector<std::string>&>(parameter->GetParam("verbose")).resize(1, "0");
+
+  StaticData::InstanceNonConst().LoadData(parameter);
+
+  std::vector<Phrase> sentences;
+  std::string line;
+  while(getline(std::cin, line)) {
+    sentences.push_back(Phrase());
+    sentences.back().CreateFromString(Input, input, line, "||dummy_string||", NULL);
+  }
+
+  std::stringstream ss;
+  ss << "PhraseDictionaryMemory input-factor=0 output-factor=0 num-features="
+     << nscores << " path=" << ruleTable;
+  NodeTrieRuleTable table(ss.str());
+
+  size_t baseMB = MemoryMB();
+
+  Timer loadTimer;
+  loadTimer.start();
+  table.Load();
+  double loadTime = loadTimer.get_elapsed_time();
+  size_t nodeMB = MemoryMB() - baseMB;
+
+  Timer nodeTimer;
+  nodeTimer.start();
+  size_t nodeFound = LookupAll(table.GetNodeRoot(), sentences, maxLength);
+  double nodeTime = nodeTimer.get_elapsed_time();
+
+  Timer flattenTimer;
+  flattenTimer.start();
+  table.Flatten();
+  double flattenTime = flattenTimer.get_elapsed_time();
+  size_t flatMB = MemoryMB() - baseMB;
+
+  Timer flatTimer;
+  flatTimer.start();
+  size_t flatFound = LookupAll(table.GetRootNode(), sentences, maxLength);
+  double flatTime = flatTimer.get_elapsed_time();
+
+  if (nodeFound != flatFound) {
+    std::cerr << "ERROR: node trie found " << nodeFound << " spans, flat trie "
+              << flatFound << std::endl;
+    return 1;
+  }
+
+  std::cout << "load (node trie):    " << loadTime << " s" << std::endl
+            << "flatten:             " << flattenTime << " s" << std::endl
+            << "nodes:               " << table.GetNumNodes() << std::endl
+            << "memory, node trie:   " << nodeMB << " MB (with rules)" << std::endl
+            << "memory, flat trie:   " << flatMB << " MB (with rules, trie "
+            << (table.GetFlatMemoryUsage() >> 20) << " MB)" << std::endl
+            << "lookups:             " << nodeFound << " spans found" << std::endl
+            << "lookup, node trie:   " << nodeTime << " s" << std::endl
+            << "lookup, flat trie:   " << flatTime << " s" << std::endl;
+  return 0;
+}
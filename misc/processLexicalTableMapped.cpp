@@ -0,0 +1,48 @@
+#include <iostream>
+#include <string>
+
+#include "moses/Timer.h"
+#include "moses/FF/LexicalReordering/LexicalReorderingTableMapped.h"
+
+using namespace Moses;
+
+void printHelp()
+{
+  std::cerr << "Usage:\n"
+            "options: \n"
+            "\t-in  string -- input table file name, may be gzipped\n"
+            "\t-out string -- prefix of binary table file (" << LexicalReorderingTableMapped::Suffix << " is appended)\n"
+            "The input table is read twice, so it cannot be stdin.\n"
+            "\n";
+}
+
+int main(int argc, char** argv)
+{
+  std::string inFilePath;
+  std::string outFilePath("out");
+  for(int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    if("-in" == arg && i+1 < argc) {
+      ++i;
+      inFilePath = argv[i];
+    } else if("-out" == arg && i+1 < argc) {
+      ++i;
+      outFilePath = argv[i];
+    } else {
+      //somethings wrong... print help
+      printHelp();
+      return 1;
+    }
+  }
+  if(inFilePath.empty()) {
+    printHelp();
+    return 1;
+  }
+
+  Timer timer;
+  timer.start();
+  std::cerr << "processing " << inFilePath << " to " << outFilePath << LexicalReorderingTableMapped::Suffix << "\n";
+  LexicalReorderingTableMapped::Create(inFilePath, outFilePath + LexicalReorderingTableMapped::Suffix);
+  std::cerr << "done in " << timer << " seconds\n";
+  return 0;
+}
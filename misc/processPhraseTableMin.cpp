@@ -8,6 +8,7 @@
 #include "moses/TranslationModel/CompactPT/PhraseTableCreator.h"
 
 #include "util/file.hh"
+#include "util/usage.hh"
 
 using namespace Moses;
 
@@ -27,6 +28,8 @@ void printHelp(char **argv)
             "\t-encoding string  -- encoding type: PREnc REnc None (default PREnc)\n"
             "\t-rankscore int    -- score index of P(t|s) (default 2)\n"
             "\t-maxrank int      -- maximum rank for PREnc (default 100)\n"
+            "\t-max-rank-hash-memory int -- MB of the PREnc rank hash to keep in memory,\n"
+            "\t                     the rest is kept on disk (default unlimited)\n"
             "\t-landmark int     -- use landmark phrase every 2^n source phrases (default 10)\n"
             "\t-fingerprint int  -- number of bits used for source phrase fingerprints (default 16)\n"
             "\t-join-scores      -- single set of Huffman codes for score components\n"
@@ -64,6 +67,7 @@ int main(int argc, char **argv)
   bool multipleScoreTrees = true;
   size_t quantize = 0;
   size_t maxRank = 100;
+  size_t maxRankHashMemory = 0;
   bool sortScoreIndexSet = false;
   size_t sortScoreIndex = 2;
   bool warnMe = true;
@@ -98,6 +102,9 @@ int main(int argc, char **argv)
     } else if("-maxrank" == arg && i+1 < argc) {
       ++i;
       maxRank = atoi(argv[i]);
+    } else if("-max-rank-hash-memory" == arg && i+1 < argc) {
+      ++i;
+      maxRankHashMemory = atoi(argv[i]);
     } else if("-nscores" == arg && i+1 < argc) {
       ++i;
       numScoreComponent = atoi(argv[i]);
@@ -162,9 +169,11 @@ int main(int argc, char **argv)
                      numScoreComponent, sortScoreIndex,
                      coding, orderBits, fingerprintBits,
                      useAlignmentInfo, multipleScoreTrees,
-                     quantize, maxRank, warnMe
+                     quantize, maxRank, warnMe, maxRankHashMemory
 #ifdef WITH_THREADS
                      , threads
 #endif
                     );
+
+  util::PrintUsage(std::cerr);
 }
@@ -6,6 +6,7 @@
 #include "moses/Timer.h"
 #include "moses/InputFileStream.h"
 #include "moses/FF/LexicalReordering/LexicalReorderingTable.h"
+#include "moses/FF/LexicalReordering/LexicalReorderingTableMapped.h"
 
 using namespace Moses;
 
@@ -91,7 +92,10 @@ int main(int argc, char** argv)
   f.CreateFromString(Input, f_mask, query_f, "|", NULL);
   c.CreateFromString(Input, c_mask,  query_c,"|", NULL);
   LexicalReorderingTable* table;
-  if(FileExists(inFilePath+".binlexr.idx")) {
+  if(FileExists(inFilePath+LexicalReorderingTableMapped::Suffix)) {
+    std::cerr << "Loading mapped table...\n";
+    table = new LexicalReorderingTableMapped(inFilePath+LexicalReorderingTableMapped::Suffix, f_mask, e_mask, c_mask);
+  } else if(FileExists(inFilePath+".binlexr.idx")) {
     std::cerr << "Loading binary table...\n";
     table = new LexicalReorderingTableTree(inFilePath, f_mask, e_mask, c_mask);
   } else {
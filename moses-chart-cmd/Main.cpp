@@ -107,6 +107,17 @@ public:
       }
       if (staticData.GetNBestSize() > 0)
         m_ioWrapper.OutputNBestList(nbest, translationId);
+      if (!staticData.GetOutputUnknownsFile().empty()) {
+        m_ioWrapper.OutputUnknowns(manager.GetParser().GetUnknownSources(),
+                                   translationId);
+      }
+      if (staticData.GetOutputSearchGraph()) {
+        std::ostringstream out;
+        manager.OutputSearchGraph(translationId, out);
+        OutputCollector *oc = m_ioWrapper.GetSearchGraphOutputCollector();
+        UTIL_THROW_IF2(oc == NULL, "File for search graph output not specified");
+        oc->Write(translationId, out.str());
+      }
       return;
     }
 
@@ -296,10 +307,11 @@ int main(int argc, char* argv[])
       IFVERBOSE(1)
       ResetUserTime();
       TranslationTask *task = new TranslationTask(source, *ioWrapper);
-      source = NULL;  // task will delete source
 #ifdef WITH_THREADS
-      pool.Submit(task);  // pool will delete task
+      pool.Submit(task, source->GetSize());  // pool will delete task
+      source = NULL;  // task will delete source
 #else
+      source = NULL;  // task will delete source
       task->Run();
       delete task;
 #endif
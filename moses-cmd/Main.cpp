@@ -45,6 +45,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "TranslationAnalysis.h"
 #include "IOWrapper.h"
 #include "mbr.h"
+#include "Server.h"
 
 #include "moses/Hypothesis.h"
 #include "moses/Manager.h"
@@ -615,6 +616,27 @@ int main(int argc, char** argv)
     // shorthand for accessing information in StaticData
     const StaticData& staticData = StaticData::Instance();
 
+    // run as a server: translate sentences sent by clients, until killed
+    if (params.isParamSpecified("server-port") || params.isParamSpecified("server-socket")) {
+      int port = 0;
+      string socketPath;
+      if (params.isParamSpecified("server-socket")) {
+        socketPath = staticData.GetParam("server-socket")[0];
+      } else {
+        port = Scan<int>(staticData.GetParam("server-port")[0]);
+      }
+      size_t maxConnections = 64, maxNBestSize = 100;
+      if (params.isParamSpecified("server-max-connections")) {
+        maxConnections = Scan<size_t>(staticData.GetParam("server-max-connections")[0]);
+      }
+      if (params.isParamSpecified("server-max-nbest")) {
+        maxNBestSize = Scan<size_t>(staticData.GetParam("server-max-nbest")[0]);
+      }
+      Server server(port, socketPath, maxConnections, maxNBestSize);
+      server.Run();
+      exit(0);
+    }
+
 
     //initialise random numbers
     srand(time(NULL));
@@ -765,9 +787,9 @@ int main(int argc, char** argv)
                             unknownsCollector.get(),
                             staticData.GetOutputSearchGraphSLF(),
                             staticData.GetOutputSearchGraphHypergraph());
-      // execute task
+      // execute task, longest sentences first
 #ifdef WITH_THREADS
-      pool.Submit(task);
+      pool.Submit(task, source->GetSize());
 #else
       task->Run();
       delete task;
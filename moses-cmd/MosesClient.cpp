@@ -0,0 +1,296 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+/**
+ * Client for a moses started with -server-port or -server-socket.
+ *
+ * Sends every line of standard input as a request, over several
+ * connections at once, and prints the responses in input order.  Each
+ * connection waits for the response to its request before sending the
+ * next, so -connections sets the load on the server.  Latency percentiles
+ * and throughput are reported on standard error.
+ **/
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "util/exception.hh"
+#include "util/file.hh"
+
+using namespace std;
+
+namespace
+{
+
+struct Options {
+  string host;
+  string port;
+  string socketPath;
+  size_t connections;
+  string requestOptions; // passed on with every request
+  Options() : host("localhost"), connections(1) {}
+};
+
+double Now()
+{
+  timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+int Connect(const Options &options)
+{
+  if (!options.socketPath.empty()) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    UTIL_THROW_IF(fd == -1, util::ErrnoException, "Could not create socket");
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, options.socketPath.c_str(), sizeof(address.sun_path) - 1);
+    UTIL_THROW_IF(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1,
+                  util::ErrnoException, "Could not connect to " << options.socketPath);
+    return fd;
+  }
+
+  addrinfo hints, *addresses;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  int ret = getaddrinfo(options.host.c_str(), options.port.c_str(), &hints, &addresses);
+  UTIL_THROW_IF(ret, util::Exception, "Could not resolve " << options.host << ": " << gai_strerror(ret));
+  int fd = -1;
+  for (addrinfo *i = addresses; i; i = i->ai_next) {
+    fd = socket(i->ai_family, i->ai_socktype, i->ai_protocol);
+    if (fd == -1) continue;
+    if (connect(fd, i->ai_addr, i->ai_addrlen) == 0) break;
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(addresses);
+  UTIL_THROW_IF(fd == -1, util::ErrnoException, "Could not connect to " << options.host << ":" << options.port);
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return fd;
+}
+
+class LineReader
+{
+public:
+  explicit LineReader(int fd) : m_fd(fd), m_position(0) {}
+
+  void ReadLine(string &line) {
+    while (true) {
+      size_t newline = m_buffer.find('\n', m_position);
+      if (newline != string::npos) {
+        line.assign(m_buffer, m_position, newline - m_position);
+        m_position = newline + 1;
+        return;
+      }
+      m_buffer.erase(0, m_position);
+      m_position = 0;
+      char chunk[4096];
+      size_t got = util::PartialRead(m_fd, chunk, sizeof(chunk));
+      UTIL_THROW_IF(!got, util::Exception, "Server closed the connection");
+      m_buffer.append(chunk, got);
+    }
+  }
+
+private:
+  int m_fd;
+  string m_buffer;
+  size_t m_position;
+};
+
+/** Input sentences, handed out to the connections one at a time. */
+class Batch
+{
+public:
+  Batch(const vector<string> &input)
+    : m_input(input)
+    , m_responses(input.size())
+    , m_latencies(input.size())
+    , m_next(0) {
+  }
+
+  //! send the next sentences over one connection until there are none left
+  void Translate(const Options &options) {
+    util::scoped_fd fd(Connect(options));
+    LineReader reader(fd.get());
+    string line;
+    size_t index;
+    while (Take(index)) {
+      ostringstream request;
+      request << index << " " << options.requestOptions << " ||| " << m_input[index] << "\n";
+      const string requestStr = request.str();
+
+      double start = Now();
+      util::WriteOrThrow(fd.get(), requestStr.data(), requestStr.size());
+
+      // header: <id> OK <lines>, or <id> ERROR <message>
+      reader.ReadLine(line);
+      istringstream header(line);
+      string id, status;
+      size_t numLines = 0;
+      header >> id >> status >> numLines;
+      string &response = m_responses[index];
+      if (status == "OK") {
+        for (size_t i = 0; i < numLines; ++i) {
+          reader.ReadLine(line);
+          response += line + "\n";
+        }
+      } else {
+        cerr << "Error for line " << index + 1 << ": " << line << endl;
+        response = "\n";
+      }
+      m_latencies[index] = Now() - start;
+    }
+  }
+
+  const vector<string> &GetResponses() const {
+    return m_responses;
+  }
+  const vector<double> &GetLatencies() const {
+    return m_latencies;
+  }
+
+private:
+  const vector<string> &m_input;
+  vector<string> m_responses;
+  vector<double> m_latencies;
+  size_t m_next;
+  boost::mutex m_mutex;
+
+  bool Take(size_t &index) {
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (m_next == m_input.size()) return false;
+    index = m_next++;
+    return true;
+  }
+};
+
+void RunConnection(Batch &batch, const Options &options)
+{
+  try {
+    batch.Translate(options);
+  } catch (const std::exception &e) {
+    cerr << "Exception: " << e.what() << endl;
+    exit(1);
+  }
+}
+
+double Percentile(const vector<double> &sorted, double fraction)
+{
+  size_t index = static_cast<size_t>(fraction * sorted.size());
+  return sorted[min(index, sorted.size() - 1)];
+}
+
+void Usage()
+{
+  cerr << "usage: moses-client (-port PORT [-host HOST] | -socket PATH) [-connections N]" << endl
+       << "                    [-nbest N] [-distinct] [-align] [-weight-setting NAME] < input > output" << endl;
+  exit(1);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  Options options;
+  ostringstream requestOptions;
+  for (int i = 1; i < argc; ++i) {
+    const string arg(argv[i]);
+    const bool hasValue = i + 1 < argc;
+    if (arg == "-host" && hasValue) {
+      options.host = argv[++i];
+    } else if (arg == "-port" && hasValue) {
+      options.port = argv[++i];
+    } else if (arg == "-socket" && hasValue) {
+      options.socketPath = argv[++i];
+    } else if (arg == "-connections" && hasValue) {
+      options.connections = atoi(argv[++i]);
+    } else if (arg == "-nbest" && hasValue) {
+      requestOptions << " nbest=" << argv[++i];
+    } else if (arg == "-distinct") {
+      requestOptions << " distinct=1";
+    } else if (arg == "-align") {
+      requestOptions << " align=1";
+    } else if (arg == "-weight-setting" && hasValue) {
+      requestOptions << " weight-setting=" << argv[++i];
+    } else {
+      Usage();
+    }
+  }
+  if ((options.port.empty() && options.socketPath.empty()) || options.connections == 0) {
+    Usage();
+  }
+  options.requestOptions = requestOptions.str();
+
+  vector<string> input;
+  string line;
+  while (getline(cin, line)) {
+    input.push_back(line);
+  }
+  if (input.empty()) return 0;
+
+  Batch batch(input);
+  double start = Now();
+  boost::thread_group connections;
+  for (size_t i = 0; i < options.connections; ++i) {
+    connections.create_thread(boost::bind(&RunConnection, boost::ref(batch), boost::cref(options)));
+  }
+  connections.join_all();
+  double elapsed = Now() - start;
+
+  const vector<string> &responses = batch.GetResponses();
+  for (size_t i = 0; i < responses.size(); ++i) {
+    cout << responses[i];
+  }
+
+  vector<double> latencies(batch.GetLatencies());
+  sort(latencies.begin(), latencies.end());
+  double total = 0.0;
+  for (size_t i = 0; i < latencies.size(); ++i) {
+    total += latencies[i];
+  }
+  cerr << latencies.size() << " requests over " << options.connections << " connections in "
+       << elapsed << " s, " << latencies.size() / elapsed << " requests/s" << endl
+       << "latency (ms): mean " << 1000 * total / latencies.size()
+       << " p50 " << 1000 * Percentile(latencies, 0.50)
+       << " p90 " << 1000 * Percentile(latencies, 0.90)
+       << " p99 " << 1000 * Percentile(latencies, 0.99)
+       << " max " << 1000 * latencies.back() << endl;
+  return 0;
+}
@@ -0,0 +1,488 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <set>
+#include <sstream>
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+
+#include <boost/bind.hpp>
+#ifdef WITH_THREADS
+#include <boost/thread.hpp>
+#endif
+
+#include "Server.h"
+#include "IOWrapper.h"
+
+#include "moses/Hypothesis.h"
+#include "moses/Manager.h"
+#include "moses/Sentence.h"
+#include "moses/StaticData.h"
+#include "moses/ThreadPool.h"
+#include "moses/Timer.h"
+#include "moses/TrellisPathList.h"
+#include "moses/Util.h"
+#include "util/exception.hh"
+
+using namespace std;
+using namespace Moses;
+
+namespace MosesCmd
+{
+
+namespace
+{
+// a client sending a longer line without a newline is dropped
+const size_t MAX_LINE_LENGTH = 1 << 24;
+
+//! a decimal number without sign, small enough not to overflow
+bool ParseCount(const string &value, size_t &out)
+{
+  if (value.empty() || value.size() > 9 || value.find_first_not_of("0123456789") != string::npos) {
+    return false;
+  }
+  out = Scan<size_t>(value);
+  return true;
+}
+
+//! the values Scan<bool> accepts, without throwing on others
+bool ParseFlag(const string &value, bool &out)
+{
+  const string lc = ToLower(value);
+  if (lc == "1" || lc == "true" || lc == "yes" || lc == "y") {
+    out = true;
+  } else if (lc == "0" || lc == "false" || lc == "no" || lc == "n") {
+    out = false;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/** Translates the sentence of one request and sends the response back on
+ * the connection it came from.
+ */
+class ServerTask : public Task
+{
+public:
+  ServerTask(const ServerRequest &request, long translationId, boost::shared_ptr<ServerConnection> connection,
+             WeightSettingGate &weightSettings)
+    : m_request(request)
+    , m_translationId(translationId)
+    , m_connection(connection)
+    , m_weightSettings(weightSettings) {
+  }
+
+  void Run() {
+    Timer translationTime;
+    translationTime.start();
+
+    string setting, error;
+    if (!GetWeightSetting(setting, error)) {
+      m_connection->Write(m_request.id + " ERROR " + error + "\n");
+      return;
+    }
+
+    string body;
+    m_weightSettings.Enter(setting);
+    try {
+      body = Translate();
+      m_weightSettings.Leave();
+    } catch (const std::exception &e) {
+      m_weightSettings.Leave();
+      string message(e.what());
+      replace(message.begin(), message.end(), '\n', ' ');
+      m_connection->Write(m_request.id + " ERROR " + message + "\n");
+      return;
+    }
+
+    ostringstream response;
+    response << m_request.id << " OK " << count(body.begin(), body.end(), '\n') << "\n" << body;
+    m_connection->Write(response.str());
+    VERBOSE(1, "Request " << m_request.id << ": Translation took " << translationTime << " seconds total" << endl);
+  }
+
+private:
+  ServerRequest m_request;
+  long m_translationId;
+  boost::shared_ptr<ServerConnection> m_connection;
+  WeightSettingGate &m_weightSettings;
+
+  /** The weight setting the sentence is translated with.  It may also be
+   * given as <seg weight-setting=...> markup, which Sentence::Read applies
+   * to StaticData right away.
+   */
+  bool GetWeightSetting(string &setting, string &error) const {
+    string line = m_request.source;
+    map<string, string> meta = ProcessAndStripSGML(line);
+    map<string, string>::const_iterator markup = meta.find("weight-setting");
+    if (markup != meta.end() && !m_request.weightSetting.empty() && markup->second != m_request.weightSetting) {
+      error = "weight setting " + m_request.weightSetting + " conflicts with " + markup->second + " in the markup";
+      return false;
+    }
+    setting = (markup != meta.end()) ? markup->second : m_request.weightSetting;
+    if (setting.empty()) {
+      setting = "default";
+    } else if (!StaticData::Instance().HasWeightSetting(setting)) {
+      error = "unknown weight setting " + setting;
+      return false;
+    }
+    return true;
+  }
+
+  string Translate() {
+    const StaticData &staticData = StaticData::Instance();
+
+    Sentence sentence;
+    istringstream in(m_request.source + "\n");
+    sentence.Read(in, staticData.GetInputFactorOrder());
+    sentence.SetTranslationId(m_translationId);
+    if (!m_request.weightSetting.empty()) {
+      sentence.SetWeightSetting(m_request.weightSetting);
+      sentence.SetSpecifiesWeightSetting(true);
+    }
+
+    Manager manager(m_translationId, sentence, staticData.GetSearchAlgorithm());
+    manager.ProcessSentence();
+
+    ostringstream out;
+    const Hypothesis *bestHypo = manager.GetBestHypothesis();
+    if (bestHypo) {
+      OutputBestSurface(out, bestHypo, staticData.GetOutputFactorOrder(),
+                        staticData.GetReportSegmentation(), staticData.GetReportAllFactors());
+      if (m_request.reportAlignment) {
+        out << "||| ";
+        OutputAlignment(out, bestHypo);
+      } else {
+        out << endl;
+      }
+    } else {
+      out << endl;
+    }
+
+    if (m_request.nBestSize > 0) {
+      TrellisPathList nBestList;
+      manager.CalcNBest(m_request.nBestSize, nBestList, m_request.distinctNBest);
+      OutputNBest(out, nBestList, staticData.GetOutputFactorOrder(), m_translationId,
+                  staticData.GetReportSegmentation());
+    }
+
+    manager.CalcDecoderStatistics();
+    return out.str();
+  }
+};
+
+} // namespace
+
+bool ParseServerRequest(const string &line, size_t maxNBestSize, ServerRequest &request, string &error)
+{
+  size_t bar = line.find("|||");
+  vector<string> header = Tokenize(line.substr(0, bar));
+  if (header.empty()) {
+    request.id = "-";
+    error = "missing request id";
+    return false;
+  }
+  request.id = header[0];
+  if (bar == string::npos) {
+    error = "missing ||| before the sentence";
+    return false;
+  }
+  request.source = Trim(line.substr(bar + 3));
+
+  set<string> seen;
+  for (size_t i = 1; i < header.size(); ++i) {
+    size_t equals = header[i].find('=');
+    const string key = header[i].substr(0, equals);
+    const string value = (equals == string::npos) ? "" : header[i].substr(equals + 1);
+    if (!seen.insert(key).second) {
+      error = "option " + key + " given more than once";
+      return false;
+    }
+    bool ok;
+    if (key == "nbest") {
+      ok = ParseCount(value, request.nBestSize);
+      if (ok && request.nBestSize > maxNBestSize) {
+        error = "nbest=" + value + " is more than the maximum of " + SPrint(maxNBestSize);
+        return false;
+      }
+    } else if (key == "distinct") {
+      ok = ParseFlag(value, request.distinctNBest);
+    } else if (key == "align") {
+      ok = ParseFlag(value, request.reportAlignment);
+    } else if (key == "weight-setting") {
+      ok = !value.empty();
+      request.weightSetting = value;
+    } else {
+      error = "unknown option " + header[i];
+      return false;
+    }
+    if (!ok) {
+      error = "bad value in " + header[i];
+      return false;
+    }
+  }
+  return true;
+}
+
+WeightSettingGate::WeightSettingGate()
+  : m_setting("default")
+  , m_running(0)
+  , m_waiting(0)
+{
+}
+
+void WeightSettingGate::Enter(const string &setting)
+{
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_mutex);
+  if (m_running > 0 && (setting != m_setting || m_waiting > 0)) {
+    // woken when the running ones are done; those with the setting
+    // that got in first may follow it
+    ++m_waiting;
+    do {
+      m_changed.wait(lock);
+    } while (m_running > 0 && setting != m_setting);
+    --m_waiting;
+  }
+#endif
+  m_setting = setting;
+  ++m_running;
+}
+
+void WeightSettingGate::Leave()
+{
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_mutex);
+  if (--m_running == 0) {
+    m_changed.notify_all();
+  }
+#else
+  --m_running;
+#endif
+}
+
+ConnectionLimit::ConnectionLimit(size_t max)
+  : m_max(max)
+  , m_open(0)
+{
+}
+
+void ConnectionLimit::Acquire()
+{
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_mutex);
+  while (m_open >= m_max) {
+    m_released.wait(lock);
+  }
+#endif
+  ++m_open;
+}
+
+void ConnectionLimit::Release()
+{
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_mutex);
+  --m_open;
+  m_released.notify_one();
+#else
+  --m_open;
+#endif
+}
+
+ServerConnection::ServerConnection(int fd)
+  : m_fd(fd)
+  , m_position(0)
+  , m_failed(false)
+{
+}
+
+bool ServerConnection::ReadLine(string &line)
+{
+  while (true) {
+    size_t newline = m_buffer.find('\n', m_position);
+    if (newline != string::npos) {
+      line.assign(m_buffer, m_position, newline - m_position);
+      if (!line.empty() && line[line.size() - 1] == '\r') {
+        line.resize(line.size() - 1);
+      }
+      m_position = newline + 1;
+      return true;
+    }
+
+    // keep the unfinished line, read more
+    m_buffer.erase(0, m_position);
+    m_position = 0;
+    if (m_buffer.size() > MAX_LINE_LENGTH) {
+      return false;
+    }
+    char chunk[4096];
+    ssize_t got;
+    do {
+      got = read(m_fd.get(), chunk, sizeof(chunk));
+    } while (got == -1 && errno == EINTR);
+    if (got <= 0) {
+      return false;
+    }
+    m_buffer.append(chunk, got);
+  }
+}
+
+void ServerConnection::Write(const string &response)
+{
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_writeMutex);
+#endif
+  if (m_failed) return;
+  try {
+    util::WriteOrThrow(m_fd.get(), response.data(), response.size());
+  } catch (const util::Exception &e) {
+    // the client went away. its remaining responses are dropped
+    VERBOSE(1, "Could not send response: " << e.what() << endl);
+    m_failed = true;
+  }
+}
+
+Server::Server(int port, const string &socketPath, size_t maxConnections, size_t maxNBestSize)
+  : m_socketPath(socketPath)
+  , m_tcp(socketPath.empty())
+  , m_nextTranslationId(StaticData::Instance().GetStartTranslationId())
+  , m_maxNBestSize(maxNBestSize)
+  , m_connections(std::max<size_t>(maxConnections, 1))
+#ifdef WITH_THREADS
+  , m_pool(StaticData::Instance().ThreadCount())
+#endif
+{
+  // a client closing its connection early must not take the server down
+  signal(SIGPIPE, SIG_IGN);
+
+  if (m_tcp) {
+    m_listen.reset(socket(AF_INET, SOCK_STREAM, 0));
+    UTIL_THROW_IF(m_listen.get() == -1, util::ErrnoException, "Could not create socket");
+    int one = 1;
+    setsockopt(m_listen.get(), SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    UTIL_THROW_IF(bind(m_listen.get(), reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1,
+                  util::ErrnoException, "Could not bind to port " << port);
+  } else {
+    m_listen.reset(socket(AF_UNIX, SOCK_STREAM, 0));
+    UTIL_THROW_IF(m_listen.get() == -1, util::ErrnoException, "Could not create socket");
+
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    UTIL_THROW_IF(socketPath.size() >= sizeof(address.sun_path), util::Exception,
+                  "Socket path too long: " << socketPath);
+    strcpy(address.sun_path, socketPath.c_str());
+    unlink(socketPath.c_str());
+    UTIL_THROW_IF(bind(m_listen.get(), reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1,
+                  util::ErrnoException, "Could not bind to " << socketPath);
+  }
+
+  UTIL_THROW_IF(listen(m_listen.get(), SOMAXCONN) == -1, util::ErrnoException, "Could not listen");
+  if (m_tcp) {
+    VERBOSE(1, "Listening on port " << port << endl);
+  } else {
+    VERBOSE(1, "Listening on " << socketPath << endl);
+  }
+}
+
+Server::~Server()
+{
+  if (!m_tcp) {
+    unlink(m_socketPath.c_str());
+  }
+}
+
+void Server::Run()
+{
+  while (true) {
+    // released by Serve when the connection is closed
+    m_connections.Acquire();
+    int fd = accept(m_listen.get(), NULL, NULL);
+    if (fd == -1) {
+      m_connections.Release();
+      UTIL_THROW_IF(errno != EINTR && errno != ECONNABORTED, util::ErrnoException, "accept failed");
+      continue;
+    }
+    if (m_tcp) {
+      // responses are written in one go, don't hold them back
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    boost::shared_ptr<ServerConnection> connection(new ServerConnection(fd));
+#ifdef WITH_THREADS
+    boost::thread reader(boost::bind(&Server::Serve, this, connection));
+    reader.detach();
+#else
+    Serve(connection);
+#endif
+  }
+}
+
+/** Read the requests of one connection until the client closes it. */
+void Server::Serve(boost::shared_ptr<ServerConnection> connection)
+{
+  string line;
+  while (connection->ReadLine(line)) {
+    if (Trim(line).empty()) continue;
+
+    ServerRequest request;
+    string error;
+    if (!ParseServerRequest(line, m_maxNBestSize, request, error)) {
+      connection->Write(request.id + " ERROR " + error + "\n");
+      continue;
+    }
+
+    ServerTask *task = new ServerTask(request, NextTranslationId(), connection, m_weightSettings);
+#ifdef WITH_THREADS
+    // first come, first served: ordering by length would starve short requests
+    m_pool.Submit(task);
+#else
+    task->Run();
+    delete task;
+#endif
+  }
+  m_connections.Release();
+}
+
+long Server::NextTranslationId()
+{
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_idMutex);
+#endif
+  return m_nextTranslationId++;
+}
+
+}
@@ -0,0 +1,187 @@
+// -*- c++ -*-
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_cmd_Server_h
+#define moses_cmd_Server_h
+
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+#ifdef WITH_THREADS
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include "moses/ThreadPool.h"
+#endif
+
+#include "util/file.hh"
+
+namespace MosesCmd
+{
+
+/** A sentence sent by a client, and what to send back for it. */
+struct ServerRequest {
+  std::string id;
+  size_t nBestSize;
+  bool distinctNBest;
+  bool reportAlignment;
+  std::string weightSetting;
+  std::string source;
+
+  ServerRequest()
+    : nBestSize(0)
+    , distinctNBest(false)
+    , reportAlignment(false) {
+  }
+};
+
+/** Parse a request line.  Returns false and describes the problem in error
+ * if the line is malformed, an option is repeated or has a bad value, or
+ * more than maxNBestSize translations are asked for; request.id is filled
+ * in if it could be read.
+ */
+bool ParseServerRequest(const std::string &line, size_t maxNBestSize, ServerRequest &request, std::string &error);
+
+/** A client connection.  Shared by the thread reading its requests and the
+ * tasks translating them, and closed when the last of them lets go.
+ */
+class ServerConnection
+{
+public:
+  explicit ServerConnection(int fd);
+
+  //! next request line, without the newline. false at end of stream
+  bool ReadLine(std::string &line);
+
+  //! send a complete response. may be called from several threads
+  void Write(const std::string &response);
+
+private:
+  util::scoped_fd m_fd;
+  std::string m_buffer;
+  size_t m_position;
+  bool m_failed;
+#ifdef WITH_THREADS
+  boost::mutex m_writeMutex;
+#endif
+};
+
+/** StaticData holds the weights of one weight setting at a time, and
+ * Manager switches them for each sentence.  Requests are let through
+ * concurrently only while they use the same setting; a request asking
+ * for another one waits until those running are done, and holds back
+ * later ones so that it is not starved.
+ */
+class WeightSettingGate
+{
+public:
+  WeightSettingGate();
+
+  //! wait until sentences may be translated with this setting
+  void Enter(const std::string &setting);
+  void Leave();
+
+private:
+#ifdef WITH_THREADS
+  boost::mutex m_mutex;
+  boost::condition_variable m_changed;
+#endif
+  std::string m_setting;
+  size_t m_running;
+  size_t m_waiting;
+};
+
+/** Counts the connections being served, and makes the server wait for one
+ * to close before it accepts another past the limit.  Clients beyond it
+ * wait in the listen backlog.
+ */
+class ConnectionLimit
+{
+public:
+  explicit ConnectionLimit(size_t max);
+
+  //! wait until another connection may be served
+  void Acquire();
+  void Release();
+
+private:
+#ifdef WITH_THREADS
+  boost::mutex m_mutex;
+  boost::condition_variable m_released;
+#endif
+  size_t m_max;
+  size_t m_open;
+};
+
+/** Translation server, started with -server-port or -server-socket.
+ *
+ * Keeps the models loaded by StaticData and translates sentences sent
+ * over TCP or a Unix domain socket.  A client sends one request per line:
+ *
+ *   <id> [nbest=N] [distinct=1] [align=1] [weight-setting=NAME] ||| <sentence>
+ *
+ * and gets back, for each request, a header line followed by its body:
+ *
+ *   <id> OK <number of lines>
+ *   <translation>[ ||| <word alignment>]
+ *   <n-best list, in the format of -n-best-list, if asked for>
+ *
+ * or "<id> ERROR <message>" on a single line.  The sentence may contain the
+ * usual xml markup.  A weight setting must be one of the alternate weight
+ * settings in the configuration; requests with different settings are not
+ * translated at the same time.  N-best lists can be as long as
+ * -server-max-nbest (default 100); requests with bad options get an ERROR.
+ *
+ * Requests of all connections go to one pool of -threads workers, in the
+ * order they arrive, and responses are sent as soon as they are done, so
+ * a client may send several requests before reading the responses and
+ * match them up by id.  At most -server-max-connections (default 64)
+ * connections are served at a time.
+ */
+class Server
+{
+public:
+  //! listen on a Unix domain socket if socketPath is not empty, otherwise on TCP port
+  Server(int port, const std::string &socketPath, size_t maxConnections, size_t maxNBestSize);
+  ~Server();
+
+  //! serve clients until the process is killed
+  void Run();
+
+private:
+  util::scoped_fd m_listen;
+  std::string m_socketPath;
+  bool m_tcp;
+  long m_nextTranslationId;
+  size_t m_maxNBestSize;
+  WeightSettingGate m_weightSettings;
+  ConnectionLimit m_connections;
+#ifdef WITH_THREADS
+  Moses::ThreadPool m_pool;
+  boost::mutex m_idMutex;
+#endif
+
+  void Serve(boost::shared_ptr<ServerConnection> connection);
+  long NextTranslationId();
+};
+
+}
+
+#endif
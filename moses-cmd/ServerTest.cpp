@@ -0,0 +1,121 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#define BOOST_TEST_MODULE server
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+#include "Server.h"
+
+using namespace MosesCmd;
+using namespace std;
+
+namespace
+{
+
+const size_t MAX_NBEST = 100;
+
+// the error for line, or "" if it is accepted
+string ErrorOf(const string &line)
+{
+  ServerRequest request;
+  string error;
+  if (ParseServerRequest(line, MAX_NBEST, request, error)) {
+    BOOST_CHECK(error.empty());
+    return "";
+  }
+  BOOST_CHECK(!error.empty());
+  return error;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(parse_server_request)
+
+BOOST_AUTO_TEST_CASE(plain)
+{
+  ServerRequest request;
+  string error;
+  BOOST_REQUIRE(ParseServerRequest("s1 ||| das ist ein haus ", MAX_NBEST, request, error));
+  BOOST_CHECK_EQUAL(request.id, "s1");
+  BOOST_CHECK_EQUAL(request.source, "das ist ein haus");
+  BOOST_CHECK_EQUAL(request.nBestSize, 0);
+  BOOST_CHECK(!request.distinctNBest);
+  BOOST_CHECK(!request.reportAlignment);
+  BOOST_CHECK(request.weightSetting.empty());
+}
+
+BOOST_AUTO_TEST_CASE(options)
+{
+  ServerRequest request;
+  string error;
+  BOOST_REQUIRE(ParseServerRequest("7 nbest=100 distinct=1 align=true weight-setting=news ||| haus",
+                                   MAX_NBEST, request, error));
+  BOOST_CHECK_EQUAL(request.id, "7");
+  BOOST_CHECK_EQUAL(request.nBestSize, 100);
+  BOOST_CHECK(request.distinctNBest);
+  BOOST_CHECK(request.reportAlignment);
+  BOOST_CHECK_EQUAL(request.weightSetting, "news");
+  BOOST_CHECK_EQUAL(request.source, "haus");
+
+  BOOST_REQUIRE(ParseServerRequest("8 align=0 distinct=no ||| haus", MAX_NBEST, request, error));
+  BOOST_CHECK(!request.reportAlignment);
+  BOOST_CHECK(!request.distinctNBest);
+}
+
+BOOST_AUTO_TEST_CASE(malformed)
+{
+  BOOST_CHECK(!ErrorOf("").empty());
+  BOOST_CHECK(!ErrorOf("||| haus").empty());
+  BOOST_CHECK(!ErrorOf("1 haus").empty());
+  BOOST_CHECK(!ErrorOf("1 colour=red ||| haus").empty());
+
+  // the id is known, so the error can be matched up with the request
+  ServerRequest request;
+  string error;
+  BOOST_CHECK(!ParseServerRequest("9 nbest=x ||| haus", MAX_NBEST, request, error));
+  BOOST_CHECK_EQUAL(request.id, "9");
+}
+
+BOOST_AUTO_TEST_CASE(bad_values)
+{
+  BOOST_CHECK(!ErrorOf("1 nbest= ||| haus").empty());
+  BOOST_CHECK(!ErrorOf("1 nbest ||| haus").empty());
+  BOOST_CHECK(!ErrorOf("1 nbest=-1 ||| haus").empty());
+  BOOST_CHECK(!ErrorOf("1 nbest=10x ||| haus").empty());
+  BOOST_CHECK(!ErrorOf("1 nbest=99999999999999999999 ||| haus").empty());
+  BOOST_CHECK(!ErrorOf("1 distinct=maybe ||| haus").empty());
+  BOOST_CHECK(!ErrorOf("1 align= ||| haus").empty());
+  BOOST_CHECK(!ErrorOf("1 weight-setting= ||| haus").empty());
+}
+
+BOOST_AUTO_TEST_CASE(bounded_nbest)
+{
+  BOOST_CHECK_EQUAL(ErrorOf("1 nbest=100 ||| haus"), "");
+  BOOST_CHECK_EQUAL(ErrorOf("1 nbest=101 ||| haus"), "nbest=101 is more than the maximum of 100");
+  BOOST_CHECK(!ErrorOf("1 nbest=1000000000 ||| haus").empty());
+}
+
+BOOST_AUTO_TEST_CASE(repeated_option)
+{
+  BOOST_CHECK_EQUAL(ErrorOf("1 nbest=1 nbest=2 ||| haus"), "option nbest given more than once");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
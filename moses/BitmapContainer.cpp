@@ -197,9 +197,9 @@ BackwardsEdge::Initialize()
   m_initialized = true;
 }
 
-Hypothesis *BackwardsEdge::CreateHypothesis(const Hypothesis &hypothesis, const TranslationOption &transOpt)
+Hypothesis *BackwardsEdge::BuildHypothesis(const Hypothesis &hypothesis, const TranslationOption &transOpt)
 {
-  // create hypothesis and calculate all its scores
+  // create hypothesis without scoring it
   IFVERBOSE(2) {
     hypothesis.GetManager().GetSentenceStats().StartTimeBuildHyp();
   }
@@ -207,6 +207,13 @@ Hypothesis *BackwardsEdge::CreateHypothesis(const Hypothesis &hypothesis, const
   IFVERBOSE(2) {
     hypothesis.GetManager().GetSentenceStats().StopTimeBuildHyp();
   }
+  return newHypo;
+}
+
+Hypothesis *BackwardsEdge::CreateHypothesis(const Hypothesis &hypothesis, const TranslationOption &transOpt)
+{
+  // create hypothesis and calculate all its scores
+  Hypothesis *newHypo = BuildHypothesis(hypothesis, transOpt);
   newHypo->Evaluate(m_futurescore);
 
   return newHypo;
@@ -244,22 +251,32 @@ BackwardsEdge::GetBitmapContainer() const
 void
 BackwardsEdge::PushSuccessors(const size_t x, const size_t y)
 {
-  Hypothesis *newHypo;
+  Hypothesis *nextTranslation = NULL, *nextHypothesis = NULL;
 
   if(y + 1 < m_translations.size() && !SeenPosition(x, y + 1)) {
     SetSeenPosition(x, y + 1);
-    newHypo = CreateHypothesis(*m_hypotheses[x], *m_translations.Get(y + 1));
-    if(newHypo != NULL) {
-      m_parent.Enqueue(x, y + 1, newHypo, (BackwardsEdge*)this);
-    }
+    nextTranslation = BuildHypothesis(*m_hypotheses[x], *m_translations.Get(y + 1));
   }
 
   if(x + 1 < m_hypotheses.size() && !SeenPosition(x + 1, y)) {
     SetSeenPosition(x + 1, y);
-    newHypo = CreateHypothesis(*m_hypotheses[x + 1], *m_translations.Get(y));
-    if(newHypo != NULL) {
-      m_parent.Enqueue(x + 1, y, newHypo, (BackwardsEdge*)this);
-    }
+    nextHypothesis = BuildHypothesis(*m_hypotheses[x + 1], *m_translations.Get(y));
+  }
+
+  // start the language model lookups of both successors before scoring either
+  if (StaticData::Instance().GetLMPrefetchDistance()) {
+    if (nextTranslation != NULL) nextTranslation->Prefetch();
+    if (nextHypothesis != NULL) nextHypothesis->Prefetch();
+  }
+
+  if(nextTranslation != NULL) {
+    nextTranslation->Evaluate(m_futurescore);
+    m_parent.Enqueue(x, y + 1, nextTranslation, (BackwardsEdge*)this);
+  }
+
+  if(nextHypothesis != NULL) {
+    nextHypothesis->Evaluate(m_futurescore);
+    m_parent.Enqueue(x + 1, y, nextHypothesis, (BackwardsEdge*)this);
   }
 }
 
@@ -20,6 +20,7 @@
  ***********************************************************************/
 
 #include <algorithm>
+#include <limits>
 #include "ChartCell.h"
 #include "ChartCellCollection.h"
 #include "RuleCubeQueue.h"
@@ -55,7 +56,18 @@ ChartCell::ChartCell(size_t startPos, size_t endPos, ChartManager &manager) :
   m_nBestIsEnabled = staticData.IsNBestEnabled();
 }
 
-ChartCell::~ChartCell() {}
+ChartCell::~ChartCell()
+{
+  MapType::iterator iter;
+  for (iter = m_hypoColl.begin(); iter != m_hypoColl.end(); ++iter) {
+    delete iter->second;
+  }
+}
+
+ChartCell::MapType::const_iterator ChartCell::LowerBound(const Word &constituentLabel) const
+{
+  return std::lower_bound(m_hypoColl.begin(), m_hypoColl.end(), constituentLabel[0]->GetId(), LabelIdOrderer());
+}
 
 /** Add the given hypothesis to the cell.
  *  Returns true if added, false if not. Maybe it already exists in the collection or score falls below threshold etc.
@@ -65,7 +77,11 @@ ChartCell::~ChartCell() {}
 bool ChartCell::AddHypothesis(ChartHypothesis *hypo)
 {
   const Word &targetLHS = hypo->GetTargetLHS();
-  return m_hypoColl[targetLHS].AddHypothesis(hypo, m_manager);
+  MapType::iterator iter = m_hypoColl.begin() + (LowerBound(targetLHS) - m_hypoColl.begin());
+  if (iter == m_hypoColl.end() || iter->first[0]->GetId() != targetLHS[0]->GetId()) {
+    iter = m_hypoColl.insert(iter, MapType::value_type(targetLHS, new ChartHypothesisCollection()));
+  }
+  return iter->second->AddHypothesis(hypo, m_manager);
 }
 
 /** Prune each collection in this cell to a particular size */
@@ -73,7 +89,7 @@ void ChartCell::PruneToSize()
 {
   MapType::iterator iter;
   for (iter = m_hypoColl.begin(); iter != m_hypoColl.end(); ++iter) {
-    ChartHypothesisCollection &coll = iter->second;
+    ChartHypothesisCollection &coll = *iter->second;
     coll.PruneToSize(m_manager);
   }
 }
@@ -100,8 +116,20 @@ void ChartCell::ProcessSentence(const ChartTranslationOptionList &transOptList
 
   // pluck things out of queue and add to hypo collection
   const size_t popLimit = staticData.GetCubePruningPopLimit();
+  const bool earlyStop = staticData.GetCubePruningEarlyStop();
+  float stopScore = -std::numeric_limits<float>::infinity();
   for (size_t numPops = 0; numPops < popLimit && !queue.IsEmpty(); ++numPops) {
+    // the queue is ordered, so nothing left in it can reach the beam of the
+    // best hypothesis so far
+    if (earlyStop && queue.GetTopScore() < stopScore) {
+      VERBOSE(3, "Cell " << m_coverage << " stopped after " << numPops << " pops" << std::endl);
+      break;
+    }
     ChartHypothesis *hypo = queue.Pop();
+    float score = hypo->GetTotalScore();
+    if (earlyStop) {
+      stopScore = std::max(stopScore, score + staticData.GetBeamWidth() - staticData.GetCubePruningEarlyStopMargin());
+    }
     AddHypothesis(hypo);
   }
 }
@@ -113,7 +141,7 @@ void ChartCell::SortHypotheses()
 
   MapType::iterator iter;
   for (iter = m_hypoColl.begin(); iter != m_hypoColl.end(); ++iter) {
-    ChartHypothesisCollection &coll = iter->second;
+    ChartHypothesisCollection &coll = *iter->second;
     coll.SortHypotheses();
     m_targetLabelSet.AddConstituent(iter->first, &coll.GetSortedHypotheses());
   }
@@ -127,7 +155,7 @@ const ChartHypothesis *ChartCell::GetBestHypothesis() const
 
   MapType::const_iterator iter;
   for (iter = m_hypoColl.begin(); iter != m_hypoColl.end(); ++iter) {
-    const HypoList &sortedList = iter->second.GetSortedHypotheses();
+    const HypoList &sortedList = iter->second->GetSortedHypotheses();
     if (sortedList.size() > 0) {
       const ChartHypothesis *hypo = sortedList[0];
       if (hypo->GetTotalScore() > bestScore) {
@@ -148,18 +176,28 @@ void ChartCell::CleanupArcList()
 
   MapType::iterator iter;
   for (iter = m_hypoColl.begin(); iter != m_hypoColl.end(); ++iter) {
-    ChartHypothesisCollection &coll = iter->second;
+    ChartHypothesisCollection &coll = *iter->second;
     coll.CleanupArcList();
   }
 }
 
+//! call OffsetIds() in each hypo collection in this cell
+void ChartCell::OffsetHypothesisIds(unsigned firstId, unsigned offset)
+{
+  MapType::iterator iter;
+  for (iter = m_hypoColl.begin(); iter != m_hypoColl.end(); ++iter) {
+    ChartHypothesisCollection &coll = *iter->second;
+    coll.OffsetIds(firstId, offset);
+  }
+}
+
 //! debug info - size of each hypo collection in this cell
 void ChartCell::OutputSizes(std::ostream &out) const
 {
   MapType::const_iterator iter;
   for (iter = m_hypoColl.begin(); iter != m_hypoColl.end(); ++iter) {
     const Word &targetLHS = iter->first;
-    const ChartHypothesisCollection &coll = iter->second;
+    const ChartHypothesisCollection &coll = *iter->second;
 
     out << targetLHS << "=" << coll.GetSize() << " ";
   }
@@ -171,7 +209,7 @@ size_t ChartCell::GetSize() const
   size_t ret = 0;
   MapType::const_iterator iter;
   for (iter = m_hypoColl.begin(); iter != m_hypoColl.end(); ++iter) {
-    const ChartHypothesisCollection &coll = iter->second;
+    const ChartHypothesisCollection &coll = *iter->second;
 
     ret += coll.GetSize();
   }
@@ -185,7 +223,7 @@ const HypoList *ChartCell::GetAllSortedHypotheses() const
 
   MapType::const_iterator iter;
   for (iter = m_hypoColl.begin(); iter != m_hypoColl.end(); ++iter) {
-    const ChartHypothesisCollection &coll = iter->second;
+    const ChartHypothesisCollection &coll = *iter->second;
     const HypoList &list = coll.GetSortedHypotheses();
     std::copy(list.begin(), list.end(), std::inserter(*ret, ret->end()));
   }
@@ -197,7 +235,7 @@ void ChartCell::GetSearchGraph(long translationId, std::ostream &outputSearchGra
 {
   MapType::const_iterator iterOutside;
   for (iterOutside = m_hypoColl.begin(); iterOutside != m_hypoColl.end(); ++iterOutside) {
-    const ChartHypothesisCollection &coll = iterOutside->second;
+    const ChartHypothesisCollection &coll = *iterOutside->second;
     coll.GetSearchGraph(translationId, outputSearchGraphStream, reachable);
   }
 }
@@ -209,7 +247,7 @@ std::ostream& operator<<(std::ostream &out, const ChartCell &cell)
     const Word &targetLHS = iterOutside->first;
     cerr << targetLHS << ":" << endl;
 
-    const ChartHypothesisCollection &coll = iterOutside->second;
+    const ChartHypothesisCollection &coll = *iterOutside->second;
     cerr << coll;
   }
 
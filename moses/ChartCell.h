@@ -34,9 +34,6 @@
 #include "ChartCellLabelSet.h"
 
 #include <boost/scoped_ptr.hpp>
-#include <boost/functional/hash.hpp>
-#include <boost/unordered_map.hpp>
-#include <boost/version.hpp>
 
 namespace Moses
 {
@@ -75,19 +72,24 @@ class ChartCell : public ChartCellBase
 {
   friend std::ostream& operator<<(std::ostream&, const ChartCell&);
 public:
-#if defined(BOOST_VERSION) && (BOOST_VERSION >= 104200)
-  typedef boost::unordered_map<Word,
-          ChartHypothesisCollection,
-          NonTerminalHasher,
-          NonTerminalEqualityPred
-          > MapType;
-#else
-  typedef std::map<Word, ChartHypothesisCollection> MapType;
-#endif
+  /** one hypothesis collection per constituent label, ordered by the label's
+   *  non-terminal id.  A cell holds few labels, so binary search in a flat
+   *  vector beats a hash map and only allocates when a label is first seen.
+   *  The collections come from the sentence arena.
+   */
+  typedef std::vector<std::pair<Word, ChartHypothesisCollection*> > MapType;
 
 protected:
+  struct LabelIdOrderer {
+    bool operator()(const MapType::value_type &entry, size_t id) const {
+      return entry.first[0]->GetId() < id;
+    }
+  };
+
   MapType m_hypoColl;
 
+  MapType::const_iterator LowerBound(const Word &constituentLabel) const;
+
   bool m_nBestIsEnabled; /**< flag to determine whether to keep track of old arcs */
   ChartManager &m_manager;
 
@@ -100,8 +102,9 @@ public:
 
   //! Get all hypotheses in the cell that have the specified constituent label
   const HypoList *GetSortedHypotheses(const Word &constituentLabel) const {
-    MapType::const_iterator p = m_hypoColl.find(constituentLabel);
-    return (p == m_hypoColl.end()) ? NULL : &(p->second.GetSortedHypotheses());
+    MapType::const_iterator p = LowerBound(constituentLabel);
+    return (p == m_hypoColl.end() || p->first[0]->GetId() != constituentLabel[0]->GetId())
+           ? NULL : &(p->second->GetSortedHypotheses());
   }
 
   //! for n-best list
@@ -116,6 +119,8 @@ public:
 
   void CleanupArcList();
 
+  void OffsetHypothesisIds(unsigned firstId, unsigned offset);
+
   void OutputSizes(std::ostream &out) const;
   size_t GetSize() const;
 
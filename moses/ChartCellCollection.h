@@ -73,6 +73,8 @@ private:
 };
 
 /** Hold all the chart cells for 1 input sentence. A variable of this type is held by the ChartManager
+ *  All cells are created up front, so different threads may fill different cells,
+ *  as long as none reads a cell that is still being filled.
  */
 class ChartCellCollection : public ChartCellCollectionBase
 {
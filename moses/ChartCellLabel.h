@@ -20,6 +20,7 @@
 #pragma once
 
 #include "HypoList.h"
+#include "SentenceArena.h"
 #include "Word.h"
 #include "WordsRange.h"
 
@@ -55,6 +56,13 @@ public:
     , m_stack(stack) {
   }
 
+  static void *operator new(std::size_t size) {
+    return SentenceArena::Allocate(size);
+  }
+  static void operator delete(void *ptr) {
+    SentenceArena::Free(ptr);
+  }
+
   const WordsRange &GetCoverage() const {
     return m_coverage;
   }
@@ -23,6 +23,8 @@
 #include "NonTerminal.h"
 #include "moses/FactorCollection.h"
 
+#include <algorithm>
+
 #include <boost/functional/hash.hpp>
 #include <boost/unordered_map.hpp>
 #include <boost/version.hpp>
@@ -46,7 +48,6 @@ public:
 
   ChartCellLabelSet(const WordsRange &coverage)
   : m_coverage(coverage)
-  , m_map(FactorCollection::Instance().GetNumNonTerminals(), NULL)
   , m_size(0) { }
 
   ~ChartCellLabelSet() {
@@ -91,16 +92,13 @@ public:
     }
   }
 
-  // grow vector if necessary
+  // grow vector if necessary. Most cells hold no or few labels, so the
+  // vector is only allocated when the first label is added
   bool ChartCellExists(size_t idx) {
-    try {
-      if (m_map.at(idx) != NULL) {
-        return true;
-      }
-    }
-    catch (const std::out_of_range& oor) {
-      m_map.resize(FactorCollection::Instance().GetNumNonTerminals(), NULL);
+    if (idx < m_map.size()) {
+      return m_map[idx] != NULL;
     }
+    m_map.resize(std::max(idx + 1, FactorCollection::Instance().GetNumNonTerminals()), NULL);
     return false;
   }
 
@@ -114,12 +112,7 @@ public:
 
   const ChartCellLabel *Find(const Word &w) const {
     size_t idx = w[0]->GetId();
-    try {
-      return m_map.at(idx);
-    }
-    catch (const std::out_of_range& oor) {
-      return NULL;
-    }
+    return idx < m_map.size() ? m_map[idx] : NULL;
   }
 
   ChartCellLabel::Stack &FindOrInsert(const Word &w) {
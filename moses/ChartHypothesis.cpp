@@ -55,7 +55,7 @@ ChartHypothesis::ChartHypothesis(const ChartTranslationOptions &transOpt,
   ,m_arcList(NULL)
   ,m_winningHypo(NULL)
   ,m_manager(manager)
-  ,m_id(manager.GetNextHypoId())
+  ,m_id(manager.GetNextHypoId(m_currSourceWordsRange))
 {
   // underlying hypotheses for sub-spans
   const std::vector<HypothesisDimension> &childEntries = item.GetHypothesisDimensions();
@@ -66,6 +66,22 @@ ChartHypothesis::ChartHypothesis(const ChartTranslationOptions &transOpt,
   }
 }
 
+ChartHypothesis::ChartHypothesis(const TargetPhrase &targetPhrase,
+                                 const WordsRange &range,
+                                 const std::vector<const ChartHypothesis*> &prevHypos,
+                                 ChartManager &manager)
+  :m_transOpt(new ChartTranslationOption(targetPhrase))
+  ,m_currSourceWordsRange(range)
+  ,m_ffStates(StatefulFeatureFunction::GetStatefulFeatureFunctions().size())
+  ,m_totalScore(0)
+  ,m_arcList(NULL)
+  ,m_winningHypo(NULL)
+  ,m_prevHypos(prevHypos)
+  ,m_manager(manager)
+  ,m_id(manager.GetNextHypoId(m_currSourceWordsRange))
+{
+}
+
 ChartHypothesis::~ChartHypothesis()
 {
   // delete feature function states
@@ -162,9 +178,8 @@ int ChartHypothesis::RecombineCompare(const ChartHypothesis &compare) const
 /** calculate total score
   * @todo this should be in ScoreBreakdown
  */
-void ChartHypothesis::Evaluate()
+void ChartHypothesis::SumPrevAndRuleScores()
 {
-  const StaticData &staticData = StaticData::Instance();
   // total scores from prev hypos
   std::vector<const ChartHypothesis*>::iterator iter;
   for (iter = m_prevHypos.begin(); iter != m_prevHypos.end(); ++iter) {
@@ -177,6 +192,12 @@ void ChartHypothesis::Evaluate()
   // scores from current translation rule. eg. translation models & word penalty
   const ScoreComponentCollection &scoreBreakdown = GetTranslationOption().GetScores();
   m_scoreBreakdown.PlusEquals(scoreBreakdown);
+}
+
+void ChartHypothesis::Evaluate()
+{
+  const StaticData &staticData = StaticData::Instance();
+  SumPrevAndRuleScores();
 
   // compute values of stateless feature functions that were not
   // cached in the translation option-- there is no principled distinction
@@ -199,6 +220,24 @@ void ChartHypothesis::Evaluate()
   m_totalScore	= m_scoreBreakdown.GetWeightedScore();
 }
 
+void ChartHypothesis::EvaluateStatefulExcept(const StatefulFeatureFunction &skip, ScoreComponentCollection &changes)
+{
+  const StaticData &staticData = StaticData::Instance();
+  SumPrevAndRuleScores();
+
+  changes.MinusEquals(m_scoreBreakdown);
+  const std::vector<const StatefulFeatureFunction*>& ffs =
+    StatefulFeatureFunction::GetStatefulFeatureFunctions();
+  for (unsigned i = 0; i < ffs.size(); ++i) {
+    if (ffs[i] != &skip && ! staticData.IsFeatureFunctionIgnored( *ffs[i] )) {
+      m_ffStates[i] = ffs[i]->EvaluateChart(*this,i,&m_scoreBreakdown);
+    }
+  }
+  changes.PlusEquals(m_scoreBreakdown);
+
+  m_totalScore	= m_scoreBreakdown.GetWeightedScore();
+}
+
 void ChartHypothesis::AddArc(ChartHypothesis *loserHypo)
 {
   if (!m_arcList) {
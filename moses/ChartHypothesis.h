@@ -27,6 +27,7 @@
 #include "Phrase.h"
 #include "ChartTranslationOptions.h"
 #include "ObjectPool.h"
+#include "SentenceArena.h"
 
 namespace Moses
 {
@@ -35,6 +36,7 @@ class ChartHypothesis;
 class ChartManager;
 class RuleCubeItem;
 class FFState;
+class StatefulFeatureFunction;
 
 typedef std::vector<ChartHypothesis*> ChartArcList;
 
@@ -74,6 +76,8 @@ protected:
   //! not implemented
   ChartHypothesis(const ChartHypothesis &copy);
 
+  void SumPrevAndRuleScores();
+
 public:
 #ifdef USE_HYPO_POOL
   void *operator new(size_t /* num_bytes */) {
@@ -86,6 +90,13 @@ public:
     s_objectPool.freeObject(hypo);
   }
 #else
+  static void *operator new(std::size_t size) {
+    return SentenceArena::Allocate(size);
+  }
+  static void operator delete(void *ptr) {
+    SentenceArena::Free(ptr);
+  }
+
   //! delete \param hypo. Works with object pool too
   static void Delete(ChartHypothesis *hypo) {
     delete hypo;
@@ -95,12 +106,21 @@ public:
   ChartHypothesis(const ChartTranslationOptions &, const RuleCubeItem &item,
                   ChartManager &manager);
 
+  //! for incremental search, which has no rule cube
+  ChartHypothesis(const TargetPhrase &targetPhrase, const WordsRange &range,
+                  const std::vector<const ChartHypothesis*> &prevHypos,
+                  ChartManager &manager);
+
   ~ChartHypothesis();
 
   unsigned GetId() const {
     return m_id;
   }
 
+  void SetId(unsigned id) {
+    m_id = id;
+  }
+
   const ChartTranslationOption &GetTranslationOption()const {
     return *m_transOpt;
   }
@@ -137,6 +157,13 @@ public:
 
   void Evaluate();
 
+  /** for incremental search, which scores the rule and one language model
+   * itself: sums up the scores like Evaluate(), but evaluates only the
+   * stateful feature functions other than skip.  changes gets what they
+   * added to the score breakdown.
+   */
+  void EvaluateStatefulExcept(const StatefulFeatureFunction &skip, ScoreComponentCollection &changes);
+
   void AddArc(ChartHypothesis *loserHypo);
   void CleanupArcList();
   void SetWinningHypo(const ChartHypothesis *hypo);
@@ -62,7 +62,7 @@ ChartHypothesisCollection::~ChartHypothesisCollection()
 bool ChartHypothesisCollection::AddHypothesis(ChartHypothesis *hypo, ChartManager &manager)
 {
   if (hypo->GetTotalScore() == - std::numeric_limits<float>::infinity()) {
-    manager.GetSentenceStats().AddDiscarded();
+    manager.AddDiscarded();
     VERBOSE(3,"discarded, -inf score" << std::endl);
     ChartHypothesis::Delete(hypo);
     return false;
@@ -70,7 +70,7 @@ bool ChartHypothesisCollection::AddHypothesis(ChartHypothesis *hypo, ChartManage
 
   if (hypo->GetTotalScore() < m_bestScore + m_beamWidth) {
     // really bad score. don't bother adding hypo into collection
-    manager.GetSentenceStats().AddDiscarded();
+    manager.AddDiscarded();
     VERBOSE(3,"discarded, too bad for stack" << std::endl);
     ChartHypothesis::Delete(hypo);
     return false;
@@ -223,7 +223,7 @@ void ChartHypothesisCollection::PruneToSize(ChartManager &manager)
       if (score < scoreThreshold) {
         HCType::iterator iterRemove = iter++;
         Remove(iterRemove);
-        manager.GetSentenceStats().AddPruning();
+        manager.AddPruning();
       } else {
         ++iter;
       }
@@ -285,6 +285,32 @@ void ChartHypothesisCollection::CleanupArcList()
   }
 }
 
+/** Add offset to the ids from firstId onwards, of main hypos and the hypos in their arc lists
+ * \param firstId hypos with a smaller id keep it
+ * \param offset added to the ids of all other hypos
+ */
+void ChartHypothesisCollection::OffsetIds(unsigned firstId, unsigned offset)
+{
+  HCType::iterator iter;
+  for (iter = m_hypos.begin() ; iter != m_hypos.end() ; ++iter) {
+    ChartHypothesis *mainHypo = *iter;
+    if (mainHypo->GetId() >= firstId) {
+      mainHypo->SetId(mainHypo->GetId() + offset);
+    }
+
+    const ChartArcList *arcList = mainHypo->GetArcList();
+    if (arcList) {
+      ChartArcList::const_iterator iterArc;
+      for (iterArc = arcList->begin(); iterArc != arcList->end(); ++iterArc) {
+        ChartHypothesis *arc = *iterArc;
+        if (arc->GetId() >= firstId) {
+          arc->SetId(arc->GetId() + offset);
+        }
+      }
+    }
+  }
+}
+
 /** Return all hypos, and all hypos in the arclist, in order to create the output searchgraph, ie. the hypergraph. The output is the debug hypo information.
  * @todo this is a useful function. Make sure it outputs everything required, especially scores.
  * \param translationId unique, contiguous id for the input sentence
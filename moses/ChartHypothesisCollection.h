@@ -23,6 +23,7 @@
 #include <set>
 #include "ChartHypothesis.h"
 #include "RuleCube.h"
+#include "SentenceArena.h"
 
 
 namespace Moses
@@ -90,6 +91,14 @@ public:
 
   ChartHypothesisCollection();
   ~ChartHypothesisCollection();
+
+  static void *operator new(std::size_t size) {
+    return SentenceArena::Allocate(size);
+  }
+  static void operator delete(void *ptr) {
+    SentenceArena::Free(ptr);
+  }
+
   bool AddHypothesis(ChartHypothesis *hypo, ChartManager &manager);
 
   void Detach(const HCType::iterator &iter);
@@ -106,6 +115,7 @@ public:
 
   void SortHypotheses();
   void CleanupArcList();
+  void OffsetIds(unsigned firstId, unsigned offset);
 
   //! return vector of hypothesis that has been sorted by score
   const HypoList &GetSortedHypotheses() const {
@@ -33,6 +33,12 @@
 #include "TreeInput.h"
 #include "moses/FF/WordPenaltyProducer.h"
 
+#ifdef WITH_THREADS
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include "ThreadPool.h"
+#endif
+
 using namespace std;
 using namespace Moses;
 
@@ -40,6 +46,78 @@ namespace Moses
 {
 extern bool g_mosesDebug;
 
+#ifdef WITH_THREADS
+namespace
+{
+
+//! counts down the cells of one width that are still being decoded
+class PendingCells
+{
+public:
+  explicit PendingCells(size_t count) : m_count(count) {}
+
+  //! a cell is done. error is empty unless decoding it threw
+  void Done(const std::string &error) {
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (m_error.empty()) {
+      m_error = error;
+    }
+    if (--m_count == 0) {
+      m_done.notify_all();
+    }
+  }
+
+  //! wait for all cells. rethrows the error of a cell, if any
+  void Wait() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_count) {
+      m_done.wait(lock);
+    }
+    UTIL_THROW_IF2(!m_error.empty(), m_error);
+  }
+
+private:
+  boost::mutex m_mutex;
+  boost::condition_variable m_done;
+  size_t m_count;
+  std::string m_error;
+};
+
+//! cube pruning for one cell, once its rules have been looked up
+class ChartCellTask : public Task
+{
+public:
+  ChartCellTask(ChartCell &cell, ChartTranslationOptionList &transOptList,
+                const ChartCellCollection &cells, PendingCells &pending)
+    : m_cell(cell)
+    , m_transOptList(transOptList)
+    , m_cells(cells)
+    , m_pending(pending) {}
+
+  virtual void Run() {
+    std::string error;
+    try {
+      m_cell.ProcessSentence(m_transOptList, m_cells);
+      m_transOptList.Clear();
+      m_cell.PruneToSize();
+      m_cell.CleanupArcList();
+      m_cell.SortHypotheses();
+    } catch (const std::exception &e) {
+      error = e.what();
+    }
+    m_pending.Done(error);
+  }
+
+private:
+  ChartCell &m_cell;
+  ChartTranslationOptionList &m_transOptList;
+  const ChartCellCollection &m_cells;
+  PendingCells &m_pending;
+};
+
+}
+#endif
+
 /* constructor. Initialize everything prior to decoding a particular sentence.
  * \param source the sentence to be decoded
  * \param system which particular set of models to use.
@@ -60,6 +138,7 @@ ChartManager::~ChartManager()
   float et = (end - m_start);
   et /= (float)CLOCKS_PER_SEC;
   VERBOSE(1, "Translation took " << et << " seconds" << endl);
+  VERBOSE(2, "Sentence arena used " << m_arena.GetBytesAllocated() << " bytes" << endl);
 
 }
 
@@ -76,6 +155,42 @@ void ChartManager::ProcessSentence()
   AddXmlChartOptions();
 
   // MAIN LOOP
+#ifdef WITH_THREADS
+  const size_t numThreads = StaticData::Instance().ChartThreadCount();
+  if (numThreads > 1) {
+    ProcessSpansInParallel(numThreads);
+  } else {
+    ProcessSpans();
+  }
+#else
+  ProcessSpans();
+#endif
+
+  IFVERBOSE(1) {
+    size_t size = m_source.GetSize();
+
+    for (size_t startPos = 0; startPos < size; ++startPos) {
+      cerr.width(3);
+      cerr << startPos << " ";
+    }
+    cerr << endl;
+    for (size_t width = 1; width <= size; width++) {
+      for( size_t space = 0; space < width-1; space++ ) {
+        cerr << "  ";
+      }
+      for (size_t startPos = 0; startPos <= size-width; ++startPos) {
+        WordsRange range(startPos, startPos+width-1);
+        cerr.width(3);
+        cerr << m_hypoStackColl.Get(range).GetSize() << " ";
+      }
+      cerr << endl;
+    }
+  }
+}
+
+//! decode the spans one at a time, from the last start position to the first, and by increasing width
+void ChartManager::ProcessSpans()
+{
   size_t size = m_source.GetSize();
   for (int startPos = size-1; startPos >= 0; --startPos) {
     for (size_t width = 1; width <= size-startPos; ++width) {
@@ -100,26 +215,93 @@ void ChartManager::ProcessSentence()
       cell.SortHypotheses();
     }
   }
+}
 
-  IFVERBOSE(1) {
+#ifdef WITH_THREADS
+/** decode the spans by increasing width, the cells of one width in parallel.
+ *  A cell only reads the cells of its subspans, so the cells of one width are
+ *  independent once the narrower ones are done, and each task only writes to
+ *  its own cell.  Rule lookup keeps per-sentence state, so the rules of all
+ *  cells of a width are looked up first, in this thread.  The output is the
+ *  same as that of ProcessSpans().
+ */
+void ChartManager::ProcessSpansInParallel(size_t numThreads)
+{
+  const StaticData &staticData = StaticData::Instance();
+  size_t size = m_source.GetSize();
 
-    for (size_t startPos = 0; startPos < size; ++startPos) {
-      cerr.width(3);
-      cerr << startPos << " ";
+  // hypotheses are numbered per cell meanwhile. RenumberHypotheses() fixes the ids
+  m_cellHypothesisIds.assign(size * size, m_hypothesisId);
+
+  boost::ptr_vector<ChartTranslationOptionList> transOptLists;
+  for (size_t startPos = 0; startPos < size; ++startPos) {
+    transOptLists.push_back(new ChartTranslationOptionList(staticData.GetRuleLimit(), m_source));
+  }
+  ThreadPool pool(numThreads);
+
+  for (size_t width = 1; width <= size; ++width) {
+    // create trans opt
+    for (size_t startPos = 0; startPos <= size-width; ++startPos) {
+      WordsRange range(startPos, startPos + width - 1);
+      ChartTranslationOptionList &transOptList = transOptLists[startPos];
+      m_parser.Create(range, transOptList);
+      transOptList.ApplyThreshold();
+
+      const InputPath &inputPath = m_parser.GetInputPath(range);
+      transOptList.Evaluate(m_source, inputPath);
     }
-    cerr << endl;
-    for (size_t width = 1; width <= size; width++) {
-      for( size_t space = 0; space < width-1; space++ ) {
-        cerr << "  ";
-      }
-      for (size_t startPos = 0; startPos <= size-width; ++startPos) {
-        WordsRange range(startPos, startPos+width-1);
-        cerr.width(3);
-        cerr << m_hypoStackColl.Get(range).GetSize() << " ";
-      }
-      cerr << endl;
+
+    // decode. cells with more rules first
+    PendingCells pending(size - width + 1);
+    for (size_t startPos = 0; startPos <= size-width; ++startPos) {
+      WordsRange range(startPos, startPos + width - 1);
+      ChartTranslationOptionList &transOptList = transOptLists[startPos];
+      pool.Submit(new ChartCellTask(m_hypoStackColl.Get(range), transOptList, m_hypoStackColl, pending),
+                  transOptList.GetSize());
     }
+    pending.Wait();
+  }
+
+  RenumberHypotheses();
+}
+#endif
+
+/** give the hypotheses numbered per cell by ProcessSpansInParallel() the ids
+ *  that ProcessSpans() would have given them, by adding to each cell's ids the
+ *  number of hypotheses created in the cells that ProcessSpans() decodes before
+ */
+void ChartManager::RenumberHypotheses()
+{
+  if (m_cellHypothesisIds.empty()) {
+    return;
   }
+
+  const unsigned firstId = m_hypothesisId;
+  size_t size = m_source.GetSize();
+  for (int startPos = size-1; startPos >= 0; --startPos) {
+    for (size_t endPos = startPos; endPos < size; ++endPos) {
+      WordsRange range(startPos, endPos);
+      m_hypoStackColl.Get(range).OffsetHypothesisIds(firstId, m_hypothesisId - firstId);
+      m_hypothesisId += m_cellHypothesisIds[startPos * size + endPos] - firstId;
+    }
+  }
+  m_cellHypothesisIds.clear();
+}
+
+void ChartManager::AddDiscarded()
+{
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_statsMutex);
+#endif
+  m_sentenceStats->AddDiscarded();
+}
+
+void ChartManager::AddPruning()
+{
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_statsMutex);
+#endif
+  m_sentenceStats->AddPruning();
 }
 
 /** add specific translation options and hypotheses according to the XML override translation scheme.
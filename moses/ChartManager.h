@@ -30,9 +30,14 @@
 #include "SentenceStats.h"
 #include "ChartTranslationOptionList.h"
 #include "ChartParser.h"
+#include "SentenceArena.h"
 
 #include <boost/shared_ptr.hpp>
 
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#endif
+
 namespace Moses
 {
 
@@ -54,16 +59,27 @@ private:
                                  const ChartTrellisNode &,
                                  ChartTrellisDetourQueue &);
 
+  SentenceArena m_arena; /**< memory for per-sentence objects. declared first so that it is released last */
   InputType const& m_source; /**< source sentence to be translated */
   ChartCellCollection m_hypoStackColl;
   std::auto_ptr<SentenceStats> m_sentenceStats;
   clock_t m_start; /**< starting time, used for logging */
   unsigned m_hypothesisId; /* For handing out hypothesis ids to ChartHypothesis */
+  std::vector<unsigned> m_cellHypothesisIds; /**< next hypothesis id of each cell, while cells are decoded in parallel */
+#ifdef WITH_THREADS
+  boost::mutex m_statsMutex; /**< guards m_sentenceStats while cells are decoded in parallel */
+#endif
 
   ChartParser m_parser;
 
   ChartTranslationOptionList m_translationOptionList; /**< pre-computed list of translation options for the phrases in this sentence */
 
+  void ProcessSpans();
+#ifdef WITH_THREADS
+  void ProcessSpansInParallel(size_t numThreads);
+#endif
+  void RenumberHypotheses();
+
 public:
   ChartManager(InputType const& source);
   ~ChartManager();
@@ -102,11 +118,29 @@ public:
   }
 
   //! contigious hypo id for each input sentence. For debugging purposes
-  unsigned GetNextHypoId() {
-    return m_hypothesisId++;
+  unsigned GetNextHypoId(const WordsRange &range) {
+    if (m_cellHypothesisIds.empty()) {
+      return m_hypothesisId++;
+    }
+    return m_cellHypothesisIds[range.GetStartPos() * m_source.GetSize() + range.GetEndPos()]++;
   }
 
+  //! count a discarded hypothesis in the sentence stats. safe while cells are decoded in parallel
+  void AddDiscarded();
+
+  //! count a pruned hypothesis in the sentence stats. safe while cells are decoded in parallel
+  void AddPruning();
+
   const ChartParser &GetParser() const { return m_parser; }
+
+  //! for incremental search, which makes hypotheses only to score stateful
+  //! features, and decodes with this chart and parser
+  ChartCellCollection &GetChartCellCollection() {
+    return m_hypoStackColl;
+  }
+  ChartParser &GetParser() {
+    return m_parser;
+  }
 };
 
 }
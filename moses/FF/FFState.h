@@ -3,6 +3,7 @@
 
 #include <vector>
 
+#include "moses/SentenceArena.h"
 
 namespace Moses
 {
@@ -12,6 +13,14 @@ class FFState
 public:
   virtual ~FFState();
   virtual int Compare(const FFState& other) const = 0;
+
+  // states are created per hypothesis. take them from the sentence's arena
+  static void *operator new(std::size_t size) {
+    return SentenceArena::Allocate(size);
+  }
+  static void operator delete(void *ptr) {
+    SentenceArena::Free(ptr);
+  }
 };
 
 class DummyState : public FFState
@@ -1,4 +1,5 @@
 #include "LexicalReorderingTable.h"
+#include "LexicalReorderingTableMapped.h"
 #include "moses/InputFileStream.h"
 //#include "LVoc.h" //need IPhrase
 
@@ -51,7 +52,10 @@ void auxAppend(IPhrase& head, const IPhrase& tail)
 
 LexicalReorderingTable* LexicalReorderingTable::LoadAvailable(const std::string& filePath, const FactorList& f_factors, const FactorList& e_factors, const FactorList& c_factors)
 {
-  //decide use Compact or Tree or Memory table
+  //decide use Mapped or Compact or Tree or Memory table
+  LexicalReorderingTable *mappedLexr = LexicalReorderingTableMapped::CheckAndLoad(filePath, f_factors, e_factors, c_factors);
+  if(mappedLexr)
+    return mappedLexr;
   LexicalReorderingTable *compactLexr = NULL;
 #ifdef HAVE_CMPH
   compactLexr = LexicalReorderingTableCompact::CheckAndLoad(filePath + ".minlexr", f_factors, e_factors, c_factors);
@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <cstring>
+
+#include "LexicalReorderingTableMapped.h"
+#include "moses/InputFileStream.h"
+#include "moses/StaticData.h"
+#include "moses/Util.h"
+#include "util/exception.hh"
+#include "util/file.hh"
+#include "util/murmur_hash.hh"
+#include "util/tokenize_piece.hh"
+
+namespace Moses
+{
+
+namespace
+{
+const char Magic[8] = "mlexr1";
+
+// scores sampled per column to make its codebook
+const size_t SampleSize = 1 << 20;
+
+const size_t CodebookSize = 256;
+
+inline uint64_t HashFactor(const StringPiece &factor, uint64_t seed)
+{
+  return util::MurmurHashNative(factor.data(), factor.size(), seed + 1);
+}
+
+// word and phrase boundaries, so that "a b" and "ab" differ
+inline uint64_t EndWord(uint64_t seed)
+{
+  return seed * 3 + 0x9e3779b97f4a7c15ULL;
+}
+
+inline uint64_t EndPhrase(uint64_t seed)
+{
+  return seed * 5 + 0x7f4a7c159e3779b9ULL;
+}
+
+// 0 marks an empty bucket
+inline uint64_t Finish(uint64_t hash)
+{
+  return hash ? hash : 1;
+}
+
+uint64_t HashPhrase(const Phrase &phrase, const FactorList &factors, uint64_t seed)
+{
+  for (size_t pos = 0; pos < phrase.GetSize(); ++pos) {
+    const Word &word = phrase.GetWord(pos);
+    for (size_t i = 0; i < factors.size(); ++i) {
+      seed = HashFactor(word[factors[i]]->GetString(), seed);
+    }
+    seed = EndWord(seed);
+  }
+  return EndPhrase(seed);
+}
+
+//! 256 values that cover the sample with equally many values each
+void MakeCodebook(std::vector<float> &sample, float *codebook)
+{
+  std::sort(sample.begin(), sample.end());
+  std::vector<float> distinct(sample);
+  distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+  if (distinct.empty()) {
+    distinct.push_back(0);
+  }
+
+  if (distinct.size() <= CodebookSize) {
+    // exact
+    std::copy(distinct.begin(), distinct.end(), codebook);
+    std::fill(codebook + distinct.size(), codebook + CodebookSize, distinct.back());
+    return;
+  }
+
+  for (size_t code = 0; code < CodebookSize; ++code) {
+    size_t begin = code * sample.size() / CodebookSize;
+    size_t end = (code + 1) * sample.size() / CodebookSize;
+    double sum = 0;
+    for (size_t i = begin; i < end; ++i) {
+      sum += sample[i];
+    }
+    codebook[code] = sum / (end - begin);
+  }
+}
+
+uint8_t Encode(const float *codebook, float score)
+{
+  const float *upper = std::lower_bound(codebook, codebook + CodebookSize, score);
+  if (upper == codebook) return 0;
+  if (upper == codebook + CodebookSize) return CodebookSize - 1;
+  return (score - upper[-1] < *upper - score) ? upper - codebook - 1 : upper - codebook;
+}
+
+//! phrases and scores of a line of a text table
+void ParseLine(const std::string &line, std::vector<std::string> &phrases, std::vector<float> &scores)
+{
+  phrases = TokenizeMultiCharSeparator(line, "|||");
+  UTIL_THROW_IF2(phrases.size() < 2, "Malformed line in reordering table: " << line);
+  scores = Scan<float>(Tokenize(phrases.back()));
+  phrases.pop_back();
+  for (size_t i = 0; i < phrases.size(); ++i) {
+    phrases[i] = Trim(phrases[i]);
+  }
+  std::transform(scores.begin(), scores.end(), scores.begin(), TransformScore);
+  std::transform(scores.begin(), scores.end(), scores.begin(), FloorScore);
+}
+
+}
+
+struct LexicalReorderingTableMapped::Header {
+  char magic[8];
+  uint32_t numScores;
+  uint32_t numPhrases; // 2 for tables conditioned on f and e, otherwise 1
+  uint64_t numRows;
+  uint64_t tableBytes;
+};
+
+const std::string LexicalReorderingTableMapped::Suffix = ".mlexr";
+
+LexicalReorderingTableMapped::LexicalReorderingTableMapped(
+  const std::string& filePath,
+  const std::vector<FactorType>& f_factors,
+  const std::vector<FactorType>& e_factors,
+  const std::vector<FactorType>& c_factors)
+  : LexicalReorderingTable(f_factors, e_factors, c_factors)
+{
+  UTIL_THROW_IF2(!c_factors.empty(), "Mapped reordering tables do not support contexts");
+
+  util::scoped_fd file(util::OpenReadOrThrow(filePath.c_str()));
+  uint64_t size = util::SizeOrThrow(file.get());
+  UTIL_THROW_IF2(size < sizeof(Header), filePath << " is too small for a reordering table");
+  util::MapRead(util::POPULATE_OR_READ, file.get(), 0, size, m_memory);
+
+  const Header &header = *reinterpret_cast<const Header*>(m_memory.begin());
+  UTIL_THROW_IF2(memcmp(header.magic, Magic, sizeof(Magic)), filePath << " is not a mapped reordering table");
+  size_t numPhrases = (f_factors.empty() ? 0 : 1) + (e_factors.empty() ? 0 : 1);
+  UTIL_THROW_IF2(header.numPhrases != numPhrases, "Reordering table " << filePath << " has "
+                 << header.numPhrases << " phrases per line, the model type expects " << numPhrases);
+
+  m_numScores = header.numScores;
+  const char *mem = m_memory.begin() + sizeof(Header);
+  m_codebook = reinterpret_cast<const float*>(mem);
+  mem += sizeof(float) * CodebookSize * m_numScores;
+  m_table = Table(const_cast<char*>(mem), header.tableBytes);
+  mem += header.tableBytes;
+  m_codes = reinterpret_cast<const uint8_t*>(mem);
+  UTIL_THROW_IF2(m_codes + header.numRows * m_numScores > reinterpret_cast<const uint8_t*>(m_memory.begin()) + size,
+                 filePath << " is truncated");
+}
+
+LexicalReorderingTable* LexicalReorderingTableMapped::CheckAndLoad(
+  const std::string& filePath,
+  const std::vector<FactorType>& f_factors,
+  const std::vector<FactorType>& e_factors,
+  const std::vector<FactorType>& c_factors)
+{
+  if (FileExists(filePath + Suffix)) {
+    VERBOSE(2,"Using mapped lexical reordering table" << std::endl);
+    return new LexicalReorderingTableMapped(filePath + Suffix, f_factors, e_factors, c_factors);
+  }
+  if (filePath.size() > Suffix.size()
+      && filePath.compare(filePath.size() - Suffix.size(), Suffix.size(), Suffix) == 0
+      && FileExists(filePath)) {
+    VERBOSE(2,"Using mapped lexical reordering table" << std::endl);
+    return new LexicalReorderingTableMapped(filePath, f_factors, e_factors, c_factors);
+  }
+  return NULL;
+}
+
+uint64_t LexicalReorderingTableMapped::Hash(const Phrase& f, const Phrase& e) const
+{
+  uint64_t hash = 0;
+  if (!m_FactorsF.empty()) {
+    hash = HashPhrase(f, m_FactorsF, hash);
+  }
+  if (!m_FactorsE.empty()) {
+    hash = HashPhrase(e, m_FactorsE, hash);
+  }
+  return Finish(hash);
+}
+
+uint64_t LexicalReorderingTableMapped::HashText(const std::vector<StringPiece> &phrases)
+{
+  uint64_t hash = 0;
+  for (size_t i = 0; i < phrases.size(); ++i) {
+    for (util::TokenIter<util::SingleCharacter, true> word(phrases[i], ' '); word; ++word) {
+      for (util::TokenIter<util::SingleCharacter> factor(*word, '|'); factor; ++factor) {
+        hash = HashFactor(*factor, hash);
+      }
+      hash = EndWord(hash);
+    }
+    hash = EndPhrase(hash);
+  }
+  return Finish(hash);
+}
+
+bool LexicalReorderingTableMapped::GetScore(const Phrase& f, const Phrase& e, float *scores) const
+{
+  Table::ConstIterator found;
+  if (!m_table.Find(Hash(f, e), found)) {
+    return false;
+  }
+  const uint8_t *codes = m_codes + static_cast<uint64_t>(found->row) * m_numScores;
+  for (size_t i = 0; i < m_numScores; ++i) {
+    scores[i] = m_codebook[i * CodebookSize + codes[i]];
+  }
+  return true;
+}
+
+Scores LexicalReorderingTableMapped::GetScore(const Phrase& f, const Phrase& e, const Phrase& /*c*/)
+{
+  if ((!m_FactorsF.empty() && 0 == f.GetSize())
+      || (!m_FactorsE.empty() && 0 == e.GetSize())) {
+    return Scores();
+  }
+  Scores ret(m_numScores);
+  if (!GetScore(f, e, &ret[0])) {
+    return Scores();
+  }
+  return ret;
+}
+
+void LexicalReorderingTableMapped::Create(const std::string& inPath, const std::string& outPath)
+{
+  std::string line;
+  std::vector<std::string> phrases;
+  std::vector<float> scores;
+
+  // pass 1: size, and a sample of each score for the codebooks
+  Header header;
+  memcpy(header.magic, Magic, sizeof(Magic));
+  header.numRows = 0;
+  std::vector<std::vector<float> > samples;
+  {
+    InputFileStream in(inPath);
+    while (getline(in, line)) {
+      ParseLine(line, phrases, scores);
+      if (header.numRows == 0) {
+        header.numPhrases = phrases.size();
+        header.numScores = scores.size();
+        samples.resize(scores.size());
+      }
+      UTIL_THROW_IF2(phrases.size() != header.numPhrases || scores.size() != header.numScores,
+                     "Line " << header.numRows + 1 << " of " << inPath << " differs in the number of phrases or scores from the first");
+
+      // reservoir sampling
+      for (size_t i = 0; i < scores.size(); ++i) {
+        if (header.numRows < SampleSize) {
+          samples[i].push_back(scores[i]);
+        } else {
+          uint64_t replace = util::MurmurHashNative(&header.numRows, sizeof(header.numRows), i) % (header.numRows + 1);
+          if (replace < SampleSize) samples[i][replace] = scores[i];
+        }
+      }
+      ++header.numRows;
+    }
+  }
+  UTIL_THROW_IF2(header.numRows == 0, inPath << " is empty");
+  UTIL_THROW_IF2(header.numRows > 0xffffffffULL, inPath << " has more rows than a mapped reordering table can hold");
+
+  std::vector<float> codebook(CodebookSize * header.numScores);
+  for (size_t i = 0; i < header.numScores; ++i) {
+    MakeCodebook(samples[i], &codebook[i * CodebookSize]);
+  }
+  samples.clear();
+
+  header.tableBytes = Table::Size(header.numRows, 1.5);
+  util::scoped_malloc tableMem(util::CallocOrThrow(header.tableBytes));
+  Table table(tableMem.get(), header.tableBytes);
+
+  util::scoped_fd out(util::CreateOrThrow(outPath.c_str()));
+  util::WriteOrThrow(out.get(), &header, sizeof(header));
+  util::WriteOrThrow(out.get(), &codebook[0], sizeof(float) * codebook.size());
+  uint64_t tableOffset = sizeof(header) + sizeof(float) * codebook.size();
+  util::SeekOrThrow(out.get(), tableOffset + header.tableBytes);
+
+  // pass 2: codes, and the hash table
+  InputFileStream in(inPath);
+  std::vector<uint8_t> codes(header.numScores);
+  std::vector<StringPiece> pieces;
+  size_t duplicates = 0;
+  for (uint32_t row = 0; getline(in, line); ++row) {
+    ParseLine(line, phrases, scores);
+
+    pieces.assign(phrases.begin(), phrases.end());
+    Entry entry;
+    entry.key = HashText(pieces);
+    entry.row = row;
+    Table::MutableIterator ignored;
+    if (table.FindOrInsert(entry, ignored)) {
+      ++duplicates;
+    }
+
+    for (size_t i = 0; i < header.numScores; ++i) {
+      codes[i] = Encode(&codebook[i * CodebookSize], scores[i]);
+    }
+    util::WriteOrThrow(out.get(), &codes[0], codes.size());
+  }
+  if (duplicates) {
+    std::cerr << "Warning: " << duplicates << " repeated phrase pairs (or hash collisions), kept the first" << std::endl;
+  }
+
+  util::SeekOrThrow(out.get(), tableOffset);
+  util::WriteOrThrow(out.get(), tableMem.get(), header.tableBytes);
+}
+
+}
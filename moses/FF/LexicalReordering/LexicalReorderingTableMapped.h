@@ -0,0 +1,90 @@
+#ifndef moses_LexicalReorderingTableMapped_h
+#define moses_LexicalReorderingTableMapped_h
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include "LexicalReorderingTable.h"
+#include "util/mmap.hh"
+#include "util/probing_hash_table.hh"
+#include "util/string_piece.hh"
+
+namespace Moses
+{
+
+/** Memory mapped reordering table, made by processLexicalTableMapped.
+ *
+ * A phrase pair is looked up by a 64 bit hash of its words in a probing
+ * hash table, which gives the row of its scores.  Scores are quantized to
+ * one byte each, against a codebook of 256 values per score, so decoding a
+ * row is one table lookup per score.  Nothing is cached per sentence.
+ * Contexts (c factors) are not supported.
+ */
+class LexicalReorderingTableMapped : public LexicalReorderingTable
+{
+public:
+  static const std::string Suffix;
+
+  LexicalReorderingTableMapped(const std::string& filePath,
+                               const std::vector<FactorType>& f_factors,
+                               const std::vector<FactorType>& e_factors,
+                               const std::vector<FactorType>& c_factors);
+
+  //! the table at filePath + Suffix, or at filePath if it ends in Suffix. NULL if there is none
+  static LexicalReorderingTable* CheckAndLoad(const std::string& filePath,
+      const std::vector<FactorType>& f_factors,
+      const std::vector<FactorType>& e_factors,
+      const std::vector<FactorType>& c_factors);
+
+  virtual Scores GetScore(const Phrase& f, const Phrase& e, const Phrase& c);
+
+  //! decode the scores of a phrase pair into scores. false if the pair is not in the table
+  bool GetScore(const Phrase& f, const Phrase& e, float *scores) const;
+
+  size_t GetNumScores() const {
+    return m_numScores;
+  }
+
+  /** Convert a text reordering table, read twice from inPath (which may be
+   * gzipped): once to collect the scores for the codebooks, once to fill
+   * the table.
+   */
+  static void Create(const std::string& inPath, const std::string& outPath);
+
+  //! hash of a phrase pair as written in a text table, factors separated by '|'
+  static uint64_t HashText(const std::vector<StringPiece> &phrases);
+
+private:
+  struct Header;
+
+#pragma pack(push)
+#pragma pack(4)
+  struct Entry {
+    typedef uint64_t Key;
+    uint64_t key;
+    uint32_t row;
+
+    uint64_t GetKey() const {
+      return key;
+    }
+    void SetKey(uint64_t to) {
+      key = to;
+    }
+  };
+#pragma pack(pop)
+  typedef util::ProbingHashTable<Entry, util::IdentityHash> Table;
+
+  util::scoped_memory m_memory;
+  size_t m_numScores;
+  const float *m_codebook; // 256 values for each score
+  Table m_table;
+  const uint8_t *m_codes;  // m_numScores codes per row
+
+  uint64_t Hash(const Phrase& f, const Phrase& e) const;
+};
+
+}
+
+#endif
@@ -34,6 +34,17 @@ public:
     const FFState* prev_state,
     ScoreComponentCollection* accumulator) const = 0;
 
+  /**
+   * Hint that Evaluate(cur_hypo, prev_state, ...) will be called soon.
+   * Features backed by large tables (eg. the language model) can start
+   * loading the memory it will touch, so the search can overlap the cache
+   * misses of several hypotheses.  Default: nothing.
+   */
+  virtual void Prefetch(
+    const Hypothesis& /* cur_hypo */,
+    const FFState* /* prev_state */) const {
+  }
+
   virtual FFState* EvaluateChart(
     const ChartHypothesis& /* cur_hypo */,
     int /* featureID - used to index the state in the previous hypotheses */,
@@ -37,33 +37,63 @@ FactorCollection FactorCollection::s_instance;
 
 const Factor *FactorCollection::AddFactor(const StringPiece &factorString, bool isNonTerminal)
 {
+  const std::size_t hash = util::MurmurHashNative(factorString.data(), factorString.size());
+#ifdef WITH_THREADS
+  ThreadCache *cache = m_threadCache.get();
+  if (cache == NULL) {
+    cache = new ThreadCache();
+    m_threadCache.reset(cache);
+  }
+  ThreadCache::Entry &entry = cache->m_entries[isNonTerminal][hash & (ThreadCache::SIZE - 1)];
+  if (entry.factor && entry.hash == hash && entry.factor->GetString() == factorString) {
+    return entry.factor;
+  }
+  const Factor *factor = AddFactorToShard(factorString, hash, isNonTerminal);
+  entry.hash = hash;
+  entry.factor = factor;
+  return factor;
+#else
+  return AddFactorToShard(factorString, hash, isNonTerminal);
+#endif
+}
+
+const Factor *FactorCollection::AddFactorToShard(const StringPiece &factorString, std::size_t hash, bool isNonTerminal)
+{
+  Shard &shard = m_shards[(hash >> 24) & (NUM_SHARDS - 1)];
+  Set &set = (isNonTerminal) ? shard.m_setNonTerminal : shard.m_setTerminal;
+
   FactorFriend to_ins;
   to_ins.in.m_string = factorString;
-  to_ins.in.m_id = (isNonTerminal) ? m_factorIdNonTerminal : m_factorId;
-  Set & set = (isNonTerminal) ? m_set : m_setNonTerminal;
   // If we're threaded, hope a read-only lock is sufficient.
 #ifdef WITH_THREADS
   {
     // read=lock scope
-    boost::shared_lock<boost::shared_mutex> read_lock(m_accessLock);
+    boost::shared_lock<boost::shared_mutex> read_lock(shard.m_accessLock);
     Set::const_iterator i = set.find(to_ins);
     if (i != set.end()) return &i->in;
   }
-  boost::unique_lock<boost::shared_mutex> lock(m_accessLock);
+  boost::unique_lock<boost::shared_mutex> lock(shard.m_accessLock);
 #endif // WITH_THREADS
-  std::pair<Set::iterator, bool> ret(set.insert(to_ins));
-  if (ret.second) {
-    ret.first->in.m_string.set(
-      memcpy(m_string_backing.Allocate(factorString.size()), factorString.data(), factorString.size()),
-      factorString.size());
+  {
+    // threaded: another thread may have inserted it between the two locks
+    Set::const_iterator i = set.find(to_ins);
+    if (i != set.end()) return &i->in;
+  }
+  {
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock idLock(m_idLock);
+#endif
     if (isNonTerminal) {
-      m_factorIdNonTerminal++;
+      to_ins.in.m_id = m_factorIdNonTerminal++;
       UTIL_THROW_IF2(m_factorIdNonTerminal >= moses_MaxNumNonterminals, "Number of non-terminals exceeds maximum size reserved. Adjust parameter moses_MaxNumNonterminals, then recompile");
-    }
-    else {
-      m_factorId++;
+    } else {
+      to_ins.in.m_id = m_factorId++;
     }
   }
+  to_ins.in.m_string.set(
+    memcpy(shard.m_string_backing.Allocate(factorString.size()), factorString.data(), factorString.size()),
+    factorString.size());
+  std::pair<Set::iterator, bool> ret(set.insert(to_ins));
   return &ret.first->in;
 }
 
@@ -74,11 +104,14 @@ TO_STRING_BODY(FactorCollection);
 // friend
 ostream& operator<<(ostream& out, const FactorCollection& factorCollection)
 {
+  for (size_t shard = 0; shard < FactorCollection::NUM_SHARDS; ++shard) {
+    const FactorCollection::Shard &s = factorCollection.m_shards[shard];
 #ifdef WITH_THREADS
-  boost::shared_lock<boost::shared_mutex> lock(factorCollection.m_accessLock);
+    boost::shared_lock<boost::shared_mutex> lock(s.m_accessLock);
 #endif
-  for (FactorCollection::Set::const_iterator i = factorCollection.m_set.begin(); i != factorCollection.m_set.end(); ++i) {
-    out << i->in;
+    for (FactorCollection::Set::const_iterator i = s.m_setTerminal.begin(); i != s.m_setTerminal.end(); ++i) {
+      out << i->in;
+    }
   }
   return out;
 }
@@ -28,12 +28,15 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #endif
 
 #ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/tss.hpp>
 #endif
 
 #include "util/murmur_hash.hh"
 #include <boost/unordered_set.hpp>
 
+#include <cstring>
 #include <functional>
 #include <string>
 
@@ -62,6 +65,12 @@ struct FactorFriend {
  * from being created on the stack, etc), their memory addresses can
  * be used as keys to uniquely identify them.
  * Only 1 FactorCollection object should be created.
+ *
+ * The collection is split into shards selected by the string hash, each with
+ * its own reader-writer lock and string pool, so that threads interning
+ * different words rarely contend.  In front of the shards every thread keeps
+ * a small direct-mapped cache of factors it has already seen; a hit there
+ * doesn't touch any shared lock.
  */
 class FactorCollection
 {
@@ -78,17 +87,46 @@ class FactorCollection
     }
   };
   typedef boost::unordered_set<FactorFriend, HashFactor, EqualsFactor> Set;
-  Set m_set;
-  Set m_setNonTerminal;
 
-  util::Pool m_string_backing;
+  //! one independently locked slice of the collection
+  struct Shard {
+    Set m_setTerminal;
+    Set m_setNonTerminal;
+    util::Pool m_string_backing;
+#ifdef WITH_THREADS
+    //reader-writer lock
+    mutable boost::shared_mutex m_accessLock;
+#endif
+  };
+
+  //! number of shards. must be a power of 2
+  static const size_t NUM_SHARDS = 64;
+  Shard m_shards[NUM_SHARDS];
 
-  static FactorCollection s_instance;
 #ifdef WITH_THREADS
-  //reader-writer lock
-  mutable boost::shared_mutex m_accessLock;
+  /** per-thread direct-mapped cache of recently interned factors.
+   * Factors are never deleted, so cached pointers stay valid.
+   */
+  struct ThreadCache {
+    static const size_t SIZE = 4096; // must be a power of 2
+    struct Entry {
+      std::size_t hash;
+      const Factor *factor;
+    };
+    Entry m_entries[2][SIZE]; // [isNonTerminal][slot]
+
+    ThreadCache() {
+      std::memset(m_entries, 0, sizeof(m_entries));
+    }
+  };
+  boost::thread_specific_ptr<ThreadCache> m_threadCache;
+
+  //! guards id assignment. only taken when a new factor is inserted
+  boost::mutex m_idLock;
 #endif
 
+  static FactorCollection s_instance;
+
   size_t m_factorIdNonTerminal; /**< unique, contiguous ids, starting from 0, for each non-terminal factor */
   size_t m_factorId; /**< unique, contiguous ids, starting from moses_MaxNumNonterminals, for each terminal factor */
 
@@ -98,6 +136,9 @@ class FactorCollection
     , m_factorId(moses_MaxNumNonterminals) {
   }
 
+  //! look up or insert factorString in the shard owning hash
+  const Factor *AddFactorToShard(const StringPiece &factorString, std::size_t hash, bool isNonTerminal);
+
 public:
   static FactorCollection& Instance() {
     return s_instance;
@@ -0,0 +1,106 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#ifdef WITH_THREADS
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#endif
+
+#include "FactorCollection.h"
+
+using namespace Moses;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(factor_collection)
+
+BOOST_AUTO_TEST_CASE(same_string_same_factor)
+{
+  FactorCollection &fc = FactorCollection::Instance();
+  string word("fc_test_house");
+  const Factor *f1 = fc.AddFactor(word);
+  const Factor *f2 = fc.AddFactor(StringPiece(word));
+  const Factor *f3 = fc.AddFactor(string("fc_test_") + "house");
+  BOOST_CHECK_EQUAL(f1, f2);
+  BOOST_CHECK_EQUAL(f1, f3);
+  BOOST_CHECK_EQUAL(f1->GetString(), StringPiece(word));
+  BOOST_CHECK(f1 != fc.AddFactor("fc_test_houses"));
+}
+
+BOOST_AUTO_TEST_CASE(terminal_and_non_terminal_distinct)
+{
+  FactorCollection &fc = FactorCollection::Instance();
+  const Factor *t = fc.AddFactor("fc_test_NP");
+  const Factor *nt = fc.AddFactor("fc_test_NP", true);
+  BOOST_CHECK(t != nt);
+  BOOST_CHECK_EQUAL(nt, fc.AddFactor("fc_test_NP", true));
+  BOOST_CHECK(nt->GetId() < moses_MaxNumNonterminals);
+  BOOST_CHECK(t->GetId() >= moses_MaxNumNonterminals);
+}
+
+#ifdef WITH_THREADS
+
+namespace
+{
+
+void AddAll(const vector<string> *words, vector<const Factor*> *out)
+{
+  FactorCollection &fc = FactorCollection::Instance();
+  for (size_t i = 0; i < words->size(); ++i) {
+    out->push_back(fc.AddFactor((*words)[i]));
+  }
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_add)
+{
+  vector<string> words;
+  for (size_t i = 0; i < 5000; ++i) {
+    words.push_back("fc_test_concurrent_" + SPrint(i));
+  }
+  const size_t threads = 8;
+  vector<vector<const Factor*> > results(threads);
+  boost::thread_group group;
+  for (size_t t = 0; t < threads; ++t) {
+    group.create_thread(boost::bind(&AddAll, &words, &results[t]));
+  }
+  group.join_all();
+
+  set<size_t> ids;
+  for (size_t i = 0; i < words.size(); ++i) {
+    for (size_t t = 1; t < threads; ++t) {
+      BOOST_REQUIRE_EQUAL(results[0][i], results[t][i]);
+    }
+    BOOST_CHECK_EQUAL(results[0][i]->GetString(), StringPiece(words[i]));
+    ids.insert(results[0][i]->GetId());
+  }
+  // every distinct word got its own id
+  BOOST_CHECK_EQUAL(ids.size(), words.size());
+}
+
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
+
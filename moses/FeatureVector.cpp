@@ -152,17 +152,6 @@ const std::string& FName::name() const
   return id2name[m_id];
 }
 
-
-bool FName::operator==(const FName& rhs) const
-{
-  return m_id == rhs.m_id;
-}
-
-bool FName::operator!=(const FName& rhs) const
-{
-  return ! (*this == rhs);
-}
-
 FVector::FVector(size_t coreFeatures) : m_coreFeatures(coreFeatures) {}
 
 void FVector::resize(size_t newsize)
@@ -372,9 +361,14 @@ FVector& FVector::operator+= (const FVector& rhs)
   if (rhs.m_coreFeatures.size() > m_coreFeatures.size())
     resize(rhs.m_coreFeatures.size());
   for (const_iterator i = rhs.cbegin(); i != rhs.cend(); ++i)
-    set(i->first, get(i->first) + i->second);
-  for (size_t i = 0; i < rhs.m_coreFeatures.size(); ++i)
-    m_coreFeatures[i] += rhs.m_coreFeatures[i];
+    m_features[i->first] += i->second;
+  const size_t size = rhs.m_coreFeatures.size();
+  if (size) {
+    FValue *lhsCore = &m_coreFeatures[0];
+    const FValue *rhsCore = &rhs.m_coreFeatures[0];
+    for (size_t i = 0; i < size; ++i)
+      lhsCore[i] += rhsCore[i];
+  }
   return *this;
 }
 
@@ -801,10 +795,24 @@ FValue FVector::inner_product(const FVector& rhs) const
   for (const_iterator i = cbegin(); i != cend(); ++i) {
     product += ((i->second)*(rhs.get(i->first)));
   }
-  for (size_t i = 0; i < m_coreFeatures.size(); ++i) {
-    product += m_coreFeatures[i]*rhs.m_coreFeatures[i];
+
+  // core features: independent partial sums, so the loop vectorises
+  const size_t size = m_coreFeatures.size();
+  if (size == 0) return product;
+  const FValue *lhsCore = &m_coreFeatures[0];
+  const FValue *rhsCore = &rhs.m_coreFeatures[0];
+  FValue partial[4] = {0, 0, 0, 0};
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    partial[0] += lhsCore[i] * rhsCore[i];
+    partial[1] += lhsCore[i + 1] * rhsCore[i + 1];
+    partial[2] += lhsCore[i + 2] * rhsCore[i + 2];
+    partial[3] += lhsCore[i + 3] * rhsCore[i + 3];
+  }
+  for (; i < size; ++i) {
+    partial[0] += lhsCore[i] * rhsCore[i];
   }
-  return product;
+  return product + (partial[0] + partial[1]) + (partial[2] + partial[3]);
 }
 
 void FVector::merge(const FVector &other)
@@ -22,6 +22,7 @@
 #ifndef FEATUREVECTOR_H
 #define FEATUREVECTOR_H
 
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <sstream>
@@ -85,8 +86,16 @@ struct FName {
 
   size_t hash() const;
 
-  bool operator==(const FName& rhs) const ;
-  bool operator!=(const FName& rhs) const ;
+  bool operator==(const FName& rhs) const {
+    return m_id == rhs.m_id;
+  }
+  bool operator!=(const FName& rhs) const {
+    return m_id != rhs.m_id;
+  }
+  //! orders by id, ie. by when the name was first seen
+  bool operator<(const FName& rhs) const {
+    return m_id < rhs.m_id;
+  }
 
   static size_t getId(const std::string& name);
   static size_t getHopeIdCount(const std::string& name);
@@ -121,6 +130,94 @@ struct FNameHash
 
 class ProxyFVector;
 
+/**
+ * Sparse feature values, kept in a vector sorted by feature id.
+ * Most score vectors carry no sparse features at all, or a handful, so
+ * this is cheaper to copy, add and multiply than a hash map, and an empty
+ * one does not allocate.
+ **/
+class FNameValueMap
+{
+public:
+  typedef std::pair<FName, FValue> value_type;
+  typedef std::vector<value_type>::iterator iterator;
+  typedef std::vector<value_type>::const_iterator const_iterator;
+
+  iterator begin() {
+    return m_data.begin();
+  }
+  iterator end() {
+    return m_data.end();
+  }
+  const_iterator begin() const {
+    return m_data.begin();
+  }
+  const_iterator end() const {
+    return m_data.end();
+  }
+  const_iterator cbegin() const {
+    return m_data.begin();
+  }
+  const_iterator cend() const {
+    return m_data.end();
+  }
+
+  size_t size() const {
+    return m_data.size();
+  }
+  bool empty() const {
+    return m_data.empty();
+  }
+  void clear() {
+    m_data.clear();
+  }
+  void swap(FNameValueMap &other) {
+    m_data.swap(other.m_data);
+  }
+
+  iterator find(const FName &name) {
+    iterator i = std::lower_bound(m_data.begin(), m_data.end(), name, KeyLess());
+    return (i != m_data.end() && i->first == name) ? i : m_data.end();
+  }
+  const_iterator find(const FName &name) const {
+    const_iterator i = std::lower_bound(m_data.begin(), m_data.end(), name, KeyLess());
+    return (i != m_data.end() && i->first == name) ? i : m_data.end();
+  }
+
+  //! value for name, inserted as 0 if missing
+  FValue &operator[](const FName &name) {
+    // features are usually added in id order
+    if (m_data.empty() || m_data.back().first < name) {
+      m_data.push_back(value_type(name, 0));
+      return m_data.back().second;
+    }
+    iterator i = std::lower_bound(m_data.begin(), m_data.end(), name, KeyLess());
+    if (i == m_data.end() || i->first != name) {
+      i = m_data.insert(i, value_type(name, 0));
+    }
+    return i->second;
+  }
+
+  void erase(const FName &name) {
+    iterator i = find(name);
+    if (i != m_data.end()) m_data.erase(i);
+  }
+
+private:
+  struct KeyLess {
+    bool operator()(const value_type &entry, const FName &name) const {
+      return entry.first < name;
+    }
+  };
+
+  std::vector<value_type> m_data;
+};
+
+inline void swap(FNameValueMap &first, FNameValueMap &second)
+{
+  first.swap(second);
+}
+
 /**
  * A sparse feature (or weight) vector.
  **/
@@ -141,7 +238,7 @@ public:
   **/
   void resize(size_t newsize);
 
-  typedef boost::unordered_map<FName,FValue,FNameHash, FNameEquals> FNVmap;
+  typedef FNameValueMap FNVmap;
   /** Iterators */
   typedef FNVmap::iterator iterator;
   typedef FNVmap::const_iterator const_iterator;
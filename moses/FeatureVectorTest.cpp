@@ -306,6 +306,42 @@ BOOST_AUTO_TEST_CASE(ip)
   BOOST_CHECK_CLOSE((FValue)p1, 1.1*0.5 + -0.1*0.25 + 2.2*2.4, TOL);
 }
 
+BOOST_AUTO_TEST_CASE(ip_core_unrolled)
+{
+  FVector f1(7);
+  FVector f2(7);
+  FValue expected = 0;
+  for (size_t i = 0; i < 7; ++i) {
+    f1[i] = i + 1;
+    f2[i] = 0.5 * i;
+    expected += (i + 1) * 0.5 * i;
+  }
+  BOOST_CHECK_CLOSE(inner_product(f1,f2), expected, TOL);
+}
+
+BOOST_AUTO_TEST_CASE(sparse_out_of_order)
+{
+  FName n1("p");
+  FName n2("q");
+  FName n3("r");
+  FVector f1;
+  f1[n3] = 3;
+  f1[n1] = 1;
+  f1[n2] = 2;
+  f1[n1] += 1;
+  BOOST_CHECK_EQUAL(f1.size(), 3);
+  BOOST_CHECK_CLOSE((FValue)f1[n1], 2, TOL);
+  BOOST_CHECK_CLOSE((FValue)f1[n2], 2, TOL);
+  BOOST_CHECK_CLOSE((FValue)f1[n3], 3, TOL);
+
+  FVector f2;
+  f2[n2] = 2;
+  f1 -= f2;
+  f1.pruneZeroWeightFeatures();
+  BOOST_CHECK_EQUAL(f1.size(), 2);
+  BOOST_CHECK(!f1.hasNonDefaultValue(n2));
+}
+
 
 BOOST_AUTO_TEST_SUITE_END()
 
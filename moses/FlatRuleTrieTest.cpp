@@ -0,0 +1,127 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#include "FactorCollection.h"
+#include "TargetPhrase.h"
+#include "TranslationModel/FlatRuleTrie.h"
+
+using namespace Moses;
+using namespace std;
+
+namespace
+{
+
+Word MakeWord(const string &str, bool isNonTerminal = false)
+{
+  Word word(isNonTerminal);
+  word.SetFactor(0, FactorCollection::Instance().AddFactor(str, isNonTerminal));
+  return word;
+}
+
+void AddRule(PhraseDictionaryNodeMemory &node)
+{
+  node.GetTargetPhraseCollection().Add(new TargetPhrase());
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(flat_rule_trie)
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+  FlatRuleTrie trie;
+  BOOST_CHECK(trie.GetRootNode().IsLeaf());
+  BOOST_CHECK(trie.GetRootNode().GetChild(MakeWord("a")) == NULL);
+  BOOST_CHECK(trie.GetRootNode().GetTargetPhraseCollection().IsEmpty());
+}
+
+BOOST_AUTO_TEST_CASE(terminals)
+{
+  PhraseDictionaryNodeMemory root;
+  const char *words[] = {"the", "house", "is", "small", "a", "big", "garden"};
+  for (size_t i = 0; i < 7; ++i) {
+    PhraseDictionaryNodeMemory *child = root.GetOrCreateChild(MakeWord(words[i]));
+    AddRule(*child);
+    if (i % 2 == 0) {
+      AddRule(*child->GetOrCreateChild(MakeWord("house")));
+    }
+  }
+
+  FlatRuleTrie trie;
+  trie.Build(root);
+  BOOST_CHECK(root.IsLeaf());
+  BOOST_CHECK_EQUAL(trie.GetNumNodes(), 12);
+
+  const FlatRuleTrie::Node &flatRoot = trie.GetRootNode();
+  BOOST_CHECK_EQUAL(flatRoot.GetNumTerminals(), 7);
+  for (size_t i = 0; i < 7; ++i) {
+    const FlatRuleTrie::Node *child = flatRoot.GetChild(MakeWord(words[i]));
+    BOOST_REQUIRE(child != NULL);
+    BOOST_CHECK_EQUAL(child->GetTargetPhraseCollection().GetSize(), 1);
+    const FlatRuleTrie::Node *grandChild = child->GetChild(MakeWord("house"));
+    BOOST_CHECK_EQUAL(grandChild != NULL, i % 2 == 0);
+    if (grandChild) {
+      BOOST_CHECK(grandChild->IsLeaf());
+      BOOST_CHECK_EQUAL(grandChild->GetTargetPhraseCollection().GetSize(), 1);
+    }
+  }
+  BOOST_CHECK(flatRoot.GetChild(MakeWord("garage")) == NULL);
+  BOOST_CHECK(flatRoot.GetTargetPhraseCollection().IsEmpty());
+}
+
+#if !defined(UNLABELLED_SOURCE)
+BOOST_AUTO_TEST_CASE(non_terminals_keep_map_order)
+{
+  PhraseDictionaryNodeMemory root;
+  const char *labels[] = {"NP", "VP", "PP", "S", "ADJP"};
+  for (size_t i = 0; i < 5; ++i) {
+    Word label = MakeWord(labels[i], true);
+    AddRule(*root.GetOrCreateChild(MakeWord("X", true), label)->GetOrCreateChild(MakeWord("a")));
+  }
+  vector<PhraseDictionaryNodeMemory::NonTerminalMapKey> order;
+  const PhraseDictionaryNodeMemory::NonTerminalMap &nonTerms = root.GetNonTerminalMap();
+  for (PhraseDictionaryNodeMemory::NonTerminalMap::const_iterator p = nonTerms.begin(); p != nonTerms.end(); ++p) {
+    order.push_back(p->first);
+  }
+
+  FlatRuleTrie trie;
+  trie.Build(root);
+  const FlatRuleTrie::Node &flatRoot = trie.GetRootNode();
+  BOOST_REQUIRE_EQUAL(flatRoot.GetNumNonTerminals(), 5);
+  for (size_t i = 0; i < 5; ++i) {
+    BOOST_CHECK(flatRoot.GetNonTerminal(i) == order[i]);
+    const FlatRuleTrie::Node *child = flatRoot.GetChild(order[i].first, order[i].second);
+    BOOST_CHECK_EQUAL(child, &flatRoot.GetNonTerminalChild(i));
+    const FlatRuleTrie::Node *rule = child->GetChild(MakeWord("a"));
+    BOOST_REQUIRE(rule != NULL);
+    BOOST_CHECK_EQUAL(rule->GetTargetPhraseCollection().GetSize(), 1);
+  }
+  BOOST_CHECK(flatRoot.GetChild(MakeWord("X", true), MakeWord("NN", true)) == NULL);
+
+  trie.Clear();
+  BOOST_CHECK(trie.GetRootNode().IsLeaf());
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -276,6 +276,19 @@ void Hypothesis::Evaluate(const SquareMatrix &futureScore)
   }
 }
 
+void Hypothesis::Prefetch() const
+{
+  const StaticData &staticData = StaticData::Instance();
+  const vector<const StatefulFeatureFunction*>& ffs =
+    StatefulFeatureFunction::GetStatefulFeatureFunctions();
+  for (unsigned i = 0; i < ffs.size(); ++i) {
+    const StatefulFeatureFunction &ff = *ffs[i];
+    if (! staticData.IsFeatureFunctionIgnored(ff)) {
+      ff.Prefetch(*this, m_prevHypo ? m_prevHypo->m_ffStates[i] : NULL);
+    }
+  }
+}
+
 const Hypothesis* Hypothesis::GetPrevHypo()const
 {
   return m_prevHypo;
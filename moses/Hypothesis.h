@@ -35,6 +35,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ScoreComponentCollection.h"
 #include "InputType.h"
 #include "ObjectPool.h"
+#include "SentenceArena.h"
 
 namespace Moses
 {
@@ -96,6 +97,15 @@ public:
     return s_objectPool;
   }
 
+#ifndef USE_HYPO_POOL
+  static void *operator new(std::size_t size) {
+    return SentenceArena::Allocate(size);
+  }
+  static void operator delete(void *ptr) {
+    SentenceArena::Free(ptr);
+  }
+#endif
+
   ~Hypothesis();
 
   /** return the subclass of Hypothesis most appropriate to the given translation option */
@@ -139,6 +149,10 @@ public:
 
   void Evaluate(const SquareMatrix &futureScore);
 
+  /** let the stateful feature functions start loading what Evaluate() will
+   * look up, eg. language model hash buckets */
+  void Prefetch() const;
+
   int GetId()const {
     return m_id;
   }
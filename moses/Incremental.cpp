@@ -3,6 +3,8 @@
 #include "moses/Incremental.h"
 
 #include "moses/ChartCell.h"
+#include "moses/ChartHypothesis.h"
+#include "moses/ChartManager.h"
 #include "moses/ChartParserCallback.h"
 #include "moses/FeatureVector.h"
 #include "moses/StaticData.h"
@@ -19,6 +21,8 @@
 
 #include <boost/lexical_cast.hpp>
 
+#include <map>
+
 namespace Moses
 {
 namespace Incremental
@@ -26,6 +30,77 @@ namespace Incremental
 namespace
 {
 
+// Scores complete edges with the stateful features other than the language
+// model the search scores, by making a ChartHypothesis for each.  Its states
+// are what the edge recombines on.
+class OtherFeatures
+{
+public:
+  OtherFeatures(ChartManager &manager, std::deque<AppliedRule> &rules, std::vector<ChartHypothesis*> &hypos, std::deque<ScoreComponentCollection> &scores)
+    : manager_(manager), rules_(rules), hypos_(hypos), scores_(scores), searched_(LanguageModel::GetFirstLM()) {}
+
+  // Adjusts the score of complete and gives it a note with the changes.
+  search::OtherState Score(search::PartialEdge complete);
+
+  static int Compare(search::OtherState first, search::OtherState second) {
+    return static_cast<const ChartHypothesis*>(first)->RecombineCompare(*static_cast<const ChartHypothesis*>(second));
+  }
+
+private:
+  // The weighted future score estimates of the other language models, which
+  // are part of the phrase's future score until they are scored for real.
+  float Estimates(const TargetPhrase &phrase) const;
+
+  ChartManager &manager_;
+  std::deque<AppliedRule> &rules_;
+  std::vector<ChartHypothesis*> &hypos_;
+  std::deque<ScoreComponentCollection> &scores_;
+  const LanguageModel &searched_;
+};
+
+search::OtherState OtherFeatures::Score(search::PartialEdge complete)
+{
+  const AppliedRule &rule = *static_cast<const AppliedRule*>(complete.GetNote().vp);
+  const TargetPhrase &phrase = rule.phrase;
+  // Edges have their non-terminals in target order, hypotheses in source order.
+  const AlignmentInfo::NonTermIndexMap &align = phrase.GetAlignNonTerm().GetNonTermIndexMap();
+  std::vector<const ChartHypothesis*> prev(complete.GetArity());
+  const search::PartialVertex *nt = complete.NT();
+  for (size_t i = 0; i < phrase.GetSize(); ++i) {
+    if (phrase.GetWord(i).IsNonTerminal()) {
+      prev[align[i]] = static_cast<const ChartHypothesis*>((nt++)->Other());
+    }
+  }
+
+  hypos_.push_back(new ChartHypothesis(phrase, rule.range, prev, manager_));
+  scores_.push_back(ScoreComponentCollection());
+  hypos_.back()->EvaluateStatefulExcept(searched_, scores_.back());
+  complete.SetScore(complete.GetScore() + scores_.back().GetWeightedScore() - Estimates(phrase));
+
+  rules_.push_back(AppliedRule(phrase, rule.range, &scores_.back()));
+  search::Note note;
+  note.vp = &rules_.back();
+  complete.SetNote(note);
+  return hypos_.back();
+}
+
+float OtherFeatures::Estimates(const TargetPhrase &phrase) const
+{
+  const StaticData &data = StaticData::Instance();
+  const std::vector<const StatefulFeatureFunction*> &ffs = StatefulFeatureFunction::GetStatefulFeatureFunctions();
+  float ret = 0.0;
+  for (size_t i = 0; i < ffs.size(); ++i) {
+    const LanguageModel *lm = dynamic_cast<const LanguageModel*>(ffs[i]);
+    if (!lm || lm == &searched_ || data.IsFeatureFunctionIgnored(*lm)) continue;
+    float full, ngram;
+    size_t oov;
+    // As in LanguageModel::Evaluate.
+    lm->CalcScore(phrase, full, ngram, oov);
+    ret += (full - ngram) * lm->GetWeight();
+  }
+  return ret;
+}
+
 // This is called by EdgeGenerator.  Route hypotheses to separate vertices for
 // each left hand side label, populating ChartCellLabelSet out.
 template <class Best> class HypothesisCallback
@@ -33,19 +108,19 @@ template <class Best> class HypothesisCallback
 private:
   typedef search::VertexGenerator<Best> Gen;
 public:
-  HypothesisCallback(search::ContextBase &context, Best &best, ChartCellLabelSet &out, boost::object_pool<search::Vertex> &vertex_pool)
-    : context_(context), best_(best), out_(out), vertex_pool_(vertex_pool) {}
+  HypothesisCallback(search::ContextBase &context, Best &best, ChartCellLabelSet &out, boost::object_pool<search::Vertex> &vertex_pool, OtherFeatures *others)
+    : context_(context), best_(best), out_(out), vertex_pool_(vertex_pool), others_(others) {}
 
   void NewHypothesis(search::PartialEdge partial) {
     // Get the LHS, look it up in the output ChartCellLabel, and upcast it.
     // It's not part of the union because it would have been ugly to expose template types in ChartCellLabel.
-    ChartCellLabel::Stack &stack = out_.FindOrInsert(static_cast<const TargetPhrase *>(partial.GetNote().vp)->GetTargetLHS());
+    ChartCellLabel::Stack &stack = out_.FindOrInsert(static_cast<const AppliedRule *>(partial.GetNote().vp)->phrase.GetTargetLHS());
     Gen *entry = static_cast<Gen*>(stack.incr_generator);
     if (!entry) {
       entry = generator_pool_.construct(context_, *vertex_pool_.construct(), best_);
       stack.incr_generator = entry;
     }
-    entry->NewHypothesis(partial);
+    entry->NewHypothesis(partial, others_ ? others_->Score(partial) : NULL);
   }
 
   void FinishedSearch() {
@@ -69,6 +144,30 @@ private:
 
   boost::object_pool<search::Vertex> &vertex_pool_;
   boost::object_pool<Gen> generator_pool_;
+
+  OtherFeatures *others_;
+};
+
+// The same for the root, where everything goes into one vertex.
+template <class Best> class RootCallback
+{
+public:
+  RootCallback(search::RootVertexGenerator<Best> &gen, OtherFeatures *others)
+    : gen_(gen), others_(others) {}
+
+  void NewHypothesis(search::PartialEdge partial) {
+    if (others_) others_->Score(partial);
+    gen_.NewHypothesis(partial);
+  }
+
+  void FinishedSearch() {
+    gen_.FinishedSearch();
+  }
+
+private:
+  search::RootVertexGenerator<Best> &gen_;
+
+  OtherFeatures *others_;
 };
 
 // This is called by the moses parser to collect hypotheses.  It converts to my
@@ -76,10 +175,10 @@ private:
 template <class Model> class Fill : public ChartParserCallback
 {
 public:
-  Fill(search::Context<Model> &context, const std::vector<lm::WordIndex> &vocab_mapping, search::Score oov_weight)
-    : context_(context), vocab_mapping_(vocab_mapping), oov_weight_(oov_weight) {}
+  Fill(search::Context<Model> &context, const std::vector<lm::WordIndex> &vocab_mapping, search::Score oov_weight, std::deque<AppliedRule> &rules, OtherFeatures *others)
+    : context_(context), vocab_mapping_(vocab_mapping), oov_weight_(oov_weight), rules_(rules), others_(others) {}
 
-  void Add(const TargetPhraseCollection &targets, const StackVec &nts, const WordsRange &ignored);
+  void Add(const TargetPhraseCollection &targets, const StackVec &nts, const WordsRange &range);
 
   void AddPhraseOOV(TargetPhrase &phrase, std::list<TargetPhraseCollection*> &waste_memory, const WordsRange &range);
 
@@ -90,7 +189,7 @@ public:
   }
 
   template <class Best> void Search(Best &best, ChartCellLabelSet &out, boost::object_pool<search::Vertex> &vertex_pool) {
-    HypothesisCallback<Best> callback(context_, best, out, vertex_pool);
+    HypothesisCallback<Best> callback(context_, best, out, vertex_pool, others_);
     edges_.Search(context_, callback);
   }
 
@@ -98,7 +197,8 @@ public:
   template <class Best> search::History RootSearch(Best &best) {
     search::Vertex vertex;
     search::RootVertexGenerator<Best> gen(vertex, best);
-    edges_.Search(context_, gen);
+    RootCallback<Best> callback(gen, others_);
+    edges_.Search(context_, callback);
     return vertex.BestChild();
   }
 
@@ -115,6 +215,10 @@ private:
   search::EdgeGenerator edges_;
 
   const search::Score oov_weight_;
+
+  std::deque<AppliedRule> &rules_;
+
+  OtherFeatures *others_;
 };
 
 template <class Model> void Fill<Model>::Add(const TargetPhraseCollection &targets, const StackVec &nts, const WordsRange &range)
@@ -150,15 +254,16 @@ template <class Model> void Fill<Model>::Add(const TargetPhraseCollection &targe
     // prob and oov were already accounted for.
     search::ScoreRule(context_.LanguageModel(), words, edge.Between());
 
+    rules_.push_back(AppliedRule(phrase, range));
     search::Note note;
-    note.vp = &phrase;
+    note.vp = &rules_.back();
     edge.SetNote(note);
 
     edges_.AddEdge(edge);
   }
 }
 
-template <class Model> void Fill<Model>::AddPhraseOOV(TargetPhrase &phrase, std::list<TargetPhraseCollection*> &, const WordsRange &)
+template <class Model> void Fill<Model>::AddPhraseOOV(TargetPhrase &phrase, std::list<TargetPhraseCollection*> &, const WordsRange &range)
 {
   std::vector<lm::WordIndex> words;
   UTIL_THROW_IF2(phrase.GetSize() > 1,
@@ -171,8 +276,9 @@ template <class Model> void Fill<Model>::AddPhraseOOV(TargetPhrase &phrase, std:
   search::ScoreRuleRet scored(search::ScoreRule(context_.LanguageModel(), words, edge.Between()));
   edge.SetScore(phrase.GetFutureScore() + scored.prob * context_.LMWeight() + static_cast<search::Score>(scored.oov) * oov_weight_);
 
+  rules_.push_back(AppliedRule(phrase, range));
   search::Note note;
-  note.vp = &phrase;
+  note.vp = &rules_.back();
   edge.SetNote(note);
 
   edges_.AddEdge(edge);
@@ -196,22 +302,58 @@ template <class Model> lm::WordIndex Fill<Model>::Convert(const Word &word) cons
   return (factor >= vocab_mapping_.size() ? 0 : vocab_mapping_[factor]);
 }
 
+// With a search graph, hypotheses recombined into those of the derivations
+// are kept as well, up to the pop limit.
+search::NBestConfig MakeNBestConfig()
+{
+  const StaticData &data = StaticData::Instance();
+  search::NBestConfig config(std::max<size_t>(data.GetNBestSize(), 1));
+  if (data.GetOutputSearchGraph()) {
+    config.keep = std::max<unsigned int>(config.keep, data.GetCubePruningPopLimit());
+  }
+  return config;
+}
+
 struct ChartCellBaseFactory {
   ChartCellBase *operator()(size_t startPos, size_t endPos) const {
     return new ChartCellBase(startPos, endPos);
   }
 };
 
+bool HasOtherStatefulFeatures()
+{
+  const StaticData &data = StaticData::Instance();
+  const std::vector<const StatefulFeatureFunction*> &ffs = StatefulFeatureFunction::GetStatefulFeatureFunctions();
+  for (size_t i = 0; i < ffs.size(); ++i) {
+    if (ffs[i] != &LanguageModel::GetFirstLM() && !data.IsFeatureFunctionIgnored(*ffs[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
 } // namespace
 
 Manager::Manager(const InputType &source) :
+  chart_manager_(HasOtherStatefulFeatures() ? new ChartManager(source) : NULL),
   source_(source),
-  cells_(source, ChartCellBaseFactory()),
-  parser_(source, cells_),
-  n_best_(search::NBestConfig(StaticData::Instance().GetNBestSize())) {}
+  own_cells_(chart_manager_ ? NULL : new ChartCellCollectionBase(source, ChartCellBaseFactory())),
+  own_parser_(chart_manager_ ? NULL : new ChartParser(source, *own_cells_)),
+  cells_(chart_manager_ ? chart_manager_->GetChartCellCollection() : *own_cells_),
+  parser_(chart_manager_ ? chart_manager_->GetParser() : *own_parser_),
+  n_best_(MakeNBestConfig())
+{
+  if (chart_manager_) {
+    chart_manager_->ResetSentenceStats(source);
+  }
+}
 
 Manager::~Manager()
 {
+  // before the arena of chart_manager_ goes
+  for (std::vector<ChartHypothesis*>::iterator i = other_hypos_.begin(); i != other_hypos_.end(); ++i) {
+    ChartHypothesis::Delete(*i);
+  }
 }
 
 template <class Model, class Best> search::History Manager::PopulateBest(const Model &model, const std::vector<lm::WordIndex> &words, Best &out)
@@ -219,7 +361,12 @@ template <class Model, class Best> search::History Manager::PopulateBest(const M
   const LanguageModel &abstract = LanguageModel::GetFirstLM();
   const float oov_weight = abstract.OOVFeatureEnabled() ? abstract.GetOOVWeight() : 0.0;
   const StaticData &data = StaticData::Instance();
-  search::Config config(abstract.GetWeight() * M_LN10, data.GetCubePruningPopLimit(), search::NBestConfig(data.GetNBestSize()));
+  boost::scoped_ptr<OtherFeatures> others;
+  if (chart_manager_) {
+    others.reset(new OtherFeatures(*chart_manager_, rules_, other_hypos_, other_scores_));
+  }
+  search::Config config(abstract.GetWeight() * M_LN10, data.GetCubePruningPopLimit(), search::NBestConfig(data.GetNBestSize()),
+                        others ? &OtherFeatures::Compare : NULL);
   search::Context<Model> context(config, model);
 
   size_t size = source_.GetSize();
@@ -232,22 +379,23 @@ template <class Model, class Best> search::History Manager::PopulateBest(const M
         break;
       }
       WordsRange range(startPos, startPos + width - 1);
-      Fill<Model> filler(context, words, oov_weight);
+      Fill<Model> filler(context, words, oov_weight, rules_, others.get());
       parser_.Create(range, filler);
       filler.Search(out, cells_.MutableBase(range).MutableTargetLabelSet(), vertex_pool);
     }
   }
 
   WordsRange range(0, size - 1);
-  Fill<Model> filler(context, words, oov_weight);
+  Fill<Model> filler(context, words, oov_weight, rules_, others.get());
   parser_.Create(range, filler);
   return filler.RootSearch(out);
 }
 
 template <class Model> void Manager::LMCallback(const Model &model, const std::vector<lm::WordIndex> &words)
 {
-  std::size_t nbest = StaticData::Instance().GetNBestSize();
-  if (nbest <= 1) {
+  const StaticData &data = StaticData::Instance();
+  // The search graph needs the recombined hypotheses, which only n_best_ keeps.
+  if (data.GetNBestSize() <= 1 && !data.GetOutputSearchGraph()) {
     search::History ret = PopulateBest(model, words, single_best_);
     if (ret) {
       backing_for_single_.resize(1);
@@ -260,6 +408,12 @@ template <class Model> void Manager::LMCallback(const Model &model, const std::v
     search::History ret = PopulateBest(model, words, n_best_);
     if (ret) {
       completed_nbest_ = &n_best_.Extract(ret);
+      if (data.GetOutputSearchGraph()) {
+        // Writing the search graph reveals more of the root's list, which
+        // would grow (and move) the vector completed_nbest_ points to.
+        backing_for_single_ = *completed_nbest_;
+        completed_nbest_ = &backing_for_single_;
+      }
     } else {
       backing_for_single_.clear();
       completed_nbest_ = &backing_for_single_;
@@ -284,20 +438,24 @@ namespace
 {
 
 struct NoOp {
-  void operator()(const TargetPhrase &) const {}
+  void operator()(const AppliedRule &) const {}
 };
 struct AccumScore {
   AccumScore(ScoreComponentCollection &out) : out_(&out) {}
-  void operator()(const TargetPhrase &phrase) {
-    out_->PlusEquals(phrase.GetScoreBreakdown());
+  void operator()(const AppliedRule &rule) {
+    out_->PlusEquals(rule.phrase.GetScoreBreakdown());
+    if (rule.others) {
+      out_->PlusEquals(*rule.others);
+    }
   }
   ScoreComponentCollection *out_;
 };
 template <class Action> void AppendToPhrase(const search::Applied final, Phrase &out, Action action)
 {
   assert(final.Valid());
-  const TargetPhrase &phrase = *static_cast<const TargetPhrase*>(final.GetNote().vp);
-  action(phrase);
+  const AppliedRule &rule = *static_cast<const AppliedRule*>(final.GetNote().vp);
+  const TargetPhrase &phrase = rule.phrase;
+  action(rule);
   const search::Applied *child = final.Children();
   for (std::size_t i = 0; i < phrase.GetSize(); ++i) {
     const Word &word = phrase.GetWord(i);
@@ -309,8 +467,83 @@ template <class Action> void AppendToPhrase(const search::Applied final, Phrase
   }
 }
 
+// Numbers hypotheses bottom up, writing each one the first time it is reached.
+// Derivations of an n-best list share their common hypotheses.  A hypothesis
+// is followed by those recombined into it, as the chart decoder's arcs are.
+class SearchGraphWriter
+{
+public:
+  SearchGraphWriter(long translationId, std::ostream &out, search::NBest &nbest)
+    : translation_id_(translationId), out_(out), nbest_(nbest), next_id_(0) {}
+
+  std::size_t Write(const search::Applied applied) {
+    std::map<const void*, std::size_t>::const_iterator found = ids_.find(applied.Base());
+    if (found != ids_.end()) {
+      return found->second;
+    }
+
+    // copied, as writing the children may reveal more of other lists
+    const std::vector<search::Applied> alternatives(nbest_.Alternatives(applied));
+    if (alternatives.front().Base() != applied.Base()) {
+      // this writes applied too
+      Write(alternatives.front());
+      return ids_[applied.Base()];
+    }
+
+    std::size_t id = WriteHypothesis(applied, NULL);
+    for (std::size_t i = 1; i < alternatives.size(); ++i) {
+      WriteHypothesis(alternatives[i], &id);
+    }
+    return id;
+  }
+
+private:
+  std::size_t WriteHypothesis(const search::Applied applied, const std::size_t *winner) {
+    std::vector<std::size_t> children;
+    const search::Applied *child = applied.Children();
+    for (search::Arity i = 0; i < applied.GetArity(); ++i) {
+      children.push_back(Write(child[i]));
+    }
+
+    const AppliedRule &rule = *static_cast<const AppliedRule*>(applied.GetNote().vp);
+    std::size_t id = next_id_++;
+    ids_[applied.Base()] = id;
+    out_ << translation_id_ << " " << id;
+    if (winner) {
+      out_ << "->" << *winner;
+    }
+    if (StaticData::Instance().GetIncludeLHSInSearchGraph()) {
+      out_ << " " << rule.phrase.GetTargetLHS() << "=>";
+    }
+    out_ << " " << rule.phrase << " " << rule.range;
+    for (std::size_t i = 0; i < children.size(); ++i) {
+      out_ << " " << children[i];
+    }
+
+    Phrase yield;
+    ScoreComponentCollection features;
+    PhraseAndFeatures(applied, yield, features);
+    out_ << " [total=" << applied.GetScore() << "] " << features << "\n";
+    return id;
+  }
+
+  const long translation_id_;
+  std::ostream &out_;
+  search::NBest &nbest_;
+  std::map<const void*, std::size_t> ids_;
+  std::size_t next_id_;
+};
+
 } // namespace
 
+void Manager::OutputSearchGraph(long translationId, std::ostream &out)
+{
+  SearchGraphWriter writer(translationId, out, n_best_);
+  for (std::vector<search::Applied>::const_iterator i = completed_nbest_->begin(); i != completed_nbest_->end(); ++i) {
+    writer.Write(*i);
+  }
+}
+
 void ToPhrase(const search::Applied final, Phrase &out)
 {
   out.Clear();
@@ -323,7 +556,7 @@ void PhraseAndFeatures(const search::Applied final, Phrase &phrase, ScoreCompone
   features.ZeroAll();
   AppendToPhrase(final, phrase, AccumScore(features));
 
-  // If we made it this far, there is only one language model.
+  // The searched language model was not scored with the others.
   float full, ignored_ngram;
   std::size_t ignored_oov;
 
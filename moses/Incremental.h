@@ -6,19 +6,42 @@
 
 #include "moses/ChartCellCollection.h"
 #include "moses/ChartParser.h"
+#include "moses/ScoreComponentCollection.h"
+#include "moses/WordsRange.h"
 
+#include <boost/scoped_ptr.hpp>
+
+#include <deque>
+#include <ostream>
 #include <vector>
 #include <string>
 
 namespace Moses
 {
-class ScoreComponentCollection;
 class InputType;
 class LanguageModel;
+class ChartManager;
+class ChartHypothesis;
 
 namespace Incremental
 {
 
+// What the search::Note of an edge points to: the rule and the span it was
+// applied to.  Once the edge is complete, also what the stateful features
+// other than the searched language model added to the score breakdown.
+struct AppliedRule {
+  AppliedRule(const TargetPhrase &phrase, const WordsRange &range, const ScoreComponentCollection *others = NULL)
+    : phrase(phrase), range(range), others(others) {}
+
+  const TargetPhrase &phrase;
+  const WordsRange range;
+  const ScoreComponentCollection *others;
+};
+
+// Chart decoding with incremental search.  The first language model, which
+// must be KenLM, is scored by the search.  Other stateful features are scored
+// with ChartHypothesis when an edge is complete, and hypotheses only
+// recombine if their states match as well.
 class Manager
 {
 public:
@@ -35,17 +58,45 @@ public:
     return *completed_nbest_;
   }
 
+  // Write the hypotheses that make up the completed derivations, and those
+  // recombined into them as far as the pop limit kept them, one per line in
+  // the format of the chart decoder's search graph:
+  //   id[->id of the hypothesis it was recombined into] [LHS=>] rule span
+  //   ids of the children [total=score] score breakdown
+  // Hypotheses are numbered as they are written, not as they were created.
+  void OutputSearchGraph(long translationId, std::ostream &out);
+
+  const ChartParser &GetParser() const {
+    return parser_;
+  }
+
 private:
   template <class Model, class Best> search::History PopulateBest(const Model &model, const std::vector<lm::WordIndex> &words, Best &out);
 
+  // Only if there are other stateful features.  Their hypotheses need it, so
+  // its chart and parser are used.  Declared first so that its arena, which
+  // holds their states, goes last.
+  boost::scoped_ptr<ChartManager> chart_manager_;
+
   const InputType &source_;
-  ChartCellCollectionBase cells_;
-  ChartParser parser_;
+  // Otherwise these.
+  boost::scoped_ptr<ChartCellCollectionBase> own_cells_;
+  boost::scoped_ptr<ChartParser> own_parser_;
+  ChartCellCollectionBase &cells_;
+  ChartParser &parser_;
+
+  // Notes of all edges of this sentence.  A deque so that they don't move.
+  std::deque<AppliedRule> rules_;
+
+  // Hypotheses and score changes of the other stateful features, see AppliedRule.
+  std::vector<ChartHypothesis*> other_hypos_;
+  std::deque<ScoreComponentCollection> other_scores_;
 
   // Only one of single_best_ or n_best_ will be used, but it was easier to do this than a template.
   search::SingleBest single_best_;
   // ProcessSentence returns a reference to a vector.  ProcessSentence
-  // doesn't have one, so this is populated and returned.
+  // doesn't have one, so this is populated and returned.  Also holds a copy of
+  // the n-best list when the search graph is written.
   std::vector<search::Applied> backing_for_single_;
 
   search::NBest n_best_;
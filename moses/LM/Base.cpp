@@ -98,25 +98,18 @@ void LanguageModel::Evaluate(const Phrase &source
 
 const LanguageModel &LanguageModel::GetFirstLM()
 {
-  static const LanguageModel *lmStatic = NULL;
-
-  if (lmStatic) {
-    return *lmStatic;
-  }
-
-  // 1st time looking up lm
+  // not cached: decoding threads call this concurrently, and the loop is cheap
   const std::vector<const StatefulFeatureFunction*> &statefulFFs = StatefulFeatureFunction::GetStatefulFeatureFunctions();
   for (size_t i = 0; i < statefulFFs.size(); ++i) {
     const StatefulFeatureFunction *ff = statefulFFs[i];
     const LanguageModel *lm = dynamic_cast<const LanguageModel*>(ff);
 
     if (lm) {
-      lmStatic = lm;
-      return *lmStatic;
+      return *lm;
     }
   }
 
-  throw std::logic_error("Incremental search only supports one language model.");
+  throw std::logic_error("Incremental search needs a language model.");
 }
 
 } // namespace Moses
@@ -27,9 +27,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "lm/binary_format.hh"
 #include "lm/enumerate_vocab.hh"
+#include "lm/filter/filtered_arpa.hh"
+#include "lm/filter/vocab.hh"
 #include "lm/left.hh"
 #include "lm/model.hh"
 #include "util/exception.hh"
+#include "util/file_piece.hh"
 
 #include "Ken.h"
 #include "Base.h"
@@ -140,7 +143,7 @@ private:
 
 } // namespace
 
-template <class Model> LanguageModelKen<Model>::LanguageModelKen(const std::string &line, const std::string &file, FactorType factorType, bool lazy)
+template <class Model> LanguageModelKen<Model>::LanguageModelKen(const std::string &line, const std::string &file, FactorType factorType, bool lazy, const std::string &filterVocab)
   :LanguageModel(line)
   ,m_factorType(factorType)
 {
@@ -156,7 +159,27 @@ template <class Model> LanguageModelKen<Model>::LanguageModelKen(const std::stri
   config.enumerate_vocab = &builder;
   config.load_method = lazy ? util::LAZY : util::POPULATE_OR_READ;
 
-  m_ngram.reset(new Model(file.c_str(), config));
+  if (filterVocab.empty()) {
+    m_ngram.reset(new Model(file.c_str(), config));
+  } else {
+    // Build a small model with only the n-grams the vocabulary can produce.
+    lm::vocab::Single::Words words;
+    {
+      InputFileStream in(filterVocab);
+      lm::vocab::ReadSingle(in, words);
+    }
+    lm::vocab::Single filter(words);
+    util::FilePiece f(file.c_str(), config.ProgressMessages());
+    lm::FilteredARPA source(f, filter);
+    IFVERBOSE(1) {
+      std::cerr << "Kept n-grams of " << file << " with the " << words.size() << " words of " << filterVocab << ":";
+      for (size_t i = 0; i < source.Counts().size(); ++i) {
+        std::cerr << " " << source.Counts()[i] << "/" << source.Original()[i];
+      }
+      std::cerr << std::endl;
+    }
+    m_ngram.reset(new Model(source, config));
+  }
 
   m_beginSentenceFactor = collection.AddFactor(BOS_);
 }
@@ -285,6 +308,30 @@ template <class Model> FFState *LanguageModelKen<Model>::Evaluate(const Hypothes
   return ret.release();
 }
 
+template <class Model> void LanguageModelKen<Model>::Prefetch(const Hypothesis &hypo, const FFState *ps) const
+{
+  if (!hypo.GetCurrTargetLength()) return;
+  const lm::ngram::State &in_state = static_cast<const KenLMState&>(*ps).state;
+
+  // the same queries as Evaluate() makes with states, but with the context
+  // spelled out: the phrase so far, most recent first, then the incoming state
+  const std::size_t begin = hypo.GetCurrTargetWordsRange().GetStartPos();
+  const std::size_t end = hypo.GetCurrTargetWordsRange().GetEndPos() + 1;
+  const std::size_t adjust_end = std::min(end, begin + m_ngram->Order() - 1);
+  const std::size_t max_context = m_ngram->Order() - 1;
+
+  lm::WordIndex context[KENLM_MAX_ORDER];
+  std::copy(in_state.words, in_state.words + in_state.length, context);
+  std::size_t context_length = in_state.length;
+  for (std::size_t position = begin; position < adjust_end; ++position) {
+    const lm::WordIndex word = TranslateID(hypo.GetWord(position));
+    m_ngram->Prefetch(context, context + context_length, word);
+    context_length = std::min(context_length + 1, max_context);
+    std::copy_backward(context, context + context_length - 1, context + context_length);
+    context[0] = word;
+  }
+}
+
 class LanguageModelChartStateKenLM : public FFState
 {
 public:
@@ -391,6 +438,7 @@ LanguageModel *ConstructKenLM(const std::string &line)
   FactorType factorType = 0;
   string filePath;
   bool lazy = false;
+  string filterVocab;
 
   vector<string> toks = Tokenize(line);
   for (size_t i = 1; i < toks.size(); ++i) {
@@ -406,18 +454,21 @@ LanguageModel *ConstructKenLM(const std::string &line)
       filePath = args[1];
     } else if (args[0] == "lazyken") {
       lazy = Scan<bool>(args[1]);
+    } else if (args[0] == "filter-vocab") {
+      filterVocab = args[1];
     } else if (args[0] == "name") {
       // that's ok. do nothing, passes onto LM constructor
     }
   }
 
-  return ConstructKenLM(line, filePath, factorType, lazy);
+  return ConstructKenLM(line, filePath, factorType, lazy, filterVocab);
 }
 
-LanguageModel *ConstructKenLM(const std::string &line, const std::string &file, FactorType factorType, bool lazy)
+LanguageModel *ConstructKenLM(const std::string &line, const std::string &file, FactorType factorType, bool lazy, const std::string &filterVocab)
 {
     lm::ngram::ModelType model_type;
     if (lm::ngram::RecognizeBinary(file.c_str(), model_type)) {
+      UTIL_THROW_IF2(!filterVocab.empty(), "filter-vocab needs an ARPA file, but " << file << " is a binary KenLM model");
 
       switch(model_type) {
       case lm::ngram::PROBING:
@@ -436,7 +487,7 @@ LanguageModel *ConstructKenLM(const std::string &line, const std::string &file,
     	UTIL_THROW2("Unrecognized kenlm model type " << model_type);
       }
     } else {
-      return new LanguageModelKen<lm::ngram::ProbingModel>(line, file, factorType, lazy);
+      return new LanguageModelKen<lm::ngram::ProbingModel>(line, file, factorType, lazy, filterVocab);
     }
 }
 
@@ -41,7 +41,10 @@ class FFState;
 LanguageModel *ConstructKenLM(const std::string &line);
 
 //! This will also load. Returns a templated KenLM class
-LanguageModel *ConstructKenLM(const std::string &line, const std::string &file, FactorType factorType, bool lazy);
+/*! If filterVocab names a file of words, only n-grams made of those words are
+ *  loaded from the ARPA file.
+ */
+LanguageModel *ConstructKenLM(const std::string &line, const std::string &file, FactorType factorType, bool lazy, const std::string &filterVocab = "");
 
 /*
  * An implementation of single factor LM using Kenneth's code.
@@ -49,7 +52,7 @@ LanguageModel *ConstructKenLM(const std::string &line, const std::string &file,
 template <class Model> class LanguageModelKen : public LanguageModel
 {
 public:
-  LanguageModelKen(const std::string &line, const std::string &file, FactorType factorType, bool lazy);
+  LanguageModelKen(const std::string &line, const std::string &file, FactorType factorType, bool lazy, const std::string &filterVocab = "");
 
   virtual const FFState *EmptyHypothesisState(const InputType &/*input*/) const;
 
@@ -57,6 +60,8 @@ public:
 
   virtual FFState *Evaluate(const Hypothesis &hypo, const FFState *ps, ScoreComponentCollection *out) const;
 
+  virtual void Prefetch(const Hypothesis &hypo, const FFState *ps) const;
+
   virtual FFState *EvaluateChart(const ChartHypothesis& cur_hypo, int featureID, ScoreComponentCollection *accumulator) const;
 
   virtual void IncrementalCallback(Incremental::Manager &manager) const;
@@ -0,0 +1,127 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "FF/LexicalReordering/LexicalReorderingTableMapped.h"
+#include "FactorCollection.h"
+#include "Util.h"
+
+using namespace Moses;
+using namespace std;
+
+namespace
+{
+
+struct TableFiles {
+  string text, binary;
+
+  TableFiles() {
+    ostringstream base;
+    base << "/tmp/moses_mlexr_test_" << getpid();
+    text = base.str() + ".txt";
+    binary = base.str() + LexicalReorderingTableMapped::Suffix;
+  }
+  ~TableFiles() {
+    remove(text.c_str());
+    remove(binary.c_str());
+  }
+};
+
+Phrase MakePhrase(const string &str)
+{
+  Phrase ret;
+  vector<string> words = Tokenize(str);
+  for (size_t i = 0; i < words.size(); ++i) {
+    ret.AddWord().SetFactor(0, FactorCollection::Instance().AddFactor(words[i]));
+  }
+  return ret;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(lexical_reordering_table_mapped)
+
+BOOST_AUTO_TEST_CASE(lookup_phrase_pairs)
+{
+  TableFiles files;
+  {
+    ofstream text(files.text.c_str());
+    text << "das haus ||| the house ||| 0.5 0.25 0.25 0.125 0.125 0.75\n"
+         << "das ||| the ||| 0.1 0.2 0.7 0.3 0.3 0.4\n"
+         << "haus ||| house ||| 0.9 0.05 0.05 0.6 0.2 0.2\n";
+  }
+  LexicalReorderingTableMapped::Create(files.text, files.binary);
+
+  vector<FactorType> factors(1, 0);
+  LexicalReorderingTableMapped table(files.binary, factors, factors, vector<FactorType>());
+  BOOST_CHECK_EQUAL(table.GetNumScores(), 6);
+
+  // few distinct values, so the codebooks are exact
+  Phrase empty;
+  Scores scores = table.GetScore(MakePhrase("das haus"), MakePhrase("the house"), empty);
+  BOOST_REQUIRE_EQUAL(scores.size(), 6);
+  BOOST_CHECK_CLOSE(scores[0], FloorScore(TransformScore(0.5)), 1e-4);
+  BOOST_CHECK_CLOSE(scores[5], FloorScore(TransformScore(0.75)), 1e-4);
+
+  scores = table.GetScore(MakePhrase("haus"), MakePhrase("house"), empty);
+  BOOST_REQUIRE_EQUAL(scores.size(), 6);
+  BOOST_CHECK_CLOSE(scores[3], FloorScore(TransformScore(0.6)), 1e-4);
+
+  // word boundaries are part of the key
+  BOOST_CHECK(table.GetScore(MakePhrase("dashaus"), MakePhrase("the house"), empty).empty());
+  BOOST_CHECK(table.GetScore(MakePhrase("das"), MakePhrase("house"), empty).empty());
+}
+
+BOOST_AUTO_TEST_CASE(quantization_error_is_small)
+{
+  TableFiles files;
+  vector<float> expected;
+  {
+    ofstream text(files.text.c_str());
+    for (size_t i = 1; i <= 2000; ++i) {
+      float p = i / 2001.0;
+      text << "w" << i << " ||| " << p << "\n";
+      expected.push_back(FloorScore(TransformScore(p)));
+    }
+  }
+  LexicalReorderingTableMapped::Create(files.text, files.binary);
+
+  vector<FactorType> factors(1, 0);
+  LexicalReorderingTableMapped table(files.binary, factors, vector<FactorType>(), vector<FactorType>());
+  Phrase empty;
+  for (size_t i = 100; i <= 2000; i += 37) {
+    ostringstream word;
+    word << "w" << i;
+    Scores scores = table.GetScore(MakePhrase(word.str()), empty, empty);
+    BOOST_REQUIRE_EQUAL(scores.size(), 1);
+    BOOST_CHECK_SMALL(scores[0] - expected[i - 1], 0.05f);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -71,6 +71,8 @@ Manager::~Manager()
   delete m_search;
   // this is a comment ...
 
+  VERBOSE(2, "Sentence arena used " << m_arena.GetBytesAllocated() << " bytes" << endl);
+
   StaticData::Instance().CleanUpAfterSentenceProcessing(m_source);
 }
 
@@ -101,6 +103,9 @@ void Manager::ProcessSentence()
     GetSentenceStats().StartTimeCollectOpts();
   }
   m_transOptColl->CreateTranslationOptions();
+  GetSentenceStats().AddTransOptCacheLookups(m_transOptColl->GetNumCacheHits()
+      , m_transOptColl->GetNumCacheMisses()
+      , m_transOptColl->GetCacheTimeSaved());
 
   // some reporting on how long this took
   IFVERBOSE(1) {
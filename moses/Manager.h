@@ -34,6 +34,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "WordsBitmap.h"
 #include "Search.h"
 #include "SearchCubePruning.h"
+#include "SentenceArena.h"
 
 namespace Moses
 {
@@ -111,6 +112,7 @@ private:
 
 protected:
   // data
+  SentenceArena m_arena; /**< memory for per-sentence objects. declared first so that it is released last */
 //	InputType const& m_source; /**< source sentence to be translated */
   TranslationOptionCollection *m_transOptColl; /**< pre-computed list of translation options for the phrases in this sentence */
   Search *m_search;
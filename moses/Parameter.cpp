@@ -63,6 +63,10 @@ Parameter::Parameter()
   AddParam("phrase-drop-allowed", "da", "if present, allow dropping of source words"); //da = drop any (word); see -du for comparison
   AddParam("report-all-factors", "report all factors in output, not just first");
   AddParam("report-all-factors-in-n-best", "Report all factors in n-best-lists. Default is false");
+  AddParam("server-port", "run as a translation server listening on this TCP port, instead of translating the input");
+  AddParam("server-socket", "run as a translation server listening on this Unix domain socket, instead of translating the input");
+  AddParam("server-max-connections", "number of client connections the translation server serves at a time (default 64)");
+  AddParam("server-max-nbest", "largest n-best list a client of the translation server may ask for (default 100)");
   AddParam("stack", "s", "maximum stack size for histogram pruning");
   AddParam("stack-diversity", "sd", "minimum number of hypothesis of each coverage in stack (default 0)");
   AddParam("threads","th", "number of threads to use in decoding (defaults to single-threaded)");
@@ -119,6 +123,10 @@ Parameter::Parameter()
   AddParam("output-hypo-score", "Output the hypo score to stdout with the output string. For search error analysis. Default is false");
   AddParam("unknown-lhs", "file containing target lhs of unknown words. 1 per line: LHS prob");
   AddParam("cube-pruning-lazy-scoring", "cbls", "Don't fully score a hypothesis until it is popped");
+  AddParam("cube-pruning-early-stop", "cbes", "Stop popping hypotheses for a chart cell once the best remaining one scores this margin (log) below the cell's beam. Trades accuracy for speed, best combined with -cbls (default: off)");
+  AddParam("translation-option-cache-mb", "Keep the translation options of source phrases across sentences, up to this many MB. Text input only. 0 disables (default 0)");
+  AddParam("chart-threads", "number of threads that decode the spans of one width in parallel, for chart decoding. Does not change the output (default 1)");
+  AddParam("lm-prefetch-distance", "How many hypotheses ahead of scoring to prefetch language model entries, for phrase-based search. 0 disables (default 4)");
   AddParam("search-algorithm", "Which search algorithm to use. 0=normal stack, 1=cube pruning, 2=cube growing, 4=stack with batched lm requests (default = 0)");
   AddParam("link-param-count", "Number of parameters on word links when using confusion networks or lattices (default = 1)");
   AddParam("description", "Source language, target language, description");
@@ -54,6 +54,10 @@ public:
   bool IsEmpty() const {
     return m_queue.empty();
   }
+  //! score of the hypothesis Pop() would return next, estimated with lazy scoring
+  float GetTopScore() const {
+    return m_queue.top()->GetTopScore();
+  }
 
 private:
   typedef std::priority_queue<RuleCube*, std::vector<RuleCube*>,
@@ -23,6 +23,9 @@ SearchNormal::SearchNormal(Manager& manager, const InputType &source, const Tran
   VERBOSE(1, "Translating: " << m_source << endl);
   const StaticData &staticData = StaticData::Instance();
 
+  // early discarding decides per hypothesis whether to build it at all
+  m_prefetchDistance = staticData.UseEarlyDiscarding() ? 0 : staticData.GetLMPrefetchDistance();
+
   // only if constraint decoding (having to match a specified output)
   // long sentenceID = source.GetTranslationId();
 
@@ -260,12 +263,60 @@ void SearchNormal::ExpandAllHypotheses(const Hypothesis &hypothesis, size_t star
 
   // loop through all translation options
   const TranslationOptionList &transOptList = m_transOptColl.GetTranslationOptionList(WordsRange(startPos, endPos));
+  if (m_prefetchDistance) {
+    ExpandHypothesisBatch(hypothesis, transOptList);
+    return;
+  }
   TranslationOptionList::const_iterator iter;
   for (iter = transOptList.begin() ; iter != transOptList.end() ; ++iter) {
     ExpandHypothesis(hypothesis, **iter, expectedScore);
   }
 }
 
+/**
+ * Expand one hypothesis with all translation options of a span.
+ * All the new hypotheses are built first, then scored in order while the
+ * feature function lookups (mostly the language model) of the next few are
+ * prefetched, so their cache misses overlap instead of being taken one
+ * after another.  The result is the same as calling ExpandHypothesis() for
+ * each option without early discarding.
+ */
+void SearchNormal::ExpandHypothesisBatch(const Hypothesis &hypothesis, const TranslationOptionList &transOptList)
+{
+  SentenceStats &stats = m_manager.GetSentenceStats();
+
+  IFVERBOSE(2) {
+    stats.StartTimeBuildHyp();
+  }
+  m_batch.clear();
+  TranslationOptionList::const_iterator iter;
+  for (iter = transOptList.begin() ; iter != transOptList.end() ; ++iter) {
+    Hypothesis *newHypo = hypothesis.CreateNext(**iter);
+    if (newHypo) m_batch.push_back(newHypo);
+  }
+  IFVERBOSE(2) {
+    stats.StopTimeBuildHyp();
+  }
+
+  const size_t size = m_batch.size();
+  for (size_t i = 0; i < m_prefetchDistance && i < size; ++i) {
+    m_batch[i]->Prefetch();
+  }
+  for (size_t i = 0; i < size; ++i) {
+    if (i + m_prefetchDistance < size) {
+      m_batch[i + m_prefetchDistance]->Prefetch();
+    }
+    Hypothesis *newHypo = m_batch[i];
+    newHypo->Evaluate(m_transOptColl.GetFutureScore());
+
+    IFVERBOSE(3) {
+      newHypo->PrintHypothesis();
+    }
+    AddToStack(newHypo);
+  }
+  m_batch.clear();
+}
+
 /**
  * Expand one hypothesis with a translation option.
  * this involves initial creation, scoring and adding it to the proper stack
@@ -342,7 +393,13 @@ void SearchNormal::ExpandHypothesis(const Hypothesis &hypothesis, const Translat
     newHypo->PrintHypothesis();
   }
 
-  // add to hypothesis stack
+  AddToStack(newHypo);
+}
+
+//! add a scored hypothesis to the stack for its coverage
+void SearchNormal::AddToStack(Hypothesis *newHypo)
+{
+  SentenceStats &stats = m_manager.GetSentenceStats();
   size_t wordsTranslated = newHypo->GetWordsBitmap().GetNumWordsCovered();
   IFVERBOSE(2) {
     stats.StartTimeStack();
@@ -26,11 +26,15 @@ protected:
   size_t interrupted_flag; /**< flag indicating that decoder ran out of time (see switch -time-out) */
   HypothesisStackNormal* actual_hypoStack; /**actual (full expanded) stack of hypotheses*/
   const TranslationOptionCollection &m_transOptColl; /**< pre-computed list of translation options for the phrases in this sentence */
+  size_t m_prefetchDistance; /**< how many hypotheses ahead to prefetch feature function data. 0 = build and score one at a time */
+  std::vector<Hypothesis*> m_batch; /**< hypotheses built but not yet scored */
 
   // functions for creating hypotheses
   void ProcessOneHypothesis(const Hypothesis &hypothesis);
   void ExpandAllHypotheses(const Hypothesis &hypothesis, size_t startPos, size_t endPos);
   virtual void ExpandHypothesis(const Hypothesis &hypothesis,const TranslationOption &transOpt, float expectedScore);
+  void ExpandHypothesisBatch(const Hypothesis &hypothesis, const TranslationOptionList &transOptList);
+  void AddToStack(Hypothesis *newHypo);
 
 public:
   SearchNormal(Manager& manager, const InputType &source, const TranslationOptionCollection &transOptColl);
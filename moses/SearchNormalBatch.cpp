@@ -15,6 +15,8 @@ SearchNormalBatch::SearchNormalBatch(Manager& manager, const InputType &source,
   ,m_batch_size(10000)
 {
   m_max_stack_size = StaticData::Instance().GetMaxHypoStackSize();
+  // this search batches by its own rules, through ExpandHypothesis()
+  m_prefetchDistance = 0;
 
   // Split the feature functions into sets of stateless, stateful
   // distributed lm, and stateful non-distributed.
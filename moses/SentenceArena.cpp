@@ -0,0 +1,127 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+
+#ifdef WITH_THREADS
+#include <boost/thread/tss.hpp>
+#endif
+
+#include "SentenceArena.h"
+#include "util/scoped.hh"
+
+namespace Moses
+{
+
+namespace
+{
+
+// precedes every block handed out
+struct BlockHeader {
+  SentenceArena *arena; // NULL = heap
+  std::size_t sizeClass;
+};
+
+typedef std::vector<SentenceArena*> ArenaStack;
+
+#ifdef WITH_THREADS
+boost::thread_specific_ptr<ArenaStack> s_arenas;
+#else
+std::auto_ptr<ArenaStack> s_arenas;
+#endif
+
+ArenaStack &GetArenaStack()
+{
+  ArenaStack *arenas = s_arenas.get();
+  if (arenas == NULL) {
+    arenas = new ArenaStack;
+    s_arenas.reset(arenas);
+  }
+  return *arenas;
+}
+
+}
+
+SentenceArena::SentenceArena()
+  : m_freeLists(MAX_RECYCLED / ALIGN + 1, NULL)
+  , m_bytesAllocated(0)
+{
+  GetArenaStack().push_back(this);
+}
+
+SentenceArena::~SentenceArena()
+{
+  // arenas are normally destroyed in reverse order, but don't rely on it
+  ArenaStack &arenas = GetArenaStack();
+  ArenaStack::iterator iter = std::find(arenas.begin(), arenas.end(), this);
+  if (iter != arenas.end()) {
+    arenas.erase(iter);
+  }
+}
+
+SentenceArena *SentenceArena::Current()
+{
+  ArenaStack *arenas = s_arenas.get();
+  return (arenas && !arenas->empty()) ? arenas->back() : NULL;
+}
+
+void *SentenceArena::Allocate(std::size_t size)
+{
+  // header, then the payload rounded up to the alignment. at least ALIGN
+  // bytes of payload so that a free block can hold the free-list link
+  std::size_t sizeClass = std::max((size + ALIGN - 1) / ALIGN, (std::size_t) 1);
+  SentenceArena *arena = Current();
+
+  BlockHeader *header;
+  if (arena == NULL || sizeClass * ALIGN > MAX_RECYCLED) {
+    header = static_cast<BlockHeader*>(util::MallocOrThrow(ALIGN + size));
+    header->arena = NULL;
+  } else {
+    void *&freeList = arena->m_freeLists[sizeClass];
+    if (freeList) {
+      header = static_cast<BlockHeader*>(freeList);
+      freeList = *reinterpret_cast<void**>(reinterpret_cast<char*>(header) + ALIGN);
+    } else {
+      const std::size_t bytes = ALIGN + sizeClass * ALIGN;
+      header = static_cast<BlockHeader*>(arena->m_pool.Allocate(bytes));
+      arena->m_bytesAllocated += bytes;
+    }
+    header->arena = arena;
+  }
+  header->sizeClass = sizeClass;
+  return reinterpret_cast<char*>(header) + ALIGN;
+}
+
+void SentenceArena::Free(void *ptr)
+{
+  if (ptr == NULL) return;
+  BlockHeader *header = reinterpret_cast<BlockHeader*>(static_cast<char*>(ptr) - ALIGN);
+  if (header->arena == NULL) {
+    free(header);
+  } else if (header->arena == Current()) {
+    // recycle. blocks of other threads' arenas wait for the arena to go
+    void *&freeList = header->arena->m_freeLists[header->sizeClass];
+    *static_cast<void**>(ptr) = freeList;
+    freeList = header;
+  }
+}
+
+}
@@ -0,0 +1,86 @@
+// -*- c++ -*-
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_SentenceArena_h
+#define moses_SentenceArena_h
+
+#include <cstddef>
+#include <vector>
+
+#include "util/pool.hh"
+
+namespace Moses
+{
+
+/** Memory for the small objects created while decoding one sentence.
+ *
+ * Manager and ChartManager each own an arena.  While it exists, it is the
+ * current arena of the thread that created it, and classes that route their
+ * operator new through SentenceArena::Allocate() (hypotheses, translation
+ * options, feature function states, coverage bitmaps) are carved out of it
+ * instead of the heap.  Freed blocks are recycled by size within the arena,
+ * and everything is handed back to the system in one go when the arena is
+ * destroyed at the end of the sentence.
+ *
+ * Allocations made when no arena is current come from the heap, and
+ * Free() tells the two apart, so such objects may be created and destroyed
+ * anywhere.  Objects allocated from an arena must not outlive it; freeing
+ * them from another thread is allowed, but their memory is then only
+ * reclaimed with the arena.
+ */
+class SentenceArena
+{
+public:
+  //! makes the new arena current for the calling thread
+  SentenceArena();
+
+  //! releases all memory. the previously current arena becomes current again
+  ~SentenceArena();
+
+  //! allocate from the current arena, or the heap if there is none
+  static void *Allocate(std::size_t size);
+
+  //! free memory from Allocate()
+  static void Free(void *ptr);
+
+  //! bytes carved out of the arena so far, including headers
+  std::size_t GetBytesAllocated() const {
+    return m_bytesAllocated;
+  }
+
+private:
+  // blocks up to this size are recycled. larger ones go to the heap
+  static const std::size_t MAX_RECYCLED = 512;
+  static const std::size_t ALIGN = 16;
+
+  util::Pool m_pool;
+  std::vector<void*> m_freeLists; // one singly-linked list per size class
+  std::size_t m_bytesAllocated;
+
+  static SentenceArena *Current();
+
+  // no copying
+  SentenceArena(const SentenceArena &);
+  SentenceArena &operator=(const SentenceArena &);
+};
+
+}
+
+#endif
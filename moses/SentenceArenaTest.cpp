@@ -0,0 +1,83 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+
+#include "SentenceArena.h"
+
+using namespace Moses;
+
+BOOST_AUTO_TEST_SUITE(sentence_arena)
+
+BOOST_AUTO_TEST_CASE(heap_without_arena)
+{
+  void *ptr = SentenceArena::Allocate(100);
+  std::memset(ptr, 1, 100);
+  SentenceArena::Free(ptr);
+  SentenceArena::Free(NULL);
+}
+
+BOOST_AUTO_TEST_CASE(allocate_and_recycle)
+{
+  SentenceArena arena;
+  void *a = SentenceArena::Allocate(40);
+  void *b = SentenceArena::Allocate(40);
+  BOOST_CHECK(a != b);
+  BOOST_CHECK_EQUAL(reinterpret_cast<size_t>(a) % 16, 0);
+  BOOST_CHECK_EQUAL(reinterpret_cast<size_t>(b) % 16, 0);
+  const size_t used = arena.GetBytesAllocated();
+  BOOST_CHECK(used > 0);
+
+  // same size class comes back from the free list
+  SentenceArena::Free(a);
+  void *c = SentenceArena::Allocate(33);
+  BOOST_CHECK_EQUAL(a, c);
+  BOOST_CHECK_EQUAL(arena.GetBytesAllocated(), used);
+
+  // too big to recycle: heap
+  void *big = SentenceArena::Allocate(4096);
+  std::memset(big, 1, 4096);
+  BOOST_CHECK_EQUAL(arena.GetBytesAllocated(), used);
+  SentenceArena::Free(big);
+}
+
+BOOST_AUTO_TEST_CASE(nested_arenas)
+{
+  SentenceArena *outer = new SentenceArena;
+  SentenceArena::Allocate(8);
+  SentenceArena *inner = new SentenceArena;
+  SentenceArena::Allocate(8);
+  const size_t outerUsed = outer->GetBytesAllocated();
+  const size_t innerUsed = inner->GetBytesAllocated();
+  BOOST_CHECK(innerUsed > 0);
+
+  // out of order destruction leaves the remaining one current
+  delete outer;
+  SentenceArena::Allocate(8);
+  BOOST_CHECK(inner->GetBytesAllocated() > innerUsed);
+  BOOST_CHECK(outerUsed > 0);
+  delete inner;
+
+  void *ptr = SentenceArena::Allocate(8);
+  SentenceArena::Free(ptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -66,6 +66,9 @@ public:
     m_numHyposDiscarded = 0;
     m_numHyposEarlyDiscarded = 0;
     m_numHyposNotBuilt = 0;
+    m_numTransOptCacheHits = 0;
+    m_numTransOptCacheMisses = 0;
+    m_timeTransOptCacheSaved = 0.0;
     m_totalSourceWords = source.GetSize();
     m_recombinationInfos.clear();
     m_deletedWords.clear();
@@ -98,6 +101,17 @@ public:
   unsigned int GetNumHyposNotBuilt() const {
     return m_numHyposNotBuilt;
   }
+  //! source spans whose options came from the translation option cache
+  size_t GetNumTransOptCacheHits() const {
+    return m_numTransOptCacheHits;
+  }
+  size_t GetNumTransOptCacheMisses() const {
+    return m_numTransOptCacheMisses;
+  }
+  //! estimated time the cache hits saved in collecting options
+  double GetTimeTransOptCacheSaved() const {
+    return m_timeTransOptCacheSaved;
+  }
   double GetTimeCollectOpts() const {
     return m_timeCollectOpts.get_elapsed_time();
   }
@@ -163,6 +177,11 @@ public:
   void AddDiscarded() {
     m_numHyposDiscarded++;
   }
+  void AddTransOptCacheLookups(size_t hits, size_t misses, double timeSaved) {
+    m_numTransOptCacheHits += hits;
+    m_numTransOptCacheMisses += misses;
+    m_timeTransOptCacheSaved += timeSaved;
+  }
 
   void StartTimeCollectOpts() {
     m_timeCollectOpts.start();
@@ -237,6 +256,9 @@ protected:
   unsigned int m_numHyposDiscarded;
   unsigned int m_numHyposEarlyDiscarded;
   unsigned int m_numHyposNotBuilt;
+  size_t m_numTransOptCacheHits;
+  size_t m_numTransOptCacheMisses;
+  double m_timeTransOptCacheSaved;
   Timer m_timeCollectOpts;
   Timer m_timeBuildHyp;
   Timer m_timeEstimateScore;
@@ -258,6 +280,13 @@ inline std::ostream& operator<<(std::ostream& os, const SentenceStats& ss)
   double totalTime = ss.GetTimeTotal();
   double otherTime = totalTime - (ss.GetTimeCollectOpts() + ss.GetTimeBuildHyp() + ss.GetTimeEstimateScore() + ss.GetTimeCalcLM() + ss.GetTimeOtherScore() + ss.GetTimeStack() + ss.GetTimeSetupCubes() + ss.GetTimeManageCubes());
 
+  const size_t cacheLookups = ss.GetNumTransOptCacheHits() + ss.GetNumTransOptCacheMisses();
+  if (cacheLookups) {
+    os << "translation option cache hits = " << ss.GetNumTransOptCacheHits() << " of " << cacheLookups
+       << " spans (" << (int)(100 * ss.GetNumTransOptCacheHits() / cacheLookups) << "%), saved about "
+       << ss.GetTimeTransOptCacheSaved() << " seconds" << std::endl;
+  }
+
   return os << "total hypotheses considered = " << ss.GetTotalHypos() << std::endl
          << "    number popped from cube = " << ss.GetNumHyposPopped() << std::endl
          << "           number not built = " << ss.GetNumHyposNotBuilt() << std::endl
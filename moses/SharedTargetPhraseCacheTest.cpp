@@ -0,0 +1,175 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#ifdef WITH_THREADS
+#include <boost/thread.hpp>
+#endif
+
+#include "TranslationModel/SharedTargetPhraseCache.h"
+
+using namespace Moses;
+using namespace std;
+
+namespace
+{
+
+typedef SharedTargetPhraseCache::Ptr Ptr;
+
+// Keys below 128 that are multiples of 16 all fall into the same stripe,
+// so with room for three entries per stripe the fourth one evicts.
+const size_t kStripes = 16;
+const size_t kPerStripe = 3;
+
+size_t SameStripeKey(size_t i)
+{
+  return i * 16;
+}
+
+// Cached source phrases without translations all have the same size.
+size_t EntryBytes()
+{
+  return SharedTargetPhraseCache::EstimateBytes(NULL);
+}
+
+#ifdef WITH_THREADS
+/** Looks up keys round robin, inserting what is not cached.  Boost.Test
+ * checks are not thread safe, so it counts collections it did not get.
+ */
+class LookupWorker
+{
+public:
+  LookupWorker(SharedTargetPhraseCache &cache, size_t first, size_t numKeys, size_t lookups,
+               size_t &found, size_t &missing)
+    : m_cache(cache), m_first(first), m_numKeys(numKeys), m_lookups(lookups)
+    , m_found(found), m_missing(missing) {}
+
+  void operator()() {
+    for (size_t i = 0; i < m_lookups; ++i) {
+      size_t key = (m_first + i * 7) % m_numKeys;
+      Ptr coll;
+      if (m_cache.Find(key, coll)) {
+        ++m_found;
+        if (!coll) ++m_missing;
+      } else if (!m_cache.Insert(key, Ptr(new TargetPhraseCollection))) {
+        ++m_missing;
+      }
+    }
+  }
+
+private:
+  SharedTargetPhraseCache &m_cache;
+  size_t m_first, m_numKeys, m_lookups;
+  size_t &m_found, &m_missing;
+};
+#endif
+
+}
+
+BOOST_AUTO_TEST_SUITE(shared_target_phrase_cache)
+
+BOOST_AUTO_TEST_CASE(evicts_oldest_past_limit)
+{
+  SharedTargetPhraseCache cache(kStripes * kPerStripe * EntryBytes());
+  Ptr coll;
+
+  for (size_t i = 0; i < kPerStripe; ++i) {
+    BOOST_CHECK(!cache.Find(SameStripeKey(i), coll));
+    cache.Insert(SameStripeKey(i), Ptr());
+  }
+  SharedTargetPhraseCache::Stats stats = cache.GetStats();
+  BOOST_CHECK_EQUAL(stats.entries, kPerStripe);
+  BOOST_CHECK_EQUAL(stats.bytes, kPerStripe * EntryBytes());
+  BOOST_CHECK_EQUAL(stats.evictions, 0);
+
+  // past the limit: the oldest one goes
+  cache.Insert(SameStripeKey(3), Ptr());
+  BOOST_CHECK(!cache.Find(SameStripeKey(0), coll));
+  BOOST_CHECK(cache.Find(SameStripeKey(1), coll));
+  BOOST_CHECK(cache.Find(SameStripeKey(3), coll));
+
+  // key 1 was used since, so key 2 goes next
+  cache.Insert(SameStripeKey(4), Ptr());
+  BOOST_CHECK(!cache.Find(SameStripeKey(2), coll));
+  BOOST_CHECK(cache.Find(SameStripeKey(1), coll));
+  BOOST_CHECK(cache.Find(SameStripeKey(4), coll));
+
+  stats = cache.GetStats();
+  BOOST_CHECK_EQUAL(stats.entries, kPerStripe);
+  BOOST_CHECK_EQUAL(stats.bytes, kPerStripe * EntryBytes());
+  BOOST_CHECK_EQUAL(stats.evictions, 2);
+  BOOST_CHECK_EQUAL(stats.hits, 4);
+  BOOST_CHECK_EQUAL(stats.misses, kPerStripe + 2);
+}
+
+BOOST_AUTO_TEST_CASE(stays_within_limit)
+{
+  const size_t maxBytes = kStripes * kPerStripe * EntryBytes();
+  SharedTargetPhraseCache cache(maxBytes);
+  for (size_t key = 0; key < 1000; ++key) {
+    cache.Insert(key, Ptr());
+  }
+  SharedTargetPhraseCache::Stats stats = cache.GetStats();
+  BOOST_CHECK_LE(stats.bytes, maxBytes);
+  BOOST_CHECK_EQUAL(stats.bytes, stats.entries * EntryBytes());
+  BOOST_CHECK_EQUAL(stats.entries + stats.evictions, 1000);
+}
+
+BOOST_AUTO_TEST_CASE(keeps_first_insert)
+{
+  SharedTargetPhraseCache cache(1 << 20);
+  Ptr first(new TargetPhraseCollection), second(new TargetPhraseCollection);
+  BOOST_CHECK(cache.Insert(5, first) == first);
+  BOOST_CHECK(cache.Insert(5, second) == first);
+  Ptr coll;
+  BOOST_CHECK(cache.Find(5, coll));
+  BOOST_CHECK(coll == first);
+}
+
+#ifdef WITH_THREADS
+BOOST_AUTO_TEST_CASE(concurrent_lookups)
+{
+  // room for about half the keys
+  const size_t numKeys = 400, numThreads = 4, lookups = 20000;
+  TargetPhraseCollection empty;
+  const size_t maxBytes = numKeys / 2 * SharedTargetPhraseCache::EstimateBytes(&empty);
+  SharedTargetPhraseCache cache(maxBytes);
+  vector<size_t> found(numThreads, 0), missing(numThreads, 0);
+  boost::thread_group threads;
+  for (size_t i = 0; i < numThreads; ++i) {
+    threads.create_thread(LookupWorker(cache, i, numKeys, lookups, found[i], missing[i]));
+  }
+  threads.join_all();
+
+  size_t hits = 0;
+  for (size_t i = 0; i < numThreads; ++i) {
+    hits += found[i];
+    BOOST_CHECK_EQUAL(missing[i], 0);
+  }
+  SharedTargetPhraseCache::Stats stats = cache.GetStats();
+  BOOST_CHECK_EQUAL(stats.hits, hits);
+  BOOST_CHECK_EQUAL(stats.hits + stats.misses, numThreads * lookups);
+  BOOST_CHECK_GT(stats.hits, 0);
+  BOOST_CHECK_GT(stats.evictions, 0);
+  BOOST_CHECK_LE(stats.bytes, maxBytes);
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -26,6 +26,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "moses/FF/WordPenaltyProducer.h"
 #include "moses/FF/UnknownWordPenaltyProducer.h"
 #include "moses/FF/InputFeature.h"
+#include "moses/FF/StatefulFeatureFunction.h"
+#include "moses/LM/Base.h"
 
 #include "DecodeStepTranslation.h"
 #include "DecodeStepGeneration.h"
@@ -36,6 +38,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Timer.h"
 #include "UserMessage.h"
 #include "TranslationOption.h"
+#include "TranslationOptionCache.h"
 #include "DecodeGraph.h"
 #include "InputFileStream.h"
 #include "ScoreComponentCollection.h"
@@ -65,6 +68,7 @@ StaticData::StaticData()
   ,m_factorDelimiter("|") // default delimiter between factors
   ,m_lmEnableOOVFeature(false)
   ,m_isAlwaysCreateDirectTranslationOption(false)
+  ,m_transOptCache(NULL)
   ,m_currentWeightSetting("default")
   ,m_treeStructure(NULL)
 {
@@ -78,6 +82,7 @@ StaticData::StaticData()
 StaticData::~StaticData()
 {
   RemoveAllInColl(m_decodeGraphs);
+  delete m_transOptCache;
 
   /*
   const std::vector<FeatureFunction*> &producers = FeatureFunction::GetFeatureFunctions();
@@ -377,6 +382,20 @@ bool StaticData::LoadData(Parameter *parameter)
 
   SetBooleanParameter(&m_cubePruningLazyScoring, "cube-pruning-lazy-scoring", false);
 
+  m_cubePruningEarlyStop = m_parameter->GetParam("cube-pruning-early-stop").size() > 0;
+  m_cubePruningEarlyStopMargin = m_cubePruningEarlyStop
+                                 ? Scan<float>(m_parameter->GetParam("cube-pruning-early-stop")[0]) : 0;
+
+  m_lmPrefetchDistance = (m_parameter->GetParam("lm-prefetch-distance").size() > 0)
+                         ? Scan<size_t>(m_parameter->GetParam("lm-prefetch-distance")[0]) : DEFAULT_LM_PREFETCH_DISTANCE;
+
+  if (m_parameter->GetParam("translation-option-cache-mb").size() > 0) {
+    size_t megabytes = Scan<size_t>(m_parameter->GetParam("translation-option-cache-mb")[0]);
+    if (megabytes > 0) {
+      m_transOptCache = new TranslationOptionCache(megabytes << 20);
+    }
+  }
+
   // early distortion cost
   SetBooleanParameter( &m_useEarlyDistortionCost, "early-distortion-cost", false );
 
@@ -468,6 +487,19 @@ bool StaticData::LoadData(Parameter *parameter)
     }
   }
 
+  m_chartThreadCount = (m_parameter->GetParam("chart-threads").size() > 0) ?
+                       Scan<int>(m_parameter->GetParam("chart-threads")[0]) : 1;
+  if (m_chartThreadCount < 1) {
+    UserMessage::Add("Specify at least one chart thread.");
+    return false;
+  }
+#ifndef WITH_THREADS
+  if (m_chartThreadCount > 1) {
+    UserMessage::Add("Error: chart-threads given but moses not built with thread support");
+    return false;
+  }
+#endif
+
   m_startTranslationId = (m_parameter->GetParam("start-translation-id").size() > 0) ?
                          Scan<long>(m_parameter->GetParam("start-translation-id")[0]) : 0;
 
@@ -535,6 +567,10 @@ bool StaticData::LoadData(Parameter *parameter)
 
   LoadFeatureFunctions();
 
+  if (m_searchAlgorithm == ChartIncremental && !CheckIncrementalFeatures()) {
+    return false;
+  }
+
   if (!LoadDecodeGraphs()) return false;
 
 
@@ -938,6 +974,21 @@ void StaticData::LoadFeatureFunctions()
   CheckLEGACYPT();
 }
 
+bool StaticData::CheckIncrementalFeatures() const
+{
+  // incremental search is driven by the first language model, which must be
+  // KenLM (see LanguageModel::IncrementalCallback).  Other stateful features
+  // are scored alongside it, see Incremental::Manager.
+  const std::vector<const StatefulFeatureFunction*> &statefulFFs = StatefulFeatureFunction::GetStatefulFeatureFunctions();
+  for (size_t i = 0; i < statefulFFs.size(); ++i) {
+    if (dynamic_cast<const LanguageModel*>(statefulFFs[i])) {
+      return true;
+    }
+  }
+  UserMessage::Add("Incremental search (search-algorithm 5) needs a language model");
+  return false;
+}
+
 bool StaticData::CheckWeights() const
 {
   set<string> weightNames = m_parameter->GetWeightNames();
@@ -49,6 +49,7 @@ namespace Moses
 class InputType;
 class DecodeGraph;
 class DecodeStep;
+class TranslationOptionCache;
 
 typedef std::pair<std::string, float> UnknownLHSEntry;
 typedef std::vector<UnknownLHSEntry>  UnknownLHSList;
@@ -173,6 +174,10 @@ protected:
   size_t m_cubePruningPopLimit;
   size_t m_cubePruningDiversity;
   bool m_cubePruningLazyScoring;
+  bool m_cubePruningEarlyStop;
+  float m_cubePruningEarlyStopMargin;
+  size_t m_lmPrefetchDistance;
+  TranslationOptionCache *m_transOptCache; //! NULL unless enabled
   size_t m_ruleLimit;
 
   // Whether to load compact phrase table and reordering table into memory
@@ -187,6 +192,7 @@ protected:
   WordAlignmentSort m_wordAlignmentSort;
 
   int m_threadCount;
+  int m_chartThreadCount;
   long m_startTranslationId;
 
   // alternate weight settings
@@ -309,6 +315,22 @@ public:
   bool GetCubePruningLazyScoring() const {
     return m_cubePruningLazyScoring;
   }
+  //! whether a chart cell stops popping once the queue falls below its beam
+  bool GetCubePruningEarlyStop() const {
+    return m_cubePruningEarlyStop;
+  }
+  //! how far (log) below the beam the queue may fall before the cell stops
+  float GetCubePruningEarlyStopMargin() const {
+    return m_cubePruningEarlyStopMargin;
+  }
+  //! how many hypotheses ahead to prefetch LM entries. 0 = off
+  size_t GetLMPrefetchDistance() const {
+    return m_lmPrefetchDistance;
+  }
+  //! cache of translation options across sentences. NULL if disabled
+  TranslationOptionCache *GetTranslationOptionCache() const {
+    return m_transOptCache;
+  }
   size_t IsPathRecoveryEnabled() const {
     return m_recoverPath;
   }
@@ -608,6 +630,11 @@ public:
     return m_threadCount;
   }
 
+  //! threads that decode the spans of one width in parallel, within one chart sentence
+  int ChartThreadCount() const {
+    return m_chartThreadCount;
+  }
+
   long GetStartTranslationId() const {
     return m_startTranslationId;
   }
@@ -639,6 +666,11 @@ public:
     return m_weightSetting.size() > 0;
   }
 
+  //! whether the configuration has an alternate weight setting of this name
+  bool HasWeightSetting(const std::string &settingName) const {
+    return m_weightSetting.find(settingName) != m_weightSetting.end();
+  }
+
   /** Alternate weight settings allow the wholesale ignoring of
       feature functions. This function checks if a feature function
       should be evaluated given the current weight setting */
@@ -660,6 +692,10 @@ public:
       decoding graphs (typically a translation table). This function
       checks if a feature function should be evaluated given the
       current weight setting */
+  const std::string &GetCurrentWeightSetting() const {
+    return m_currentWeightSetting;
+  }
+
   bool IsDecodingGraphIgnored( const size_t id ) const {
     if (!GetHasAlternateWeightSettings()) {
       return false;
@@ -720,6 +756,7 @@ public:
 
   void LoadFeatureFunctions();
   bool CheckWeights() const;
+  bool CheckIncrementalFeatures() const;
   void LoadSparseWeightsFromConfig();
   bool LoadWeightSettings();
   bool LoadAlternateWeightSettings();
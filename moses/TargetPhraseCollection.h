@@ -95,6 +95,10 @@ public:
   void Detach() {
     m_collection.clear();
   }
+  //! exchange target phrases (and their ownership) with other
+  void Swap(TargetPhraseCollection &other) {
+    m_collection.swap(other.m_collection);
+  }
 
 };
 
@@ -20,6 +20,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 ***********************************************************************/
 
 
+#include <algorithm>
+
 #include "ThreadPool.h"
 
 #ifdef WITH_THREADS
@@ -31,50 +33,86 @@ namespace Moses
 {
 
 ThreadPool::ThreadPool( size_t numThreads )
-  : m_stopped(false), m_stopping(false), m_queueLimit(0)
+  : m_pending(0), m_submitted(0), m_stopped(false), m_stopping(false), m_queueLimit(0)
 {
+  // always keep one queue so that Submit has somewhere to put tasks
+  for (size_t i = 0; i < std::max(numThreads, (size_t) 1); ++i) {
+    m_queues.push_back(new WorkerQueue());
+  }
   for (size_t i = 0; i < numThreads; ++i) {
-    m_threads.create_thread(boost::bind(&ThreadPool::Execute,this));
+    m_threads.create_thread(boost::bind(&ThreadPool::Execute,this,i));
   }
 }
 
-void ThreadPool::Execute()
+ThreadPool::~ThreadPool()
+{
+  Stop();
+  for (size_t i = 0; i < m_queues.size(); ++i) {
+    delete m_queues[i];
+  }
+}
+
+Task *ThreadPool::Take(size_t worker)
+{
+  for (size_t i = 0; i < m_queues.size(); ++i) {
+    // own queue first, then steal from the neighbours in turn
+    WorkerQueue &queue = *m_queues[(worker + i) % m_queues.size()];
+    boost::mutex::scoped_lock lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      Task *task = queue.tasks.top().task;
+      queue.tasks.pop();
+      return task;
+    }
+  }
+  return NULL;
+}
+
+void ThreadPool::Execute(size_t worker)
 {
   do {
     Task* task = NULL;
     {
-      // Find a job to perform
+      // Wait until there is a job to perform
       boost::mutex::scoped_lock lock(m_mutex);
-      if (m_tasks.empty() && !m_stopped) {
+      while (m_pending == 0 && !m_stopped) {
         m_threadNeeded.wait(lock);
       }
-      if (!m_stopped && !m_tasks.empty()) {
-        task = m_tasks.front();
-        m_tasks.pop();
-      }
+      if (m_stopped) break;
+      --m_pending;
+    }
+    // m_pending was non-zero, so some queue holds a task reserved for us
+    while (!task) {
+      task = Take(worker);
     }
     //Execute job
-    if (task) {
-      task->Run();
-      if (task->DeleteAfterExecution()) {
-        delete task;
-      }
+    task->Run();
+    if (task->DeleteAfterExecution()) {
+      delete task;
     }
     m_threadAvailable.notify_all();
   } while (!m_stopped);
 }
 
-void ThreadPool::Submit( Task* task )
+void ThreadPool::Submit( Task* task, size_t cost )
 {
   boost::mutex::scoped_lock lock(m_mutex);
   if (m_stopping) {
     throw runtime_error("ThreadPool stopping - unable to accept new jobs");
   }
-  while (m_queueLimit > 0 && m_tasks.size() >= m_queueLimit) {
+  while (m_queueLimit > 0 && m_pending >= m_queueLimit) {
     m_threadAvailable.wait(lock);
   }
-  m_tasks.push(task);
-  m_threadNeeded.notify_all();
+  QueuedTask queued;
+  queued.task = task;
+  queued.cost = cost;
+  queued.seq = m_submitted++;
+  {
+    WorkerQueue &queue = *m_queues[queued.seq % m_queues.size()];
+    boost::mutex::scoped_lock queueLock(queue.mutex);
+    queue.tasks.push(queued);
+  }
+  ++m_pending;
+  m_threadNeeded.notify_one();
 }
 
 void ThreadPool::Stop(bool processRemainingJobs)
@@ -88,7 +126,7 @@ void ThreadPool::Stop(bool processRemainingJobs)
   if (processRemainingJobs) {
     boost::mutex::scoped_lock lock(m_mutex);
     //wait for queue to drain.
-    while (!m_tasks.empty() && !m_stopped) {
+    while (m_pending > 0 && !m_stopped) {
       m_threadAvailable.wait(lock);
     }
   }
@@ -59,6 +59,15 @@ public:
 
 #ifdef WITH_THREADS
 
+/** A pool of worker threads.
+ *
+ * Every worker owns a queue; submitted tasks are spread over the queues and
+ * a worker whose own queue is empty steals from the others.  Each queue is
+ * ordered by the cost hint given to Submit(), highest first, and in
+ * submission order among equal costs.  Running expensive tasks (e.g. long
+ * sentences) first keeps cores busy at the end of a batch instead of leaving
+ * one straggler to finish alone.
+ */
 class ThreadPool
 {
 public:
@@ -67,14 +76,12 @@ public:
    **/
   explicit ThreadPool(size_t numThreads);
 
-  ~ThreadPool() {
-    Stop();
-  }
+  ~ThreadPool();
 
   /**
-   * Add a job to the threadpool.
+   * Add a job to the threadpool.  Jobs with a higher cost are started first.
    **/
-  void Submit(Task* task);
+  void Submit(Task* task, size_t cost = 0);
 
   /**
    * Wait until all queued jobs have completed, and shut down
@@ -90,16 +97,41 @@ public:
   }
 
 private:
+  struct QueuedTask {
+    Task *task;
+    size_t cost;
+    size_t seq;
+
+    //! priority_queue pops the largest: highest cost, then earliest submitted
+    bool operator<(const QueuedTask &other) const {
+      if (cost != other.cost) return cost < other.cost;
+      return seq > other.seq;
+    }
+  };
+
+  struct WorkerQueue {
+    boost::mutex mutex;
+    std::priority_queue<QueuedTask> tasks;
+  };
+
   /**
    * The main loop executed by each thread.
    **/
-  void Execute();
+  void Execute(size_t worker);
+
+  /**
+   * Take the next task from the worker's own queue, or steal one.
+   * Returns NULL if every queue is empty.
+   **/
+  Task *Take(size_t worker);
 
-  std::queue<Task*> m_tasks;
+  std::vector<WorkerQueue*> m_queues;
   boost::thread_group m_threads;
   boost::mutex m_mutex;
   boost::condition_variable m_threadNeeded;
   boost::condition_variable m_threadAvailable;
+  size_t m_pending; /**< tasks queued but not yet taken. guarded by m_mutex */
+  size_t m_submitted; /**< sequence number of the next task. guarded by m_mutex */
   bool m_stopped;
   bool m_stopping;
   size_t m_queueLimit;
@@ -0,0 +1,123 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013- University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include "ThreadPool.h"
+
+using namespace Moses;
+using namespace std;
+
+#ifdef WITH_THREADS
+
+namespace
+{
+
+/** Records its id when run */
+class RecordTask : public Task
+{
+public:
+  RecordTask(int id, vector<int> &order, boost::mutex &mutex)
+    : m_id(id), m_order(order), m_mutex(mutex) {}
+
+  void Run() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_order.push_back(m_id);
+  }
+
+private:
+  int m_id;
+  vector<int> &m_order;
+  boost::mutex &m_mutex;
+};
+
+/** Blocks the worker until released, so the queue can fill up */
+class GateTask : public Task
+{
+public:
+  GateTask() : m_open(false) {}
+
+  void Run() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (!m_open) m_cond.wait(lock);
+  }
+
+  bool DeleteAfterExecution() {
+    return false;
+  }
+
+  void Open() {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_open = true;
+    m_cond.notify_all();
+  }
+
+private:
+  bool m_open;
+  boost::mutex m_mutex;
+  boost::condition_variable m_cond;
+};
+
+}
+
+BOOST_AUTO_TEST_SUITE(thread_pool)
+
+BOOST_AUTO_TEST_CASE(runs_all_tasks)
+{
+  vector<int> order;
+  boost::mutex mutex;
+  {
+    ThreadPool pool(4);
+    for (int i = 0; i < 1000; ++i) {
+      pool.Submit(new RecordTask(i, order, mutex), i % 7);
+    }
+    pool.Stop(true);
+  }
+  BOOST_REQUIRE_EQUAL(order.size(), 1000);
+  vector<bool> seen(1000, false);
+  for (size_t i = 0; i < order.size(); ++i) {
+    BOOST_CHECK(!seen[order[i]]);
+    seen[order[i]] = true;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(highest_cost_first)
+{
+  vector<int> order;
+  boost::mutex mutex;
+  GateTask gate;
+  ThreadPool pool(1);
+  pool.Submit(&gate);
+  const size_t costs[] = {3, 10, 1, 10, 7};
+  for (int i = 0; i < 5; ++i) {
+    pool.Submit(new RecordTask(i, order, mutex), costs[i]);
+  }
+  gate.Open();
+  pool.Stop(true);
+
+  // by cost, ties in submission order
+  const int expected[] = {1, 3, 4, 0, 2};
+  BOOST_CHECK_EQUAL_COLLECTIONS(order.begin(), order.end(), expected, expected + 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
@@ -17,6 +17,7 @@
   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  ***********************************************************************/
 
+#include <algorithm>
 #include <iostream>
 #include "ChartRuleLookupManagerMemory.h"
 
@@ -45,6 +46,7 @@ ChartRuleLookupManagerMemory::ChartRuleLookupManagerMemory(
   size_t sourceSize = parser.GetSize();
 
   m_completedRules.resize(sourceSize);
+  m_partialRules.resize(sourceSize);
 
   m_isSoftMatching = !m_softMatchingMap.empty();
 }
@@ -57,17 +59,16 @@ void ChartRuleLookupManagerMemory::GetChartRuleCollection(
   size_t startPos = range.GetStartPos();
   size_t absEndPos = range.GetEndPos();
 
+  m_startPos = startPos;
   m_lastPos = lastPos;
-  m_stackVec.clear();
   m_outColl = &outColl;
-  m_unaryPos = absEndPos-1; // rules ending in this position are unary and should not be added to collection
 
-  const PhraseDictionaryNodeMemory &rootNode = m_ruleTable.GetRootNode();
+  const FlatRuleTrie::Node &rootNode = m_ruleTable.GetRootNode();
 
   // size-1 terminal rules
   if (startPos == absEndPos) {
     const Word &sourceWord = GetSourceAt(absEndPos).GetLabel();
-    const PhraseDictionaryNodeMemory *child = rootNode.GetChild(sourceWord);
+    const FlatRuleTrie::Node *child = rootNode.GetChild(sourceWord);
 
     // if we found a new rule -> directly add it to the out collection
     if (child != NULL) {
@@ -75,15 +76,40 @@ void ChartRuleLookupManagerMemory::GetChartRuleCollection(
         outColl.Add(tpc, m_stackVec, range);
     }
   }
-  // all rules starting with nonterminal
   else if (absEndPos > startPos) {
-    GetNonTerminalExtension(&rootNode, startPos, absEndPos-1);
+    std::deque<PartialRule> &partialRules = m_partialRules[startPos];
+
+    // rules starting with nonterminal. on their own they are unary, so they are only kept for extension
+    GetNonTerminalExtension(NULL, &rootNode, startPos, absEndPos-1);
     // all (non-unary) rules starting with terminal
     if (absEndPos == startPos+1) {
-      GetTerminalExtension(&rootNode, absEndPos-1);
+      GetTerminalExtension(NULL, &rootNode, absEndPos-1);
+    }
+
+    // extend the partial rules from this start position, which all end before absEndPos, to absEndPos.
+    // only spans within range are looked at, so ChartManager may visit spans in any order that puts
+    // a span after its subspans
+    for (size_t ind = 0, size = partialRules.size(); ind < size; ++ind) {
+      const PartialRule &prev = partialRules[ind];
+      const FlatRuleTrie::Node *prevNode = static_cast<const FlatRuleTrie::Node*>(prev.m_node);
+      if (prev.m_endPos + 1 == absEndPos) {
+        GetTerminalExtension(&prev, prevNode, absEndPos);
+      }
+      GetNonTerminalExtension(&prev, prevNode, prev.m_endPos+1, absEndPos);
     }
   }
 
+  // prune in the order of a depth-first search, as if every rule had been found as soon as its first symbol
+  std::vector<const PendingRule*> pendingRules(m_pendingRules.size());
+  for (size_t ind = 0; ind < m_pendingRules.size(); ++ind) {
+    pendingRules[ind] = &m_pendingRules[ind];
+  }
+  std::sort(pendingRules.begin(), pendingRules.end(), PendingRuleOrdered());
+  for (vector<const PendingRule*>::const_iterator iter = pendingRules.begin(); iter != pendingRules.end(); ++iter) {
+    m_completedRules[absEndPos].Add(*(*iter)->m_tpc, (*iter)->m_stackVec, outColl);
+  }
+  m_pendingRules.clear();
+
   // copy temporarily stored rules to out collection
   CompletedRuleCollection rules = m_completedRules[absEndPos];
   for (vector<CompletedRule*>::const_iterator iter = rules.begin(); iter != rules.end(); ++iter) {
@@ -94,76 +120,53 @@ void ChartRuleLookupManagerMemory::GetChartRuleCollection(
 
 }
 
-// if a (partial) rule matches, add it to list completed rules (if non-unary and non-empty), and try find expansions that have this partial rule as prefix.
+// if a (partial) rule matches, add it to list completed rules (if non-unary and non-empty), and keep it if it can be extended later.
 void ChartRuleLookupManagerMemory::AddAndExtend(
-    const PhraseDictionaryNodeMemory *node,
+    const PartialRule *prev,
+    const FlatRuleTrie::Node *node,
     size_t endPos,
-    const ChartCellLabel *cellLabel) {
-
-    // add backpointer
-    if (cellLabel != NULL) {
-      m_stackVec.push_back(cellLabel);
-    }
+    const ChartCellLabel *cellLabel,
+    uint64_t order) {
 
     const TargetPhraseCollection &tpc = node->GetTargetPhraseCollection();
     // add target phrase collection (except if rule is empty or unary)
-    if (!tpc.IsEmpty() && endPos != m_unaryPos) {
-      m_completedRules[endPos].Add(tpc, m_stackVec, *m_outColl);
-    }
-
-    // get all further extensions of rule (until reaching end of sentence or max-chart-span)
-    if (endPos < m_lastPos) {
-      if (!node->GetTerminalMap().empty()) {
-        GetTerminalExtension(node, endPos+1);
-      }
-      if (!node->GetNonTerminalMap().empty()) {
-        for (size_t newEndPos = endPos+1; newEndPos <= m_lastPos; newEndPos++) {
-          GetNonTerminalExtension(node, endPos+1, newEndPos);
-        }
-      }
+    if (!tpc.IsEmpty() && prev != NULL) {
+      m_pendingRules.push_back(PendingRule(tpc, *prev, cellLabel, order));
     }
 
-    // remove backpointer
-    if (cellLabel != NULL) {
-      m_stackVec.pop_back();
+    // keep the rule for extensions over spans further right (until reaching end of sentence or max-chart-span)
+    if (endPos < m_lastPos && !node->IsLeaf()) {
+      m_partialRules[m_startPos].push_back(PartialRule(node, endPos, cellLabel, prev, order));
     }
 }
 
 // search all possible terminal extensions of a partial rule (pointed at by node) at a given position
-// recursively try to expand partial rules into full rules up to m_lastPos.
 void ChartRuleLookupManagerMemory::GetTerminalExtension(
-    const PhraseDictionaryNodeMemory *node,
+    const PartialRule *prev,
+    const FlatRuleTrie::Node *node,
     size_t pos) {
 
+    // terminal edges are sorted, so this is a binary search
     const Word &sourceWord = GetSourceAt(pos).GetLabel();
-    const PhraseDictionaryNodeMemory::TerminalMap & terminals = node->GetTerminalMap();
-
-    // if node has small number of terminal edges, test word equality for each.
-    if (terminals.size() < 5) {
-      for (PhraseDictionaryNodeMemory::TerminalMap::const_iterator iter = terminals.begin(); iter != terminals.end(); ++iter) {
-        const Word & word = iter->first;
-        if (word == sourceWord) {
-          const PhraseDictionaryNodeMemory *child = & iter->second;
-          AddAndExtend(child, pos, NULL);
-        }
-      }
-    }
-    // else, do hash lookup
-    else {
-      const PhraseDictionaryNodeMemory *child = node->GetChild(sourceWord);
-      if (child != NULL) {
-        AddAndExtend(child, pos, NULL);
-      }
+    const FlatRuleTrie::Node *child = node->GetChild(sourceWord);
+    if (child != NULL) {
+      AddAndExtend(prev, child, pos, NULL, PartialRule::TerminalOrder());
     }
 }
 
 // search all nonterminal possible nonterminal extensions of a partial rule (pointed at by node) for a given span (StartPos, endPos).
-// recursively try to expand partial rules into full rules up to m_lastPos.
 void ChartRuleLookupManagerMemory::GetNonTerminalExtension(
-    const PhraseDictionaryNodeMemory *node,
+    const PartialRule *prev,
+    const FlatRuleTrie::Node *node,
     size_t startPos,
     size_t endPos) {
 
+    // non-terminal labels in phrase dictionary node
+    const size_t numNonTerms = node->GetNumNonTerminals();
+    if (numNonTerms == 0) {
+      return;
+    }
+
     // target non-terminal labels for the span
     const ChartCellLabelSet &targetNonTerms = GetTargetLabelSet(startPos, endPos);
 
@@ -182,18 +185,16 @@ void ChartRuleLookupManagerMemory::GetNonTerminalExtension(
     }
 #endif
 
-    // non-terminal labels in phrase dictionary node
-    const PhraseDictionaryNodeMemory::NonTerminalMap & nonTermMap = node->GetNonTerminalMap();
+    // how far the extension reaches beyond the partial rule, for ordering
+    const size_t endOffset = prev ? endPos - prev->m_endPos : 0;
 
     // loop over possible expansions of the rule
-    PhraseDictionaryNodeMemory::NonTerminalMap::const_iterator p;
-    PhraseDictionaryNodeMemory::NonTerminalMap::const_iterator end = nonTermMap.end();
-    for (p = nonTermMap.begin(); p != end; ++p) {
+    for (size_t labelIndex = 0; labelIndex < numNonTerms; ++labelIndex) {
       // does it match possible source and target non-terminals?
 #if defined(UNLABELLED_SOURCE)
-      const Word &targetNonTerm = p->first;
+      const Word &targetNonTerm = node->GetNonTerminal(labelIndex);
 #else
-      const PhraseDictionaryNodeMemory::NonTerminalMapKey &key = p->first;
+      const FlatRuleTrie::NonTerminalKey &key = node->GetNonTerminal(labelIndex);
       const Word &sourceNonTerm = key.first;
       // check if source label matches
       if (! sourceNonTermArray[sourceNonTerm[0]->GetId()]) {
@@ -201,17 +202,18 @@ void ChartRuleLookupManagerMemory::GetNonTerminalExtension(
       }
       const Word &targetNonTerm = key.second;
 #endif
+      size_t softMatchIndex = 0;
       //soft matching of NTs
       if (m_isSoftMatching && !m_softMatchingMap[targetNonTerm[0]->GetId()].empty()) {
         const std::vector<Word>& softMatches = m_softMatchingMap[targetNonTerm[0]->GetId()];
-        for (std::vector<Word>::const_iterator softMatch = softMatches.begin(); softMatch != softMatches.end(); ++softMatch) {
+        for (std::vector<Word>::const_iterator softMatch = softMatches.begin(); softMatch != softMatches.end(); ++softMatch, ++softMatchIndex) {
           const ChartCellLabel *cellLabel = targetNonTerms.Find(*softMatch);
           if (cellLabel == NULL) {
             continue;
           }
           // create new rule
-          const PhraseDictionaryNodeMemory &child = p->second;
-          AddAndExtend(&child, endPos, cellLabel);
+          const FlatRuleTrie::Node &child = node->GetNonTerminalChild(labelIndex);
+          AddAndExtend(prev, &child, endPos, cellLabel, PartialRule::NonTerminalOrder(endOffset, labelIndex, softMatchIndex));
         }
       } // end of soft matches lookup
 
@@ -220,8 +222,8 @@ void ChartRuleLookupManagerMemory::GetNonTerminalExtension(
         continue;
       }
       // create new rule
-      const PhraseDictionaryNodeMemory &child = p->second;
-      AddAndExtend(&child, endPos, cellLabel);
+      const FlatRuleTrie::Node &child = node->GetNonTerminalChild(labelIndex);
+      AddAndExtend(prev, &child, endPos, cellLabel, PartialRule::NonTerminalOrder(endOffset, labelIndex, softMatchIndex));
     }
 }
 
@@ -21,13 +21,14 @@
 #ifndef moses_ChartRuleLookupManagerMemory_h
 #define moses_ChartRuleLookupManagerMemory_h
 
+#include <deque>
 #include <vector>
 
 #include "ChartRuleLookupManagerCYKPlus.h"
 #include "CompletedRuleCollection.h"
 #include "moses/NonTerminal.h"
 #include "moses/TranslationModel/PhraseDictionaryMemory.h"
-#include "moses/TranslationModel/PhraseDictionaryNodeMemory.h"
+#include "moses/TranslationModel/FlatRuleTrie.h"
 #include "moses/StackVec.h"
 
 namespace Moses
@@ -54,18 +55,22 @@ public:
 private:
 
 void GetTerminalExtension(
-    const PhraseDictionaryNodeMemory *node,
+    const PartialRule *prev,
+    const FlatRuleTrie::Node *node,
     size_t pos);
 
 void GetNonTerminalExtension(
-    const PhraseDictionaryNodeMemory *node,
+    const PartialRule *prev,
+    const FlatRuleTrie::Node *node,
     size_t startPos,
     size_t endPos);
 
   void AddAndExtend(
-    const PhraseDictionaryNodeMemory *node,
+    const PartialRule *prev,
+    const FlatRuleTrie::Node *node,
     size_t endPos,
-    const ChartCellLabel *cellLabel);
+    const ChartCellLabel *cellLabel,
+    uint64_t order);
 
   const PhraseDictionaryMemory &m_ruleTable;
 
@@ -76,8 +81,14 @@ void GetNonTerminalExtension(
   // temporary storage of completed rules (one collection per end position; all rules collected consecutively start from the same position)
   std::vector<CompletedRuleCollection> m_completedRules;
 
+  // partial rules that may be extended further, one list per start position
+  std::vector<std::deque<PartialRule> > m_partialRules;
+
+  // rules ending at the current end position, before pruning
+  std::vector<PendingRule> m_pendingRules;
+
+  size_t m_startPos;
   size_t m_lastPos;
-  size_t m_unaryPos;
 
   StackVec m_stackVec;
   ChartParserCallback* m_outColl;
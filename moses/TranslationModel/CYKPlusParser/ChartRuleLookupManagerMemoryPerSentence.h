@@ -21,6 +21,7 @@
 #ifndef moses_ChartRuleLookupManagerMemoryPerSentence_h
 #define moses_ChartRuleLookupManagerMemoryPerSentence_h
 
+#include <deque>
 #include <vector>
 
 #include "ChartRuleLookupManagerCYKPlus.h"
@@ -54,18 +55,22 @@ public:
 private:
 
 void GetTerminalExtension(
+    const PartialRule *prev,
     const PhraseDictionaryNodeMemory *node,
     size_t pos);
 
 void GetNonTerminalExtension(
+    const PartialRule *prev,
     const PhraseDictionaryNodeMemory *node,
     size_t startPos,
     size_t endPos);
 
   void AddAndExtend(
+    const PartialRule *prev,
     const PhraseDictionaryNodeMemory *node,
     size_t endPos,
-    const ChartCellLabel *cellLabel);
+    const ChartCellLabel *cellLabel,
+    uint64_t order);
 
   const PhraseDictionaryFuzzyMatch &m_ruleTable;
 
@@ -76,8 +81,14 @@ void GetNonTerminalExtension(
   // temporary storage of completed rules (one collection per end position; all rules collected consecutively start from the same position)
   std::vector<CompletedRuleCollection> m_completedRules;
 
+  // partial rules that may be extended further, one list per start position
+  std::vector<std::deque<PartialRule> > m_partialRules;
+
+  // rules ending at the current end position, before pruning
+  std::vector<PendingRule> m_pendingRules;
+
+  size_t m_startPos;
   size_t m_lastPos;
-  size_t m_unaryPos;
 
   StackVec m_stackVec;
   ChartParserCallback* m_outColl;
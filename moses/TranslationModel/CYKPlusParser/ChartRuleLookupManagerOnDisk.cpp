@@ -237,18 +237,15 @@ void ChartRuleLookupManagerOnDisk::GetChartRuleCollection(
           std::map<UINT64, const TargetPhraseCollection*>::const_iterator iterCache = m_cache.find(tpCollFilePos);
           if (iterCache == m_cache.end()) {
 
-            const OnDiskPt::TargetPhraseCollection *tpcollBerkeleyDb = node->GetTargetPhraseCollection(m_dictionary.GetTableLimit(), m_dbWrapper);
-
             std::vector<float> weightT = staticData.GetWeights(&m_dictionary);
             targetPhraseCollection
-            = tpcollBerkeleyDb->ConvertToMoses(m_inputFactorsVec
-                                               ,m_outputFactorsVec
-                                               ,m_dictionary
-                                               ,weightT
-                                               ,m_dbWrapper.GetVocab()
-                                               ,true);
-
-            delete tpcollBerkeleyDb;
+            = node->GetMosesTargetPhraseCollection(m_dictionary.GetTableLimit()
+                                                   ,m_inputFactorsVec
+                                                   ,m_outputFactorsVec
+                                                   ,m_dictionary
+                                                   ,weightT
+                                                   ,true
+                                                   ,m_dbWrapper);
             m_cache[tpCollFilePos] = targetPhraseCollection;
           } else {
             // just get out of cache
@@ -72,4 +72,29 @@ void CompletedRuleCollection::Add(const TargetPhraseCollection &tpc,
   }
 }
 
-}
\ No newline at end of file
+PendingRule::PendingRule(const TargetPhraseCollection &tpc,
+                         const PartialRule &prefix,
+                         const ChartCellLabel *cellLabel,
+                         uint64_t order)
+  : m_tpc(&tpc)
+{
+  std::vector<const PartialRule*> symbols;
+  for (const PartialRule *rule = &prefix; rule != NULL; rule = rule->m_prev) {
+    symbols.push_back(rule);
+  }
+
+  m_key.reserve(symbols.size() + 2);
+  m_key.push_back(symbols.back()->m_endPos);
+  for (std::vector<const PartialRule*>::const_reverse_iterator iter = symbols.rbegin(); iter != symbols.rend(); ++iter) {
+    m_key.push_back((*iter)->m_order);
+    if ((*iter)->m_cellLabel != NULL) {
+      m_stackVec.push_back((*iter)->m_cellLabel);
+    }
+  }
+  m_key.push_back(order);
+  if (cellLabel != NULL) {
+    m_stackVec.push_back(cellLabel);
+  }
+}
+
+}
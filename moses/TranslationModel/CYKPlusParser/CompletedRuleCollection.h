@@ -23,6 +23,8 @@
 
 #include <vector>
 
+#include <stdint.h>
+
 #include "moses/StackVec.h"
 #include "moses/TargetPhraseCollection.h"
 #include "moses/ChartTranslationOptions.h"
@@ -71,6 +73,73 @@ public:
   }
 };
 
+/* a rule prefix that matches the input from a start position up to endPos,
+ * kept until it has been extended by the symbols of every span further right.
+ * order ranks it among the extensions of prev (or, if prev is NULL, of the
+ * rule trie root), as a depth-first search would find them: first the
+ * terminal at endPos+1, then nonterminals by increasing end position, each
+ * in the order of the node's nonterminal map, soft matches before the label
+ * itself.
+ * node is the rule table trie node the prefix leads to; its type depends on
+ * the rule table (like the node pointers kept in InputPath).
+ */
+struct PartialRule
+{
+public:
+  PartialRule(const void *node,
+              size_t endPos,
+              const ChartCellLabel *cellLabel,
+              const PartialRule *prev,
+              uint64_t order)
+    : m_node(node)
+    , m_endPos(endPos)
+    , m_cellLabel(cellLabel)
+    , m_prev(prev)
+    , m_order(order) {}
+
+  //! order of the terminal extension
+  static uint64_t TerminalOrder() {
+    return 1ULL << 40;
+  }
+
+  //! order of a nonterminal extension ending endOffset words after the prefix
+  static uint64_t NonTerminalOrder(size_t endOffset, size_t labelIndex, size_t softMatchIndex) {
+    return (uint64_t(endOffset) << 40) | (uint64_t(labelIndex + 1) << 16) | softMatchIndex;
+  }
+
+  const void *m_node;
+  size_t m_endPos;
+  const ChartCellLabel *m_cellLabel; // NULL if the last symbol is a terminal
+  const PartialRule *m_prev;         // NULL for the first symbol
+  uint64_t m_order;
+};
+
+/* a rule found while extending partial rules, before it goes through the
+ * pruning of CompletedRuleCollection.  Rules are pruned in the order a
+ * depth-first search from the first symbol would have found them, so the
+ * surviving rules do not depend on the order in which spans are visited.
+ */
+struct PendingRule
+{
+public:
+  PendingRule(const TargetPhraseCollection &tpc,
+              const PartialRule &prefix,
+              const ChartCellLabel *cellLabel,
+              uint64_t order);
+
+  const TargetPhraseCollection *m_tpc;
+  StackVec m_stackVec;
+  std::vector<uint64_t> m_key; // end of the first symbol, then the order of each symbol
+};
+
+class PendingRuleOrdered
+{
+public:
+  bool operator()(const PendingRule* itemA, const PendingRule* itemB) const {
+    return itemA->m_key < itemB->m_key;
+  }
+};
+
 struct CompletedRuleCollection
 {
 public:
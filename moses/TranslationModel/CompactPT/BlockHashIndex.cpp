@@ -36,7 +36,7 @@ BlockHashIndex::BlockHashIndex(size_t orderBits, size_t fingerPrintBits,
   : m_orderBits(orderBits), m_fingerPrintBits(fingerPrintBits),
     m_fileHandle(0), m_fileHandleStart(0), m_size(0),
     m_lastSaved(-1), m_lastDropped(-1), m_numLoadedRanges(0),
-    m_threadPool(threadsNum)
+    m_fullyLoaded(false), m_threadPool(threadsNum)
 {
 #ifndef HAVE_CMPH
   std::cerr << "minphr: CMPH support not compiled in." << std::endl;
@@ -47,7 +47,8 @@ BlockHashIndex::BlockHashIndex(size_t orderBits, size_t fingerPrintBits,
 BlockHashIndex::BlockHashIndex(size_t orderBits, size_t fingerPrintBits)
   : m_orderBits(orderBits), m_fingerPrintBits(fingerPrintBits),
     m_fileHandle(0), m_fileHandleStart(0), m_size(0),
-    m_lastSaved(-1), m_lastDropped(-1), m_numLoadedRanges(0)
+    m_lastSaved(-1), m_lastDropped(-1), m_numLoadedRanges(0),
+    m_fullyLoaded(false)
 {
 #ifndef HAVE_CMPH
   std::cerr << "minphr: CMPH support not compiled in." << std::endl;
@@ -71,7 +72,7 @@ BlockHashIndex::~BlockHashIndex()
 #endif
 }
 
-size_t BlockHashIndex::GetHash(const char* key)
+size_t BlockHashIndex::GetRange(const char* key) const
 {
   std::string keyStr(key);
   size_t i = std::distance(m_landmarks.begin(),
@@ -79,6 +80,19 @@ size_t BlockHashIndex::GetHash(const char* key)
                                m_landmarks.end(), keyStr)) - 1;
 
   if(i == 0ul-1)
+    return GetNumRanges();
+  return i;
+}
+
+size_t BlockHashIndex::GetNumRanges() const
+{
+  return m_landmarks.size();
+}
+
+size_t BlockHashIndex::GetHash(const char* key)
+{
+  size_t i = GetRange(key);
+  if(i == GetNumRanges())
     return GetSize();
 
   size_t pos = GetHash(i, key);
@@ -99,7 +113,9 @@ size_t BlockHashIndex::GetFprint(const char* key) const
 size_t BlockHashIndex::GetHash(size_t i, const char* key)
 {
 #ifdef WITH_THREADS
-  boost::mutex::scoped_lock lock(m_mutex);
+  boost::mutex::scoped_lock lock(m_mutex, boost::defer_lock);
+  if(!m_fullyLoaded)
+    lock.lock();
 #endif
   if(m_hashes[i] == 0)
     LoadRange(i);
@@ -111,7 +127,8 @@ size_t BlockHashIndex::GetHash(size_t i, const char* key)
 #endif
 
   std::pair<size_t, size_t> orderPrint = m_arrays[i]->Get(idx, m_orderBits, m_fingerPrintBits);
-  m_clocks[i] = clock();
+  if(!m_fullyLoaded)
+    m_clocks[i] = clock();
 
   if(GetFprint(key) == orderPrint.second)
     return orderPrint.first;
@@ -182,15 +199,14 @@ void BlockHashIndex::SaveLastRange()
 void BlockHashIndex::DropRange(size_t i)
 {
 #ifdef HAVE_CMPH
-  if(m_hashes[i] != 0) {
-    cmph_destroy((cmph_t*)m_hashes[i]);
-    m_hashes[i] = 0;
-  }
-  if(m_arrays[i] != 0) {
-    delete m_arrays[i];
-    m_arrays[i] = 0;
-    m_clocks[i] = 0;
-  }
+  if(m_hashes[i] == 0)
+    return;
+
+  cmph_destroy((cmph_t*)m_hashes[i]);
+  m_hashes[i] = 0;
+  delete m_arrays[i];
+  m_arrays[i] = 0;
+  m_clocks[i] = 0;
   m_numLoadedRanges--;
 #endif
 }
@@ -311,6 +327,7 @@ size_t BlockHashIndex::Load(std::FILE * mphf)
 
   for(size_t i = 0; i < m_seekIndex.size(); i++)
     LoadRange(i);
+  m_fullyLoaded = true;
   std::fseek(m_fileHandle, end, SEEK_SET);
   return byteSize;
 }
@@ -334,9 +351,11 @@ void BlockHashIndex::KeepNLastRanges(float ratio, float tolerance)
       if(m_hashes[i] != 0)
         lastLoaded.push_back(std::make_pair(m_clocks[i], i));
 
-    std::sort(lastLoaded.begin(), lastLoaded.end());
-    for(LastLoaded::reverse_iterator it = lastLoaded.rbegin() + size_t(n * (1 - tolerance));
-        it != lastLoaded.rend(); it++)
+    // only the oldest ranges have to be found, not sorted
+    size_t keep = std::min(size_t(n * (1 - tolerance)), lastLoaded.size());
+    LastLoaded::iterator oldest = lastLoaded.end() - keep;
+    std::nth_element(lastLoaded.begin(), oldest, lastLoaded.end());
+    for(LastLoaded::iterator it = lastLoaded.begin(); it != oldest; it++)
       DropRange(it->second);
   }
 }
@@ -399,6 +418,7 @@ void BlockHashIndex::CalcHash(size_t current, void* source_void)
   m_arrays[current] = pv;
   m_clocks[current] = clock();
   m_queue.push(-current);
+  m_numLoadedRanges++;
 #endif
 }
 
@@ -68,6 +68,10 @@ private:
   int m_lastDropped;
   size_t m_numLoadedRanges;
 
+  // set by Load(): all ranges are in memory for good, so lookups need
+  // neither the lock nor the clocks
+  bool m_fullyLoaded;
+
 #ifdef WITH_THREADS
   ThreadPool m_threadPool;
   boost::mutex m_mutex;
@@ -110,6 +114,10 @@ public:
   size_t GetHash(const char* key);
   size_t GetHash(std::string key);
 
+  //! range (block) a key falls into, or GetNumRanges() if none
+  size_t GetRange(const char* key) const;
+  size_t GetNumRanges() const;
+
   size_t operator[](std::string key);
   size_t operator[](char* key);
 
@@ -51,7 +51,8 @@ public:
 
   PackedArray(size_t size, size_t bits) : m_size(size) {
     m_storageSize = ceil(float(bits * size) / float(m_dataBits));
-    m_storage = new D[m_storageSize];
+    // zeroed, Set leaves the padding bits alone and they are saved too
+    m_storage = new D[m_storageSize]();
   }
 
   PackedArray(const PackedArray<T, D> &c) {
@@ -43,7 +43,10 @@ PhraseDecoder::PhraseDecoder(
     m_phraseDictionary(phraseDictionary), m_input(input), m_output(output),
     m_weight(weight),
     m_separator(" ||| ")
-{ }
+{
+  size_t threads = std::max(StaticData::Instance().ThreadCount(), 1);
+  m_decodingCacheSize = std::max<size_t>(5000 / threads, 1000);
+}
 
 PhraseDecoder::~PhraseDecoder()
 {
@@ -58,15 +61,27 @@ PhraseDecoder::~PhraseDecoder()
     delete m_alignTree;
 }
 
+PhraseDecoder::DecodingContext &PhraseDecoder::GetContext()
+{
+  DecodingContext *context = m_context.get();
+  if(context == NULL) {
+    context = new DecodingContext(m_decodingCacheSize);
+    m_context.reset(context);
+  }
+  return *context;
+}
+
 inline unsigned PhraseDecoder::GetSourceSymbolId(std::string& symbol)
 {
+  boost::unordered_map<std::string, unsigned> &sourceSymbolsMap
+  = GetContext().m_sourceSymbolsMap;
   boost::unordered_map<std::string, unsigned>::iterator it
-  = m_sourceSymbolsMap.find(symbol);
-  if(it != m_sourceSymbolsMap.end())
+  = sourceSymbolsMap.find(symbol);
+  if(it != sourceSymbolsMap.end())
     return it->second;
 
   size_t idx = m_sourceSymbols.find(symbol);
-  m_sourceSymbolsMap[symbol] = idx;
+  sourceSymbolsMap[symbol] = idx;
   return idx;
 }
 
@@ -190,7 +205,8 @@ std::string PhraseDecoder::MakeSourceKey(std::string &source)
   return source + m_separator;
 }
 
-TargetPhraseVectorPtr PhraseDecoder::CreateTargetPhraseCollection(const Phrase &sourcePhrase, bool topLevel, bool eval)
+TargetPhraseVectorPtr PhraseDecoder::CreateTargetPhraseCollection(const Phrase &sourcePhrase, bool topLevel, bool eval,
+    const std::string *sourceKey)
 {
 
   // Not using TargetPhraseCollection avoiding "new" operator
@@ -200,7 +216,7 @@ TargetPhraseVectorPtr PhraseDecoder::CreateTargetPhraseCollection(const Phrase &
 
   if(m_coding == PREnc) {
     std::pair<TargetPhraseVectorPtr, size_t> cachedPhraseColl
-    = m_decodingCache.Retrieve(sourcePhrase);
+    = GetContext().m_decodingCache.Retrieve(sourcePhrase);
 
     // Has been cached and is complete or does not need to be completed
     if(cachedPhraseColl.first != NULL && (!topLevel || cachedPhraseColl.second == 0))
@@ -217,8 +233,13 @@ TargetPhraseVectorPtr PhraseDecoder::CreateTargetPhraseCollection(const Phrase &
   }
 
   // Retrieve source phrase identifier
-  std::string sourcePhraseString = sourcePhrase.GetStringRep(*m_input);
-  size_t sourcePhraseId = m_phraseDictionary.m_hash[MakeSourceKey(sourcePhraseString)];
+  size_t sourcePhraseId;
+  if(sourceKey)
+    sourcePhraseId = m_phraseDictionary.m_hash.GetHash(sourceKey->c_str());
+  else {
+    std::string sourcePhraseString = sourcePhrase.GetStringRep(*m_input);
+    sourcePhraseId = m_phraseDictionary.m_hash[MakeSourceKey(sourcePhraseString)];
+  }
 
   if(sourcePhraseId != m_phraseDictionary.m_hash.GetSize()) {
     // Retrieve compressed and encoded target phrase collection
@@ -438,7 +459,7 @@ TargetPhraseVectorPtr PhraseDecoder::DecodeCollection(
 
   if(m_coding == PREnc && !extending) {
     bitsLeft = bitsLeft > 8 ? bitsLeft : 0;
-    m_decodingCache.Cache(sourcePhrase, tpv, bitsLeft, m_maxRank);
+    GetContext().m_decodingCache.Cache(sourcePhrase, tpv, bitsLeft, m_maxRank);
   }
 
   return tpv;
@@ -446,7 +467,7 @@ TargetPhraseVectorPtr PhraseDecoder::DecodeCollection(
 
 void PhraseDecoder::PruneCache()
 {
-  m_decodingCache.Prune();
+  GetContext().m_decodingCache.Prune();
 }
 
 }
@@ -26,6 +26,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <vector>
 #include <boost/unordered_map.hpp>
 #include <boost/unordered_set.hpp>
+#include <boost/scoped_ptr.hpp>
+#ifdef WITH_THREADS
+#include <boost/thread/tss.hpp>
+#endif
 #include <string>
 #include <iterator>
 #include <algorithm>
@@ -66,7 +70,6 @@ protected:
   size_t m_maxRank;
   size_t m_maxPhraseLength;
 
-  boost::unordered_map<std::string, unsigned> m_sourceSymbolsMap;
   StringVector<unsigned char, unsigned, std::allocator> m_sourceSymbols;
   StringVector<unsigned char, unsigned, std::allocator> m_targetSymbols;
 
@@ -80,7 +83,30 @@ protected:
 
   CanonicalHuffman<AlignPoint>* m_alignTree;
 
-  TargetPhraseCollectionCache m_decodingCache;
+  // State that decoding changes as it goes. Each thread has its own, so
+  // lookups from several threads never wait for each other.
+  struct DecodingContext {
+    DecodingContext(size_t cacheSize) : m_decodingCache(cacheSize) {}
+
+    // ids of the source words seen so far
+    boost::unordered_map<std::string, unsigned> m_sourceSymbolsMap;
+    // recently decoded collections, reused for PREnc subphrases. A thread
+    // only hits what it decoded itself
+    TargetPhraseCollectionCache m_decodingCache;
+  };
+
+  // entries of each thread's decoding cache: the threads split what a
+  // single cache used to hold (5000 collections), but each keeps at least
+  // 1000, so more than five threads hold up to 1000 each
+  size_t m_decodingCacheSize;
+
+#ifdef WITH_THREADS
+  boost::thread_specific_ptr<DecodingContext> m_context;
+#else
+  boost::scoped_ptr<DecodingContext> m_context;
+#endif
+
+  DecodingContext &GetContext();
 
   PhraseDictionaryCompact& m_phraseDictionary;
 
@@ -130,8 +156,11 @@ public:
 
   size_t Load(std::FILE* in);
 
+  // sourceKey is the MakeSourceKey() key of sourcePhrase if the caller has
+  // already made it
   TargetPhraseVectorPtr CreateTargetPhraseCollection(const Phrase &sourcePhrase,
-      bool topLevel = false, bool eval = true);
+      bool topLevel = false, bool eval = true,
+      const std::string *sourceKey = NULL);
 
   TargetPhraseVectorPtr DecodeCollection(TargetPhraseVectorPtr tpv,
                                          BitWrapper<> &encodedBitStream,
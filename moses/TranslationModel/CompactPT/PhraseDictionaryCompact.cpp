@@ -102,6 +102,16 @@ void PhraseDictionaryCompact::Load()
 		  "Not successfully loaded");
 }
 
+void PhraseDictionaryCompact::SetParameter(const std::string& key, const std::string& value)
+{
+  if (key == "in-memory") {
+    // false keeps the source phrase index and target phrases memory-mapped
+    m_inMemory = Scan<bool>(value);
+  } else {
+    PhraseDictionary::SetParameter(key, value);
+  }
+}
+
 // now properly declared in TargetPhraseCollection.h
 // and defined in TargetPhraseCollection.cpp
 // struct CompareTargetPhrase {
@@ -112,6 +122,13 @@ void PhraseDictionaryCompact::Load()
 
 const TargetPhraseCollection*
 PhraseDictionaryCompact::GetTargetPhraseCollectionNonCacheLEGACY(const Phrase &sourcePhrase) const
+{
+  return GetTargetPhraseCollectionNonCacheLEGACY(sourcePhrase, NULL);
+}
+
+const TargetPhraseCollection*
+PhraseDictionaryCompact::GetTargetPhraseCollectionNonCacheLEGACY(const Phrase &sourcePhrase,
+    const std::string *sourceKey) const
 {
 
   // There is no souch source phrase if source phrase is longer than longest
@@ -121,7 +138,7 @@ PhraseDictionaryCompact::GetTargetPhraseCollectionNonCacheLEGACY(const Phrase &s
 
   // Retrieve target phrase collection from phrase table
   TargetPhraseVectorPtr decodedPhraseColl
-  = m_phraseDecoder->CreateTargetPhraseCollection(sourcePhrase, true, true);
+  = m_phraseDecoder->CreateTargetPhraseCollection(sourcePhrase, true, true, sourceKey);
 
   if(decodedPhraseColl != NULL && decodedPhraseColl->size()) {
     TargetPhraseVectorPtr tpv(new TargetPhraseVector(*decodedPhraseColl));
@@ -145,6 +162,81 @@ PhraseDictionaryCompact::GetTargetPhraseCollectionNonCacheLEGACY(const Phrase &s
     return NULL;
 }
 
+namespace
+{
+struct RangeLookup {
+  size_t m_range;
+  std::string m_key;
+  InputPath *m_node;
+
+  RangeLookup(size_t range, const std::string &key, InputPath *node)
+    : m_range(range), m_key(key), m_node(node) {}
+};
+
+bool CompareRange(const RangeLookup &a, const RangeLookup &b)
+{
+  return a.m_range < b.m_range;
+}
+}
+
+void
+PhraseDictionaryCompact::GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const
+{
+  // In memory there is no locality to gain from the lookup order
+  if(m_inMemory) {
+    PhraseDictionary::GetTargetPhraseCollectionBatch(inputPathQueue);
+    return;
+  }
+
+  // Look up the source phrases of the sentence that are not cached in the
+  // order of the hash index ranges they fall into. The target phrase
+  // collections are stored in the same order, so both memory-mapped
+  // structures are read front to back instead of jumping around.
+  typedef std::vector<RangeLookup> Batch;
+  Batch batch;
+  batch.reserve(inputPathQueue.size());
+
+  for(InputPathList::const_iterator it = inputPathQueue.begin();
+      it != inputPathQueue.end(); ++it) {
+    InputPath &node = **it;
+    const Phrase &sourcePhrase = node.GetPhrase();
+
+    // There is no such source phrase if source phrase is longer than longest
+    // observed source phrase during compilation
+    if(sourcePhrase.GetSize() > m_phraseDecoder->GetMaxSourcePhraseLength()) {
+      node.SetTargetPhrases(*this, NULL, NULL);
+      continue;
+    }
+
+    const TargetPhraseCollection *targetPhrases;
+    if(FindInCache(sourcePhrase, targetPhrases)) {
+      node.SetTargetPhrases(*this, targetPhrases, NULL);
+      continue;
+    }
+
+    std::string sourcePhraseString = sourcePhrase.GetStringRep(m_input);
+    std::string sourceKey = m_phraseDecoder->MakeSourceKey(sourcePhraseString);
+    size_t range = m_hash.GetRange(sourceKey.c_str());
+    if(range == m_hash.GetNumRanges())
+      node.SetTargetPhrases(*this, NULL, NULL);
+    else
+      batch.push_back(RangeLookup(range, sourceKey, &node));
+  }
+
+  std::stable_sort(batch.begin(), batch.end(), CompareRange);
+  for(Batch::iterator it = batch.begin(); it != batch.end(); ++it) {
+    InputPath &node = *it->m_node;
+    const Phrase &sourcePhrase = node.GetPhrase();
+
+    // the same phrase may occur more than once in the sentence
+    const TargetPhraseCollection *targetPhrases;
+    if(!FindInCache(sourcePhrase, targetPhrases))
+      targetPhrases = AddToCache(sourcePhrase,
+                                 GetTargetPhraseCollectionNonCacheLEGACY(sourcePhrase, &it->m_key));
+    node.SetTargetPhrases(*this, targetPhrases, NULL);
+  }
+}
+
 TargetPhraseVectorPtr
 PhraseDictionaryCompact::GetTargetPhraseCollectionRaw(const Phrase &sourcePhrase) const
 {
@@ -166,15 +258,19 @@ PhraseDictionaryCompact::~PhraseDictionaryCompact()
 
 //TO_STRING_BODY(PhraseDictionaryCompact)
 
+PhraseDictionaryCompact::PhraseCache &PhraseDictionaryCompact::GetSentenceCache()
+{
+  PhraseCache *cache = m_sentenceCache.get();
+  if(cache == NULL) {
+    cache = new PhraseCache;
+    m_sentenceCache.reset(cache);
+  }
+  return *cache;
+}
+
 void PhraseDictionaryCompact::CacheForCleanup(TargetPhraseCollection* tpc)
 {
-#ifdef WITH_THREADS
-  boost::mutex::scoped_lock lock(m_sentenceMutex);
-  PhraseCache &ref = m_sentenceCache[boost::this_thread::get_id()];
-#else
-  PhraseCache &ref = m_sentenceCache;
-#endif
-  ref.push_back(tpc);
+  GetSentenceCache().push_back(tpc);
 }
 
 void PhraseDictionaryCompact::AddEquivPhrase(const Phrase &source,
@@ -187,13 +283,7 @@ void PhraseDictionaryCompact::CleanUpAfterSentenceProcessing(const InputType &so
 
   m_phraseDecoder->PruneCache();
 
-#ifdef WITH_THREADS
-  boost::mutex::scoped_lock lock(m_sentenceMutex);
-  PhraseCache &ref = m_sentenceCache[boost::this_thread::get_id()];
-#else
-  PhraseCache &ref = m_sentenceCache;
-#endif
-
+  PhraseCache &ref = GetSentenceCache();
   for(PhraseCache::iterator it = ref.begin(); it != ref.end(); it++)
     delete *it;
 
@@ -24,10 +24,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <boost/unordered_map.hpp>
 
+#include <boost/scoped_ptr.hpp>
 #ifdef WITH_THREADS
-#ifdef BOOST_HAS_PTHREADS
-#include <boost/thread/mutex.hpp>
-#endif
+#include <boost/thread/tss.hpp>
 #endif
 
 #include "moses/TranslationModel/PhraseDictionary.h"
@@ -51,14 +50,18 @@ protected:
   bool m_inMemory;
   bool m_useAlignmentInfo;
 
+  // collections handed out for the current sentence of each thread
   typedef std::vector<TargetPhraseCollection*> PhraseCache;
 #ifdef WITH_THREADS
-  boost::mutex m_sentenceMutex;
-  typedef std::map<boost::thread::id, PhraseCache> SentenceCache;
+  boost::thread_specific_ptr<PhraseCache> m_sentenceCache;
 #else
-  typedef PhraseCache SentenceCache;
+  boost::scoped_ptr<PhraseCache> m_sentenceCache;
 #endif
-  SentenceCache m_sentenceCache;
+
+  PhraseCache &GetSentenceCache();
+
+  const TargetPhraseCollection* GetTargetPhraseCollectionNonCacheLEGACY(const Phrase &source,
+      const std::string *sourceKey) const;
 
   BlockHashIndex m_hash;
   PhraseDecoder* m_phraseDecoder;
@@ -73,10 +76,13 @@ public:
   ~PhraseDictionaryCompact();
 
   void Load();
+  void SetParameter(const std::string& key, const std::string& value);
 
   const TargetPhraseCollection* GetTargetPhraseCollectionNonCacheLEGACY(const Phrase &source) const;
   TargetPhraseVectorPtr GetTargetPhraseCollectionRaw(const Phrase &source) const;
 
+  void GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const;
+
   void AddEquivPhrase(const Phrase &source, const TargetPhrase &targetPhrase);
 
   void CacheForCleanup(TargetPhraseCollection* tpc);
@@ -24,6 +24,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "PhraseTableCreator.h"
 #include "ConsistentPhrases.h"
 #include "ThrowingFwrite.h"
+#include "moses/Timer.h"
 #include "util/file.hh"
 #include "util/exception.hh"
 
@@ -52,7 +53,8 @@ PhraseTableCreator::PhraseTableCreator(std::string inPath,
                                        bool multipleScoreTrees,
                                        size_t quantize,
                                        size_t maxRank,
-                                       bool warnMe
+                                       bool warnMe,
+                                       size_t maxRankHashMemory
 #ifdef WITH_THREADS
                                        , size_t threads
 #endif
@@ -63,7 +65,7 @@ PhraseTableCreator::PhraseTableCreator(std::string inPath,
     m_coding(coding), m_orderBits(orderBits), m_fingerPrintBits(fingerPrintBits),
     m_useAlignmentInfo(useAlignmentInfo),
     m_multipleScoreTrees(multipleScoreTrees),
-    m_quantize(quantize), m_maxRank(maxRank),
+    m_quantize(quantize), m_maxRank(maxRank), m_maxRankHashMemory(maxRankHashMemory),
 #ifdef WITH_THREADS
     m_threads(threads),
     m_srcHash(m_orderBits, m_fingerPrintBits, 1),
@@ -72,12 +74,15 @@ PhraseTableCreator::PhraseTableCreator(std::string inPath,
     m_srcHash(m_orderBits, m_fingerPrintBits),
     m_rnkHash(m_orderBits, m_fingerPrintBits),
 #endif
-    m_maxPhraseLength(0),
+    m_rnkHashFile(0), m_rnkHashRatio(1), m_maxPhraseLength(0), m_ranks(0),
     m_lastFlushedLine(-1), m_lastFlushedSourceNum(0),
     m_lastFlushedSourcePhrase("")
 {
   PrintInfo();
 
+  Timer timer;
+  timer.start();
+
   AddTargetSymbolId(m_phraseStopSymbol);
 
   size_t cur_pass = 1;
@@ -103,7 +108,20 @@ PhraseTableCreator::PhraseTableCreator(std::string inPath,
   } else if(m_coding == PREnc) {
     std::cerr << "Pass " << cur_pass << "/" << all_passes << ": Creating hash function for rank assignment" << std::endl;
     cur_pass++;
+
+    if(tempfilePath.size()) {
+      MmapAllocator<unsigned> allocRanks(util::FMakeTemp(tempfilePath));
+      m_ranks = new std::vector<unsigned, MmapAllocator<unsigned> >(allocRanks);
+    } else {
+      m_ranks = new std::vector<unsigned, MmapAllocator<unsigned> >();
+    }
+
+    if(m_maxRankHashMemory) {
+      m_rnkHashFile = tempfilePath.size() ? util::FMakeTemp(tempfilePath) : std::tmpfile();
+      m_rnkHash.BeginSave(m_rnkHashFile);
+    }
     CreateRankHash();
+    std::cerr << "Elapsed: " << timer.get_elapsed_time() << " s" << std::endl << std::endl;
   }
 
   // 1st pass
@@ -117,6 +135,7 @@ PhraseTableCreator::PhraseTableCreator(std::string inPath,
     m_encodedTargetPhrases = new StringVector<unsigned char, unsigned long, MmapAllocator>();
   }
   EncodeTargetPhrases();
+  std::cerr << "Elapsed: " << timer.get_elapsed_time() << " s" << std::endl << std::endl;
 
   cur_pass++;
 
@@ -133,10 +152,11 @@ PhraseTableCreator::PhraseTableCreator(std::string inPath,
     m_compressedTargetPhrases = new StringVector<unsigned char, unsigned long, MmapAllocator>();
   }
   CompressTargetPhrases();
+  std::cerr << "Elapsed: " << timer.get_elapsed_time() << " s" << std::endl << std::endl;
 
   std::cerr << "Saving to " << m_outPath << std::endl;
   Save();
-  std::cerr << "Done" << std::endl;
+  std::cerr << "Done in " << timer.get_elapsed_time() << " s" << std::endl;
   std::fclose(m_outFile);
 }
 
@@ -152,6 +172,10 @@ PhraseTableCreator::~PhraseTableCreator()
 
   delete m_encodedTargetPhrases;
   delete m_compressedTargetPhrases;
+
+  delete m_ranks;
+  if(m_rnkHashFile)
+    std::fclose(m_rnkHashFile);
 }
 
 void PhraseTableCreator::PrintInfo()
@@ -170,6 +194,11 @@ void PhraseTableCreator::PrintInfo()
       std::cerr << "unlimited" << std::endl;
     else
       std::cerr << m_maxRank << std::endl;
+    std::cerr << "\tMemory for the rank hash: ";
+    if(!m_maxRankHashMemory)
+      std::cerr << "unlimited" << std::endl;
+    else
+      std::cerr << m_maxRankHashMemory << " MB" << std::endl;
   }
   std::cerr << "\tNumber of score components in phrase table: " << m_numScoreComponent << std::endl;
   std::cerr << "\tSingle Huffman code set for score components: " << (m_multipleScoreTrees ? "no" : "yes") << std::endl;
@@ -568,10 +597,10 @@ void PhraseTableCreator::EncodeTargetPhraseREnc(std::vector<std::string>& s,
         if(r < bestRank) {
           bestRank = r;
           bestSrcPos = *it;
-          bestDiff = abs(*it-i);
-        } else if(r == bestRank && unsigned(abs(*it-i)) < bestDiff) {
+          bestDiff = abs(long(*it) - long(i));
+        } else if(r == bestRank && unsigned(abs(long(*it) - long(i))) < bestDiff) {
           bestSrcPos = *it;
-          bestDiff = abs(*it-i);
+          bestDiff = abs(long(*it) - long(i));
         }
       }
     }
@@ -623,7 +652,7 @@ void PhraseTableCreator::EncodeTargetPhrasePREnc(std::vector<std::string>& s,
     std::string key1Str = key1.str(), key2Str = key2.str();
     size_t idx = m_rnkHash[MakeSourceTargetKey(key1Str, key2Str)];
     if(idx != m_rnkHash.GetSize())
-      rank = m_ranks[idx];
+      rank = (*m_ranks)[idx];
 
     if(rank >= 0 && (m_maxRank == 0 || unsigned(rank) < m_maxRank)) {
       if(unsigned(p.m) != s.size() || unsigned(rank) < ownRank) {
@@ -838,6 +867,10 @@ void PhraseTableCreator::FlushRankedQueue(bool force)
 
     if(m_lastSourceRange.size() == step) {
       m_rnkHash.AddRange(m_lastSourceRange);
+      if(m_rnkHashFile) {
+        m_rnkHash.SaveLastRange();
+        m_rnkHash.DropLastRange();
+      }
       m_lastSourceRange.clear();
     }
 
@@ -851,10 +884,10 @@ void PhraseTableCreator::FlushRankedQueue(bool force)
           std::cerr << "[" << m_lastFlushedSourceNum << "]" << std::endl;
         }
 
-        m_ranks.resize(m_lastFlushedLine + 1);
+        m_ranks->resize(m_lastFlushedLine + 1);
         int r = 0;
         while(!m_rankQueue.empty()) {
-          m_ranks[m_rankQueue.top().second] = r++;
+          (*m_ranks)[m_rankQueue.top().second] = r++;
           m_rankQueue.pop();
         }
       }
@@ -874,10 +907,21 @@ void PhraseTableCreator::FlushRankedQueue(bool force)
     m_rnkHash.WaitAll();
 #endif
 
-    m_ranks.resize(m_lastFlushedLine + 1);
+    if(m_rnkHashFile) {
+      m_rnkHash.SaveLastRange();
+      m_rnkHash.DropLastRange();
+      size_t hashSize = m_rnkHash.FinalizeSave();
+
+      // half of the budget goes to the ranges kept in memory while encoding
+      size_t budget = m_maxRankHashMemory << 19;
+      if(hashSize > budget)
+        m_rnkHashRatio = float(budget) / hashSize;
+    }
+
+    m_ranks->resize(m_lastFlushedLine + 1);
     int r = 0;
     while(!m_rankQueue.empty()) {
-      m_ranks[m_rankQueue.top().second] = r++;
+      (*m_ranks)[m_rankQueue.top().second] = r++;
       m_rankQueue.pop();
     }
 
@@ -896,6 +940,9 @@ void PhraseTableCreator::AddEncodedLine(PackedItem& pi)
 
 void PhraseTableCreator::FlushEncodedQueue(bool force)
 {
+  if(m_rnkHashFile)
+    m_rnkHash.KeepNLastRanges(m_rnkHashRatio);
+
   while(!m_queue.empty() && m_lastFlushedLine + 1 == m_queue.top().GetLine()) {
     PackedItem pi = m_queue.top();
     m_queue.pop();
@@ -1159,7 +1206,7 @@ void EncodingTask::operator()()
 
       size_t ownRank = 0;
       if(m_creator.m_coding == PhraseTableCreator::PREnc)
-        ownRank = m_creator.m_ranks[lineNum + i];
+        ownRank = (*m_creator.m_ranks)[lineNum + i];
 
       std::string encodedLine = m_creator.EncodeLine(tokens, ownRank);
 
@@ -36,6 +36,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "BlockHashIndex.h"
 #include "StringVector.h"
+#include "MmapAllocator.h"
 #include "CanonicalHuffman.h"
 
 namespace Moses
@@ -199,6 +200,9 @@ private:
   size_t m_quantize;
   size_t m_maxRank;
 
+  // memory in MB for the ranges of m_rnkHash, 0 means unlimited
+  size_t m_maxRankHashMemory;
+
   static std::string m_phraseStopSymbol;
   static std::string m_separator;
 
@@ -210,9 +214,16 @@ private:
   BlockHashIndex m_srcHash;
   BlockHashIndex m_rnkHash;
 
+  // With -max-rank-hash-memory the ranges of m_rnkHash are spilled to this file
+  // as soon as they are hashed and are loaded back on demand during
+  // encoding, keeping only the m_rnkHashRatio most recently used in memory.
+  std::FILE* m_rnkHashFile;
+  float m_rnkHashRatio;
+
   size_t m_maxPhraseLength;
 
-  std::vector<unsigned> m_ranks;
+  // one rank per line of the phrase table, backed by a temporary file
+  std::vector<unsigned, MmapAllocator<unsigned> >* m_ranks;
 
   typedef std::pair<unsigned, unsigned> SrcTrg;
   typedef std::pair<std::string, std::string> SrcTrgString;
@@ -342,7 +353,8 @@ public:
                      bool multipleScoreTrees = true,
                      size_t quantize = 0,
                      size_t maxRank = 100,
-                     bool warnMe = true
+                     bool warnMe = true,
+                     size_t maxRankHashMemory = 0
 #ifdef WITH_THREADS
                                    , size_t threads = 2
 #endif
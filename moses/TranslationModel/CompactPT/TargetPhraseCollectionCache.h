@@ -26,12 +26,6 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <set>
 #include <vector>
 
-#ifdef WITH_THREADS
-#ifdef BOOST_HAS_PTHREADS
-#include <boost/thread/mutex.hpp>
-#endif
-#endif
-
 #include <boost/shared_ptr.hpp>
 
 #include "moses/Phrase.h"
@@ -44,7 +38,8 @@ namespace Moses
 typedef std::vector<TargetPhrase> TargetPhraseVector;
 typedef boost::shared_ptr<TargetPhraseVector> TargetPhraseVectorPtr;
 
-/** Implementation of Persistent Cache **/
+/** Implementation of Persistent Cache. Not thread-safe, PhraseDecoder
+ *  keeps one per thread **/
 class TargetPhraseCollectionCache
 {
 private:
@@ -66,10 +61,6 @@ private:
 
   CacheMap m_phraseCache;
 
-#ifdef WITH_THREADS
-  boost::mutex m_mutex;
-#endif
-
 public:
 
   typedef CacheMap::iterator iterator;
@@ -98,10 +89,6 @@ public:
   /** retrieve translations for source phrase from persistent cache **/
   void Cache(const Phrase &sourcePhrase, TargetPhraseVectorPtr tpv,
              size_t bitsLeft = 0, size_t maxRank = 0) {
-#ifdef WITH_THREADS
-    boost::mutex::scoped_lock lock(m_mutex);
-#endif
-
     // check if source phrase is already in cache
     iterator it = m_phraseCache.find(sourcePhrase);
     if(it != m_phraseCache.end())
@@ -120,10 +107,6 @@ public:
   }
 
   std::pair<TargetPhraseVectorPtr, size_t> Retrieve(const Phrase &sourcePhrase) {
-#ifdef WITH_THREADS
-    boost::mutex::scoped_lock lock(m_mutex);
-#endif
-
     iterator it = m_phraseCache.find(sourcePhrase);
     if(it != m_phraseCache.end()) {
       LastUsed &lu = it->second;
@@ -135,10 +118,6 @@ public:
 
   // if cache full, reduce
   void Prune() {
-#ifdef WITH_THREADS
-    boost::mutex::scoped_lock lock(m_mutex);
-#endif
-
     if(m_phraseCache.size() > m_max * (1 + m_tolerance)) {
       typedef std::set<std::pair<clock_t, Phrase> > Cands;
       Cands cands;
@@ -159,9 +138,6 @@ public:
   }
 
   void CleanUp() {
-#ifdef WITH_THREADS
-    boost::mutex::scoped_lock lock(m_mutex);
-#endif
     m_phraseCache.clear();
   }
 
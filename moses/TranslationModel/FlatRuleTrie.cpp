@@ -0,0 +1,234 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+
+#include "FlatRuleTrie.h"
+#include "moses/TargetPhrase.h"
+#include "moses/Terminal.h"
+#include "util/exception.hh"
+
+using namespace std;
+
+namespace Moses
+{
+
+namespace
+{
+
+// strict weak order on terminals that agrees with TerminalEqualityPred for
+// words with the same active factors
+struct TerminalLess {
+  bool operator()(const Word &a, const Word &b) const {
+    for (size_t i = 0; i < MAX_NUM_FACTORS; ++i) {
+      if (a[i] != b[i]) {
+        return a[i] < b[i];
+      }
+    }
+    return false;
+  }
+};
+
+struct TerminalEdgeLess {
+  bool operator()(const pair<Word, PhraseDictionaryNodeMemory*> &a,
+                  const pair<Word, PhraseDictionaryNodeMemory*> &b) const {
+    return TerminalLess()(a.first, b.first);
+  }
+};
+
+struct TrieSize {
+  TrieSize() : numNodes(0), numTerminals(0), numNonTerminals(0), numCollections(0) {}
+  size_t numNodes, numTerminals, numNonTerminals, numCollections;
+};
+
+void CountNodes(const PhraseDictionaryNodeMemory &node, TrieSize &size)
+{
+  ++size.numNodes;
+  if (!node.GetTargetPhraseCollection().IsEmpty()) {
+    ++size.numCollections;
+  }
+  const PhraseDictionaryNodeMemory::TerminalMap &terminals = node.GetTerminalMap();
+  size.numTerminals += terminals.size();
+  for (PhraseDictionaryNodeMemory::TerminalMap::const_iterator p = terminals.begin(); p != terminals.end(); ++p) {
+    CountNodes(p->second, size);
+  }
+  const PhraseDictionaryNodeMemory::NonTerminalMap &nonTerminals = node.GetNonTerminalMap();
+  size.numNonTerminals += nonTerminals.size();
+  for (PhraseDictionaryNodeMemory::NonTerminalMap::const_iterator p = nonTerminals.begin(); p != nonTerminals.end(); ++p) {
+    CountNodes(p->second, size);
+  }
+}
+
+}
+
+const FlatRuleTrie::Node *FlatRuleTrie::Node::GetChild(const Word &sourceTerm) const
+{
+  const Word *end = m_terminals + m_numTerminals;
+  const Word *p = std::lower_bound(m_terminals, end, sourceTerm, TerminalLess());
+  if (p == end || TerminalLess()(sourceTerm, *p)) {
+    return NULL;
+  }
+  return m_children + (p - m_terminals);
+}
+
+#if defined(UNLABELLED_SOURCE)
+const FlatRuleTrie::Node *FlatRuleTrie::Node::GetNonTerminalChild(const Word &targetNonTerm) const
+{
+  UTIL_THROW_IF2(!targetNonTerm.IsNonTerminal(),
+                 "Not a non-terminal: " << targetNonTerm);
+
+  NonTerminalEqualityPred equal;
+  for (size_t i = 0; i < m_numNonTerminals; ++i) {
+    if (equal(m_nonTerminals[i], targetNonTerm)) {
+      return &GetNonTerminalChild(i);
+    }
+  }
+  return NULL;
+}
+#else
+const FlatRuleTrie::Node *FlatRuleTrie::Node::GetChild(const Word &sourceNonTerm, const Word &targetNonTerm) const
+{
+  UTIL_THROW_IF2(!sourceNonTerm.IsNonTerminal(),
+                 "Not a non-terminal: " << sourceNonTerm);
+  UTIL_THROW_IF2(!targetNonTerm.IsNonTerminal(),
+                 "Not a non-terminal: " << targetNonTerm);
+
+  NonTerminalKey key(sourceNonTerm, targetNonTerm);
+  NonTerminalMapKeyEqualityPred equal;
+  for (size_t i = 0; i < m_numNonTerminals; ++i) {
+    if (equal(m_nonTerminals[i], key)) {
+      return &GetNonTerminalChild(i);
+    }
+  }
+  return NULL;
+}
+#endif
+
+FlatRuleTrie::FlatRuleTrie()
+{
+  Reset();
+}
+
+void FlatRuleTrie::Reset()
+{
+  m_nodes.assign(1, Node());
+  Node &root = m_nodes[0];
+  root.m_children = NULL;
+  root.m_terminals = NULL;
+  root.m_nonTerminals = NULL;
+  root.m_targetPhraseCollection = &m_empty;
+  root.m_numTerminals = 0;
+  root.m_numNonTerminals = 0;
+}
+
+void FlatRuleTrie::Clear()
+{
+  std::vector<TargetPhraseCollection>().swap(m_targetPhraseCollections);
+  std::vector<NonTerminalKey>().swap(m_nonTerminals);
+  std::vector<Word>().swap(m_terminals);
+  std::vector<Node>().swap(m_nodes);
+  Reset();
+}
+
+void FlatRuleTrie::Build(PhraseDictionaryNodeMemory &root)
+{
+  Clear();
+
+  TrieSize size;
+  CountNodes(root, size);
+  const size_t numNodes = size.numNodes;
+
+  // sized once, so that pointers into the arrays stay valid
+  m_nodes.resize(numNodes);
+  m_terminals.reserve(size.numTerminals);
+  m_nonTerminals.reserve(size.numNonTerminals);
+  m_targetPhraseCollections.resize(size.numCollections);
+
+  // offsets into m_terminals and m_nonTerminals, turned into pointers once
+  // both arrays are complete
+  std::vector<std::pair<size_t, size_t> > labelOffsets(numNodes);
+
+  typedef std::pair<PhraseDictionaryNodeMemory*, size_t> Pending;
+  std::deque<Pending> queue;
+  queue.push_back(Pending(&root, 0));
+  size_t nextNode = 1, nextCollection = 0;
+
+  std::vector<std::pair<Word, PhraseDictionaryNodeMemory*> > terminals;
+  while (!queue.empty()) {
+    PhraseDictionaryNodeMemory &from = *queue.front().first;
+    size_t index = queue.front().second;
+    queue.pop_front();
+
+    Node &to = m_nodes[index];
+    to.m_children = &m_nodes[0] + nextNode;
+    labelOffsets[index] = std::make_pair(m_terminals.size(), m_nonTerminals.size());
+
+    // terminal children, sorted
+    PhraseDictionaryNodeMemory::TerminalMap &terminalMap = from.m_sourceTermMap;
+    terminals.clear();
+    for (PhraseDictionaryNodeMemory::TerminalMap::iterator p = terminalMap.begin(); p != terminalMap.end(); ++p) {
+      terminals.push_back(std::make_pair(p->first, &p->second));
+    }
+    std::sort(terminals.begin(), terminals.end(), TerminalEdgeLess());
+    for (size_t i = 0; i < terminals.size(); ++i) {
+      m_terminals.push_back(terminals[i].first);
+      queue.push_back(Pending(terminals[i].second, nextNode++));
+    }
+    to.m_numTerminals = terminals.size();
+
+    // non-terminal children, in map order
+    PhraseDictionaryNodeMemory::NonTerminalMap &nonTerminalMap = from.m_nonTermMap;
+    for (PhraseDictionaryNodeMemory::NonTerminalMap::iterator p = nonTerminalMap.begin(); p != nonTerminalMap.end(); ++p) {
+      m_nonTerminals.push_back(p->first);
+      queue.push_back(Pending(&p->second, nextNode++));
+    }
+    to.m_numNonTerminals = nonTerminalMap.size();
+
+    TargetPhraseCollection &rules = from.GetTargetPhraseCollection();
+    if (rules.IsEmpty()) {
+      to.m_targetPhraseCollection = &m_empty;
+    } else {
+      m_targetPhraseCollections[nextCollection].Swap(rules);
+      to.m_targetPhraseCollection = &m_targetPhraseCollections[nextCollection++];
+    }
+  }
+
+  for (size_t i = 0; i < numNodes; ++i) {
+    Node &node = m_nodes[i];
+    node.m_terminals = m_terminals.empty() ? NULL : &m_terminals[0] + labelOffsets[i].first;
+    node.m_nonTerminals = m_nonTerminals.empty() ? NULL : &m_nonTerminals[0] + labelOffsets[i].second;
+    if (node.IsLeaf()) {
+      node.m_children = NULL;
+    }
+  }
+
+  root.Remove();
+}
+
+size_t FlatRuleTrie::GetMemoryUsage() const
+{
+  return m_nodes.capacity() * sizeof(Node)
+         + m_terminals.capacity() * sizeof(Word)
+         + m_nonTerminals.capacity() * sizeof(NonTerminalKey)
+         + m_targetPhraseCollections.capacity() * sizeof(TargetPhraseCollection);
+}
+
+}
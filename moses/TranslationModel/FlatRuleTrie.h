@@ -0,0 +1,128 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2006 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "moses/Word.h"
+#include "moses/TargetPhraseCollection.h"
+#include "PhraseDictionaryNodeMemory.h"
+
+namespace Moses
+{
+
+/** Immutable, flattened copy of a PhraseDictionaryNodeMemory trie, built once
+ *  loading has finished.  All nodes live in one array in breadth-first order,
+ *  so the children of a node are contiguous: first its terminal children,
+ *  sorted by word for binary search, then its non-terminal children in the
+ *  iteration order of the node's non-terminal map.  The edge labels are kept
+ *  in two more arrays, and only nodes that have rules own a
+ *  TargetPhraseCollection.  This replaces a pair of hash tables per node.
+ */
+class FlatRuleTrie : private boost::noncopyable
+{
+public:
+#if defined(UNLABELLED_SOURCE)
+  typedef Word NonTerminalKey;
+#else
+  typedef PhraseDictionaryNodeMemory::NonTerminalMapKey NonTerminalKey;
+#endif
+
+  class Node
+  {
+    friend class FlatRuleTrie;
+
+  public:
+    bool IsLeaf() const {
+      return m_numTerminals == 0 && m_numNonTerminals == 0;
+    }
+
+    //! child reached by a terminal, or NULL
+    const Node *GetChild(const Word &sourceTerm) const;
+
+#if defined(UNLABELLED_SOURCE)
+    const Node *GetNonTerminalChild(const Word &targetNonTerm) const;
+#else
+    const Node *GetChild(const Word &sourceNonTerm, const Word &targetNonTerm) const;
+#endif
+
+    size_t GetNumTerminals() const {
+      return m_numTerminals;
+    }
+    const Word &GetTerminal(size_t i) const {
+      return m_terminals[i];
+    }
+    const Node &GetTerminalChild(size_t i) const {
+      return m_children[i];
+    }
+
+    size_t GetNumNonTerminals() const {
+      return m_numNonTerminals;
+    }
+    const NonTerminalKey &GetNonTerminal(size_t i) const {
+      return m_nonTerminals[i];
+    }
+    const Node &GetNonTerminalChild(size_t i) const {
+      return m_children[m_numTerminals + i];
+    }
+
+    const TargetPhraseCollection &GetTargetPhraseCollection() const {
+      return *m_targetPhraseCollection;
+    }
+
+  private:
+    const Node *m_children;
+    const Word *m_terminals;
+    const NonTerminalKey *m_nonTerminals;
+    const TargetPhraseCollection *m_targetPhraseCollection;
+    unsigned m_numTerminals;
+    unsigned m_numNonTerminals;
+  };
+
+  FlatRuleTrie();
+
+  //! moves the rules of root into the flat trie and empties root
+  void Build(PhraseDictionaryNodeMemory &root);
+  void Clear();
+
+  const Node &GetRootNode() const {
+    return m_nodes[0];
+  }
+
+  size_t GetNumNodes() const {
+    return m_nodes.size();
+  }
+
+  //! bytes used by the trie structure, excluding the target phrases
+  size_t GetMemoryUsage() const;
+
+private:
+  std::vector<Node> m_nodes;
+  std::vector<Word> m_terminals;
+  std::vector<NonTerminalKey> m_nonTerminals;
+  std::vector<TargetPhraseCollection> m_targetPhraseCollections;
+  TargetPhraseCollection m_empty;
+
+  void Reset();
+};
+
+}
@@ -53,36 +53,44 @@ PhraseDictionary::PhraseDictionary(const std::string &line)
 const TargetPhraseCollection *PhraseDictionary::GetTargetPhraseCollectionLEGACY(const Phrase& src) const
 {
   const TargetPhraseCollection *ret;
-  if (m_maxCacheSize) {
-    CacheColl &cache = GetCache();
-
-    size_t hash = hash_value(src);
-
-    CacheColl::iterator iter;
-    iter = cache.find(hash);
+  if (FindInCache(src, ret)) {
+    return ret;
+  }
+  // not in cache, need to look up from phrase table
+  return AddToCache(src, GetTargetPhraseCollectionNonCacheLEGACY(src));
+}
 
+bool PhraseDictionary::FindInCache(const Phrase &src, const TargetPhraseCollection *&ret) const
+{
+  if (UseSharedCache()) {
+    return FindInSharedCache(hash_value(src), ret);
+  } else if (m_maxCacheSize) {
+    CacheColl &cache = GetCache();
+    CacheColl::iterator iter = cache.find(hash_value(src));
     if (iter == cache.end()) {
-      // not in cache, need to look up from phrase table
-      ret = GetTargetPhraseCollectionNonCacheLEGACY(src);
-      if (ret) {
-        ret = new TargetPhraseCollection(*ret);
-      }
-
-      std::pair<const TargetPhraseCollection*, clock_t> value(ret, clock());
-      cache[hash] = value;
-    } else {
-      // in cache. just use it
-      std::pair<const TargetPhraseCollection*, clock_t> &value = iter->second;
-      value.second = clock();
-
-      ret = value.first;
+      return false;
     }
-  } else {
-    // don't use cache. look up from phrase table
-    ret = GetTargetPhraseCollectionNonCacheLEGACY(src);
+    // in cache. just use it
+    std::pair<const TargetPhraseCollection*, clock_t> &value = iter->second;
+    value.second = clock();
+    ret = value.first;
+    return true;
   }
+  return false;
+}
 
-  return ret;
+const TargetPhraseCollection *PhraseDictionary::AddToCache(const Phrase &src, const TargetPhraseCollection *coll) const
+{
+  if (UseSharedCache()) {
+    return AddToSharedCache(hash_value(src), coll ? new TargetPhraseCollection(*coll) : NULL);
+  } else if (m_maxCacheSize) {
+    const TargetPhraseCollection *ret = coll ? new TargetPhraseCollection(*coll) : NULL;
+    std::pair<const TargetPhraseCollection*, clock_t> value(ret, clock());
+    GetCache()[hash_value(src)] = value;
+    return ret;
+  }
+  // don't use cache
+  return coll;
 }
 
 TargetPhraseCollection const *
@@ -106,6 +114,9 @@ SetParameter(const std::string& key, const std::string& value)
 {
   if (key == "cache-size") {
     m_maxCacheSize = Scan<size_t>(value);
+  } else if (key == "shared-cache-mb") {
+    size_t megabytes = Scan<size_t>(value);
+    m_sharedCache.reset(megabytes ? new SharedTargetPhraseCache(megabytes << 20) : NULL);
   } else if (key == "path") {
     m_filePath = value;
   } else if (key == "table-limit") {
@@ -171,6 +182,19 @@ GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const
 // reduce presistent cache by half of maximum size
 void PhraseDictionary::ReduceCache() const
 {
+  if (UseSharedCache()) {
+    // the shared cache evicts as it goes. just let go of this thread's entries
+    GetCachePins().clear();
+    IFVERBOSE(2) {
+      SharedTargetPhraseCache::Stats stats = m_sharedCache->GetStats();
+      TRACE_ERR("Shared phrase-table cache for " << GetScoreProducerDescription()
+                << ": hits=" << stats.hits << " misses=" << stats.misses
+                << " evictions=" << stats.evictions << " entries=" << stats.entries
+                << " bytes=" << stats.bytes << std::endl);
+    }
+    return;
+  }
+
   Timer reduceCacheTime;
   reduceCacheTime.start();
   CacheColl &cache = GetCache();
@@ -212,5 +236,37 @@ CacheColl &PhraseDictionary::GetCache() const
   return *cache;
 }
 
+PhraseDictionary::CachePins &PhraseDictionary::GetCachePins() const
+{
+  CachePins *pins = m_cachePins.get();
+  if (pins == NULL) {
+    pins = new CachePins;
+    m_cachePins.reset(pins);
+  }
+  return *pins;
+}
+
+bool PhraseDictionary::FindInSharedCache(size_t key, const TargetPhraseCollection *&ret) const
+{
+  SharedTargetPhraseCache::Ptr coll;
+  if (!m_sharedCache->Find(key, coll)) {
+    return false;
+  }
+  ret = coll.get();
+  if (ret) {
+    GetCachePins().push_back(coll);
+  }
+  return true;
+}
+
+const TargetPhraseCollection *PhraseDictionary::AddToSharedCache(size_t key, const TargetPhraseCollection *coll) const
+{
+  SharedTargetPhraseCache::Ptr inserted = m_sharedCache->Insert(key, SharedTargetPhraseCache::Ptr(coll));
+  if (inserted) {
+    GetCachePins().push_back(inserted);
+  }
+  return inserted.get();
+}
+
 } // namespace
 
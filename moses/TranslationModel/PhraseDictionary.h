@@ -30,12 +30,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <stdexcept>
 #include <vector>
 #include <string>
+#include <boost/scoped_ptr.hpp>
 #include <boost/unordered_map.hpp>
 
 #ifdef WITH_THREADS
 #include <boost/thread/tss.hpp>
 #else
-#include <boost/scoped_ptr.hpp>
 #include <time.h>
 #endif
 
@@ -44,6 +44,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "moses/TargetPhraseCollection.h"
 #include "moses/InputPath.h"
 #include "moses/FF/DecodeFeature.h"
+#include "moses/TranslationModel/SharedTargetPhraseCache.h"
 
 namespace Moses
 {
@@ -149,12 +150,43 @@ protected:
   mutable boost::scoped_ptr<CacheColl> m_cache;
 #endif
 
+  // cache shared by all threads, used instead of m_cache if set
+  boost::scoped_ptr<SharedTargetPhraseCache> m_sharedCache;
+
+  // shared cache entries handed out to the current sentence of this thread.
+  // keeps them alive if they are evicted before the sentence is done
+  typedef std::vector<SharedTargetPhraseCache::Ptr> CachePins;
+#ifdef WITH_THREADS
+  mutable boost::thread_specific_ptr<CachePins> m_cachePins;
+#else
+  mutable boost::scoped_ptr<CachePins> m_cachePins;
+#endif
+
   virtual const TargetPhraseCollection *GetTargetPhraseCollectionNonCacheLEGACY(const Phrase& src) const;
   void ReduceCache() const;
 
 protected:
   CacheColl &GetCache() const;
 
+  bool UseSharedCache() const {
+    return m_sharedCache.get() != NULL;
+  }
+
+  //! look up key in the shared cache. The result is valid until the next ReduceCache() by this thread
+  bool FindInSharedCache(size_t key, const TargetPhraseCollection *&ret) const;
+
+  //! add to the shared cache, which takes ownership of coll. Returns the collection to use
+  const TargetPhraseCollection *AddToSharedCache(size_t key, const TargetPhraseCollection *coll) const;
+
+  //! look up src in whichever cache is in use. False if not cached or caching is off
+  bool FindInCache(const Phrase &src, const TargetPhraseCollection *&ret) const;
+
+  //! cache a copy of coll, the result of a cache miss on src. Returns the collection to use
+  const TargetPhraseCollection *AddToCache(const Phrase &src, const TargetPhraseCollection *coll) const;
+
+private:
+  CachePins &GetCachePins() const;
+
 };
 
 }
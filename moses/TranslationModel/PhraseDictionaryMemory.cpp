@@ -69,7 +69,7 @@ GetTargetPhraseCollectionLEGACY(const Phrase& sourceOrig) const
   // exactly like CreateTargetPhraseCollection, but don't create
   const size_t size = source.GetSize();
 
-  const PhraseDictionaryNodeMemory *currNode = &m_collection;
+  const FlatRuleTrie::Node *currNode = &GetRootNode();
   for (size_t pos = 0 ; pos < size ; ++pos) {
     const Word& word = source.GetWord(pos);
     currNode = currNode->GetChild(word);
@@ -137,6 +137,7 @@ void PhraseDictionaryMemory::SortAndPrune()
   if (GetTableLimit()) {
     m_collection.Sort(GetTableLimit());
   }
+  m_trie.Build(m_collection);
 }
 
 void
@@ -149,10 +150,10 @@ GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const
     const Phrase &phrase = node.GetPhrase();
     const InputPath *prevPath = node.GetPrevPath();
 
-    const PhraseDictionaryNodeMemory *prevPtNode = NULL;
+    const FlatRuleTrie::Node *prevPtNode = NULL;
 
     if (prevPath) {
-      prevPtNode = static_cast<const PhraseDictionaryNodeMemory*>(prevPath->GetPtNode(*this));
+      prevPtNode = static_cast<const FlatRuleTrie::Node*>(prevPath->GetPtNode(*this));
     } else {
       // Starting subphrase.
       assert(phrase.GetSize() == 1);
@@ -163,7 +164,7 @@ GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const
       Word lastWord = phrase.GetWord(phrase.GetSize() - 1);
       lastWord.OnlyTheseFactors(m_inputFactors);
 
-      const PhraseDictionaryNodeMemory *ptNode = prevPtNode->GetChild(lastWord);
+      const FlatRuleTrie::Node *ptNode = prevPtNode->GetChild(lastWord);
       if (ptNode) {
         const TargetPhraseCollection &targetPhrases = ptNode->GetTargetPhraseCollection();
         node.SetTargetPhrases(*this, &targetPhrases, ptNode);
@@ -179,21 +180,18 @@ TO_STRING_BODY(PhraseDictionaryMemory);
 // friend
 ostream& operator<<(ostream& out, const PhraseDictionaryMemory& phraseDict)
 {
-  typedef PhraseDictionaryNodeMemory::TerminalMap TermMap;
-  typedef PhraseDictionaryNodeMemory::NonTerminalMap NonTermMap;
-
-  const PhraseDictionaryNodeMemory &coll = phraseDict.m_collection;
-  for (NonTermMap::const_iterator p = coll.m_nonTermMap.begin(); p != coll.m_nonTermMap.end(); ++p) {
+  const FlatRuleTrie::Node &root = phraseDict.GetRootNode();
+  for (size_t i = 0; i < root.GetNumNonTerminals(); ++i) {
 #if defined(UNLABELLED_SOURCE)
-    const Word &targetNonTerm = p->first;
+    const Word &targetNonTerm = root.GetNonTerminal(i);
     out << targetNonTerm;
 #else
-    const Word &sourceNonTerm = p->first.first;
+    const Word &sourceNonTerm = root.GetNonTerminal(i).first;
     out << sourceNonTerm;
 #endif
   }
-  for (TermMap::const_iterator p = coll.m_sourceTermMap.begin(); p != coll.m_sourceTermMap.end(); ++p) {
-    const Word &sourceTerm = p->first;
+  for (size_t i = 0; i < root.GetNumTerminals(); ++i) {
+    const Word &sourceTerm = root.GetTerminal(i);
     out << sourceTerm;
   }
   return out;
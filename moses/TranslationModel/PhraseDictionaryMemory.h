@@ -20,6 +20,7 @@
 #pragma once
 
 #include "PhraseDictionaryNodeMemory.h"
+#include "FlatRuleTrie.h"
 #include "moses/TranslationModel/PhraseDictionary.h"
 #include "moses/InputType.h"
 #include "moses/NonTerminal.h"
@@ -31,6 +32,8 @@ class ChartParser;
 
 /** Implementation of a in-memory rule table in a trie.  Looking up a rule of
  * length n symbols requires n look-ups to find the TargetPhraseCollection.
+ * Rules are collected in a PhraseDictionaryNodeMemory trie while loading,
+ * which is then flattened into a FlatRuleTrie for decoding.
  */
 class PhraseDictionaryMemory : public RuleTableTrie
 {
@@ -45,8 +48,8 @@ protected:
 public:
   PhraseDictionaryMemory(const std::string &line);
 
-  const PhraseDictionaryNodeMemory &GetRootNode() const {
-    return m_collection;
+  const FlatRuleTrie::Node &GetRootNode() const {
+    return m_trie.GetRootNode();
   }
 
   ChartRuleLookupManager*
@@ -71,7 +74,8 @@ protected:
 
   void SortAndPrune();
 
-  PhraseDictionaryNodeMemory m_collection;
+  PhraseDictionaryNodeMemory m_collection; // only used while loading
+  FlatRuleTrie m_trie;
 };
 
 }  // namespace Moses
@@ -41,6 +41,7 @@ namespace Moses
 class PhraseDictionaryMemory;
 class PhraseDictionaryScope3;
 class PhraseDictionaryFuzzyMatch;
+class FlatRuleTrie;
 
 //! @todo why?
 class NonTerminalMapKeyHasher
@@ -127,6 +128,7 @@ private:
   friend std::ostream& operator<<(std::ostream&, const PhraseDictionaryMemory&);
   friend std::ostream& operator<<(std::ostream&, const PhraseDictionaryScope3&);
   friend std::ostream& operator<<(std::ostream&, const PhraseDictionaryFuzzyMatch&);
+  friend class FlatRuleTrie;
 
   TerminalMap m_sourceTermMap;
   NonTerminalMap m_nonTermMap;
@@ -56,6 +56,7 @@ void PhraseDictionaryALSuffixArray::InitializeForInput(InputType const& source)
 void PhraseDictionaryALSuffixArray::CleanUpAfterSentenceProcessing(const InputType &source)
 {
   m_collection.Remove();
+  m_trie.Clear();
 }
 
 }
@@ -47,6 +47,14 @@ PhraseDictionaryOnDisk::~PhraseDictionaryOnDisk()
 void PhraseDictionaryOnDisk::Load()
 {
   SetFeaturesToApply();
+
+  OnDiskPt::OnDiskWrapper *obj = OpenTable();
+  if (obj->IsMapped()) {
+    m_mappedImplementation.reset(obj);
+  } else {
+    // reopened for each sentence, see InitializeForInput()
+    delete obj;
+  }
 }
 
 ChartRuleLookupManager *PhraseDictionaryOnDisk::CreateRuleLookupManager(
@@ -62,6 +70,9 @@ ChartRuleLookupManager *PhraseDictionaryOnDisk::CreateRuleLookupManager(
 
 OnDiskPt::OnDiskWrapper &PhraseDictionaryOnDisk::GetImplementation()
 {
+  if (m_mappedImplementation) {
+    return *m_mappedImplementation;
+  }
   OnDiskPt::OnDiskWrapper* dict;
   dict = m_implementation.get();
   UTIL_THROW_IF2(dict == NULL, "Dictionary object not yet created for this thread");
@@ -70,6 +81,9 @@ OnDiskPt::OnDiskWrapper &PhraseDictionaryOnDisk::GetImplementation()
 
 const OnDiskPt::OnDiskWrapper &PhraseDictionaryOnDisk::GetImplementation() const
 {
+  if (m_mappedImplementation) {
+    return *m_mappedImplementation;
+  }
   OnDiskPt::OnDiskWrapper* dict;
   dict = m_implementation.get();
   UTIL_THROW_IF2(dict == NULL, "Dictionary object not yet created for this thread");
@@ -78,16 +92,25 @@ const OnDiskPt::OnDiskWrapper &PhraseDictionaryOnDisk::GetImplementation() const
 
 void PhraseDictionaryOnDisk::InitializeForInput(InputType const& source)
 {
-  const StaticData &staticData = StaticData::Instance();
-
   ReduceCache();
 
+  if (m_mappedImplementation) {
+    return;
+  }
+
+  m_implementation.reset(OpenTable());
+}
+
+OnDiskPt::OnDiskWrapper *PhraseDictionaryOnDisk::OpenTable() const
+{
   OnDiskPt::OnDiskWrapper *obj = new OnDiskPt::OnDiskWrapper();
   obj->BeginLoad(m_filePath);
 
-  UTIL_THROW_IF2(obj->GetMisc("Version") != OnDiskPt::OnDiskWrapper::VERSION_NUM,
+  UTIL_THROW_IF2(obj->GetMisc("Version") != OnDiskPt::OnDiskWrapper::VERSION_NUM
+                 && obj->GetMisc("Version") != OnDiskPt::OnDiskWrapper::MAPPED_VERSION_NUM,
 		  "On-disk phrase table is version " <<  obj->GetMisc("Version")
-		  << ". It is not compatible with version " << OnDiskPt::OnDiskWrapper::VERSION_NUM);
+		  << ". It is not compatible with version " << OnDiskPt::OnDiskWrapper::VERSION_NUM
+		  << " or " << OnDiskPt::OnDiskWrapper::MAPPED_VERSION_NUM);
 
   UTIL_THROW_IF2(obj->GetMisc("NumSourceFactors") != m_input.size(),
 		  "On-disk phrase table has " <<  obj->GetMisc("NumSourceFactors") << " source factors."
@@ -101,7 +124,7 @@ void PhraseDictionaryOnDisk::InitializeForInput(InputType const& source)
 		  "On-disk phrase table has " <<  obj->GetMisc("NumScores") << " scores."
 		  		  << ". The ini file specified " << m_numScoreComponents << " scores");
 
-  m_implementation.reset(obj);
+  return obj;
 }
 
 void PhraseDictionaryOnDisk::GetTargetPhraseCollectionBatch(const InputPathList &inputPathQueue) const
@@ -162,9 +185,16 @@ void PhraseDictionaryOnDisk::GetTargetPhraseCollectionBatch(InputPath &inputPath
 const TargetPhraseCollection *PhraseDictionaryOnDisk::GetTargetPhraseCollection(const OnDiskPt::PhraseNode *ptNode) const
 {
   const TargetPhraseCollection *ret;
+  size_t hash = (size_t) ptNode->GetFilePos();
+
+  if (UseSharedCache()) {
+    if (!FindInSharedCache(hash, ret)) {
+      ret = AddToSharedCache(hash, GetTargetPhraseCollectionNonCache(ptNode));
+    }
+    return ret;
+  }
 
   CacheColl &cache = GetCache();
-  size_t hash = (size_t) ptNode->GetFilePos();
 
   CacheColl::iterator iter;
 
@@ -192,15 +222,7 @@ const TargetPhraseCollection *PhraseDictionaryOnDisk::GetTargetPhraseCollectionN
   OnDiskPt::OnDiskWrapper &wrapper = const_cast<OnDiskPt::OnDiskWrapper&>(GetImplementation());
 
   vector<float> weightT = StaticData::Instance().GetWeights(this);
-  OnDiskPt::Vocab &vocab = wrapper.GetVocab();
-
-  const OnDiskPt::TargetPhraseCollection *targetPhrasesOnDisk = ptNode->GetTargetPhraseCollection(m_tableLimit, wrapper);
-  TargetPhraseCollection *targetPhrases
-  = targetPhrasesOnDisk->ConvertToMoses(m_input, m_output, *this, weightT, vocab, false);
-
-  delete targetPhrasesOnDisk;
-
-  return targetPhrases;
+  return ptNode->GetMosesTargetPhraseCollection(m_tableLimit, m_input, m_output, *this, weightT, false, wrapper);
 }
 
 } // namespace
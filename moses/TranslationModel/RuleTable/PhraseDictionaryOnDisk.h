@@ -29,10 +29,9 @@
 #include "OnDiskPt/Word.h"
 #include "OnDiskPt/PhraseNode.h"
 
+#include <boost/scoped_ptr.hpp>
 #ifdef WITH_THREADS
 #include <boost/thread/tss.hpp>
-#else
-#include <boost/scoped_ptr.hpp>
 #endif
 
 namespace Moses
@@ -55,6 +54,10 @@ protected:
 #else
   boost::scoped_ptr<OnDiskPt::OnDiskWrapper> m_implementation;
 #endif
+  // a table in the mapped format is read only, and opened once for all threads
+  boost::scoped_ptr<OnDiskPt::OnDiskWrapper> m_mappedImplementation;
+
+  OnDiskPt::OnDiskWrapper *OpenTable() const;
 
   OnDiskPt::OnDiskWrapper &GetImplementation();
   const OnDiskPt::OnDiskWrapper &GetImplementation() const;
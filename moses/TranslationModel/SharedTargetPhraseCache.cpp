@@ -0,0 +1,141 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include "moses/TranslationModel/SharedTargetPhraseCache.h"
+#include "moses/TargetPhrase.h"
+
+namespace Moses
+{
+
+SharedTargetPhraseCache::SharedTargetPhraseCache(size_t maxBytes)
+  : m_maxBytesPerStripe(maxBytes / NUM_STRIPES)
+{
+}
+
+bool SharedTargetPhraseCache::Find(size_t key, Ptr &out)
+{
+  Stripe &stripe = GetStripe(key);
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(stripe.mutex);
+#endif
+  boost::unordered_map<size_t, size_t>::const_iterator iter = stripe.index.find(key);
+  if (iter == stripe.index.end()) {
+    ++stripe.misses;
+    return false;
+  }
+  Entry &entry = stripe.entries[iter->second];
+  entry.referenced = true;
+  out = entry.coll;
+  ++stripe.hits;
+  return true;
+}
+
+SharedTargetPhraseCache::Ptr SharedTargetPhraseCache::Insert(size_t key, const Ptr &coll)
+{
+  const size_t bytes = EstimateBytes(coll.get());
+  Stripe &stripe = GetStripe(key);
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(stripe.mutex);
+#endif
+  boost::unordered_map<size_t, size_t>::const_iterator iter = stripe.index.find(key);
+  if (iter != stripe.index.end()) {
+    // lost the race against another thread looking up the same phrase
+    Entry &entry = stripe.entries[iter->second];
+    entry.referenced = true;
+    return entry.coll;
+  }
+  if (bytes > m_maxBytesPerStripe) {
+    // would flush the whole stripe. don't cache
+    return coll;
+  }
+
+  MakeRoom(stripe, bytes);
+
+  Entry entry;
+  entry.key = key;
+  entry.coll = coll;
+  entry.bytes = bytes;
+  entry.referenced = false;
+  stripe.index[key] = stripe.entries.size();
+  stripe.entries.push_back(entry);
+  stripe.bytes += bytes;
+  return coll;
+}
+
+void SharedTargetPhraseCache::MakeRoom(Stripe &stripe, size_t incoming)
+{
+  std::vector<Entry> &entries = stripe.entries;
+  while (!entries.empty() && stripe.bytes + incoming > m_maxBytesPerStripe) {
+    if (stripe.hand >= entries.size()) {
+      stripe.hand = 0;
+    }
+    Entry &entry = entries[stripe.hand];
+    if (entry.referenced) {
+      // second chance
+      entry.referenced = false;
+      ++stripe.hand;
+      continue;
+    }
+
+    stripe.bytes -= entry.bytes;
+    stripe.index.erase(entry.key);
+    if (stripe.hand + 1 != entries.size()) {
+      // fill the hole with the last entry. it is examined next
+      entry = entries.back();
+      stripe.index[entry.key] = stripe.hand;
+    }
+    entries.pop_back();
+    ++stripe.evictions;
+  }
+}
+
+SharedTargetPhraseCache::Stats SharedTargetPhraseCache::GetStats() const
+{
+  Stats ret;
+  ret.hits = ret.misses = ret.evictions = ret.entries = ret.bytes = 0;
+  for (size_t i = 0; i < NUM_STRIPES; ++i) {
+    const Stripe &stripe = m_stripes[i];
+#ifdef WITH_THREADS
+    boost::mutex::scoped_lock lock(stripe.mutex);
+#endif
+    ret.hits += stripe.hits;
+    ret.misses += stripe.misses;
+    ret.evictions += stripe.evictions;
+    ret.entries += stripe.entries.size();
+    ret.bytes += stripe.bytes;
+  }
+  return ret;
+}
+
+size_t SharedTargetPhraseCache::EstimateBytes(const TargetPhraseCollection *coll)
+{
+  // entry, index node and shared_ptr control block
+  size_t ret = sizeof(Entry) + 4 * sizeof(void*);
+  if (coll == NULL) {
+    return ret;
+  }
+  ret += sizeof(TargetPhraseCollection) + sizeof(void*) * coll->GetSize();
+  for (TargetPhraseCollection::const_iterator iter = coll->begin(); iter != coll->end(); ++iter) {
+    const TargetPhrase &tp = **iter;
+    ret += sizeof(TargetPhrase) + sizeof(Word) * tp.GetSize();
+  }
+  return ret;
+}
+
+}
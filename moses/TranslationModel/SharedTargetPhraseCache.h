@@ -0,0 +1,119 @@
+// -*- c++ -*-
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_SharedTargetPhraseCache_h
+#define moses_SharedTargetPhraseCache_h
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#endif
+
+#include "moses/TargetPhraseCollection.h"
+
+namespace Moses
+{
+
+/** Cache of target phrase collections shared by all decoding threads.
+ *
+ * The key space is split into stripes, each with its own lock, so threads
+ * looking up different source phrases rarely contend.  Each stripe holds at
+ * most its share of the byte budget and evicts with the CLOCK (second
+ * chance) policy: a hit sets the entry's reference bit, and the clock hand
+ * clears bits until it finds an unreferenced entry to drop.
+ *
+ * Collections are handed out as shared pointers, so an evicted collection
+ * stays alive for as long as some sentence still uses it.
+ */
+class SharedTargetPhraseCache
+{
+public:
+  typedef boost::shared_ptr<const TargetPhraseCollection> Ptr;
+
+  struct Stats {
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    size_t entries;
+    size_t bytes;
+  };
+
+  //! maxBytes = approximate upper bound on the memory held by cached collections
+  explicit SharedTargetPhraseCache(size_t maxBytes);
+
+  /** look up key.  On a hit, out is set to the cached collection (which may
+   * be empty, if the source phrase has no translations) and true is returned.
+   */
+  bool Find(size_t key, Ptr &out);
+
+  /** add a collection, evicting others as needed.  If another thread added
+   * the same key first, its collection is kept and returned instead.
+   */
+  Ptr Insert(size_t key, const Ptr &coll);
+
+  Stats GetStats() const;
+
+  //! rough memory footprint of a collection, used for the byte budget
+  static size_t EstimateBytes(const TargetPhraseCollection *coll);
+
+private:
+  struct Entry {
+    size_t key;
+    Ptr coll;
+    size_t bytes;
+    bool referenced;
+  };
+
+  struct Stripe {
+    boost::unordered_map<size_t, size_t> index; // key -> position in entries
+    std::vector<Entry> entries;
+    size_t hand;
+    size_t bytes;
+    size_t hits, misses, evictions;
+#ifdef WITH_THREADS
+    mutable boost::mutex mutex;
+#endif
+    Stripe() : hand(0), bytes(0), hits(0), misses(0), evictions(0) {}
+  };
+
+  static const size_t NUM_STRIPES = 16;
+  Stripe m_stripes[NUM_STRIPES];
+  size_t m_maxBytesPerStripe;
+
+  Stripe &GetStripe(size_t key) {
+    // keys are often hashes, but OnDisk keys are file offsets; mix a little
+    return m_stripes[(key ^ (key >> 7) ^ (key >> 17)) % NUM_STRIPES];
+  }
+
+  //! drop entries until the stripe can take 'incoming' more bytes
+  void MakeRoom(Stripe &stripe, size_t incoming);
+
+  // no copying
+  SharedTargetPhraseCache(const SharedTargetPhraseCache &);
+  SharedTargetPhraseCache &operator=(const SharedTargetPhraseCache &);
+};
+
+}
+
+#endif
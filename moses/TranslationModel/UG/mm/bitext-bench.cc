@@ -0,0 +1,154 @@
+// Benchmark concurrent phrase statistics lookups on a memory-mapped bitext.
+// Reports lookups per second versus the number of lookup threads, once with
+// an empty cache (every source phrase has to be sampled) and once more with
+// all phrases cached, as when many decoding threads share one Mmsapt.
+//
+// usage: bitext-bench [options] <base name> <L1> <L2> < input-text
+// Every n-gram (up to --max-length) of every input line that occurs in the
+// L1 side of the bitext is looked up.
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+#include <boost/foreach.hpp>
+#include <boost/thread.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "ug_typedefs.h"
+#include "ug_corpus_token.h"
+#include "ug_bitext.h"
+#include "moses/TranslationModel/UG/generic/program_options/ug_get_options.h"
+
+using namespace std;
+using namespace ugdiss;
+using namespace Moses;
+using namespace Moses::bitext;
+
+typedef L2R_Token<SimpleWordId> Token;
+typedef mmBitext<Token> mmbitext;
+
+string bname, L1, L2, thread_counts;
+size_t max_samples, max_length;
+
+void interpret_args(int ac, char* av[]);
+
+class
+lookup_worker
+{
+  mmbitext const& bt;
+  vector<vector<id_type> > const& input;
+  size_t first, step;
+  size_t& lookups;
+public:
+  lookup_worker(mmbitext const& b, vector<vector<id_type> > const& i,
+		size_t const f, size_t const s, size_t& l)
+    : bt(b), input(i), first(f), step(s), lookups(l) {}
+
+  void
+  operator()()
+  {
+    size_t n = 0;
+    for (size_t s = first; s < input.size(); s += step)
+      {
+	vector<id_type> const& snt = input[s];
+	for (size_t i = 0; i < snt.size(); ++i)
+	  {
+	    TSA<Token>::tree_iterator m(bt.I1.get());
+	    for (size_t k = i; (k < snt.size() && k - i < max_length
+				&& m.extend(snt[k])); ++k, ++n)
+	      bt.lookup(m);
+	  }
+      }
+    lookups = n;
+  }
+};
+
+// run one round of lookups with /n/ threads; returns lookups per second
+double
+run(mmbitext const& bt, vector<vector<id_type> > const& input, size_t const n)
+{
+  vector<size_t> lookups(n,0);
+  boost::thread_group threads;
+  boost::posix_time::ptime start
+    = boost::posix_time::microsec_clock::universal_time();
+  for (size_t t = 0; t < n; ++t)
+    threads.create_thread(lookup_worker(bt, input, t, n, lookups[t]));
+  threads.join_all();
+  boost::posix_time::time_duration elapsed
+    = boost::posix_time::microsec_clock::universal_time() - start;
+  size_t total = 0;
+  BOOST_FOREACH(size_t x, lookups) total += x;
+  double secs = elapsed.total_microseconds() / 1e6;
+  return secs > 0 ? total / secs : 0;
+}
+
+int main(int argc, char* argv[])
+{
+  interpret_args(argc, argv);
+  char c = *bname.rbegin();
+  if (c != '/' && c != '.') bname += ".";
+
+  vector<size_t> nthreads;
+  istringstream buf(thread_counts);
+  for (size_t n; buf >> n; buf.ignore()) nthreads.push_back(max(n,size_t(1)));
+
+  vector<vector<id_type> > input;
+  {
+    mmbitext bt;
+    bt.open(bname, L1, L2);
+    string line;
+    while (getline(cin,line))
+      {
+	input.push_back(vector<id_type>());
+	bt.V1->fillIdSeq(line,input.back());
+      }
+  }
+
+  cout << setw(8) << "threads" << setw(16) << "cold lookups/s"
+       << setw(16) << "warm lookups/s" << endl;
+  BOOST_FOREACH(size_t n, nthreads)
+    {
+      // a fresh bitext for each thread count, so that nothing is cached
+      mmbitext bt;
+      bt.open(bname, L1, L2);
+      bt.setDefaultSampleSize(max_samples);
+      double cold = run(bt, input, n);
+      double warm = run(bt, input, n);
+      cout << setw(8) << n << fixed << setprecision(0)
+	   << setw(16) << cold << setw(16) << warm << endl;
+    }
+  exit(0);
+}
+
+void
+interpret_args(int ac, char* av[])
+{
+  namespace po=boost::program_options;
+  po::variables_map vm;
+  po::options_description o("Options");
+  po::options_description h("Hidden Options");
+  po::positional_options_description a;
+
+  o.add_options()
+    ("help,h",    "print this message")
+    ("threads,t", po::value<string>(&thread_counts)->default_value("1,2,4,8,16"),
+     "comma-separated list of thread counts to measure")
+    ("samples,s", po::value<size_t>(&max_samples)->default_value(1000),
+     "max. number of samples per source phrase")
+    ("max-length,l", po::value<size_t>(&max_length)->default_value(7),
+     "max. source phrase length")
+    ;
+
+  h.add_options()
+    ("bname", po::value<string>(&bname), "base name")
+    ("L1",    po::value<string>(&L1), "L1 tag")
+    ("L2",    po::value<string>(&L2), "L2 tag")
+    ;
+  a.add("bname",1);
+  a.add("L1",1);
+  a.add("L2",1);
+  get_options(ac,av,h.add(o),a,vm);
+}
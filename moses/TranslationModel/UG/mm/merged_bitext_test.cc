@@ -0,0 +1,162 @@
+// -*- c++ -*-
+// test for write_merged_bitext(): merging a memory-mapped bitext with a
+// dynamic one must give the same files as building the whole corpus at once
+
+#define BOOST_TEST_MODULE MergedBitext
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "ug_bitext.h"
+
+using namespace std;
+using namespace ugdiss;
+using namespace Moses::bitext;
+
+namespace
+{
+  typedef L2R_Token<SimpleWordId> Token;
+
+  char const* const src[] = {
+    "das haus ist klein",
+    "das haus ist gross",
+    "ein haus",
+    "klein ist das buch",
+    "das buch ist klein und das haus ist gross",
+    "ein buch"
+  };
+  char const* const trg[] = {
+    "the house is small",
+    "the house is big",
+    "a house",
+    "the book is small",
+    "the book is small and the house is big",
+    "a book"
+  };
+  char const* const aln[] = {
+    "0-0 1-1 2-2 3-3",
+    "0-0 1-1 2-2 3-3",
+    "0-0 1-1",
+    "0-3 1-2 2-0 3-1",
+    "0-0 1-1 2-2 3-3 4-4 5-5 6-6 7-7 8-8",
+    "0-0 1-1"
+  };
+  size_t const numPairs = 6;
+
+  struct TempDir
+  {
+    string path;
+    TempDir()
+    {
+      char name[] = "/tmp/merged_bitext_test.XXXXXX";
+      BOOST_REQUIRE(mkdtemp(name));
+      path = string(name) + "/";
+    }
+    ~TempDir()
+    {
+      string cmd = "rm -rf " + path;
+      if (::system(cmd.c_str())) {}
+    }
+  };
+
+  sptr<imBitext<Token> >
+  AddPairs(sptr<imBitext<Token> > bt, size_t start, size_t stop)
+  {
+    vector<string> s1(src+start, src+stop);
+    vector<string> s2(trg+start, trg+stop);
+    vector<string> a(aln+start, aln+stop);
+    return bt->add(s1,s2,a);
+  }
+
+  string
+  ReadFile(string const& fname)
+  {
+    ifstream in(fname.c_str());
+    BOOST_REQUIRE(in);
+    return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+  }
+
+  void
+  CheckSameFiles(string const& a, string const& b)
+  {
+    char const* const suffix[] = { "de.tdx", "en.tdx", "de.mct", "en.mct",
+				   "de-en.mam", "de.sfa", "en.sfa" };
+    for (size_t i = 0; i < sizeof(suffix)/sizeof(char const*); ++i)
+      {
+	BOOST_TEST_MESSAGE("comparing " << suffix[i]);
+	BOOST_CHECK(ReadFile(a+suffix[i]) == ReadFile(b+suffix[i]));
+      }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(merge_mm_and_im)
+{
+  TempDir dir;
+
+  // the whole corpus, built in memory and written as is; this also
+  // assigns the word ids, which the merged bitext keeps
+  sptr<imBitext<Token> > all(new imBitext<Token>());
+  all = AddPairs(all, 0, numPairs);
+  imBitext<Token> none(all->V1, all->V2);
+  write_merged_bitext(*all, none, dir.path+"full.", "de", "en");
+
+  // the first four sentence pairs as the memory-mapped base
+  sptr<imBitext<Token> > head(new imBitext<Token>(all->V1, all->V2));
+  head = AddPairs(head, 0, 4);
+  write_merged_bitext(*head, none, dir.path+"base.", "de", "en");
+  mmBitext<Token> base;
+  base.open(dir.path+"base.", "de", "en");
+  BOOST_CHECK_EQUAL(base.T1->size(), 4);
+
+  // the rest added dynamically on top of it, as Mmsapt does
+  sptr<imBitext<Token> > delta(new imBitext<Token>(base.V1, base.V2));
+  delta = AddPairs(delta, 4, numPairs);
+  write_merged_bitext(base, *delta, dir.path+"merged.", "de", "en");
+
+  CheckSameFiles(dir.path+"merged.", dir.path+"full.");
+
+  mmBitext<Token> merged;
+  merged.open(dir.path+"merged.", "de", "en");
+  BOOST_CHECK_EQUAL(merged.T1->size(), numPairs);
+  BOOST_CHECK_EQUAL(merged.T2->size(), numPairs);
+
+  // n-gram counts agree with the in-memory index of the whole corpus
+  char const* const ngrams[] = { "das", "das haus", "ist klein", "buch",
+				 "das haus ist gross", "und" };
+  for (size_t i = 0; i < sizeof(ngrams)/sizeof(char const*); ++i)
+    {
+      vector<id_type> a, b;
+      merged.V1->fillIdSeq(ngrams[i], a);
+      all->V1->fillIdSeq(ngrams[i], b);
+      TSA<Token>::tree_iterator m(merged.I1.get()), f(all->I1.get());
+      for (size_t k = 0; k < a.size(); ++k)
+	{
+	  BOOST_REQUIRE(m.extend(a[k]));
+	  BOOST_REQUIRE(f.extend(b[k]));
+	}
+      BOOST_CHECK_EQUAL(m.rawCnt(), f.rawCnt());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(vocabulary_write_includes_new_words)
+{
+  TempDir dir;
+  sptr<imBitext<Token> > bt(new imBitext<Token>());
+  bt = AddPairs(bt, 0, 2);
+  size_t known = bt->V1->tsize();
+  (*bt->V1)["neu"];
+  BOOST_CHECK_EQUAL(bt->V1->tsize(), known+1);
+  BOOST_CHECK_EQUAL(bt->V1->write(dir.path+"de.tdx"), known+1);
+
+  TokenIndex V;
+  V.open(dir.path+"de.tdx");
+  BOOST_CHECK_EQUAL(V.tsize(), known+1);
+  BOOST_CHECK_EQUAL(V["neu"], (*bt->V1)["neu"]);
+  BOOST_CHECK_EQUAL(V["haus"], (*bt->V1)["haus"]);
+}
@@ -16,7 +16,8 @@ namespace ugdiss
 
   TokenIndex::
   TokenIndex(string unkToken) 
-    : ridx(0),unkLabel(unkToken),unkId(1),numTokens(0)
+    : ridx(0),unkLabel(unkToken),unkId(1),numTokens(0),dynamic(false)
+    , startIdx(NULL),endIdx(NULL)
   { 
     lock.reset(new boost::mutex());
   };
@@ -300,9 +301,9 @@ namespace ugdiss
   TokenIndex::
   tsize() const
   {
-    return (newWords != NULL
-            ? numTokens+newWords->size()
-            : numTokens);
+    if (newWords == NULL) return numTokens;
+    boost::lock_guard<boost::mutex> lk(*this->lock);
+    return numTokens+newWords->size();
   }
 
   void
@@ -337,16 +338,25 @@ namespace ugdiss
     out<<data.str();
   }
 
-  void 
+  id_type
   TokenIndex::
-  write(string fname)
+  write(string fname) const
   {
     typedef pair<string,uint32_t>  Token;      // token and id
-    vector<Token>       tok(totalVocabSize()); 
-    for (id_type i = 0; i < tok.size(); ++i)
-      tok[i] = Token((*this)[i],i);
+    vector<Token> tok;
+    tok.reserve(endIdx-startIdx);
+    for (Entry const* x = startIdx; x != endIdx; x++)
+      tok.push_back(Token(comp.base+x->offset,x->id));
+    if (newWords != NULL)
+      { 
+	// other threads may add items meanwhile; copy them under the lock
+	boost::lock_guard<boost::mutex> lk(*this->lock);
+	for (size_t i = 0; i < newWords->size(); ++i)
+	  tok.push_back(Token((*newWords)[i],numTokens+i));
+      }
     sort(tok.begin(),tok.end());
     write_tokenindex_to_disk(tok,fname,unkLabel);
+    return tok.size();
   }
   
   bool 
@@ -104,7 +104,9 @@ namespace ugdiss
 
     char const* const getUnkToken() const;
 
-    void write(string fname); // write TokenIndex to a new file
+    // write TokenIndex to a new file; returns the number of items written,
+    // which is all items added dynamically before the call
+    id_type write(string fname) const;
     bool isDynamic() const;
     bool setDynamic(bool onoff);
 
@@ -41,21 +41,48 @@ namespace Moses
       this->lock.unlock();
     }
 
+    void
+    pstats::
+    merge(partial const& p)
+    {
+      boost::lock_guard<boost::mutex> guard(this->lock);
+      this->sum_pairs += p.sum_pairs;
+      for (int i = po_first; i <= po_other; ++i)
+	{
+	  this->ofwd[i] += p.ofwd[i];
+	  this->obwd[i] += p.obwd[i];
+	}
+      typedef boost::unordered_map<uint64_t, jstats>::const_iterator iter;
+      for (iter m = p.trg.begin(); m != p.trg.end(); ++m)
+	{
+	  pair<boost::unordered_map<uint64_t, jstats>::iterator, bool> 
+	    foo = this->trg.insert(*m);
+	  if (!foo.second) foo.first->second.add(m->second);
+	}
+    }
+
+    pstats::
+    partial::
+    partial()
+      : good(0), sum_pairs(0)
+    {
+      ofwd[0] = ofwd[1] = ofwd[2] = ofwd[3] = ofwd[4] = ofwd[5] = ofwd[6] = 0;
+      obwd[0] = obwd[1] = obwd[2] = obwd[3] = obwd[4] = obwd[5] = obwd[6] = 0;
+    }
+
     bool
     pstats::
+    partial::
     add(uint64_t pid, float const w, 
 	vector<uchar> const& a, 
 	uint32_t const cnt2, 
 	uint32_t fwd_o, 
 	uint32_t bwd_o)
     {
-      this->lock.lock();
       jstats& entry = this->trg[pid];
-      this->lock.unlock();
       entry.add(w,a,cnt2,fwd_o,bwd_o);
       if (this->good < entry.rcnt())
 	{
-	  this->lock.lock();
 	  return false;
 	  // UTIL_THROW(util::Exception, "more joint counts than good counts!" 
 	  // 	     << entry.rcnt() << "/" << this->good);
@@ -63,6 +90,52 @@ namespace Moses
       return true;
     }
 
+    static boost::thread_specific_ptr<pstats_thread_cache> thread_cache;
+
+    pstats_thread_cache::
+    entry&
+    pstats_thread_cache::
+    slot(uint64_t const owner, uint64_t const pid)
+    {
+      pstats_thread_cache* c = thread_cache.get();
+      if (!c) 
+	{
+	  c = new pstats_thread_cache();
+	  thread_cache.reset(c);
+	}
+      uint64_t h = (pid ^ (owner * 0x9E3779B97F4A7C15ULL)) * 0xff51afd7ed558ccdULL;
+      return c->slots[(h >> 32) & (SIZE - 1)];
+    }
+
+    sptr<pstats>
+    pstats_thread_cache::
+    find(uint64_t const owner, uint64_t const pid)
+    {
+      entry& e = slot(owner, pid);
+      if (e.owner == owner && e.pid == pid) return e.stats;
+      return sptr<pstats>();
+    }
+
+    void
+    pstats_thread_cache::
+    store(uint64_t const owner, uint64_t const pid, sptr<pstats> const& stats)
+    {
+      entry& e = slot(owner, pid);
+      e.owner = owner;
+      e.pid   = pid;
+      e.stats = stats;
+    }
+    
+    uint64_t
+    pstats_thread_cache::
+    new_owner()
+    {
+      static boost::mutex lock;
+      static uint64_t next_owner = 0;
+      boost::lock_guard<boost::mutex> guard(lock);
+      return ++next_owner;
+    }
+
     jstats::
     jstats()
       : my_rcnt(0), my_wcnt(0), my_cnt2(0)
@@ -77,6 +150,7 @@ namespace Moses
     {
       my_rcnt = other.rcnt();
       my_wcnt = other.wcnt();
+      my_cnt2 = other.cnt2();
       my_aln  = other.aln();
       for (int i = po_first; i <= po_other; i++)
 	{
@@ -106,7 +180,6 @@ namespace Moses
     add(float w, vector<uchar> const& a, uint32_t const cnt2,
 	uint32_t fwd_orient, uint32_t bwd_orient)
     {
-      boost::lock_guard<boost::mutex> lk(this->lock);
       my_rcnt += 1;
       my_wcnt += w;
       my_cnt2 += cnt2;
@@ -125,6 +198,32 @@ namespace Moses
       ++obwd[bwd_orient];
     }
     
+    void
+    jstats::
+    add(jstats const& other)
+    {
+      my_rcnt += other.my_rcnt;
+      my_wcnt += other.my_wcnt;
+      my_cnt2 += other.my_cnt2;
+      for (size_t k = 0; k < other.my_aln.size(); ++k)
+	{
+	  size_t i = 0;
+	  while (i < my_aln.size() && my_aln[i].second != other.my_aln[k].second) 
+	    ++i;
+	  if (i == my_aln.size()) 
+	    my_aln.push_back(other.my_aln[k]);
+	  else
+	    my_aln[i].first += other.my_aln[k].first;
+	}
+      // keep the most frequent alignment in front
+      make_heap(my_aln.begin(),my_aln.end());
+      for (int i = po_first; i <= po_other; i++)
+	{
+	  ofwd[i] += other.ofwd[i];
+	  obwd[i] += other.obwd[i];
+	}
+    }
+    
     uint32_t 
     jstats::
     rcnt() const 
@@ -145,19 +244,6 @@ namespace Moses
     aln() const 
     { return my_aln; }
 
-    void 
-    jstats::
-    invalidate()
-    {
-      my_rcnt = 0;
-    }
-
-    bool
-    jstats::
-    valid()
-    {
-      return my_rcnt != 0;
-    }
 
     bool
     PhrasePair::
@@ -359,8 +445,8 @@ namespace Moses
 	      binwrite(obuf,row);
 	      binwrite(obuf,col);
 	    }
-	  char const* x = obuf.str().c_str();
-	  vector<char> v(x,x+obuf.str().size());
+	  string const x = obuf.str();
+	  vector<char> v(x.begin(),x.end());
 	  ret->myTx = append(ret->myTx, v);
 	}
       thread1.join();
@@ -94,10 +94,11 @@ namespace Moses {
 	 float const confidence);
 
     // "joint" (i.e., phrase pair) statistics
+    // Not synchronized: while sampling, each worker fills its own jstats
+    // (see pstats::partial), which are merged into the shared pstats once.
     class
     jstats
     {
-      boost::mutex lock;
       uint32_t my_rcnt; // unweighted count
       float    my_wcnt; // weighted count 
       uint32_t my_cnt2;
@@ -113,16 +114,40 @@ namespace Moses {
       vector<pair<size_t, vector<uchar> > > const & aln() const;
       void add(float w, vector<uchar> const& a, uint32_t const cnt2,
 	       uint32_t fwd_orient, uint32_t bwd_orient);
-      void invalidate();
-      bool valid();
+      void add(jstats const& other); // merge counts from another worker
       uint32_t dcnt_fwd(PhraseOrientation const idx) const;
       uint32_t dcnt_bwd(PhraseOrientation const idx) const;
     };
 
+    // Statistics of a source phrase. While sampling is in progress, 
+    // raw_cnt, sample_cnt and good are maintained by the job under the
+    // job's lock (they steer the sampling); all other counts are 
+    // collected by each worker in a pstats::partial and merged in 
+    // once, when the worker leaves the job. Once in_progress has 
+    // dropped to zero, a pstats is never modified again and can be 
+    // read by any number of threads without locking.
     struct 
     pstats
     {
-      boost::mutex lock;               // for parallel gathering of stats
+      // counts collected by a single worker
+      struct 
+      partial
+      {
+	size_t good; // number of samples this worker has processed
+	size_t sum_pairs;
+	uint32_t ofwd[po_other+1], obwd[po_other+1];
+	boost::unordered_map<uint64_t, jstats> trg;
+	partial();
+
+	bool 
+	add(uint64_t const pid, 
+	    float    const w, 
+	    vector<uchar> const& a, 
+	    uint32_t      const cnt2,
+	    uint32_t fwd_o, uint32_t bwd_o);
+      };
+
+      boost::mutex lock;               // guards in_progress and merging
       boost::condition_variable ready; // consumers can wait for this data structure to be ready.
       
       size_t raw_cnt;    // (approximate) raw occurrence count 
@@ -139,12 +164,37 @@ namespace Moses {
       void register_worker();
       size_t count_workers() { return in_progress; } 
 
-      bool 
-      add(uint64_t const pid, 
-	  float    const w, 
-	  vector<uchar> const& a, 
-	  uint32_t      const cnt2,
-	  uint32_t fwd_o, uint32_t bwd_o);
+      // add a worker's counts; called once per worker and job
+      void merge(partial const& p);
+    };
+
+    // Per-thread, direct-mapped cache of finished pstats, shared by all
+    // bitexts and placed in front of their (locked) caches. Entries are
+    // tagged with an owner id (see Bitext::cache_id), so a hit here 
+    // takes no lock at all. Entries of bitexts that have gone away are
+    // simply overwritten in due course.
+    class
+    pstats_thread_cache
+    {
+    public:
+      static size_t const SIZE = 4096; // must be a power of 2
+      
+      static sptr<pstats> find(uint64_t const owner, uint64_t const pid);
+      static void store(uint64_t const owner, uint64_t const pid, 
+			sptr<pstats> const& stats);
+
+      // hands out owner ids; never returns the same one twice
+      static uint64_t new_owner();
+    private:
+      struct
+      entry
+      {
+	uint64_t owner, pid;
+	sptr<pstats> stats;
+	entry() : owner(0), pid(0) {}
+      };
+      entry slots[SIZE];
+      static entry& slot(uint64_t const owner, uint64_t const pid);
     };
     
     class 
@@ -409,12 +459,21 @@ namespace Moses {
        bitvector* full_alignment,
        bool const flip) const;
       
-      mutable boost::unordered_map<uint64_t,sptr<pstats> > cache1,cache2;
+      typedef boost::unordered_map<uint64_t,sptr<pstats> > pcache_t;
+      mutable pcache_t cache1,cache2;
     protected:
+      // Readers of cache1/cache2 share this lock; it is held exclusively
+      // only to add an entry. Lookups of phrases that the calling thread
+      // has seen before are served from pstats_thread_cache without it.
+      mutable boost::shared_mutex cache_lock; 
+      uint64_t cache_id; // our tag in pstats_thread_cache
       size_t default_sample_size;
     private:
+      sptr<agenda> get_agenda() const;
       sptr<pstats> 
 	prep2(iter const& phrase, size_t const max_sample) const;
+      uint64_t 
+      thread_cache_owner(iter const& phrase) const;
     public:
       Bitext(size_t const max_sample=5000);
 
@@ -433,6 +492,7 @@ namespace Moses {
       sptr<pstats> lookup(iter const& phrase) const;
       sptr<pstats> lookup(iter const& phrase, size_t const max_sample) const;
       void prep(iter const& phrase) const;
+      // not to be called while lookups are running
       void setDefaultSampleSize(size_t const max_samples);
       size_t getDefaultSampleSize() const;
       
@@ -473,8 +533,11 @@ namespace Moses {
     { 
       if (max_samples != default_sample_size) 
 	{
+	  boost::unique_lock<boost::shared_mutex> guard(cache_lock);
 	  cache1.clear();
 	  cache2.clear();
+	  // entries in the per-thread caches are stale now, too
+	  cache_id = pstats_thread_cache::new_owner();
 	  default_sample_size = max_samples; 
 	}
     }
@@ -482,7 +545,8 @@ namespace Moses {
     template<typename Token>
     Bitext<Token>::
     Bitext(size_t const max_sample)
-      : default_sample_size(max_sample)
+      : cache_id(pstats_thread_cache::new_owner())
+      , default_sample_size(max_sample)
     { }
 
     template<typename Token>
@@ -496,6 +560,7 @@ namespace Moses {
 	   TSA<Token>* const i2,
 	   size_t const max_sample)
       : Tx(tx), T1(t1), T2(t2), V1(v1), V2(v2), I1(i1), I2(i2)
+      , cache_id(pstats_thread_cache::new_owner())
       , default_sample_size(max_sample)
     { }
 
@@ -508,7 +573,9 @@ namespace Moses {
       boost::mutex lock; 
       class job 
       {
-	boost::mutex      lock; 
+	// guards the sampling state below, including stats->raw_cnt,
+	// stats->sample_cnt and stats->good while sampling is in progress
+	mutable boost::mutex lock; 
 	friend class agenda;
       public:
 	size_t         workers; // how many workers are working on this job?
@@ -522,6 +589,7 @@ namespace Moses {
 	bool               fwd; // if true, source phrase is L1 
 	sptr<pstats>     stats; // stores statistics collected during sampling
 	bool step(uint64_t & sid, uint64_t & offset); // select another occurrence
+	void good_sample(); // the occurrence selected has a valid alignment
 	bool done() const;
 	job(typename TSA<Token>::tree_iterator const& m, 
 	    sptr<TSA<Token> > const& r, size_t maxsmpl, bool isfwd);
@@ -564,7 +632,6 @@ namespace Moses {
 	{
 	  next = root->readSid(next,stop,sid);
 	  next = root->readOffset(next,stop,offset);
-	  boost::lock_guard<boost::mutex> sguard(stats->lock);
 	  if (stats->raw_cnt == ctr) ++stats->raw_cnt;
 	  stats->sample_cnt++;
 	  return true;
@@ -575,21 +642,29 @@ namespace Moses {
 	    {
 	      next = root->readSid(next,stop,sid);
 	      next = root->readOffset(next,stop,offset);
-	      {
-		boost::lock_guard<boost::mutex> sguard(stats->lock);
-		if (stats->raw_cnt == ctr) ++stats->raw_cnt;
-		size_t rnum = randInt(stats->raw_cnt - ctr++);
-		if (rnum < max_samples - stats->good)
-		  {
-		    stats->sample_cnt++;
-		    return true;
-		  }
-	      }
+	      if (stats->raw_cnt == ctr) ++stats->raw_cnt;
+	      size_t rnum = randInt(stats->raw_cnt - ctr++);
+	      if (rnum < max_samples - stats->good)
+		{
+		  stats->sample_cnt++;
+		  return true;
+		}
 	    }
 	  return false;
 	}
     }
 
+    template<typename Token>
+    void
+    Bitext<Token>::
+    agenda::
+    job::
+    good_sample()
+    {
+      boost::lock_guard<boost::mutex> jguard(lock);
+      ++stats->good;
+    }
+
     template<typename Token>
     void
     Bitext<Token>::
@@ -634,6 +709,7 @@ namespace Moses {
       while(sptr<job> j = ag.get_job())
 	{
 	  j->stats->register_worker();
+	  pstats::partial mine; // merged into j->stats when we're done
 	  vector<uchar> aln;
 	  bitvector full_alignment(100*100);
 	  while (j->step(sid,offset))
@@ -651,12 +727,11 @@ namespace Moses {
 		       (sid,offset,offset+j->len,s1,s2,e1,e2,po_fwd,po_bwd,
 			NULL,NULL,true))
 		continue;
-	      j->stats->lock.lock(); 
-	      j->stats->good += 1; 
-	      j->stats->sum_pairs += (s2-s1+1)*(e2-e1+1);
-	      ++j->stats->ofwd[po_fwd];
-	      ++j->stats->obwd[po_bwd];
-	      j->stats->lock.unlock();
+	      j->good_sample();
+	      mine.good += 1; 
+	      mine.sum_pairs += (s2-s1+1)*(e2-e1+1);
+	      ++mine.ofwd[po_fwd];
+	      ++mine.obwd[po_bwd];
 	      for (size_t k = j->fwd ? 1 : 0; k < aln.size(); k += 2) 
 		aln[k] += s2 - s1;
 	      Token const* o = (j->fwd ? ag.bt.T2 : ag.bt.T1)->sntStart(sid);
@@ -669,9 +744,9 @@ namespace Moses {
 		  // assert(b);
 		  for (size_t i = e1; i <= e2; ++i)
 		    {
-		      if (!j->stats->add(b->getPid(),sample_weight,aln,
-					 b->approxOccurrenceCount(),
-					 po_fwd,po_bwd))
+		      if (!mine.add(b->getPid(),sample_weight,aln,
+				    b->approxOccurrenceCount(),
+				    po_fwd,po_bwd))
 			{
 			  for (size_t z = 0; z < j->len; ++z)
 			    {
@@ -699,8 +774,8 @@ namespace Moses {
 		    for (size_t k = j->fwd ? 1 : 0; k < aln.size(); k += 2) 
 		      --aln[k];
 		}
-	      // j->stats->lock.unlock();
 	    }
+	  j->stats->merge(mine);
 	  j->stats->release();
 	}
     }
@@ -1210,34 +1285,50 @@ namespace Moses {
     }
 
     template<typename Token>
-    sptr<pstats> 
+    sptr<typename Bitext<Token>::agenda> 
     Bitext<Token>::
-    prep2(iter const& phrase, size_t const max_sample) const
+    get_agenda() const
     {
-      // boost::lock_guard<boost::mutex>(this->lock);
+      boost::lock_guard<boost::mutex> guard(this->lock);
       if (!ag) 
 	{
 	  ag.reset(new agenda(*this));
 	  // ag->add_workers(1);
 	  ag->add_workers(20);
 	}
-      typedef boost::unordered_map<uint64_t,sptr<pstats> > pcache_t;
-      sptr<pstats> ret;
-      if (max_sample == this->default_sample_size)
-      	{
-      	  uint64_t pid = phrase.getPid();
-      	  pcache_t & cache(phrase.root == &(*this->I1) ? cache1 : cache2);
-      	  pcache_t::value_type entry(pid,sptr<pstats>());
-	  pair<pcache_t::iterator,bool> foo;
-	  {
-	    // boost::lock_guard<boost::mutex>(this->lock);
-	    foo = cache.emplace(entry);
-	  }
-      	  if (foo.second) foo.first->second = ag->add_job(phrase, max_sample);
-	  ret = foo.first->second;
-      	}
-      else ret = ag->add_job(phrase, max_sample);
-      return ret;
+      return ag;
+    }
+
+    template<typename Token>
+    uint64_t
+    Bitext<Token>::
+    thread_cache_owner(iter const& phrase) const
+    {
+      return (cache_id << 1) + (phrase.root == &(*this->I1) ? 0 : 1);
+    }
+
+    template<typename Token>
+    sptr<pstats> 
+    Bitext<Token>::
+    prep2(iter const& phrase, size_t const max_sample) const
+    {
+      if (max_sample != this->default_sample_size)
+	return get_agenda()->add_job(phrase, max_sample);
+
+      uint64_t pid = phrase.getPid();
+      pcache_t & cache(phrase.root == &(*this->I1) ? cache1 : cache2);
+      {
+	boost::shared_lock<boost::shared_mutex> guard(cache_lock);
+	pcache_t::const_iterator m = cache.find(pid);
+	if (m != cache.end()) return m->second;
+      }
+      sptr<agenda> a = get_agenda();
+      boost::unique_lock<boost::shared_mutex> guard(cache_lock);
+      // another thread may have added it between the two locks
+      pair<typename pcache_t::iterator,bool> foo;
+      foo = cache.insert(typename pcache_t::value_type(pid,sptr<pstats>()));
+      if (foo.second) foo.first->second = a->add_job(phrase, max_sample);
+      return foo.first->second;
     }
 
     template<typename Token>
@@ -1245,13 +1336,18 @@ namespace Moses {
     Bitext<Token>::
     lookup(iter const& phrase) const
     {
-      boost::lock_guard<boost::mutex>(this->lock);
-      sptr<pstats> ret;
+      uint64_t owner = thread_cache_owner(phrase);
+      sptr<pstats> ret = pstats_thread_cache::find(owner, phrase.getPid());
+      if (ret) return ret;
       ret = prep2(phrase, this->default_sample_size);
       assert(ret);
-      boost::unique_lock<boost::mutex> lock(ret->lock);
-      while (ret->in_progress)
-	ret->ready.wait(lock);
+      {
+	boost::unique_lock<boost::mutex> lock(ret->lock);
+	while (ret->in_progress)
+	  ret->ready.wait(lock);
+      }
+      // only finished stats go into the thread cache
+      pstats_thread_cache::store(owner, phrase.getPid(), ret);
       return ret;
     }
 
@@ -1260,7 +1356,8 @@ namespace Moses {
     Bitext<Token>::
     lookup(iter const& phrase, size_t const max_sample) const
     {
-      boost::lock_guard<boost::mutex>(this->lock);
+      if (max_sample == this->default_sample_size)
+	return lookup(phrase);
       sptr<pstats> ret = prep2(phrase, max_sample);
       boost::unique_lock<boost::mutex> lock(ret->lock);
       while (ret->in_progress)
@@ -1294,9 +1391,120 @@ namespace Moses {
     job::
     done() const
     { 
+      boost::lock_guard<boost::mutex> jguard(lock);
       return (max_samples && stats->good >= max_samples) || next == stop; 
     }
 
+    // Write the sentences of track /a/ followed by those of track /b/
+    // (if any) as a memory-mapped track file (.mct or .mam).
+    template<typename TKN>
+    void
+    write_merged_track(Ttrack<TKN> const& a, Ttrack<TKN> const* b, 
+		       string const& fname)
+    {
+      ofstream out(fname.c_str());
+      mmTtrack<TKN> writer;
+      writer.write_blank_file_header(out);
+      vector<id_type> idx(1,0);
+      Ttrack<TKN> const* t[2] = { &a, b };
+      for (size_t k = 0; k < 2 && t[k]; ++k)
+	for (size_t sid = 0; sid < t[k]->size(); ++sid)
+	  {
+	    char const* x = reinterpret_cast<char const*>(t[k]->sntStart(sid));
+	    char const* z = reinterpret_cast<char const*>(t[k]->sntEnd(sid));
+	    out.write(x,z-x);
+	    idx.push_back(idx.back() + t[k]->sntLen(sid));
+	  }
+      writer.write_index_and_finalize(out,idx,idx.back());
+      out.close();
+      if (!out)
+	UTIL_THROW(util::Exception, "Error writing " << fname);
+    }
+
+    // Write the suffix array of /crp/ as a memory-mapped suffix array 
+    // (.sfa) file by merging the suffix arrays /a/ and /b/. /crp/ must
+    // be the corpus of /a/ followed by that of /b/ (see 
+    // write_merged_track()); the sentence ids of /b/ are shifted 
+    // accordingly. /vsize/ is the size of the vocabulary.
+    template<typename TKN>
+    void
+    write_merged_tsa(TSA<TKN> const& a, TSA<TKN> const* b, 
+		     Ttrack<TKN> const& crp, size_t const vsize,
+		     string const& fname)
+    {
+      typedef ttrack::Position::LESS<Ttrack<TKN> > less_t;
+      less_t less(&crp);
+      id_type const shift = a.getCorpus()->size();
+      tsa::ArrayEntry x, y;
+      char const* p = a.arrayStart();
+      char const* q = b ? b->arrayStart() : NULL;
+      if (p < a.arrayEnd()) a.readEntry(p,x);
+      if (b && q < b->arrayEnd()) { b->readEntry(q,y); y.sid += shift; }
+
+      ofstream out(fname.c_str());
+      numwrite(out,filepos_type(0)); // place holder for index start
+      numwrite(out,id_type(0));      // place holder for index size
+      vector<filepos_type> mmIndex;
+      for (;;)
+	{
+	  bool from_a = p < a.arrayEnd();
+	  bool from_b = b && q < b->arrayEnd();
+	  if (!from_a && !from_b) break;
+	  if (from_a && from_b) from_b = less(y,x);
+	  tsa::ArrayEntry const& e = from_b ? y : x;
+	  id_type wid = crp.getToken(e)->id();
+	  while (mmIndex.size() <= wid) mmIndex.push_back(out.tellp());
+	  tightwrite(out,e.sid,0);
+	  tightwrite(out,e.offset,1);
+	  if (from_b)
+	    {
+	      q = y.next;
+	      if (q < b->arrayEnd()) { b->readEntry(q,y); y.sid += shift; }
+	    }
+	  else if ((p = x.next) < a.arrayEnd()) 
+	    a.readEntry(p,x);
+	}
+      while (mmIndex.size() <= vsize) mmIndex.push_back(out.tellp());
+      filepos_type idxStart = out.tellp();
+      for (size_t i = 0; i < mmIndex.size(); i++)
+	numwrite(out,mmIndex[i]-mmIndex[0]);
+      out.seekp(0);
+      numwrite(out,idxStart);
+      numwrite(out,id_type(mmIndex.size()));
+      out.close();
+      if (!out)
+	UTIL_THROW(util::Exception, "Error writing " << fname);
+    }
+
+    // Write the sentence pairs of /base/ followed by those of /delta/ as
+    // a memory-mapped bitext that mmBitext::open(obase,L1,L2) can open.
+    // /delta/ must use the vocabularies of /base/ (as the dynamic bitext
+    // of Mmsapt does), so word ids remain as they are. The suffix arrays 
+    // are merged from the existing ones instead of being sorted anew,
+    // so the cost is linear in the size of the bitext. Lookups on 
+    // /base/ and /delta/ can continue while this runs.
+    template<typename TKN>
+    void
+    write_merged_bitext(Bitext<TKN> const& base, Bitext<TKN> const& delta,
+			string const& obase, string const& L1, 
+			string const& L2)
+    {
+      // the vocabularies first: they must cover all ids in the tracks.
+      // Decoding may add unknown words to them while this runs; write()
+      // copies them under the vocabulary's lock.
+      size_t vsize1 = base.V1->write(obase+L1+".tdx");
+      size_t vsize2 = base.V2->write(obase+L2+".tdx");
+
+      write_merged_track(*base.T1, delta.T1.get(), obase+L1+".mct");
+      write_merged_track(*base.T2, delta.T2.get(), obase+L2+".mct");
+      write_merged_track(*base.Tx, delta.Tx.get(), obase+L1+"-"+L2+".mam");
+
+      mmTtrack<TKN> t1(obase+L1+".mct");
+      write_merged_tsa(*base.I1, delta.I1.get(), t1, vsize1, obase+L1+".sfa");
+      mmTtrack<TKN> t2(obase+L2+".mct");
+      write_merged_tsa(*base.I2, delta.I2.get(), t2, vsize2, obase+L2+".sfa");
+    }
+
   } // end of namespace bitext
 } // end of namespace moses
 #endif
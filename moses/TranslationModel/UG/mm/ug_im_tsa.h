@@ -391,7 +391,7 @@ namespace ugdiss
   		k = copy(prior.sufa.begin() + prior.index[i-1], 
   			 prior.sufa.begin() + prior.index[i], k);
   	      }
-  	    this->index[i] = k - prior.sufa.begin();
+  	    this->index[i] = k - this->sufa.begin();
   	  }
   	if (++i < prior.index.size() && prior.index[i] > prior.index[i-1])
   	  {
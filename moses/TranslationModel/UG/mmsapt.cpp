@@ -1,6 +1,9 @@
 #include "mmsapt.h"
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 #include <boost/tokenizer.hpp>
+#include <boost/unordered_set.hpp>
+#include <cstdio>
 
 namespace Moses
 {
@@ -40,6 +43,12 @@ namespace Moses
     this->init(line);
   }
 
+  Mmsapt::
+  ~Mmsapt()
+  {
+    if (compactor.joinable()) compactor.join();
+  }
+
   void
   Mmsapt::
   init(string const& line)
@@ -61,6 +70,10 @@ namespace Moses
     // num_features = 0;
     m = param.find("ifactor");
     input_factor = m != param.end() ? atoi(m->second.c_str()) : 0;
+    m = param.find("compact-after");
+    compact_after = m != param.end() ? atoi(m->second.c_str()) : 0;
+    generation = 0;
+    compacting = false;
     poolCounts = true;
   }
 
@@ -68,7 +81,8 @@ namespace Moses
   Mmsapt::
   Load()
   {
-    btfix.open(bname, L1, L2);
+    btfix.reset(new mmbitext());
+    btfix->open(bname, L1, L2);
     size_t num_feats;
     // TO DO: should we use different lbop parameters 
     //        for the relative-frequency based features?
@@ -82,7 +96,7 @@ namespace Moses
 	num_feats  = calc_pfwd_dyn.init(num_feats,lbop_parameter);
 	num_feats  = calc_pbwd_dyn.init(num_feats,lbop_parameter);
       }
-    btdyn.reset(new imBitext<Token>(btfix.V1, btfix.V2));
+    btdyn.reset(new imBitext<Token>(btfix->V1, btfix->V2));
     if (num_feats != this->m_numScoreComponents)
       {
 	ostringstream buf;
@@ -113,6 +127,87 @@ namespace Moses
     vector<string> ALN(1,a);
     boost::lock_guard<boost::mutex> guard(this->lock);
     btdyn = btdyn->add(S1,S2,ALN);
+    if (compacting)
+      {
+	pending1.push_back(s1);
+	pending2.push_back(s2);
+	pending_aln.push_back(a);
+      }
+    else if (compact_after && btdyn->T1->size() >= compact_after)
+      {
+	// the previous compaction thread has released the lock for good
+	if (compactor.joinable()) compactor.join();
+	compacting = true;
+	compactor = boost::thread(boost::bind(&Mmsapt::compact, this, 
+					      btfix, btdyn, generation+1));
+      }
+  }
+
+  // Merge /fix/ and /dyn/ into generation /gen/ of the static bitext and
+  // swap it in. Runs in the background; decoding continues on /fix/ and
+  // /dyn/ (or newer versions of the dynamic bitext) in the meantime.
+  void
+  Mmsapt::
+  compact(sptr<mmbitext> fix, sptr<imbitext> dyn, size_t const gen)
+  {
+    ostringstream buf;
+    buf << bname << "g" << gen << ".";
+    string const obase = buf.str();
+    sptr<mmbitext> nfix(new mmbitext());
+    try 
+      {
+	write_merged_bitext(*fix, *dyn, obase, L1, L2);
+	nfix->open(obase, L1, L2);
+      }
+    catch (std::exception& e)
+      { 
+	// btdyn already holds everything, so we just keep going without
+	// compaction from here on
+	cerr << "Mmsapt: compaction into " << obase << " failed: " 
+	     << e.what() << endl;
+	boost::lock_guard<boost::mutex> guard(this->lock);
+	pending1.clear();
+	pending2.clear();
+	pending_aln.clear();
+	compacting = false;
+	compact_after = 0;
+	return;
+      }
+    sptr<imbitext> ndyn(new imbitext(nfix->V1, nfix->V2));
+    
+    // Replay the sentence pairs that arrived during the merge; the 
+    // lock is only held to hand over the queue and for the final swap.
+    for (;;)
+      {
+	vector<string> s1, s2, aln;
+	{
+	  boost::lock_guard<boost::mutex> guard(this->lock);
+	  if (pending1.empty())
+	    {
+	      btfix = nfix;
+	      btdyn = ndyn;
+	      generation = gen;
+	      compacting = false;
+	      break;
+	    }
+	  s1.swap(pending1);
+	  s2.swap(pending2);
+	  aln.swap(pending_aln);
+	}
+	ndyn = ndyn->add(s1,s2,aln);
+      }
+    
+    // Lookups still holding the previous generation keep their mappings
+    // after the files are unlinked. The original base files stay.
+    if (gen > 1)
+      {
+	ostringstream old;
+	old << bname << "g" << gen-1 << ".";
+	string const suffix[] = { L1+".tdx", L2+".tdx", L1+".mct", L2+".mct", 
+				  L1+"-"+L2+".mam", L1+".sfa", L2+".sfa" };
+	for (size_t i = 0; i < sizeof(suffix)/sizeof(string); ++i)
+	  remove((old.str()+suffix[i]).c_str());
+      }
   }
 
 
@@ -167,7 +262,7 @@ namespace Moses
   Mmsapt::
   pool_pstats(Phrase   const& src,
 	      uint64_t const  pid1a, 
-	      pstats        * statsa, 
+	      pstats   const* statsa, 
 	      Bitext<Token> const & bta,
 	      uint64_t const  pid1b, 
 	      pstats   const* statsb, 
@@ -185,7 +280,10 @@ namespace Moses
 
     apply_pp(bta,pp);
     boost::unordered_map<uint64_t,jstats>::const_iterator b;
-    boost::unordered_map<uint64_t,jstats>::iterator a;
+    boost::unordered_map<uint64_t,jstats>::const_iterator a;
+    // phrase pairs in statsa already covered by statsb; the stats are
+    // shared with other threads and must not be modified
+    boost::unordered_set<uint64_t> seen; 
     if (statsb)
       {
 	for (b = statsb->trg.begin(); b != statsb->trg.end(); ++b)
@@ -201,7 +299,7 @@ namespace Moses
 			       != statsa->trg.end()))
 		  {
 		    pp.update(b->first,a->second,b->second);
-		    a->second.invalidate();
+		    seen.insert(a->first);
 		  }
 		else 
 		  pp.update(b->first,m.approxOccurrenceCount(),
@@ -218,7 +316,7 @@ namespace Moses
     for (a = statsa->trg.begin(); a != statsa->trg.end(); ++a)
       {
 	uint32_t sid,off,len;
-	if (!a->second.valid()) continue;
+	if (seen.find(a->first) != seen.end()) continue;
 	parse_pid(a->first, sid, off, len);
 	if (btb.T2)
 	  {
@@ -246,7 +344,7 @@ namespace Moses
   combine_pstats
   (Phrase   const& src,
    uint64_t const  pid1a, 
-   pstats   * statsa, 
+   pstats   const* statsa, 
    Bitext<Token> const & bta,
    uint64_t const  pid1b, 
    pstats   const* statsb, 
@@ -259,7 +357,8 @@ namespace Moses
     if (statsa) ppfix.init(pid1a,*statsa,this->m_numScoreComponents);
     if (statsb) ppdyn.init(pid1b,*statsb,this->m_numScoreComponents);
     boost::unordered_map<uint64_t,jstats>::const_iterator b;
-    boost::unordered_map<uint64_t,jstats>::iterator a;
+    boost::unordered_map<uint64_t,jstats>::const_iterator a;
+    boost::unordered_set<uint64_t> seen; // see pool_pstats
     if (statsb)
       {
 	pool.init(pid1b,*statsb,0);
@@ -282,7 +381,7 @@ namespace Moses
 		ppfix.update(a->first,a->second);
 		calc_pfwd_fix(bta,ppfix,&ppdyn.fvals);
 		calc_pbwd_fix(btb,ppfix,&ppdyn.fvals);
-		a->second.invalidate();
+		seen.insert(a->first);
 	      }
 	    else 
 	      {
@@ -303,7 +402,7 @@ namespace Moses
 	apply_pp(bta,ppfix);
 	for (a = statsa->trg.begin(); a != statsa->trg.end(); ++a)
 	  {
-	    if (!a->second.valid()) continue; // done above
+	    if (seen.find(a->first) != seen.end()) continue; // done above
 	    ppfix.update(a->first,a->second);
 	    calc_pfwd_fix(bta,ppfix);
 	    calc_pbwd_fix(bta,ppfix);
@@ -418,12 +517,16 @@ namespace Moses
   {
     TargetPhraseCollection* ret = new TargetPhraseCollection();
 
-    // Reserve a local copy of the dynamic bitext in its current form. /btdyn/
+    // Reserve local copies of the bitexts in their current form. /btdyn/
     // is set to a new copy of the dynamic bitext every time a sentence pair
-    // is added. /dyn/ keeps the old bitext around as long as we need it.
+    // is added, and both are replaced when compaction finishes. /fix/ and
+    // /dyn/ keep the old bitexts around as long as we need them.
+    sptr<mmbitext> fix;
     sptr<imBitext<Token> > dyn;
+    // The lock is only held to copy the pointers.
     { // braces are needed for scoping mutex lock guard!
       boost::lock_guard<boost::mutex> guard(this->lock);
+      fix = btfix;
       dyn = btdyn;
     }
 
@@ -431,11 +534,11 @@ namespace Moses
     for (size_t i = 0; i < src.GetSize(); ++i)
       {
 	Factor const* f = src.GetFactor(i,input_factor);
-	id_type wid = (*btfix.V1)[f->ToString()]; 
+	id_type wid = (*fix->V1)[f->ToString()]; 
 	sphrase[i] = wid;
       }
 
-    TSA<Token>::tree_iterator mfix(btfix.I1.get()), mdyn(dyn->I1.get());
+    TSA<Token>::tree_iterator mfix(fix->I1.get()), mdyn(dyn->I1.get());
     for (size_t i = 0; mfix.size() == i && i < sphrase.size(); ++i)
       mfix.extend(sphrase[i]);
     
@@ -446,22 +549,19 @@ namespace Moses
       }
 
     sptr<pstats> sfix,sdyn;
+    // Bitext::lookup() is thread-safe; concurrent lookups of the same 
+    // phrase share a single sampling job.
     if (mfix.size() == sphrase.size())
-      {
-	// do we need this lock here? 
-	// Is it used here to control the total number of running threads???
-	boost::lock_guard<boost::mutex> guard(this->lock);
-	sfix = btfix.lookup(mfix);
-      }
+      sfix = fix->lookup(mfix);
     if (mdyn.size() == sphrase.size())
       sdyn = dyn->lookup(mdyn);
     if (poolCounts)
       {
-	if (!pool_pstats(src, mfix.getPid(),sfix.get(),btfix, 
+	if (!pool_pstats(src, mfix.getPid(),sfix.get(),*fix, 
 			 mdyn.getPid(),sdyn.get(),*dyn,ret))
 	  return NULL;
       }
-    else if (!combine_pstats(src, mfix.getPid(),sfix.get(),btfix, 
+    else if (!combine_pstats(src, mfix.getPid(),sfix.get(),*fix, 
 			     mdyn.getPid(),sdyn.get(),*dyn,ret))
       return NULL;
     ret->NthElement(m_tableLimit);
@@ -50,7 +50,7 @@ namespace Moses
     typedef imBitext<Token> imbitext;
     typedef TSA<Token>           tsa;
   private:
-    mmbitext btfix; 
+    sptr<mmbitext> btfix; 
     sptr<imbitext> btdyn;
     string bname;
     string L1;
@@ -66,7 +66,19 @@ namespace Moses
     PScoreLex<Token>  calc_lex; // this one I'd like to see as an external ff eventually
     PScorePP<Token>   apply_pp; // apply phrase penalty 
     void init(string const& line);
-    mutable boost::mutex lock;
+    mutable boost::mutex lock; // guards btfix, btdyn and compaction state
+
+    // Compaction: once the dynamic bitext holds /compact_after/ sentence
+    // pairs (0: never), a background thread merges it into a new generation
+    // of the static bitext on disk, which then replaces btfix. Sentence
+    // pairs added in the meantime are kept in /pending/ and replayed into
+    // the new (empty) dynamic bitext before the swap.
+    size_t compact_after;
+    size_t generation; // generation of btfix; 0 is the one at /bname/
+    bool   compacting;
+    vector<string> pending1, pending2, pending_aln;
+    boost::thread compactor;
+    void compact(sptr<mmbitext> fix, sptr<imbitext> dyn, size_t const gen);
     bool poolCounts;
     vector<FactorType> ofactor;
 
@@ -98,7 +110,7 @@ namespace Moses
     pool_pstats
     (Phrase   const& src,
      uint64_t const  pid1a, 
-     pstats        * statsa, 
+     pstats   const* statsa, 
      Bitext<Token> const & bta,
      uint64_t const  pid1b, 
      pstats   const* statsb, 
@@ -110,7 +122,7 @@ namespace Moses
     combine_pstats
     (Phrase   const& src,
      uint64_t const  pid1a, 
-     pstats   * statsa, 
+     pstats   const* statsa, 
      Bitext<Token> const & bta,
      uint64_t const  pid1b, 
      pstats   const* statsb, 
@@ -121,6 +133,7 @@ namespace Moses
   public:
     // Mmsapt(string const& description, string const& line);
     Mmsapt(string const& line);
+    ~Mmsapt();
     void
     Load();
     
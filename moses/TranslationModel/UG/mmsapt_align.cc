@@ -131,9 +131,9 @@ namespace Moses
       COOCjnt = PT.calc_lex.scorer.COOC;
 
     out << setw(10) << exp(ah.score) << " "
-	<< PT.btfix.T2->pid2str(PT.btfix.V2.get(), ah.pp.p2) 
+	<< PT.btfix->T2->pid2str(PT.btfix->V2.get(), ah.pp.p2) 
 	<< " <=> "
-	<< PT.btfix.T1->pid2str(PT.btfix.V1.get(), ah.pp.p1);
+	<< PT.btfix->T1->pid2str(PT.btfix->V1.get(), ah.pp.p1);
     vector<uchar> const& a = ah.pp.aln;
     // BOOST_FOREACH(int x,a) cout << "[" << x << "] ";
     for (size_t u = 0; u+1 < a.size(); u += 2)
@@ -197,7 +197,7 @@ namespace Moses
     tspan2pid.assign(t.size(),vector<uint64_t>(t.size(),0));
     for (size_t i = 0; i < t.size(); ++i)
       {
-	tsa::tree_iterator m(PT.btfix.I2.get());
+	tsa::tree_iterator m(PT.btfix->I2.get());
 	for (size_t k = i; k < t.size() && m.extend(t[k]); ++k)
 	  {
 	    uint64_t pid = m.getPid();
@@ -215,7 +215,7 @@ namespace Moses
     spstats.resize(s.size());
     for (size_t i = 0; i < s.size(); ++i)
       {
-	tsa::tree_iterator m(PT.btfix.I1.get());
+	tsa::tree_iterator m(PT.btfix->I1.get());
 	for (size_t k = i; k < s.size() && m.extend(s[k]); ++k)
 	  {
 	    uint64_t pid = m.getPid();
@@ -229,8 +229,8 @@ namespace Moses
 	      }
 	    else 
 	      {
-		spstats[i].push_back(PT.btfix.lookup(m));
-		cout << PT.btfix.T1->pid2str(PT.btfix.V1.get(),pid) << " "
+		spstats[i].push_back(PT.btfix->lookup(m));
+		cout << PT.btfix->T1->pid2str(PT.btfix->V1.get(),pid) << " "
 		     << spstats[i].back()->good << "/" << spstats[i].back()->sample_cnt 
 		     << endl;
 	      }
@@ -243,13 +243,13 @@ namespace Moses
   Alignment(Mmsapt const& pt, string const& src, string const& trg)
     : PT(pt)
   {
-    PT.btfix.V1->fillIdSeq(src,s);
-    PT.btfix.V2->fillIdSeq(trg,t);
+    PT.btfix->V1->fillIdSeq(src,s);
+    PT.btfix->V2->fillIdSeq(trg,t);
 
     // LexicalPhraseScorer2<Token>::table_t const& COOC = PT.calc_lex.scorer.COOC;
     // BOOST_FOREACH(id_type i, t)
     //   {
-    // 	cout << (*PT.btfix.V2)[i];
+    // 	cout << (*PT.btfix->V2)[i];
     // 	if (i < PT.wlex21.size())
     // 	  {
     // 	    BOOST_FOREACH(id_type k, PT.wlex21[i])
@@ -258,7 +258,7 @@ namespace Moses
     // 		size_t m1 = COOC.m1(k);
     // 		size_t m2 = COOC.m2(i);
     // 		if (j*1000 > m1 && j*1000 > m2)
-    // 		  cout << " " << (*PT.btfix.V1)[k];
+    // 		  cout << " " << (*PT.btfix->V1)[k];
     // 	      }	 
     // 	  }
     // 	cout << endl;
@@ -283,9 +283,9 @@ namespace Moses
 	    psiter R = tpid2span.find(y->first);
 	    if (R == tpid2span.end()) continue;
 	    pp.update(y->first, y->second);
-	    PT.calc_lex(PT.btfix,pp);
-	    PT.calc_pfwd_fix(PT.btfix,pp);
-	    PT.calc_pbwd_fix(PT.btfix,pp);
+	    PT.calc_lex(*PT.btfix,pp);
+	    PT.calc_pfwd_fix(*PT.btfix,pp);
+	    PT.calc_pbwd_fix(*PT.btfix,pp);
 	    pp.eval(PT.feature_weights);
 	    PP.push_back(pp);
 	    BOOST_FOREACH(span const& sspan, L->second)
@@ -34,6 +34,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "TypeDef.h"
 #include "ScoreComponentCollection.h"
 #include "StaticData.h"
+#include "SentenceArena.h"
 
 namespace Moses
 {
@@ -80,6 +81,14 @@ public:
   TranslationOption(const WordsRange &wordsRange
                     , const TargetPhrase &targetPhrase);
 
+  // options are created per sentence. take them from the sentence's arena
+  static void *operator new(std::size_t size) {
+    return SentenceArena::Allocate(size);
+  }
+  static void operator delete(void *ptr) {
+    SentenceArena::Free(ptr);
+  }
+
   /** returns true if all feature types in featuresToCheck are compatible between the two phrases */
   bool IsCompatible(const Phrase& phrase, const std::vector<FactorType>& featuresToCheck) const;
 
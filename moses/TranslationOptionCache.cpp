@@ -0,0 +1,59 @@
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#include <boost/functional/hash.hpp>
+
+#include "moses/TranslationOptionCache.h"
+#include "moses/Phrase.h"
+
+namespace Moses
+{
+
+TranslationOptionCache::TranslationOptionCache(size_t maxBytes)
+  : m_cache(maxBytes)
+  , m_builtSpans(0)
+  , m_buildTime(0.0)
+{
+}
+
+size_t TranslationOptionCache::MakeKey(const Phrase &source, const std::string &weightSetting)
+{
+  size_t seed = hash_value(source);
+  boost::hash_combine(seed, weightSetting);
+  return seed;
+}
+
+void TranslationOptionCache::AddBuildTime(size_t spans, double seconds)
+{
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_timeMutex);
+#endif
+  m_builtSpans += spans;
+  m_buildTime += seconds;
+}
+
+double TranslationOptionCache::GetMeanBuildTime() const
+{
+#ifdef WITH_THREADS
+  boost::mutex::scoped_lock lock(m_timeMutex);
+#endif
+  return m_builtSpans ? m_buildTime / m_builtSpans : 0.0;
+}
+
+}
@@ -0,0 +1,87 @@
+// -*- c++ -*-
+/***********************************************************************
+Moses - factored phrase-based language decoder
+Copyright (C) 2013 University of Edinburgh
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+***********************************************************************/
+
+#ifndef moses_TranslationOptionCache_h
+#define moses_TranslationOptionCache_h
+
+#include <string>
+
+#ifdef WITH_THREADS
+#include <boost/thread/mutex.hpp>
+#endif
+
+#include "moses/TranslationModel/SharedTargetPhraseCache.h"
+
+namespace Moses
+{
+
+class Phrase;
+
+/** Translation options of source phrases, kept across sentences.
+ *
+ * For each source phrase, the cache holds the target phrases of the
+ * options that the decoding graphs produced for it, in order, as they are
+ * before any feature that looks at the rest of the sentence is applied.
+ * A sentence containing the phrase again gets copies of these options
+ * instead of running the decoding steps, and then goes through the usual
+ * source-context scoring, pruning and sorting, so the result is the same.
+ *
+ * The cache is shared by all decoding threads and bounded in bytes.
+ */
+class TranslationOptionCache
+{
+public:
+  typedef SharedTargetPhraseCache::Ptr Ptr;
+
+  explicit TranslationOptionCache(size_t maxBytes);
+
+  //! key for the options of source under the decoder's current weight setting
+  static size_t MakeKey(const Phrase &source, const std::string &weightSetting);
+
+  bool Find(size_t key, Ptr &out) {
+    return m_cache.Find(key, out);
+  }
+  void Insert(size_t key, const Ptr &options) {
+    m_cache.Insert(key, options);
+  }
+
+  //! account for the time it took to build options for some spans that missed
+  void AddBuildTime(size_t spans, double seconds);
+
+  //! average time to build the options of a span, over all misses so far
+  double GetMeanBuildTime() const;
+
+  SharedTargetPhraseCache::Stats GetStats() const {
+    return m_cache.GetStats();
+  }
+
+private:
+  SharedTargetPhraseCache m_cache;
+
+  size_t m_builtSpans;
+  double m_buildTime;
+#ifdef WITH_THREADS
+  mutable boost::mutex m_timeMutex;
+#endif
+};
+
+}
+
+#endif
@@ -60,6 +60,9 @@ TranslationOptionCollection::TranslationOptionCollection(
   ,m_futureScore(src.GetSize())
   ,m_maxNoTransOptPerCoverage(maxNoTransOptPerCoverage)
   ,m_translationOptionThreshold(translationOptionThreshold)
+  ,m_cacheHits(0)
+  ,m_cacheMisses(0)
+  ,m_cacheTimeSaved(0.0)
 {
   // create 2-d vector
   size_t size = src.GetSize();
@@ -382,7 +385,6 @@ void TranslationOptionCollection::CreateTranslationOptions()
     }
 
     const DecodeGraph &decodeGraph = *decodeGraphList[graphInd];
-    size_t backoff = decodeGraph.GetBackoff();
     // generate phrases that start at startPos ...
     for (size_t startPos = 0 ; startPos < size; startPos++) {
       size_t maxSize = size - startPos; // don't go over end of sentence
@@ -391,11 +393,7 @@ void TranslationOptionCollection::CreateTranslationOptions()
 
       // ... and that end at endPos
       for (size_t endPos = startPos ; endPos < startPos + maxSize ; endPos++) {
-        if (graphInd > 0 && // only skip subsequent graphs
-        	backoff != 0 && // use of backoff specified
-            (endPos-startPos+1 >= backoff || // size exceeds backoff limit or ...
-             m_collection[startPos][endPos-startPos].size() > 0)) { // no phrases found so far
-          VERBOSE(3,"No backoff to graph " << graphInd << " for span [" << startPos << ";" << endPos << "]" << endl);
+        if (SkipBackoffGraph(graphInd, startPos, endPos)) {
           // do not create more options
           continue;
         }
@@ -406,6 +404,11 @@ void TranslationOptionCollection::CreateTranslationOptions()
     }
   }
 
+  FinalizeTranslationOptions();
+}
+
+void TranslationOptionCollection::FinalizeTranslationOptions()
+{
   VERBOSE(3,"Translation Option Collection\n " << *this << endl);
 
   ProcessUnknownWord();
@@ -424,6 +427,35 @@ void TranslationOptionCollection::CreateTranslationOptions()
   CacheLexReordering();
 }
 
+bool TranslationOptionCollection::SkipBackoffGraph(size_t graphInd, size_t startPos, size_t endPos) const
+{
+  if (graphInd == 0) {
+    // only skip subsequent graphs
+    return false;
+  }
+  size_t backoff = StaticData::Instance().GetDecodeGraphs()[graphInd]->GetBackoff();
+  if (backoff != 0 && // use of backoff specified
+      (endPos-startPos+1 >= backoff || // size exceeds backoff limit or ...
+       m_collection[startPos][endPos-startPos].size() > 0)) { // no phrases found so far
+    VERBOSE(3,"No backoff to graph " << graphInd << " for span [" << startPos << ";" << endPos << "]" << endl);
+    return true;
+  }
+  return false;
+}
+
+/** Create the translation options of one span from all decoding graphs, as
+ * CreateTranslationOptions() does for every span.
+ */
+void TranslationOptionCollection::CreateTranslationOptionsForSpan(size_t startPos, size_t endPos)
+{
+  const vector <DecodeGraph*> &decodeGraphList = StaticData::Instance().GetDecodeGraphs();
+  for (size_t graphInd = 0 ; graphInd < decodeGraphList.size() ; graphInd++) {
+    if (!SkipBackoffGraph(graphInd, startPos, endPos)) {
+      CreateTranslationOptionsForRange(*decodeGraphList[graphInd], startPos, endPos, true, graphInd);
+    }
+  }
+}
+
 void TranslationOptionCollection::CreateTranslationOptionsForRange(
   const DecodeGraph &decodeGraph
   , size_t startPos
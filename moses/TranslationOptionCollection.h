@@ -71,12 +71,23 @@ protected:
   const float				m_translationOptionThreshold; /*< threshold for translation options with regard to best option for input span */
   std::vector<const Phrase*> m_unksrcs;
   InputPathList m_inputPathQueue;
+  size_t m_cacheHits, m_cacheMisses; /*< spans looked up in the translation option cache */
+  double m_cacheTimeSaved; /*< estimated */
 
   TranslationOptionCollection(InputType const& src, size_t maxNoTransOptPerCoverage,
                               float translationOptionThreshold);
 
   void CalcFutureScore();
 
+  //! unknown words, scoring with source context, pruning, sorting and future costs, once all spans have options
+  void FinalizeTranslationOptions();
+
+  //! true if graphInd is a backoff graph that is not used for this span
+  bool SkipBackoffGraph(size_t graphInd, size_t startPos, size_t endPos) const;
+
+  //! translation options for one span from all decoding graphs
+  void CreateTranslationOptionsForSpan(size_t startPos, size_t endPos);
+
   //! Force a creation of a translation option where there are none for a particular source position.
   void ProcessUnknownWord();
   //! special handling of ONE unknown words.
@@ -120,6 +131,17 @@ public:
     return m_source;
   }
 
+  //! translation option cache lookups made for this sentence
+  size_t GetNumCacheHits() const {
+    return m_cacheHits;
+  }
+  size_t GetNumCacheMisses() const {
+    return m_cacheMisses;
+  }
+  double GetCacheTimeSaved() const {
+    return m_cacheTimeSaved;
+  }
+
   //!List of unknowns (OOVs)
   const std::vector<const Phrase*>& GetUnknownSources() const {
     return m_unksrcs;
@@ -25,6 +25,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "DecodeStepTranslation.h"
 #include "FactorCollection.h"
 #include "WordsRange.h"
+#include "StaticData.h"
+#include "TargetPhraseCollection.h"
+#include "TranslationOptionCache.h"
+#include "Timer.h"
 #include <list>
 
 using namespace std;
@@ -160,7 +164,71 @@ InputPath &TranslationOptionCollectionText::GetInputPath(size_t startPos, size_t
 void TranslationOptionCollectionText::CreateTranslationOptions()
 {
   GetTargetPhraseCollectionBatch();
-  TranslationOptionCollection::CreateTranslationOptions();
+
+  TranslationOptionCache *cache = StaticData::Instance().GetTranslationOptionCache();
+  if (cache) {
+    CreateTranslationOptionsCached(*cache);
+    FinalizeTranslationOptions();
+  } else {
+    TranslationOptionCollection::CreateTranslationOptions();
+  }
+}
+
+/** Like the graph loop of CreateTranslationOptions(), but span by span, so
+ * that the options of each span can be taken from or added to the cache.
+ * The per-span result is the same either way, since backing off to another
+ * graph only depends on the options of the span itself.
+ * Spans touched by xml options depend on the markup and are not cached.
+ */
+void TranslationOptionCollectionText::CreateTranslationOptionsCached(TranslationOptionCache &cache)
+{
+  const std::string &weightSetting = StaticData::Instance().GetCurrentWeightSetting();
+  const size_t maxSizePhrase = StaticData::Instance().GetMaxPhraseLength();
+  const size_t size = m_source.GetSize();
+  double buildTime = 0.0;
+
+  for (size_t startPos = 0 ; startPos < size; startPos++) {
+    const size_t maxSize = std::min(size - startPos, maxSizePhrase);
+    for (size_t endPos = startPos ; endPos < startPos + maxSize ; endPos++) {
+      if (HasXmlOptionsOverlappingRange(startPos, endPos)) {
+        CreateTranslationOptionsForSpan(startPos, endPos);
+        continue;
+      }
+
+      InputPath &inputPath = GetInputPath(startPos, endPos);
+      const size_t key = TranslationOptionCache::MakeKey(inputPath.GetPhrase(), weightSetting);
+
+      TranslationOptionCache::Ptr cached;
+      if (cache.Find(key, cached)) {
+        ++m_cacheHits;
+        TargetPhraseCollection::const_iterator iter;
+        for (iter = cached->begin(); iter != cached->end(); ++iter) {
+          TranslationOption *transOpt = new TranslationOption(inputPath.GetWordsRange(), **iter);
+          transOpt->SetInputPath(inputPath);
+          Add(transOpt);
+        }
+        continue;
+      }
+
+      ++m_cacheMisses;
+      Timer timer;
+      timer.start();
+      CreateTranslationOptionsForSpan(startPos, endPos);
+      buildTime += timer.get_elapsed_time();
+
+      const TranslationOptionList &transOpts = GetTranslationOptionList(startPos, endPos);
+      if (transOpts.size() > 0) {
+        TargetPhraseCollection *coll = new TargetPhraseCollection();
+        for (size_t i = 0; i < transOpts.size(); ++i) {
+          coll->Add(new TargetPhrase(transOpts.Get(i)->GetTargetPhrase()));
+        }
+        cache.Insert(key, TranslationOptionCache::Ptr(coll));
+      }
+    }
+  }
+
+  cache.AddBuildTime(m_cacheMisses, buildTime);
+  m_cacheTimeSaved = m_cacheHits * cache.GetMeanBuildTime();
 }
 
 /** create translation options that exactly cover a specific input span.
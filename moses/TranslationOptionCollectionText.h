@@ -31,6 +31,7 @@ namespace Moses
 {
 
 class Sentence;
+class TranslationOptionCache;
 
 /** Holds all translation options, for all spans, of a particular sentence input
  * Inherited from TranslationOptionCollection.
@@ -45,6 +46,8 @@ protected:
 
   InputPath &GetInputPath(size_t startPos, size_t endPos);
 
+  void CreateTranslationOptionsCached(TranslationOptionCache &cache);
+
 public:
   void ProcessUnknownWord(size_t sourcePos);
 
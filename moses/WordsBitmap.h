@@ -30,6 +30,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <cstdlib>
 #include "TypeDef.h"
 #include "WordsRange.h"
+#include "SentenceArena.h"
 
 namespace Moses
 {
@@ -67,25 +68,25 @@ public:
   //! create WordsBitmap of length size and initialise with vector
   WordsBitmap(size_t size, std::vector<bool> initialize_vector)
     :m_size	(size) {
-    m_bitmap = (bool*) malloc(sizeof(bool) * size);
+    m_bitmap = (bool*) SentenceArena::Allocate(sizeof(bool) * size);
     Initialize(initialize_vector);
   }
   //! create WordsBitmap of length size and initialise
   WordsBitmap(size_t size)
     :m_size	(size) {
-    m_bitmap = (bool*) malloc(sizeof(bool) * size);
+    m_bitmap = (bool*) SentenceArena::Allocate(sizeof(bool) * size);
     Initialize();
   }
   //! deep copy
   WordsBitmap(const WordsBitmap &copy)
     :m_size	(copy.m_size) {
-    m_bitmap = (bool*) malloc(sizeof(bool) * m_size);
+    m_bitmap = (bool*) SentenceArena::Allocate(sizeof(bool) * m_size);
     for (size_t pos = 0 ; pos < copy.m_size ; pos++) {
       m_bitmap[pos] = copy.GetValue(pos);
     }
   }
   ~WordsBitmap() {
-    free(m_bitmap);
+    SentenceArena::Free(m_bitmap);
   }
   //! count of words translated
   size_t GetNumWordsCovered() const {
@@ -38,25 +38,58 @@ extern Vocabulary vcbS;
 extern bool hierarchicalFlag;
 
 
-ExtractionPhrasePair::ExtractionPhrasePair( const PHRASE *phraseSource, 
-                                            const PHRASE *phraseTarget, 
-                                            ALIGNMENT *targetToSourceAlignment, 
+ALIGNMENT_ID AlignmentTable::StoreIfNew( const PACKED &packed )
+{
+  boost::unordered_map<PACKED, ALIGNMENT_ID>::const_iterator found = m_lookup.find( packed );
+  if ( found != m_lookup.end() ) {
+    return found->second;
+  }
+
+  ALIGNMENT_ID id = m_alignments.size();
+  m_alignments.push_back( ALIGNMENT( packed[0] ) );
+  ALIGNMENT &alignment = m_alignments.back();
+  for ( size_t i = 1; i < packed.size(); ++i ) {
+    alignment.at( packed[i] >> 16 ).insert( packed[i] & 0xffff );
+  }
+  m_lookup[packed] = id;
+  return id;
+}
+
+
+ALIGNMENT_ID AlignmentTable::Reset( ALIGNMENT_ID keep )
+{
+  ALIGNMENT alignment;
+  alignment.swap( m_alignments[keep] );
+  PACKED packed( 1, alignment.size() );
+  for ( size_t t = 0; t < alignment.size(); ++t ) {
+    for ( std::set<size_t>::const_iterator s = alignment[t].begin(); s != alignment[t].end(); ++s ) {
+      packed.push_back( ((uint32_t)t << 16) | (uint32_t)*s );
+    }
+  }
+
+  m_lookup.clear();
+  m_alignments.clear();
+  m_alignments.push_back( ALIGNMENT() );
+  m_alignments.back().swap( alignment );
+  m_lookup[packed] = 0;
+  return 0;
+}
+
+
+ExtractionPhrasePair::ExtractionPhrasePair( const PHRASE &phraseSource, 
+                                            const PHRASE &phraseTarget, 
+                                            const AlignmentTable &alignmentTable,
+                                            ALIGNMENT_ID targetToSourceAlignment, 
                                             float count, float pcfgSum ) :
+    m_alignmentTable(&alignmentTable),
     m_phraseSource(phraseSource),
     m_phraseTarget(phraseTarget),
     m_count(count),
     m_pcfgSum(pcfgSum)
 {
-  assert(phraseSource->empty());
-  assert(phraseTarget->empty());
+  m_targetToSourceAlignments.push_back( std::pair<ALIGNMENT_ID,float>(targetToSourceAlignment,count) );
 
-  m_count = count;
-  m_pcfgSum = pcfgSum;
-  
-  std::pair< std::map<ALIGNMENT*,float>::iterator, bool > insertedAlignment =
-      m_targetToSourceAlignments.insert( std::pair<ALIGNMENT*,float>(targetToSourceAlignment,count) );
-
-  m_lastTargetToSourceAlignment = insertedAlignment.first;
+  m_lastTargetToSourceAlignment = 0;
   m_lastCount = m_count;
   m_lastPcfgSum = m_pcfgSum;
 
@@ -64,14 +97,8 @@ ExtractionPhrasePair::ExtractionPhrasePair( const PHRASE *phraseSource,
 }
 
 
-ExtractionPhrasePair::~ExtractionPhrasePair( ) {
-  Clear();
-}
-
-
-// return value: true if the given alignment was seen for the first time and thus will be stored,
-//               false if it was present already (the pointer may thus be deleted(
-bool ExtractionPhrasePair::Add( ALIGNMENT *targetToSourceAlignment, 
+// return value: true if the given alignment was seen for the first time for this phrase pair
+bool ExtractionPhrasePair::Add( ALIGNMENT_ID targetToSourceAlignment, 
                                 float count, float pcfgSum ) 
 {
   m_count += count;
@@ -80,20 +107,20 @@ bool ExtractionPhrasePair::Add( ALIGNMENT *targetToSourceAlignment,
   m_lastCount = count;
   m_lastPcfgSum = pcfgSum;
   
-  std::map<ALIGNMENT*,float>::iterator iter = m_lastTargetToSourceAlignment;
-  if ( *(iter->first) == *targetToSourceAlignment ) {
-    iter->second += count;
+  if ( m_targetToSourceAlignments[m_lastTargetToSourceAlignment].first == targetToSourceAlignment ) {
+    m_targetToSourceAlignments[m_lastTargetToSourceAlignment].second += count;
     return false;
-  } else {
-    std::pair< std::map<ALIGNMENT*,float>::iterator, bool > insertedAlignment =
-        m_targetToSourceAlignments.insert( std::pair<ALIGNMENT*,float>(targetToSourceAlignment,count) );
-    if ( !insertedAlignment.second ) {
+  }
+  // phrase pairs have few distinct alignments, so a linear search will do
+  for ( size_t i = 0; i < m_targetToSourceAlignments.size(); ++i ) {
+    if ( m_targetToSourceAlignments[i].first == targetToSourceAlignment ) {
       // the alignment already exists: increment count
-      insertedAlignment.first->second += count;
+      m_targetToSourceAlignments[i].second += count;
       return false;
     }
-    m_lastTargetToSourceAlignment = insertedAlignment.first;
   }
+  m_lastTargetToSourceAlignment = m_targetToSourceAlignments.size();
+  m_targetToSourceAlignments.push_back( std::pair<ALIGNMENT_ID,float>(targetToSourceAlignment,count) );
 
   return true;
 }
@@ -103,12 +130,11 @@ void ExtractionPhrasePair::IncrementPrevious( float count, float pcfgSum )
 {
   m_count += count;
   m_pcfgSum += pcfgSum;
-  m_lastTargetToSourceAlignment->second += count;
+  m_targetToSourceAlignments[m_lastTargetToSourceAlignment].second += count;
   // properties
-  for ( std::map<std::string, std::pair< PROPERTY_VALUES*, LAST_PROPERTY_VALUE* > >::iterator iter=m_properties.begin(); 
+  for ( std::map<std::string, PropertyValues>::iterator iter=m_properties.begin(); 
         iter !=m_properties.end(); ++iter ) {
-    LAST_PROPERTY_VALUE *lastPropertyValue = (iter->second).second;
-    (*lastPropertyValue)->second += count;
+    iter->second.last->second += count;
   }
 
   m_lastCount = count;
@@ -118,14 +144,14 @@ void ExtractionPhrasePair::IncrementPrevious( float count, float pcfgSum )
 
 // Check for lexical match 
 // and in case of SCFG rules for equal non-terminal alignment.
-bool ExtractionPhrasePair::Matches( const PHRASE *otherPhraseSource,
-                                    const PHRASE *otherPhraseTarget,
-                                    ALIGNMENT *otherTargetToSourceAlignment ) const
+bool ExtractionPhrasePair::Matches( const PHRASE &otherPhraseSource,
+                                    const PHRASE &otherPhraseTarget,
+                                    ALIGNMENT_ID otherTargetToSourceAlignment ) const
 {
-  if (*otherPhraseTarget != *m_phraseTarget) {
+  if (otherPhraseTarget != m_phraseTarget) {
     return false;
   }
-  if (*otherPhraseSource != *m_phraseSource) {
+  if (otherPhraseSource != m_phraseSource) {
     return false;
   }
 
@@ -137,20 +163,20 @@ bool ExtractionPhrasePair::Matches( const PHRASE *otherPhraseSource,
 // Set boolean indicators. 
 // (Note that we check in the order: target - source - alignment
 //  and do not touch the subsequent boolean indicators once a previous one has been set to false.)
-bool ExtractionPhrasePair::Matches( const PHRASE *otherPhraseSource,
-                                    const PHRASE *otherPhraseTarget,
-                                    ALIGNMENT *otherTargetToSourceAlignment,
+bool ExtractionPhrasePair::Matches( const PHRASE &otherPhraseSource,
+                                    const PHRASE &otherPhraseTarget,
+                                    ALIGNMENT_ID otherTargetToSourceAlignment,
                                     bool &sourceMatch,
                                     bool &targetMatch,
                                     bool &alignmentMatch ) const
 {
-  if (*otherPhraseSource != *m_phraseSource) {
+  if (otherPhraseSource != m_phraseSource) {
     sourceMatch = false;
     return false;
   } else {
     sourceMatch = true;
   }
-  if (*otherPhraseTarget != *m_phraseTarget) {
+  if (otherPhraseTarget != m_phraseTarget) {
     targetMatch = false;
     return false;
   } else {
@@ -166,20 +192,21 @@ bool ExtractionPhrasePair::Matches( const PHRASE *otherPhraseSource,
 }
 
 // Check for equal non-terminal alignment in case of SCFG rules.
-// Precondition: otherTargetToSourceAlignment has the same size as m_targetToSourceAlignments.begin()->first
-bool ExtractionPhrasePair::MatchesAlignment( ALIGNMENT *otherTargetToSourceAlignment ) const
+// Precondition: the other alignment has as many target symbols as the alignments of this phrase pair
+bool ExtractionPhrasePair::MatchesAlignment( ALIGNMENT_ID otherTargetToSourceAlignmentId ) const
 {
   if (!hierarchicalFlag) return true;
 
   // all or none of the phrasePair's word alignment matrices match, so just pick one
-  const ALIGNMENT *thisTargetToSourceAlignment = m_targetToSourceAlignments.begin()->first;
+  const ALIGNMENT *thisTargetToSourceAlignment = &m_alignmentTable->GetAlignment( m_targetToSourceAlignments.front().first );
+  const ALIGNMENT *otherTargetToSourceAlignment = &m_alignmentTable->GetAlignment( otherTargetToSourceAlignmentId );
 
-  assert(m_phraseTarget->size() == thisTargetToSourceAlignment->size() + 1);
+  assert(m_phraseTarget.size() == thisTargetToSourceAlignment->size() + 1);
   assert(thisTargetToSourceAlignment->size() == otherTargetToSourceAlignment->size());
 
   // loop over all symbols but the left hand side of the rule
   for (size_t i=0; i<thisTargetToSourceAlignment->size()-1; ++i) {
-    if (isNonTerminal( vcbT.getWord( m_phraseTarget->at(i) ) )) {
+    if (isNonTerminal( vcbT.getWord( m_phraseTarget.at(i) ) )) {
       size_t thisAlign  = *(thisTargetToSourceAlignment->at(i).begin());
       size_t otherAlign = *(otherTargetToSourceAlignment->at(i).begin());
 
@@ -196,28 +223,18 @@ bool ExtractionPhrasePair::MatchesAlignment( ALIGNMENT *otherTargetToSourceAlign
 
 void ExtractionPhrasePair::Clear() 
 {
-  delete m_phraseSource;
-  delete m_phraseTarget;
+  m_phraseSource.clear();
+  m_phraseTarget.clear();
 
   m_count = 0.0f;
   m_pcfgSum = 0.0f;
 
-  for ( std::map<ALIGNMENT*,float>::iterator iter=m_targetToSourceAlignments.begin();
-        iter!=m_targetToSourceAlignments.end(); ++iter) {
-    delete iter->first;
-  }
   m_targetToSourceAlignments.clear();
-
-  for ( std::map<std::string, std::pair< PROPERTY_VALUES*, LAST_PROPERTY_VALUE* > >::iterator iter=m_properties.begin();
-        iter!=m_properties.end(); ++iter) {
-    delete (iter->second).second;
-    delete (iter->second).first;
-  }
   m_properties.clear();
 
   m_lastCount = 0.0f;
   m_lastPcfgSum = 0.0f;
-  m_lastTargetToSourceAlignment = m_targetToSourceAlignments.begin();
+  m_lastTargetToSourceAlignment = 0;
   
   m_isValid = false;
 }
@@ -250,23 +267,20 @@ const ALIGNMENT *ExtractionPhrasePair::FindBestAlignmentTargetToSource() const
 {
   float bestAlignmentCount = -1;
 
-  std::map<ALIGNMENT*,float>::const_iterator bestAlignment = m_targetToSourceAlignments.end();
+  const ALIGNMENT *bestAlignment = NULL;
 
-  for (std::map<ALIGNMENT*,float>::const_iterator iter=m_targetToSourceAlignments.begin(); 
+  for (std::vector< std::pair<ALIGNMENT_ID,float> >::const_iterator iter=m_targetToSourceAlignments.begin(); 
        iter!=m_targetToSourceAlignments.end(); ++iter) {
+    const ALIGNMENT *alignment = &m_alignmentTable->GetAlignment( iter->first );
     if ( (iter->second > bestAlignmentCount) ||
          ( (iter->second == bestAlignmentCount) &&
-           (*(iter->first) > *(bestAlignment->first)) ) ) {
+           (*alignment > *bestAlignment) ) ) {
       bestAlignmentCount = iter->second;
-      bestAlignment = iter;
+      bestAlignment = alignment;
     }
   }
 
-  if ( bestAlignment == m_targetToSourceAlignments.end()) {
-    return NULL;
-  }
-
-  return bestAlignment->first;
+  return bestAlignment;
 }
 
 
@@ -23,11 +23,49 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <deque>
+
+#include <stdint.h>
+
+#include <boost/unordered_map.hpp>
 
 namespace MosesTraining {
 
 
 typedef std::vector< std::set<size_t> > ALIGNMENT;
+typedef size_t ALIGNMENT_ID;
+
+
+// Holds each distinct word alignment of the extracted phrase pairs once.
+// Phrase pairs refer to their alignments by id.
+class AlignmentTable {
+
+public:
+
+  // Number of target symbols, then the sorted alignment points as
+  // (target position << 16 | source position).
+  typedef std::vector<uint32_t> PACKED;
+
+  ALIGNMENT_ID StoreIfNew( const PACKED &packed );
+
+  const ALIGNMENT &GetAlignment( ALIGNMENT_ID id ) const {
+    return m_alignments[id];
+  }
+
+  size_t GetSize() const {
+    return m_alignments.size();
+  }
+
+  // Forgets all alignments but /keep/, e.g. once the phrase pairs that
+  // refer to them have been scored. Returns the new id of /keep/.
+  ALIGNMENT_ID Reset( ALIGNMENT_ID keep );
+
+private:
+
+  boost::unordered_map<PACKED, ALIGNMENT_ID> m_lookup;
+  // a deque, so that references to alignments stay valid
+  std::deque<ALIGNMENT> m_alignments;
+};
 
 
 class ExtractionPhrasePair {
@@ -37,49 +75,55 @@ protected:
   typedef std::map<std::string,float> PROPERTY_VALUES;
   typedef std::map<std::string,float>::iterator LAST_PROPERTY_VALUE;
 
+  struct PropertyValues {
+    PROPERTY_VALUES values;
+    LAST_PROPERTY_VALUE last;
+  };
+
   
   bool m_isValid;
 
-  const PHRASE *m_phraseSource;
-  const PHRASE *m_phraseTarget;
+  const AlignmentTable *m_alignmentTable;
+
+  PHRASE m_phraseSource;
+  PHRASE m_phraseTarget;
 
   float m_count;
   float m_pcfgSum;
 
-  std::map<ALIGNMENT*,float> m_targetToSourceAlignments;
-  std::map<std::string, 
-           std::pair< PROPERTY_VALUES*, LAST_PROPERTY_VALUE* > > m_properties;
+  // alignments with their counts, in the order they were first seen
+  std::vector< std::pair<ALIGNMENT_ID,float> > m_targetToSourceAlignments;
+  std::map<std::string, PropertyValues> m_properties;
 
   float m_lastCount;
   float m_lastPcfgSum;
-  std::map<ALIGNMENT*,float>::iterator m_lastTargetToSourceAlignment;
+  size_t m_lastTargetToSourceAlignment;
 
 public:
 
-  ExtractionPhrasePair( const PHRASE *phraseSource, 
-                        const PHRASE *phraseTarget, 
-                        ALIGNMENT *targetToSourceAlignment, 
+  ExtractionPhrasePair( const PHRASE &phraseSource, 
+                        const PHRASE &phraseTarget, 
+                        const AlignmentTable &alignmentTable,
+                        ALIGNMENT_ID targetToSourceAlignment, 
                         float count, float pcfgSum );
 
-  ~ExtractionPhrasePair();
-
-  bool Add( ALIGNMENT *targetToSourceAlignment, 
+  bool Add( ALIGNMENT_ID targetToSourceAlignment, 
             float count, float pcfgSum );
 
   void IncrementPrevious( float count, float pcfgSum );
 
-  bool Matches( const PHRASE *otherPhraseSource,
-                const PHRASE *otherPhraseTarget,
-                ALIGNMENT *otherTargetToSourceAlignment ) const;
+  bool Matches( const PHRASE &otherPhraseSource,
+                const PHRASE &otherPhraseTarget,
+                ALIGNMENT_ID otherTargetToSourceAlignment ) const;
 
-  bool Matches( const PHRASE *otherPhraseSource,
-                const PHRASE *otherPhraseTarget,
-                ALIGNMENT *otherTargetToSourceAlignment,
+  bool Matches( const PHRASE &otherPhraseSource,
+                const PHRASE &otherPhraseTarget,
+                ALIGNMENT_ID otherTargetToSourceAlignment,
                 bool &sourceMatch,
                 bool &targetMatch,
                 bool &alignmentMatch ) const;
 
-  bool MatchesAlignment( ALIGNMENT *otherTargetToSourceAlignment ) const;
+  bool MatchesAlignment( ALIGNMENT_ID otherTargetToSourceAlignment ) const;
 
   void Clear();
 
@@ -89,11 +133,11 @@ public:
 
 
   const PHRASE *GetSource() const {
-    return m_phraseSource;
+    return &m_phraseSource;
   }
   
   const PHRASE *GetTarget() const {
-    return m_phraseTarget;
+    return &m_phraseTarget;
   }
 
   float GetCount() const {
@@ -109,12 +153,12 @@ public:
   }
 
   const std::map<std::string,float> *GetProperty( const std::string &key ) const {
-    std::map<std::string, std::pair< PROPERTY_VALUES*, LAST_PROPERTY_VALUE* > >::const_iterator iter;
+    std::map<std::string, PropertyValues>::const_iterator iter;
     iter = m_properties.find(key);
     if (iter == m_properties.end()) {
       return NULL;
     } else {
-      return iter->second.first;
+      return &iter->second.values;
     }
   }
 
@@ -128,30 +172,24 @@ public:
 
   void AddProperty( const std::string &key, const std::string &value, float count ) 
   {
-    std::map<std::string,
-             std::pair< PROPERTY_VALUES*, LAST_PROPERTY_VALUE* > >::iterator iter = m_properties.find(key);
+    std::map<std::string, PropertyValues>::iterator iter = m_properties.find(key);
     if ( iter == m_properties.end() ) {
       // key not found: insert property key and value
-      PROPERTY_VALUES *propertyValues = new PROPERTY_VALUES();
-      std::pair<LAST_PROPERTY_VALUE,bool> insertedProperty = propertyValues->insert( std::pair<std::string,float>(value,count) );
-      LAST_PROPERTY_VALUE *lastPropertyValue = new LAST_PROPERTY_VALUE(insertedProperty.first);
-      m_properties[key] = std::pair< PROPERTY_VALUES*, LAST_PROPERTY_VALUE* >(propertyValues, lastPropertyValue);
+      PropertyValues &propertyValues = m_properties[key];
+      propertyValues.last = propertyValues.values.insert( std::pair<std::string,float>(value,count) ).first;
     } else {
-      LAST_PROPERTY_VALUE *lastPropertyValue = (iter->second).second;
-      if ( (*lastPropertyValue)->first == value ) { // same property key-value pair has been seen right before
+      PropertyValues &propertyValues = iter->second;
+      if ( propertyValues.last->first == value ) { // same property key-value pair has been seen right before
         // property key-value pair exists already: add count
-        (*lastPropertyValue)->second += count;
+        propertyValues.last->second += count;
       } else { // need to check whether the property key-value pair has appeared before (insert if not)
         // property key exists, but not in combination with this value:
         // add new value with count
-        PROPERTY_VALUES *propertyValues = (iter->second).first;
-        std::pair<LAST_PROPERTY_VALUE,bool> insertedProperty = propertyValues->insert( std::pair<std::string,float>(value,count) );
+        std::pair<LAST_PROPERTY_VALUE,bool> insertedProperty = propertyValues.values.insert( std::pair<std::string,float>(value,count) );
         if ( !insertedProperty.second ) { // property value for this key appeared before: add count
           insertedProperty.first->second += count;
         }
-        LAST_PROPERTY_VALUE *lastPropertyValue = new LAST_PROPERTY_VALUE(insertedProperty.first);
-        delete (iter->second).second;
-        (iter->second).second = lastPropertyValue;
+        propertyValues.last = insertedProperty.first;
       }
     }
   }
@@ -0,0 +1,101 @@
+/***********************************************************************
+  Moses - factored phrase-based language decoder
+  Copyright (C) 2012- University of Edinburgh
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***********************************************************************/
+
+#include "ExtractionPhrasePair.h"
+#include "tables-core.h"
+
+#define  BOOST_TEST_MODULE MosesTrainingExtractionPhrasePair
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/assign/list_of.hpp>
+
+using namespace MosesTraining;
+using namespace std;
+
+//pesky global variables
+namespace MosesTraining
+{
+bool hierarchicalFlag = false;
+Vocabulary vcbT;
+Vocabulary vcbS;
+}
+
+
+BOOST_AUTO_TEST_CASE(alignment_table_interns)
+{
+  AlignmentTable table;
+  // 2 target words: 0-0 1-1
+  AlignmentTable::PACKED diagonal = boost::assign::list_of(2)(0)((1 << 16) | 1);
+  // 2 target words: 1-0
+  AlignmentTable::PACKED crossed = boost::assign::list_of(2)(1);
+
+  ALIGNMENT_ID first = table.StoreIfNew(diagonal);
+  ALIGNMENT_ID second = table.StoreIfNew(crossed);
+  BOOST_CHECK(first != second);
+  BOOST_CHECK_EQUAL(first, table.StoreIfNew(diagonal));
+  BOOST_CHECK_EQUAL(2U, table.GetSize());
+
+  const ALIGNMENT &alignment = table.GetAlignment(second);
+  BOOST_REQUIRE_EQUAL(2U, alignment.size());
+  BOOST_CHECK_EQUAL(1U, alignment[0].size());
+  BOOST_CHECK_EQUAL(1U, *alignment[0].begin());
+  BOOST_CHECK(alignment[1].empty());
+}
+
+BOOST_AUTO_TEST_CASE(alignment_table_reset_keeps_one)
+{
+  AlignmentTable table;
+  AlignmentTable::PACKED diagonal = boost::assign::list_of(2)(0)((1 << 16) | 1);
+  AlignmentTable::PACKED crossed = boost::assign::list_of(2)(1);
+  table.StoreIfNew(diagonal);
+  ALIGNMENT_ID kept = table.Reset(table.StoreIfNew(crossed));
+  BOOST_CHECK_EQUAL(1U, table.GetSize());
+  BOOST_CHECK_EQUAL(kept, table.StoreIfNew(crossed));
+
+  const ALIGNMENT &alignment = table.GetAlignment(kept);
+  BOOST_REQUIRE_EQUAL(2U, alignment.size());
+  BOOST_CHECK_EQUAL(1U, *alignment[0].begin());
+  BOOST_CHECK(alignment[1].empty());
+
+  BOOST_CHECK(kept != table.StoreIfNew(diagonal));
+  BOOST_CHECK_EQUAL(2U, table.GetSize());
+}
+
+BOOST_AUTO_TEST_CASE(phrase_pair_counts_alignments)
+{
+  AlignmentTable table;
+  AlignmentTable::PACKED packed = boost::assign::list_of(2)(0)((1 << 16) | 1);
+  ALIGNMENT_ID diagonal = table.StoreIfNew(packed);
+  packed = boost::assign::list_of(2)(1);
+  ALIGNMENT_ID crossed = table.StoreIfNew(packed);
+
+  PHRASE source = boost::assign::list_of(vcbS.storeIfNew(string("das")))(vcbS.storeIfNew(string("Haus")));
+  PHRASE target = boost::assign::list_of(vcbT.storeIfNew(string("the")))(vcbT.storeIfNew(string("house")));
+
+  ExtractionPhrasePair pair(source, target, table, crossed, 1.0, 0.0);
+  BOOST_CHECK(pair.Matches(source, target, diagonal));
+  BOOST_CHECK(!pair.Matches(source, PHRASE(1, target[0]), diagonal));
+  BOOST_CHECK(pair.Add(diagonal, 1.0, 0.0));
+  BOOST_CHECK(&table.GetAlignment(crossed) == pair.FindBestAlignmentTargetToSource());
+  BOOST_CHECK(!pair.Add(diagonal, 1.0, 0.0));
+  pair.IncrementPrevious(1.0, 0.0);
+  BOOST_CHECK_EQUAL(4.0, pair.GetCount());
+  BOOST_CHECK(&table.GetAlignment(diagonal) == pair.FindBestAlignmentTargetToSource());
+}
@@ -0,0 +1,470 @@
+/*
+ * PhraseExtractor.cpp
+ *	Phrase pair enumeration of extract, shared with build-phrase-table
+ */
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PhraseExtractor.h"
+#include "SentenceAlignment.h"
+
+using namespace std;
+
+namespace MosesTraining
+{
+
+namespace
+{
+// HPhraseVertex represents a point in the alignment matrix
+typedef pair <int, int> HPhraseVertex;
+
+// Phrase represents a bi-phrase; each bi-phrase is defined by two points in the alignment matrix:
+// bottom-left and top-right
+typedef pair<HPhraseVertex, HPhraseVertex> HPhrase;
+
+// HPhraseVector is a vector of HPhrases
+typedef vector < HPhrase > HPhraseVector;
+
+// SentenceVertices represents, from all extracted phrases, all vertices that have the same positioning
+// The key of the map is the English index and the value is a set of the source ones
+typedef map <int, set<int> > HSentenceVertices;
+
+REO_POS getOrientWordModel(SentenceAlignment &, REO_MODEL_TYPE, bool, bool,
+                           int, int, int, int, int, int, int,
+                           bool (*)(int, int), bool (*)(int, int));
+REO_POS getOrientPhraseModel(SentenceAlignment &, REO_MODEL_TYPE, bool, bool,
+                             int, int, int, int, int, int, int,
+                             bool (*)(int, int), bool (*)(int, int),
+                             const HSentenceVertices &, const HSentenceVertices &);
+REO_POS getOrientHierModel(SentenceAlignment &, REO_MODEL_TYPE, bool, bool,
+                           int, int, int, int, int, int, int,
+                           bool (*)(int, int), bool (*)(int, int),
+                           const HSentenceVertices &, const HSentenceVertices &,
+                           const HSentenceVertices &, const HSentenceVertices &,
+                           REO_POS);
+
+void insertVertex(HSentenceVertices &, int, int);
+void insertPhraseVertices(HSentenceVertices &, HSentenceVertices &, HSentenceVertices &, HSentenceVertices &,
+                          int, int, int, int);
+string getOrientString(REO_POS, REO_MODEL_TYPE);
+
+bool ge(int, int);
+bool le(int, int);
+bool lt(int, int);
+
+bool isAligned (SentenceAlignment &, int, int);
+
+} // namespace
+
+void PhraseExtractor::extract(SentenceAlignment &sentence)
+{
+  int countE = sentence.target.size();
+  int countF = sentence.source.size();
+
+  HPhraseVector inboundPhrases;
+
+  HSentenceVertices inTopLeft;
+  HSentenceVertices inTopRight;
+  HSentenceVertices inBottomLeft;
+  HSentenceVertices inBottomRight;
+
+  HSentenceVertices outTopLeft;
+  HSentenceVertices outTopRight;
+  HSentenceVertices outBottomLeft;
+  HSentenceVertices outBottomRight;
+
+  HSentenceVertices::const_iterator it;
+
+  bool relaxLimit = m_options.isHierModel();
+  bool buildExtraStructure = m_options.isPhraseModel() || m_options.isHierModel();
+
+  // check alignments for target phrase startE...endE
+  // loop over extracted phrases which are compatible with the word-alignments
+  for(int startE=0; startE<countE; startE++) {
+    for(int endE=startE;
+        (endE<countE && (relaxLimit || endE<startE+m_options.maxPhraseLength));
+        endE++) {
+
+      int minF = 9999;
+      int maxF = -1;
+      vector< int > usedF = sentence.alignedCountS;
+      for(int ei=startE; ei<=endE; ei++) {
+        for(size_t i=0; i<sentence.alignedToT[ei].size(); i++) {
+          int fi = sentence.alignedToT[ei][i];
+          if (fi<minF) {
+            minF = fi;
+          }
+          if (fi>maxF) {
+            maxF = fi;
+          }
+          usedF[ fi ]--;
+        }
+      }
+
+      if (maxF >= 0 && // aligned to any source words at all
+          (relaxLimit || maxF-minF < m_options.maxPhraseLength)) { // source phrase within limits
+
+        // check if source words are aligned to out of bound target words
+        bool out_of_bounds = false;
+        for(int fi=minF; fi<=maxF && !out_of_bounds; fi++)
+          if (usedF[fi]>0) {
+            // cout << "ouf of bounds: " << fi << "\n";
+            out_of_bounds = true;
+          }
+
+        // cout << "doing if for ( " << minF << "-" << maxF << ", " << startE << "," << endE << ")\n";
+        if (!out_of_bounds) {
+          // start point of source phrase may retreat over unaligned
+          for(int startF=minF;
+              (startF>=0 &&
+               (relaxLimit || startF>maxF-m_options.maxPhraseLength) && // within length limit
+               (startF==minF || sentence.alignedCountS[startF]==0)); // unaligned
+              startF--)
+            // end point of source phrase may advance over unaligned
+            for(int endF=maxF;
+                (endF<countF &&
+                 (relaxLimit || endF<startF+m_options.maxPhraseLength) && // within length limit
+                 (endF==maxF || sentence.alignedCountS[endF]==0)); // unaligned
+                endF++) { // at this point we have extracted a phrase
+              if(buildExtraStructure) { // phrase || hier
+                if(endE-startE < m_options.maxPhraseLength && endF-startF < m_options.maxPhraseLength) { // within limit
+                  inboundPhrases.push_back(HPhrase(HPhraseVertex(startF,startE),
+                                                   HPhraseVertex(endF,endE)));
+                  insertPhraseVertices(inTopLeft, inTopRight, inBottomLeft, inBottomRight,
+                                       startF, startE, endF, endE);
+                } else
+                  insertPhraseVertices(outTopLeft, outTopRight, outBottomLeft, outBottomRight,
+                                       startF, startE, endF, endE);
+              } else {
+                string orientationInfo = "";
+                if(m_options.isWordModel()) {
+                  REO_POS wordPrevOrient, wordNextOrient;
+                  bool connectedLeftTopP  = isAligned( sentence, startF-1, startE-1 );
+                  bool connectedRightTopP = isAligned( sentence, endF+1,   startE-1 );
+                  bool connectedLeftTopN  = isAligned( sentence, endF+1, endE+1 );
+                  bool connectedRightTopN = isAligned( sentence, startF-1,   endE+1 );
+                  wordPrevOrient = getOrientWordModel(sentence, m_options.isWordType(), connectedLeftTopP, connectedRightTopP, startF, endF, startE, endE, countF, 0, 1, &ge, &lt);
+                  wordNextOrient = getOrientWordModel(sentence, m_options.isWordType(), connectedLeftTopN, connectedRightTopN, endF, startF, endE, startE, 0, countF, -1, &lt, &ge);
+                  orientationInfo += getOrientString(wordPrevOrient, m_options.isWordType()) + " " + getOrientString(wordNextOrient, m_options.isWordType());
+                  if(m_options.isAllModelsOutputFlag())
+                    " | | ";
+                }
+                addPhrase(sentence, startE, endE, startF, endF, orientationInfo);
+              }
+            }
+        }
+      }
+    }
+  }
+
+  if(buildExtraStructure) { // phrase || hier
+    string orientationInfo = "";
+    REO_POS wordPrevOrient, wordNextOrient, phrasePrevOrient, phraseNextOrient, hierPrevOrient, hierNextOrient;
+
+    for(size_t i = 0; i < inboundPhrases.size(); i++) {
+      int startF = inboundPhrases[i].first.first;
+      int startE = inboundPhrases[i].first.second;
+      int endF = inboundPhrases[i].second.first;
+      int endE = inboundPhrases[i].second.second;
+
+      bool connectedLeftTopP  = isAligned( sentence, startF-1, startE-1 );
+      bool connectedRightTopP = isAligned( sentence, endF+1,   startE-1 );
+      bool connectedLeftTopN  = isAligned( sentence, endF+1, endE+1 );
+      bool connectedRightTopN = isAligned( sentence, startF-1,   endE+1 );
+
+      if(m_options.isWordModel()) {
+        wordPrevOrient = getOrientWordModel(sentence, m_options.isWordType(),
+                                            connectedLeftTopP, connectedRightTopP,
+                                            startF, endF, startE, endE, countF, 0, 1,
+                                            &ge, &lt);
+        wordNextOrient = getOrientWordModel(sentence, m_options.isWordType(),
+                                            connectedLeftTopN, connectedRightTopN,
+                                            endF, startF, endE, startE, 0, countF, -1,
+                                            &lt, &ge);
+      }
+      if (m_options.isPhraseModel()) {
+        phrasePrevOrient = getOrientPhraseModel(sentence, m_options.isPhraseType(),
+                                                connectedLeftTopP, connectedRightTopP,
+                                                startF, endF, startE, endE, countF-1, 0, 1, &ge, &lt, inBottomRight, inBottomLeft);
+        phraseNextOrient = getOrientPhraseModel(sentence, m_options.isPhraseType(),
+                                                connectedLeftTopN, connectedRightTopN,
+                                                endF, startF, endE, startE, 0, countF-1, -1, &lt, &ge, inBottomLeft, inBottomRight);
+      } else {
+        phrasePrevOrient = phraseNextOrient = UNKNOWN;
+      }
+      if(m_options.isHierModel()) {
+        hierPrevOrient = getOrientHierModel(sentence, m_options.isHierType(),
+                                            connectedLeftTopP, connectedRightTopP,
+                                            startF, endF, startE, endE, countF-1, 0, 1, &ge, &lt, inBottomRight, inBottomLeft, outBottomRight, outBottomLeft, phrasePrevOrient);
+        hierNextOrient = getOrientHierModel(sentence, m_options.isHierType(),
+                                            connectedLeftTopN, connectedRightTopN,
+                                            endF, startF, endE, startE, 0, countF-1, -1, &lt, &ge, inBottomLeft, inBottomRight, outBottomLeft, outBottomRight, phraseNextOrient);
+      }
+
+      orientationInfo = ((m_options.isWordModel())? getOrientString(wordPrevOrient, m_options.isWordType()) + " " + getOrientString(wordNextOrient, m_options.isWordType()) : "") + " | " +
+                        ((m_options.isPhraseModel())? getOrientString(phrasePrevOrient, m_options.isPhraseType()) + " " + getOrientString(phraseNextOrient, m_options.isPhraseType()) : "") + " | " +
+                        ((m_options.isHierModel())? getOrientString(hierPrevOrient, m_options.isHierType()) + " " + getOrientString(hierNextOrient, m_options.isHierType()) : "");
+
+      addPhrase(sentence, startE, endE, startF, endF, orientationInfo);
+    }
+  }
+}
+
+namespace
+{
+
+REO_POS getOrientWordModel(SentenceAlignment & sentence, REO_MODEL_TYPE modelType,
+                           bool connectedLeftTop, bool connectedRightTop,
+                           int startF, int endF, int startE, int endE, int countF, int zero, int unit,
+                           bool (*ge)(int, int), bool (*lt)(int, int) )
+{
+
+  if( connectedLeftTop && !connectedRightTop)
+    return LEFT;
+  if(modelType == REO_MONO)
+    return UNKNOWN;
+  if (!connectedLeftTop &&  connectedRightTop)
+    return RIGHT;
+  if(modelType == REO_MSD)
+    return UNKNOWN;
+  for(int indexF=startF-2*unit; (*ge)(indexF, zero) && !connectedLeftTop; indexF=indexF-unit)
+    connectedLeftTop = isAligned(sentence, indexF, startE-unit);
+  for(int indexF=endF+2*unit; (*lt)(indexF,countF) && !connectedRightTop; indexF=indexF+unit)
+    connectedRightTop = isAligned(sentence, indexF, startE-unit);
+  if(connectedLeftTop && !connectedRightTop)
+    return DRIGHT;
+  else if(!connectedLeftTop && connectedRightTop)
+    return DLEFT;
+  return UNKNOWN;
+}
+
+// to be called with countF-1 instead of countF
+REO_POS getOrientPhraseModel (SentenceAlignment & sentence, REO_MODEL_TYPE modelType,
+                              bool connectedLeftTop, bool connectedRightTop,
+                              int startF, int endF, int startE, int endE, int countF, int zero, int unit,
+                              bool (*ge)(int, int), bool (*lt)(int, int),
+                              const HSentenceVertices & inBottomRight, const HSentenceVertices & inBottomLeft)
+{
+
+  HSentenceVertices::const_iterator it;
+
+  if((connectedLeftTop && !connectedRightTop) ||
+      //(startE == 0 && startF == 0) ||
+      //(startE == sentence.target.size()-1 && startF == sentence.source.size()-1) ||
+      ((it = inBottomRight.find(startE - unit)) != inBottomRight.end() &&
+       it->second.find(startF-unit) != it->second.end()))
+    return LEFT;
+  if(modelType == REO_MONO)
+    return UNKNOWN;
+  if((!connectedLeftTop &&  connectedRightTop) ||
+      ((it = inBottomLeft.find(startE - unit)) != inBottomLeft.end() && it->second.find(endF + unit) != it->second.end()))
+    return RIGHT;
+  if(modelType == REO_MSD)
+    return UNKNOWN;
+  connectedLeftTop = false;
+  for(int indexF=startF-2*unit; (*ge)(indexF, zero) && !connectedLeftTop; indexF=indexF-unit)
+    if(connectedLeftTop = (it = inBottomRight.find(startE - unit)) != inBottomRight.end() &&
+                          it->second.find(indexF) != it->second.end())
+      return DRIGHT;
+  connectedRightTop = false;
+  for(int indexF=endF+2*unit; (*lt)(indexF, countF) && !connectedRightTop; indexF=indexF+unit)
+    if(connectedRightTop = (it = inBottomLeft.find(startE - unit)) != inBottomLeft.end() &&
+                           it->second.find(indexF) != it->second.end())
+      return DLEFT;
+  return UNKNOWN;
+}
+
+// to be called with countF-1 instead of countF
+REO_POS getOrientHierModel (SentenceAlignment & sentence, REO_MODEL_TYPE modelType,
+                            bool connectedLeftTop, bool connectedRightTop,
+                            int startF, int endF, int startE, int endE, int countF, int zero, int unit,
+                            bool (*ge)(int, int), bool (*lt)(int, int),
+                            const HSentenceVertices & inBottomRight, const HSentenceVertices & inBottomLeft,
+                            const HSentenceVertices & outBottomRight, const HSentenceVertices & outBottomLeft,
+                            REO_POS phraseOrient)
+{
+
+  HSentenceVertices::const_iterator it;
+
+  if(phraseOrient == LEFT ||
+      (connectedLeftTop && !connectedRightTop) ||
+      //    (startE == 0 && startF == 0) ||
+      //(startE == sentence.target.size()-1 && startF == sentence.source.size()-1) ||
+      ((it = inBottomRight.find(startE - unit)) != inBottomRight.end() &&
+       it->second.find(startF-unit) != it->second.end()) ||
+      ((it = outBottomRight.find(startE - unit)) != outBottomRight.end() &&
+       it->second.find(startF-unit) != it->second.end()))
+    return LEFT;
+  if(modelType == REO_MONO)
+    return UNKNOWN;
+  if(phraseOrient == RIGHT ||
+      (!connectedLeftTop &&  connectedRightTop) ||
+      ((it = inBottomLeft.find(startE - unit)) != inBottomLeft.end() &&
+       it->second.find(endF + unit) != it->second.end()) ||
+      ((it = outBottomLeft.find(startE - unit)) != outBottomLeft.end() &&
+       it->second.find(endF + unit) != it->second.end()))
+    return RIGHT;
+  if(modelType == REO_MSD)
+    return UNKNOWN;
+  if(phraseOrient != UNKNOWN)
+    return phraseOrient;
+  connectedLeftTop = false;
+  for(int indexF=startF-2*unit; (*ge)(indexF, zero) && !connectedLeftTop; indexF=indexF-unit) {
+    if((connectedLeftTop = (it = inBottomRight.find(startE - unit)) != inBottomRight.end() &&
+                           it->second.find(indexF) != it->second.end()) ||
+        (connectedLeftTop = (it = outBottomRight.find(startE - unit)) != outBottomRight.end() &&
+                            it->second.find(indexF) != it->second.end()))
+      return DRIGHT;
+  }
+  connectedRightTop = false;
+  for(int indexF=endF+2*unit; (*lt)(indexF, countF) && !connectedRightTop; indexF=indexF+unit) {
+    if((connectedRightTop = (it = inBottomLeft.find(startE - unit)) != inBottomLeft.end() &&
+                            it->second.find(indexF) != it->second.end()) ||
+        (connectedRightTop = (it = outBottomLeft.find(startE - unit)) != outBottomLeft.end() &&
+                             it->second.find(indexF) != it->second.end()))
+      return DLEFT;
+  }
+  return UNKNOWN;
+}
+
+bool isAligned ( SentenceAlignment &sentence, int fi, int ei )
+{
+  if (ei == -1 && fi == -1)
+    return true;
+  if (ei <= -1 || fi <= -1)
+    return false;
+  if ((size_t)ei == sentence.target.size() && (size_t)fi == sentence.source.size())
+    return true;
+  if ((size_t)ei >= sentence.target.size() || (size_t)fi >= sentence.source.size())
+    return false;
+  for(size_t i=0; i<sentence.alignedToT[ei].size(); i++)
+    if (sentence.alignedToT[ei][i] == fi)
+      return true;
+  return false;
+}
+
+bool ge(int first, int second)
+{
+  return first >= second;
+}
+
+bool le(int first, int second)
+{
+  return first <= second;
+}
+
+bool lt(int first, int second)
+{
+  return first < second;
+}
+
+void insertVertex( HSentenceVertices & corners, int x, int y )
+{
+  set<int> tmp;
+  tmp.insert(x);
+  pair< HSentenceVertices::iterator, bool > ret = corners.insert( pair<int, set<int> > (y, tmp) );
+  if(ret.second == false) {
+    ret.first->second.insert(x);
+  }
+}
+
+void insertPhraseVertices(
+  HSentenceVertices & topLeft,
+  HSentenceVertices & topRight,
+  HSentenceVertices & bottomLeft,
+  HSentenceVertices & bottomRight,
+  int startF, int startE, int endF, int endE)
+{
+
+  insertVertex(topLeft, startF, startE);
+  insertVertex(topRight, endF, startE);
+  insertVertex(bottomLeft, startF, endE);
+  insertVertex(bottomRight, endF, endE);
+}
+
+string getOrientString(REO_POS orient, REO_MODEL_TYPE modelType)
+{
+  switch(orient) {
+  case LEFT:
+    return "mono";
+    break;
+  case RIGHT:
+    return "swap";
+    break;
+  case DRIGHT:
+    return "dright";
+    break;
+  case DLEFT:
+    return "dleft";
+    break;
+  case UNKNOWN:
+    switch(modelType) {
+    case REO_MONO:
+      return "nomono";
+      break;
+    case REO_MSD:
+      return "other";
+      break;
+    case REO_MSLR:
+      return "dright";
+      break;
+    }
+    break;
+  }
+  return "";
+}
+
+} // namespace
+
+bool PhraseExtractor::checkPlaceholders (const SentenceAlignment &sentence, int startE, int endE, int startF, int endF) const
+{
+  for (size_t pos = startF; pos <= endF; ++pos) {
+    const string &sourceWord = sentence.source[pos];
+    if (isPlaceholder(sourceWord)) {
+      if (sentence.alignedToS.at(pos).size() != 1) {
+        return false;
+      } else {
+        // check it actually lines up to another placeholder
+        int targetPos = sentence.alignedToS.at(pos).at(0);
+        const string &otherWord = sentence.target[targetPos];
+        if (!isPlaceholder(otherWord)) {
+          return false;
+        }
+      }
+    }
+  }
+
+  for (size_t pos = startE; pos <= endE; ++pos) {
+    const string &targetWord = sentence.target[pos];
+    if (isPlaceholder(targetWord)) {
+      if (sentence.alignedToT.at(pos).size() != 1) {
+        return false;
+      } else {
+        // check it actually lines up to another placeholder
+        int sourcePos = sentence.alignedToT.at(pos).at(0);
+        const string &otherWord = sentence.source[sourcePos];
+        if (!isPlaceholder(otherWord)) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool PhraseExtractor::isPlaceholder(const string &word) const
+{
+  for (size_t i = 0; i < m_options.placeholders.size(); ++i) {
+    const string &placeholder = m_options.placeholders[i];
+    if (word == placeholder) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}
@@ -0,0 +1,45 @@
+/*
+ * PhraseExtractor.h
+ *	Phrase pair enumeration of extract, shared with build-phrase-table
+ */
+
+#pragma once
+#ifndef PHRASE_EXTRACTOR_H_INCLUDED_
+#define PHRASE_EXTRACTOR_H_INCLUDED_
+
+#include <string>
+
+#include "PhraseExtractionOptions.h"
+
+namespace MosesTraining
+{
+
+class SentenceAlignment;
+
+/** Finds the phrase pairs of a sentence pair that are consistent with its
+ *  word alignment, along with their orientations if the options ask for a
+ *  reordering model.  Subclasses decide what to do with each phrase pair.
+ */
+class PhraseExtractor
+{
+public:
+  PhraseExtractor(const PhraseExtractionOptions &options)
+    : m_options(options) {}
+
+  virtual ~PhraseExtractor() {}
+
+  void extract(SentenceAlignment &);
+
+protected:
+  //! Called for every phrase pair found, with inclusive spans.
+  virtual void addPhrase(SentenceAlignment &, int startE, int endE, int startF, int endF, std::string &orientationInfo) = 0;
+
+  bool checkPlaceholders (const SentenceAlignment &sentence, int startE, int endE, int startF, int endF) const;
+  bool isPlaceholder(const std::string &word) const;
+
+  const PhraseExtractionOptions &m_options;
+};
+
+}
+
+#endif
@@ -0,0 +1,999 @@
+/***********************************************************************
+  Moses - factored phrase-based language decoder
+  Copyright (C) 2009 University of Edinburgh
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***********************************************************************/
+
+/* Builds a phrase table, and optionally lexical reordering tables, from an
+ * aligned parallel corpus in one process.  It does what extract, sort, score
+ * (in both directions) and consolidate do for a phrase-based model, without
+ * writing or sorting the extract files as text:
+ *
+ *  - worker threads extract phrase pairs as fixed-size records of word ids,
+ *  - util/stream sorts them by source and target in bounded memory, with
+ *    block sorting and merging in their own threads,
+ *  - the sorted pairs are scored in the direct direction and in the inverse
+ *    one, which needs a sort by target and a sort back by source.
+ *
+ * Word ids are given in the order in which sort with LC_ALL=C puts the words
+ * of extract lines, so the tables come out in the same order as before.
+ * Hierarchical rules, discounting, domain and other extra score features are
+ * not supported here; use the separate programs for those.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include <boost/ref.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <boost/utility/in_place_factory.hpp>
+
+#include "util/exception.hh"
+#include "util/pcqueue.hh"
+#include "util/stream/chain.hh"
+#include "util/stream/sort.hh"
+#include "util/stream/stream.hh"
+#include "util/thread_pool.hh"
+#include "util/usage.hh"
+
+#include "ExtractionPhrasePair.h"
+#include "InputFileStream.h"
+#include "OutputFileStream.h"
+#include "PhraseExtractionOptions.h"
+#include "PhraseExtractor.h"
+#include "SentenceAlignment.h"
+#include "tables-core.h"
+#include "lexical-reordering/reordering_classes.h"
+
+using namespace std;
+using namespace MosesTraining;
+
+namespace
+{
+
+typedef uint32_t WordId;
+
+// Sentence pairs handed to an extraction thread at a time.
+const size_t kBatchSentences = 5000;
+
+// Reordering model types, in the order extract writes their orientations.
+const char *kReorderingTypes[] = {"wbe", "phrase", "hier"};
+const size_t kReorderingTypeCount = 3;
+
+// Orientations as extract writes them.  Zero is for none.
+const char *kOrientations[] = {"", "mono", "swap", "dright", "dleft", "other", "nomono"};
+const size_t kOrientationCount = 7;
+
+/* Order of words as sort with LC_ALL=C sees them in extract lines, where
+ * every word is followed by a space.  Then sequences of word ids compare like
+ * the lines, with the id of "|||" ending a phrase.
+ */
+bool LineOrder(const string &first, const string &second)
+{
+  size_t shorter = min(first.size(), second.size());
+  int compared = memcmp(first.data(), second.data(), shorter);
+  if (compared) return compared < 0;
+  if (first.size() == second.size()) return false;
+  if (first.size() < second.size()) {
+    return ' ' < static_cast<unsigned char>(second[shorter]);
+  }
+  return static_cast<unsigned char>(first[shorter]) < ' ';
+}
+
+class SortedVocabulary
+{
+public:
+  void Add(const string &word) {
+    m_adding.insert(word);
+  }
+
+  // Number the words added so far.  Nothing can be added after this.
+  void Finish() {
+    m_words.assign(m_adding.begin(), m_adding.end());
+    m_adding.clear();
+    sort(m_words.begin(), m_words.end(), LineOrder);
+    for (size_t i = 0; i < m_words.size(); ++i) {
+      m_ids[m_words[i]] = i;
+    }
+  }
+
+  bool Find(const string &word, WordId &id) const {
+    boost::unordered_map<string, WordId>::const_iterator found = m_ids.find(word);
+    if (found == m_ids.end()) return false;
+    id = found->second;
+    return true;
+  }
+
+  WordId GetId(const string &word) const {
+    WordId id = 0;
+    UTIL_THROW_IF(!Find(word, id), util::Exception, "Word " << word << " is not in the vocabulary");
+    return id;
+  }
+
+  const string &GetWord(WordId id) const {
+    return m_words[id];
+  }
+
+private:
+  boost::unordered_set<string> m_adding;
+  vector<string> m_words;
+  boost::unordered_map<string, WordId> m_ids;
+};
+
+/* A phrase pair as it is sorted on disk: the word alignment as a bit matrix,
+ * then the source and target word ids, padded with the id of "|||", then the
+ * fields of the stage.
+ */
+class PairLayout
+{
+public:
+  PairLayout(size_t maxLength, size_t fieldBytes, WordId end) :
+    m_length(maxLength),
+    m_end(end),
+    m_source(((maxLength * maxLength + 63) / 64) * sizeof(uint64_t)),
+    m_target(m_source + maxLength * sizeof(WordId)),
+    m_fields(m_target + maxLength * sizeof(WordId)),
+    m_size((m_fields + fieldBytes + 7) / 8 * 8) {}
+
+  size_t MaxLength() const {
+    return m_length;
+  }
+  WordId End() const {
+    return m_end;
+  }
+  size_t Size() const {
+    return m_size;
+  }
+  size_t AlignmentBytes() const {
+    return m_source;
+  }
+  size_t FieldsOffset() const {
+    return m_fields;
+  }
+
+  WordId *Source(void *pair) const {
+    return reinterpret_cast<WordId*>(static_cast<uint8_t*>(pair) + m_source);
+  }
+  const WordId *Source(const void *pair) const {
+    return reinterpret_cast<const WordId*>(static_cast<const uint8_t*>(pair) + m_source);
+  }
+  WordId *Target(void *pair) const {
+    return reinterpret_cast<WordId*>(static_cast<uint8_t*>(pair) + m_target);
+  }
+  const WordId *Target(const void *pair) const {
+    return reinterpret_cast<const WordId*>(static_cast<const uint8_t*>(pair) + m_target);
+  }
+  template <class Fields> Fields &Get(void *pair) const {
+    return *reinterpret_cast<Fields*>(static_cast<uint8_t*>(pair) + m_fields);
+  }
+  template <class Fields> const Fields &Get(const void *pair) const {
+    return *reinterpret_cast<const Fields*>(static_cast<const uint8_t*>(pair) + m_fields);
+  }
+
+  size_t Length(const WordId *phrase) const {
+    return find(phrase, phrase + m_length, m_end) - phrase;
+  }
+
+  void Align(void *pair, size_t source, size_t target) const {
+    size_t bit = target * m_length + source;
+    static_cast<uint64_t*>(pair)[bit / 64] |= static_cast<uint64_t>(1) << (bit % 64);
+  }
+  bool Aligned(const void *pair, size_t source, size_t target) const {
+    size_t bit = target * m_length + source;
+    return (static_cast<const uint64_t*>(pair)[bit / 64] >> (bit % 64)) & 1;
+  }
+
+private:
+  size_t m_length;
+  WordId m_end;
+  size_t m_source, m_target, m_fields, m_size;
+};
+
+// Fields of an extracted phrase pair.  Only the count is not part of the key.
+struct Extracted {
+  uint8_t orientation[2 * kReorderingTypeCount];
+  float count;
+};
+
+// Fields of a scored phrase pair.  The alignment is the one to print.
+struct Scored {
+  float countEF, countF, countE;
+  float lexDirect, lexInverse;
+};
+
+// Orders phrase pairs by source then target phrase, or the other way round.
+// Then by the alignment and the first keyBytes of the fields, if any.
+class PairOrder : public std::binary_function<const void *, const void *, bool>
+{
+public:
+  PairOrder(const PairLayout &layout, bool sourceFirst, size_t keyBytes)
+    : m_layout(layout), m_sourceFirst(sourceFirst), m_keyBytes(keyBytes) {}
+
+  bool operator()(const void *first, const void *second) const {
+    const WordId *firstWords = m_sourceFirst ? m_layout.Source(first) : m_layout.Target(first);
+    const WordId *secondWords = m_sourceFirst ? m_layout.Source(second) : m_layout.Target(second);
+    const size_t length = m_layout.MaxLength();
+    for (size_t i = 0; i < length; ++i) {
+      if (firstWords[i] != secondWords[i]) return firstWords[i] < secondWords[i];
+    }
+    firstWords = m_sourceFirst ? m_layout.Target(first) : m_layout.Source(first);
+    secondWords = m_sourceFirst ? m_layout.Target(second) : m_layout.Source(second);
+    for (size_t i = 0; i < length; ++i) {
+      if (firstWords[i] != secondWords[i]) return firstWords[i] < secondWords[i];
+    }
+    if (!m_keyBytes) return false;
+    int compared = memcmp(first, second, m_layout.AlignmentBytes());
+    if (compared) return compared < 0;
+    const size_t offset = m_layout.FieldsOffset();
+    return memcmp(static_cast<const uint8_t*>(first) + offset, static_cast<const uint8_t*>(second) + offset, m_keyBytes) < 0;
+  }
+
+private:
+  PairLayout m_layout;
+  bool m_sourceFirst;
+  size_t m_keyBytes;
+};
+
+// Adds up the counts of identical extracted phrase pairs while merging.
+class AddCounts
+{
+public:
+  explicit AddCounts(const PairLayout &layout)
+    : m_layout(layout), m_keyBytes(layout.FieldsOffset() + offsetof(Extracted, count)) {}
+
+  bool operator()(void *into, const void *option, const PairOrder &) const {
+    if (memcmp(into, option, m_keyBytes)) return false;
+    m_layout.Get<Extracted>(into).count += m_layout.Get<Extracted>(option).count;
+    return true;
+  }
+
+private:
+  PairLayout m_layout;
+  size_t m_keyBytes;
+};
+
+struct SentenceBatch {
+  int firstSentenceId;
+  vector<string> target, source, alignment;
+  // Extracted phrase pairs, laid out for sorting.
+  vector<uint8_t> pairs;
+};
+
+// Extracts the phrase pairs of batches of sentences as records.
+class PairExtractor : public PhraseExtractor
+{
+public:
+  PairExtractor(const PhraseExtractionOptions &options, const SortedVocabulary &vocab, const PairLayout &layout)
+    : PhraseExtractor(options), m_vocab(vocab), m_layout(layout), m_pairs(NULL) {}
+
+  void Extract(SentenceBatch &batch) {
+    batch.pairs.clear();
+    m_pairs = &batch.pairs;
+    char noWeight[] = "";
+    for (size_t i = 0; i < batch.target.size(); ++i) {
+      SentenceAlignment sentence;
+      if (!sentence.create(Buffer(batch.target[i], m_targetLine), Buffer(batch.source[i], m_sourceLine),
+                           Buffer(batch.alignment[i], m_alignmentLine), noWeight, batch.firstSentenceId + i, false)) {
+        continue;
+      }
+      Lookup(sentence.source, m_sourceIds);
+      Lookup(sentence.target, m_targetIds);
+      extract(sentence);
+    }
+  }
+
+protected:
+  void addPhrase(SentenceAlignment &sentence, int startE, int endE, int startF, int endF, string &orientationInfo) {
+    const size_t length = m_layout.MaxLength();
+    UTIL_THROW_IF(static_cast<size_t>(endE - startE) >= length || static_cast<size_t>(endF - startF) >= length,
+                  util::Exception, "Phrase pair longer than the maximum phrase length");
+    m_pairs->resize(m_pairs->size() + m_layout.Size());
+    void *pair = &*(m_pairs->end() - m_layout.Size());
+
+    WordId *source = m_layout.Source(pair);
+    fill(source, source + length, m_layout.End());
+    copy(m_sourceIds.begin() + startF, m_sourceIds.begin() + endF + 1, source);
+    WordId *target = m_layout.Target(pair);
+    fill(target, target + length, m_layout.End());
+    copy(m_targetIds.begin() + startE, m_targetIds.begin() + endE + 1, target);
+
+    for (int ei = startE; ei <= endE; ++ei) {
+      const vector<int> &aligned = sentence.alignedToT[ei];
+      for (size_t i = 0; i < aligned.size(); ++i) {
+        m_layout.Align(pair, aligned[i] - startF, ei - startE);
+      }
+    }
+
+    Extracted &fields = m_layout.Get<Extracted>(pair);
+    ParseOrientations(orientationInfo, fields.orientation);
+    fields.count = 1.0;
+  }
+
+private:
+  static char *Buffer(const string &line, vector<char> &buffer) {
+    buffer.assign(line.begin(), line.end());
+    buffer.push_back('\0');
+    return &buffer[0];
+  }
+
+  void Lookup(const vector<string> &words, vector<WordId> &ids) const {
+    ids.resize(words.size());
+    for (size_t i = 0; i < words.size(); ++i) {
+      ids[i] = m_vocab.GetId(words[i]);
+    }
+  }
+
+  // Orientations are "prev next" for word-based models alone, otherwise
+  // "wbe | phrase | hier" with each part empty or "prev next".
+  static void ParseOrientations(const string &info, uint8_t *out) {
+    size_t type = 0, position = 0;
+    istringstream parts(info);
+    string token;
+    while (parts >> token) {
+      if (token == "|") {
+        ++type;
+        position = 0;
+        continue;
+      }
+      size_t code = find(kOrientations + 1, kOrientations + kOrientationCount, token) - kOrientations;
+      UTIL_THROW_IF(code == kOrientationCount || type >= kReorderingTypeCount || position >= 2,
+                    util::Exception, "Unexpected orientation " << token << " in " << info);
+      out[2 * type + position++] = code;
+    }
+  }
+
+  const SortedVocabulary &m_vocab;
+  const PairLayout &m_layout;
+  vector<uint8_t> *m_pairs;
+
+  vector<char> m_targetLine, m_sourceLine, m_alignmentLine;
+  vector<WordId> m_sourceIds, m_targetIds;
+};
+
+class ExtractWorker
+{
+public:
+  typedef SentenceBatch *Request;
+
+  ExtractWorker(const PhraseExtractionOptions &options, const SortedVocabulary &vocab, const PairLayout &layout, util::PCQueue<SentenceBatch*> &done)
+    : m_extractor(options, vocab, layout), m_done(done) {}
+
+  void operator()(Request batch) {
+    m_extractor.Extract(*batch);
+    m_done.Produce(batch);
+  }
+
+private:
+  PairExtractor m_extractor;
+  util::PCQueue<SentenceBatch*> &m_done;
+};
+
+// Head of the chain to the first sort: copies the extracted phrase pairs of
+// batches in the order they are done.  NULL ends.
+class CollectPairs
+{
+public:
+  CollectPairs(util::PCQueue<SentenceBatch*> &done, util::PCQueue<SentenceBatch*> &free)
+    : m_done(done), m_free(free) {}
+
+  void Run(const util::stream::ChainPosition &position) {
+    const size_t size = position.GetChain().EntrySize();
+    util::stream::Stream out(position);
+    SentenceBatch *batch;
+    while (m_done.Consume(batch)) {
+      for (size_t offset = 0; offset < batch->pairs.size(); offset += size, ++out) {
+        memcpy(out.Get(), &batch->pairs[offset], size);
+      }
+      m_free.Produce(batch);
+    }
+    out.Poison();
+  }
+
+private:
+  util::PCQueue<SentenceBatch*> &m_done;
+  util::PCQueue<SentenceBatch*> &m_free;
+};
+
+// Lexical translation table, like score loads it.
+class LexicalTable
+{
+public:
+  void Load(const string &fileName, const SortedVocabulary &vocab) {
+    cerr << "Loading lexical translation table from " << fileName << endl;
+    Moses::InputFileStream file(fileName);
+    if (file.fail()) {
+      cerr << "ERROR: could not open file " << fileName << endl;
+      exit(1);
+    }
+    string line;
+    size_t lineNumber = 0;
+    while (getline(file, line)) {
+      ++lineNumber;
+      vector<string> token = tokenize(line.c_str());
+      if (token.size() != 3) {
+        cerr << "line " << lineNumber << " in " << fileName << " has wrong number of tokens, skipping" << endl;
+        continue;
+      }
+      WordId target, source;
+      // Words that are not in the corpus are never looked up.
+      if (!vocab.Find(token[0], target) || !vocab.Find(token[1], source)) continue;
+      m_table[Key(source, target)] = atof(token[2].c_str());
+    }
+  }
+
+  double Lookup(WordId source, WordId target) const {
+    boost::unordered_map<uint64_t, double>::const_iterator found = m_table.find(Key(source, target));
+    return found == m_table.end() ? 1.0 : found->second;
+  }
+
+  // Same as computeLexicalTranslation in score.
+  double Score(const WordId *source, const WordId *target, const ALIGNMENT &targetToSource, WordId null) const {
+    double lexScore = 1.0;
+    for (size_t ti = 0; ti < targetToSource.size(); ++ti) {
+      const set<size_t> &srcIndices = targetToSource[ti];
+      if (srcIndices.empty()) {
+        lexScore *= Lookup(null, target[ti]);
+      } else {
+        double thisWordScore = 0;
+        for (set<size_t>::const_iterator p = srcIndices.begin(); p != srcIndices.end(); ++p) {
+          thisWordScore += Lookup(source[*p], target[ti]);
+        }
+        lexScore *= thisWordScore / (double)srcIndices.size();
+      }
+    }
+    return lexScore;
+  }
+
+private:
+  static uint64_t Key(WordId source, WordId target) {
+    return (static_cast<uint64_t>(source) << 32) | target;
+  }
+
+  boost::unordered_map<uint64_t, double> m_table;
+};
+
+// The lexical reordering models of lexical-reordering-score, fed with the
+// pairs in the same order.  As there, the models are never deleted: Model
+// closes its file in zipFile and deletes a ModelScore that models share.
+class ReorderingTables
+{
+public:
+  ReorderingTables() : m_used(kReorderingTypeCount, static_cast<ModelScore*>(NULL)) {}
+
+  // type orientation configs..., like --model of lexical-reordering-score.
+  void AddModel(const string &specification, const string &filePath, PhraseExtractionOptions &options) {
+    istringstream is(specification);
+    string type, orientation, config;
+    is >> type >> orientation;
+    size_t index = find(kReorderingTypes, kReorderingTypes + kReorderingTypeCount, type) - kReorderingTypes;
+    if (index == kReorderingTypeCount || m_used[index]) {
+      cerr << "ERROR: unknown or repeated reordering model type " << type << endl;
+      exit(1);
+    }
+    REO_MODEL_TYPE extractType = REO_MSLR;
+    if (orientation == "msd") {
+      extractType = REO_MSD;
+    } else if (orientation == "monotonicity") {
+      extractType = REO_MONO;
+    }
+    if (type == "wbe") {
+      options.initWordModel(true);
+      options.initWordType(extractType);
+    } else if (type == "phrase") {
+      options.initPhraseModel(true);
+      options.initPhraseType(extractType);
+    } else {
+      options.initHierModel(true);
+      options.initHierType(extractType);
+    }
+    options.initOrientationFlag(true);
+    options.initAllModelsOutputFlag(true);
+
+    m_used[index] = ModelScore::createModelScore(orientation);
+    m_scores.push_back(m_used[index]);
+    while (is >> config) {
+      m_models.push_back(Model::createModel(m_used[index], config, filePath));
+    }
+  }
+
+  bool Empty() const {
+    return m_models.empty();
+  }
+
+  void CreateConstSmoothing(double smoothing) {
+    for (size_t i = 0; i < m_models.size(); ++i) {
+      m_models[i]->createConstSmoothing(smoothing);
+    }
+  }
+
+  void Add(const Extracted &fields) {
+    for (size_t i = 0; i < kReorderingTypeCount; ++i) {
+      if (!m_used[i]) continue;
+      m_used[i]->add_example(kOrientations[fields.orientation[2 * i]], kOrientations[fields.orientation[2 * i + 1]], fields.count);
+    }
+  }
+
+  void FinishPair(const string &source, const string &target) {
+    for (size_t i = 0; i < m_models.size(); ++i) {
+      m_models[i]->score_fe(source, target);
+    }
+    for (size_t i = 0; i < m_scores.size(); ++i) {
+      m_scores[i]->reset_fe();
+    }
+  }
+
+  void FinishSource(const string &source) {
+    for (size_t i = 0; i < m_models.size(); ++i) {
+      m_models[i]->score_f(source);
+    }
+    for (size_t i = 0; i < m_scores.size(); ++i) {
+      m_scores[i]->reset_f();
+    }
+  }
+
+  void Close() {
+    for (size_t i = 0; i < m_models.size(); ++i) {
+      m_models[i]->zipFile();
+    }
+  }
+
+private:
+  // By type.
+  vector<ModelScore*> m_used;
+  vector<ModelScore*> m_scores;
+  vector<Model*> m_models;
+};
+
+struct ScoringConfig {
+  const SortedVocabulary *vocab;
+  const PairLayout *extracted, *scored;
+  LexicalTable lexF2E, lexE2F;
+  WordId null;
+  ReorderingTables reordering;
+  bool logProb;
+  bool phraseCount;
+};
+
+string PhraseString(const SortedVocabulary &vocab, const WordId *phrase, size_t length)
+{
+  string ret;
+  for (size_t i = 0; i < length; ++i) {
+    if (i) ret += ' ';
+    ret += vocab.GetWord(phrase[i]);
+  }
+  return ret;
+}
+
+// Alignment with most occurrences; ties go to the greater one, as in
+// ExtractionPhrasePair::FindBestAlignmentTargetToSource.
+const ALIGNMENT *BestAlignment(const vector<pair<ALIGNMENT, float> > &alignments)
+{
+  const pair<ALIGNMENT, float> *best = &alignments.front();
+  for (size_t i = 1; i < alignments.size(); ++i) {
+    if (alignments[i].second > best->second ||
+        (alignments[i].second == best->second && alignments[i].first > best->first)) {
+      best = &alignments[i];
+    }
+  }
+  return &best->first;
+}
+
+/* Reads extracted phrase pairs sorted by source and target.  Writes one
+ * scored record per distinct pair with its count, the count of its source
+ * phrase and the lexical weights of both directions.  Each direction uses the
+ * most frequent alignment as seen from its side, as score does for the direct
+ * and the inverse extract file.
+ */
+class DirectScorer
+{
+public:
+  explicit DirectScorer(ScoringConfig &config)
+    : m_config(config), m_count(0.0), m_sourceCount(0.0) {}
+
+  void Run(util::stream::Stream &in, util::stream::Stream &out) {
+    const PairLayout &layout = *m_config.extracted;
+    const size_t length = layout.MaxLength();
+    vector<uint8_t> previous(layout.Size());
+    bool first = true;
+    for (; in; ++in) {
+      bool newSource = first || !equal(layout.Source(in.Get()), layout.Source(in.Get()) + length, layout.Source(&previous[0]));
+      bool newPair = newSource || !equal(layout.Target(in.Get()), layout.Target(in.Get()) + length, layout.Target(&previous[0]));
+      if (!first && newPair) {
+        FinishPair(&previous[0]);
+        if (newSource) FinishSource(out, &previous[0]);
+      }
+      bool newAlignment = newPair || memcmp(in.Get(), &previous[0], layout.AlignmentBytes());
+      const Extracted &fields = layout.Get<Extracted>(in.Get());
+      if (newAlignment) {
+        m_alignments.push_back(make_pair(Alignment(in.Get()), 0.0f));
+      }
+      m_alignments.back().second += fields.count;
+      m_count += fields.count;
+      if (!m_config.reordering.Empty()) m_config.reordering.Add(fields);
+      memcpy(&previous[0], in.Get(), layout.Size());
+      first = false;
+    }
+    if (!first) {
+      FinishPair(&previous[0]);
+      FinishSource(out, &previous[0]);
+    }
+    out.Poison();
+  }
+
+private:
+  // Target to source, sized to the target phrase.
+  ALIGNMENT Alignment(const void *pair) const {
+    const PairLayout &layout = *m_config.extracted;
+    size_t sourceLength = layout.Length(layout.Source(pair));
+    ALIGNMENT ret(layout.Length(layout.Target(pair)));
+    for (size_t t = 0; t < ret.size(); ++t) {
+      for (size_t s = 0; s < sourceLength; ++s) {
+        if (layout.Aligned(pair, s, t)) ret[t].insert(s);
+      }
+    }
+    return ret;
+  }
+
+  static ALIGNMENT Invert(const ALIGNMENT &targetToSource, size_t sourceLength) {
+    ALIGNMENT ret(sourceLength);
+    for (size_t t = 0; t < targetToSource.size(); ++t) {
+      for (set<size_t>::const_iterator s = targetToSource[t].begin(); s != targetToSource[t].end(); ++s) {
+        ret[*s].insert(t);
+      }
+    }
+    return ret;
+  }
+
+  void FinishPair(const void *pair) {
+    const PairLayout &in = *m_config.extracted, &out = *m_config.scored;
+    const WordId *source = in.Source(pair), *target = in.Target(pair);
+    size_t sourceLength = in.Length(source);
+
+    const ALIGNMENT *best = BestAlignment(m_alignments);
+    vector<std::pair<ALIGNMENT, float> > inverted;
+    for (size_t i = 0; i < m_alignments.size(); ++i) {
+      inverted.push_back(make_pair(Invert(m_alignments[i].first, sourceLength), m_alignments[i].second));
+    }
+
+    m_group.resize(m_group.size() + out.Size());
+    void *scored = &*(m_group.end() - out.Size());
+    memcpy(out.Source(scored), source, out.MaxLength() * sizeof(WordId));
+    memcpy(out.Target(scored), target, out.MaxLength() * sizeof(WordId));
+    for (size_t t = 0; t < best->size(); ++t) {
+      for (set<size_t>::const_iterator s = (*best)[t].begin(); s != (*best)[t].end(); ++s) {
+        out.Align(scored, *s, t);
+      }
+    }
+    Scored &fields = out.Get<Scored>(scored);
+    fields.countEF = m_count;
+    fields.lexDirect = m_config.lexF2E.Score(source, target, *best, m_config.null);
+    fields.lexInverse = m_config.lexE2F.Score(target, source, *BestAlignment(inverted), m_config.null);
+
+    if (!m_config.reordering.Empty()) {
+      m_config.reordering.FinishPair(PhraseString(*m_config.vocab, source, sourceLength), PhraseString(*m_config.vocab, target, in.Length(target)));
+    }
+    m_alignments.clear();
+    m_sourceCount += m_count;
+    m_count = 0.0;
+  }
+
+  void FinishSource(util::stream::Stream &out, const void *pair) {
+    const PairLayout &layout = *m_config.scored;
+    for (size_t offset = 0; offset < m_group.size(); offset += layout.Size(), ++out) {
+      layout.Get<Scored>(&m_group[offset]).countF = m_sourceCount;
+      memcpy(out.Get(), &m_group[offset], layout.Size());
+    }
+    if (!m_config.reordering.Empty()) {
+      const WordId *source = m_config.extracted->Source(pair);
+      m_config.reordering.FinishSource(PhraseString(*m_config.vocab, source, m_config.extracted->Length(source)));
+    }
+    m_group.clear();
+    m_sourceCount = 0.0;
+  }
+
+  ScoringConfig &m_config;
+
+  vector<pair<ALIGNMENT, float> > m_alignments;
+  float m_count;
+  // Scored pairs with the same source phrase.
+  vector<uint8_t> m_group;
+  float m_sourceCount;
+};
+
+// Reads scored pairs sorted by target phrase and fills in the target counts.
+void CountTargets(const PairLayout &layout, util::stream::Stream &in, util::stream::Stream &out)
+{
+  const size_t length = layout.MaxLength();
+  vector<uint8_t> group;
+  float targetCount = 0.0;
+  for (bool more = in; more; ) {
+    group.insert(group.end(), static_cast<const uint8_t*>(in.Get()), static_cast<const uint8_t*>(in.Get()) + layout.Size());
+    targetCount += layout.Get<Scored>(in.Get()).countEF;
+    const WordId *target = layout.Target(&*(group.end() - layout.Size()));
+    more = ++in;
+    if (more && equal(target, target + length, layout.Target(in.Get()))) continue;
+    for (size_t offset = 0; offset < group.size(); offset += layout.Size(), ++out) {
+      layout.Get<Scored>(&group[offset]).countE = targetCount;
+      memcpy(out.Get(), &group[offset], layout.Size());
+    }
+    group.clear();
+    targetCount = 0.0;
+  }
+  out.Poison();
+}
+
+inline float MaybeLogProb(bool logProb, float a)
+{
+  return logProb ? log(a) : a;
+}
+
+// Writes the lines consolidate would write for the two halves of the table.
+void WritePhraseTable(const ScoringConfig &config, util::stream::Stream &in, ostream &out)
+{
+  const PairLayout &layout = *config.scored;
+  for (; in; ++in) {
+    const WordId *source = layout.Source(in.Get()), *target = layout.Target(in.Get());
+    size_t sourceLength = layout.Length(source), targetLength = layout.Length(target);
+    const Scored &fields = layout.Get<Scored>(in.Get());
+    out << PhraseString(*config.vocab, source, sourceLength) << " ||| "
+        << PhraseString(*config.vocab, target, targetLength) << " |||"
+        << " " << MaybeLogProb(config.logProb, fields.countEF / fields.countE)
+        << " " << MaybeLogProb(config.logProb, fields.lexInverse)
+        << " " << MaybeLogProb(config.logProb, fields.countEF / fields.countF)
+        << " " << MaybeLogProb(config.logProb, fields.lexDirect);
+    if (config.phraseCount) {
+      out << " " << MaybeLogProb(config.logProb, 2.718);
+    }
+    out << " ||| ";
+    for (size_t t = 0; t < targetLength; ++t) {
+      for (size_t s = 0; s < sourceLength; ++s) {
+        if (layout.Aligned(in.Get(), s, t)) out << s << "-" << t << " ";
+      }
+    }
+    out << "||| " << fields.countE << " " << fields.countF << " " << fields.countEF << " |||\n";
+  }
+}
+
+void ReadVocabulary(const char *fileName, SortedVocabulary &vocab)
+{
+  Moses::InputFileStream file(fileName);
+  if (file.fail()) {
+    cerr << "ERROR: could not open " << fileName << endl;
+    exit(1);
+  }
+  string line;
+  while (getline(file, line)) {
+    vector<string> words = tokenize(line.c_str());
+    for (size_t i = 0; i < words.size(); ++i) {
+      vocab.Add(words[i]);
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  cerr << "BuildPhraseTable -- "
+       << "phrase extraction and scoring in one pass over an aligned parallel corpus" << endl;
+
+  if (argc < 7) {
+    cerr << "syntax: build-phrase-table en de align lex phrase-table max-length [--Threads n] [--Memory size] [--TempPrefix prefix] [--LogProb] [--PhraseCount] [--Reordering \"type orientation configs\" ...] [--ReorderingTable path] [--ReorderingSmoothing value]" << endl
+         << "  lex is the prefix of the lex.f2e and lex.e2f files." << endl
+         << "  --Reordering takes what --model of lexical-reordering-score takes, e.g. \"wbe msd wbe-msd-bidirectional-fe\"." << endl;
+    exit(1);
+  }
+  const char *fileNameE = argv[1];
+  const char *fileNameF = argv[2];
+  const char *fileNameA = argv[3];
+  const string fileNameLex = argv[4];
+  const string fileNamePhraseTable = argv[5];
+  PhraseExtractionOptions options(atoi(argv[6]));
+  if (options.maxPhraseLength <= 0) {
+    cerr << "ERROR: bad maximum phrase length " << argv[6] << endl;
+    exit(1);
+  }
+
+  size_t threads = 1;
+  string memory = "1G";
+  string tempPrefix = "/tmp/build-phrase-table";
+  ScoringConfig config;
+  config.logProb = false;
+  config.phraseCount = false;
+  vector<string> reorderingModels;
+  string reorderingPath;
+  double smoothing = 0.5;
+  for (int i = 7; i < argc; ++i) {
+    if (strcmp(argv[i], "--Threads") == 0 && i + 1 < argc) {
+      threads = max(1, atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--Memory") == 0 && i + 1 < argc) {
+      memory = argv[++i];
+    } else if (strcmp(argv[i], "--TempPrefix") == 0 && i + 1 < argc) {
+      tempPrefix = argv[++i];
+    } else if (strcmp(argv[i], "--LogProb") == 0) {
+      config.logProb = true;
+    } else if (strcmp(argv[i], "--PhraseCount") == 0) {
+      config.phraseCount = true;
+    } else if (strcmp(argv[i], "--Reordering") == 0 && i + 1 < argc) {
+      reorderingModels.push_back(argv[++i]);
+    } else if (strcmp(argv[i], "--ReorderingTable") == 0 && i + 1 < argc) {
+      reorderingPath = argv[++i];
+    } else if (strcmp(argv[i], "--ReorderingSmoothing") == 0 && i + 1 < argc) {
+      smoothing = atof(argv[++i]);
+    } else {
+      cerr << "ERROR: unknown option or missing argument " << argv[i] << endl;
+      exit(1);
+    }
+  }
+  if (!reorderingModels.empty() && reorderingPath.empty()) {
+    cerr << "ERROR: --Reordering needs --ReorderingTable" << endl;
+    exit(1);
+  }
+  for (size_t i = 0; i < reorderingModels.size(); ++i) {
+    config.reordering.AddModel(reorderingModels[i], reorderingPath, options);
+  }
+  config.reordering.CreateConstSmoothing(smoothing);
+
+  uint64_t memoryBytes = util::ParseSize(memory);
+  util::stream::SortConfig sortConfig;
+  sortConfig.temp_prefix = tempPrefix;
+  sortConfig.total_memory = memoryBytes / 2;
+  sortConfig.buffer_size = min<uint64_t>(64 << 20, memoryBytes / 8);
+  const size_t chainMemory = memoryBytes / 4;
+
+  // Number all words first, in the order sort would put them.
+  cerr << "Reading the vocabulary" << endl;
+  SortedVocabulary vocab;
+  ReadVocabulary(fileNameE, vocab);
+  ReadVocabulary(fileNameF, vocab);
+  vocab.Add("|||");
+  vocab.Add("NULL");
+  vocab.Finish();
+
+  config.vocab = &vocab;
+  config.null = vocab.GetId("NULL");
+  config.lexF2E.Load(fileNameLex + ".f2e", vocab);
+  config.lexE2F.Load(fileNameLex + ".e2f", vocab);
+
+  const PairLayout extractedLayout(options.maxPhraseLength, sizeof(Extracted), vocab.GetId("|||"));
+  const PairLayout scoredLayout(options.maxPhraseLength, sizeof(Scored), vocab.GetId("|||"));
+  config.extracted = &extractedLayout;
+  config.scored = &scoredLayout;
+
+  // Extract with threads into a sort by source and target.
+  cerr << "Extracting phrase pairs with " << threads << " threads" << endl;
+  util::stream::Chain extracted(util::stream::ChainConfig(extractedLayout.Size(), 3, chainMemory));
+  const size_t batchCount = 3 * threads;
+  boost::scoped_array<SentenceBatch> batches(new SentenceBatch[batchCount]);
+  util::PCQueue<SentenceBatch*> free(batchCount), done(batchCount + 1);
+  for (size_t i = 0; i < batchCount; ++i) {
+    free.Produce(&batches[i]);
+  }
+  extracted >> CollectPairs(done, free);
+  util::stream::Sort<PairOrder, AddCounts> bySource(extracted, sortConfig,
+      PairOrder(extractedLayout, true, offsetof(Extracted, count)), AddCounts(extractedLayout));
+  {
+    Moses::InputFileStream eFile(fileNameE), fFile(fileNameF), aFile(fileNameA);
+    if (aFile.fail()) {
+      cerr << "ERROR: could not open " << fileNameA << endl;
+      exit(1);
+    }
+    util::ThreadPool<ExtractWorker> pool(batchCount, threads,
+        boost::in_place(boost::cref(options), boost::cref(vocab), boost::cref(extractedLayout), boost::ref(done)),
+        static_cast<SentenceBatch*>(NULL));
+    int sentenceId = 0;
+    for (bool more = true; more; ) {
+      SentenceBatch *batch;
+      free.Consume(batch);
+      batch->firstSentenceId = sentenceId + 1;
+      batch->target.resize(kBatchSentences);
+      batch->source.resize(kBatchSentences);
+      batch->alignment.resize(kBatchSentences);
+      size_t i = 0;
+      for (; i < kBatchSentences; ++i) {
+        if (!getline(eFile, batch->target[i])) {
+          more = false;
+          break;
+        }
+        if (!getline(fFile, batch->source[i])) {
+          cerr << "ERROR: " << fileNameF << " has fewer lines than " << fileNameE
+               << " (no line " << sentenceId + i + 1 << ")" << endl;
+          exit(1);
+        }
+        if (!getline(aFile, batch->alignment[i])) {
+          cerr << "ERROR: " << fileNameA << " has fewer lines than " << fileNameE
+               << " (no line " << sentenceId + i + 1 << ")" << endl;
+          exit(1);
+        }
+      }
+      batch->target.resize(i);
+      batch->source.resize(i);
+      batch->alignment.resize(i);
+      sentenceId += i;
+      pool.Produce(batch);
+      if (sentenceId / kBatchSentences % 20 == 0 && i == kBatchSentences) cerr << "." << flush;
+    }
+    std::string extra;
+    if (getline(fFile, extra) || getline(aFile, extra)) {
+      cerr << "ERROR: " << fileNameF << " or " << fileNameA << " has more lines than "
+           << fileNameE << " (" << sentenceId << ")" << endl;
+      exit(1);
+    }
+    cerr << endl << "Extracted from " << sentenceId << " sentence pairs" << endl;
+  }
+  done.Produce(NULL);
+  extracted.Wait(true);
+  bySource.Output(extracted);
+
+  // Score, then sort by target to count target phrases.
+  cerr << "Scoring phrase pairs" << endl;
+  util::stream::Chain scored(util::stream::ChainConfig(scoredLayout.Size(), 3, chainMemory));
+  util::stream::Stream scoredOut;
+  scored >> scoredOut;
+  util::stream::Sort<PairOrder> byTarget(scored, sortConfig, PairOrder(scoredLayout, false, 0));
+  {
+    util::stream::Stream extractedIn;
+    extracted >> extractedIn >> util::stream::kRecycle;
+    DirectScorer scorer(config);
+    scorer.Run(extractedIn, scoredOut);
+  }
+  extracted.Wait(true);
+  if (!config.reordering.Empty()) config.reordering.Close();
+  scored.Wait(true);
+  byTarget.Output(scored);
+
+  // Count target phrases, then sort back by source.
+  util::stream::Chain counted(util::stream::ChainConfig(scoredLayout.Size(), 3, chainMemory));
+  util::stream::Stream countedOut;
+  counted >> countedOut;
+  util::stream::Sort<PairOrder> backBySource(counted, sortConfig, PairOrder(scoredLayout, true, 0));
+  {
+    util::stream::Stream scoredIn;
+    scored >> scoredIn >> util::stream::kRecycle;
+    CountTargets(scoredLayout, scoredIn, countedOut);
+  }
+  scored.Wait(true);
+  counted.Wait(true);
+  backBySource.Output(counted);
+
+  cerr << "Writing " << fileNamePhraseTable << endl;
+  Moses::OutputFileStream phraseTable;
+  if (!phraseTable.Open(fileNamePhraseTable)) {
+    cerr << "ERROR: could not open phrase table file " << fileNamePhraseTable << endl;
+    exit(1);
+  }
+  {
+    util::stream::Stream countedIn;
+    counted >> countedIn >> util::stream::kRecycle;
+    WritePhraseTable(config, countedIn, phraseTable);
+  }
+  counted.Wait(true);
+  phraseTable.Close();
+}
@@ -0,0 +1,154 @@
+#!/bin/sh
+# Checks that build-phrase-table writes the same phrase table and
+# lexical reordering tables as extract, sort, score, score --Inverse,
+# consolidate and lexical-reordering-score, on a tiny corpus.
+#
+# usage: build-phrase-table-test.sh build-phrase-table extract extract-lex \
+#          score consolidate lexical-reordering-score
+
+if [ $# -ne 6 ]; then
+  echo "usage: $0 build-phrase-table extract extract-lex score consolidate lexical-reordering-score" >&2
+  exit 1
+fi
+# the programs are run from a temporary directory
+for program in "$@"; do
+  case $program in
+    /*) set -- "$@" "$program" ;;
+    *) set -- "$@" "`pwd`/$program" ;;
+  esac
+  shift
+done
+build=$1; extract=$2; extractLex=$3; score=$4; consolidate=$5; reorderingScore=$6
+
+set -e
+LC_ALL=C
+export LC_ALL
+work=`mktemp -d ${TMPDIR:-/tmp}/build-phrase-table-test.XXXXXX`
+trap 'rm -rf $work' EXIT
+cd $work
+
+cat > corpus.en <<EOF
+green old is book
+a old small small sees and
+sees the man reads house is
+sees reads big big sees reads
+reads man a big old big
+green man sees is sees
+a a house house and man and
+big green sees
+green house old
+book book book
+big man green man old house green
+old book the reads big
+and book man book green
+man and green a green
+reads the green
+small book is man big
+house book man sees
+book reads green is
+is big a reads old a and
+old big old sees small sees the
+small reads the
+and house sees
+green book house
+old is house
+EOF
+cat > corpus.de <<EOF
+gruen alt ist buch
+ein alt klein klein sieht und
+sieht das mann liest haus ist
+sieht liest gross gross sieht liest
+liest mann ein gross alt gross
+gruen mann sieht ist sieht
+ein ein haus haus und mann und
+gross sieht gruen
+haus gruen alt
+buch buch buch
+gross mann gruen mann alt haus gruen
+alt buch das liest gross
+und buch mann buch gruen
+mann und ein gruen gruen
+liest das gruen
+klein buch ist mann gross
+haus buch sieht mann
+buch liest gruen ist
+ist gross ein alt liest ein und
+alt gross alt sieht klein das sieht
+liest klein das
+und sieht haus
+gruen haus buch
+alt haus ist
+EOF
+cat > aligned <<EOF
+0-0 1-1 2-2
+0-0 1-1 2-2 3-3 4-4
+0-0 1-1 2-2 3-3 4-4 5-5
+1-1 2-2 3-3 4-4 5-5
+0-0 1-1 2-2 3-3 5-5
+2-2 3-3 4-4
+0-1 1-0 2-2 3-3 4-4 5-5 6-6
+0-0 1-2
+0-1 2-2
+0-0 1-1 2-2
+0-0 1-1 2-2 3-3 5-5 6-6
+0-0 1-1 2-2 3-3 4-4
+0-0 1-1 2-2 3-3
+0-0 1-1 2-3 3-2 4-4
+0-0 1-1 2-2
+0-0 1-1 3-3 4-4
+0-0 1-1 2-3 3-2
+0-0 1-1 2-2 3-3
+0-0 1-1 2-2 3-4 4-3 5-5 6-6
+0-0 2-2 3-3 4-4 6-5
+0-1 1-0 2-2
+0-0 1-2 2-1
+0-0 1-2 2-1
+1-2 2-1
+EOF
+
+$extractLex corpus.en corpus.de aligned lex.e2f lex.f2e >/dev/null 2>&1
+
+# the separate programs
+$extract corpus.en corpus.de aligned extract 4 orientation --model wbe-msd --model phrase-mslr >/dev/null 2>&1
+sort extract > extract.sorted
+sort extract.inv > extract.inv.sorted
+sort extract.o > extract.o.sorted
+$score extract.sorted lex.f2e phrase-table.half.f2e >/dev/null 2>&1
+$score extract.inv.sorted lex.e2f phrase-table.half.e2f --Inverse >/dev/null 2>&1
+sort phrase-table.half.e2f > phrase-table.half.e2f.sorted
+$consolidate phrase-table.half.f2e phrase-table.half.e2f.sorted phrase-table.legacy >/dev/null 2>&1
+$reorderingScore extract.o.sorted 0.5 reordering.legacy. \
+  --model "wbe msd wbe-msd-bidirectional-fe" --model "phrase mslr phrase-mslr-bidirectional-f" >/dev/null 2>&1
+
+# all in one, with a small sort buffer so that blocks are merged
+$build corpus.en corpus.de aligned lex phrase-table.new 4 --Threads 2 --Memory 4K \
+  --Reordering "wbe msd wbe-msd-bidirectional-fe" --Reordering "phrase mslr phrase-mslr-bidirectional-f" \
+  --ReorderingTable reordering.new. >/dev/null 2>&1
+
+status=0
+if ! cmp phrase-table.legacy phrase-table.new; then
+  status=1
+fi
+
+# a foreign or alignment file that is too short is an error, not empty sentences
+head -n 20 corpus.de > short.de
+head -n 20 aligned > short.aligned
+if $build corpus.en short.de aligned lex short 4 >/dev/null 2>short.err \
+    || ! grep -q "no line 21" short.err; then
+  echo "short foreign file not detected" >&2
+  status=1
+fi
+if $build corpus.en corpus.de short.aligned lex short 4 >/dev/null 2>short.err \
+    || ! grep -q "no line 21" short.err; then
+  echo "short alignment file not detected" >&2
+  status=1
+fi
+for model in wbe-msd-bidirectional-fe phrase-mslr-bidirectional-f; do
+  gzip -dc reordering.legacy.$model.gz > legacy
+  gzip -dc reordering.new.$model.gz > new
+  if ! cmp legacy new; then
+    echo "reordering table $model differs" >&2
+    status=1
+  fi
+done
+exit $status
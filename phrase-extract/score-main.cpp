@@ -36,6 +36,7 @@
 #include "score.h"
 #include "InputFileStream.h"
 #include "OutputFileStream.h"
+#include "util/tokenize_piece.hh"
 
 using namespace std;
 using namespace MosesTraining;
@@ -73,14 +74,15 @@ std::vector<std::string> sourceLabelsByIndex;
 
 Vocabulary vcbT;
 Vocabulary vcbS;
+AlignmentTable alignmentTable;
 
 } // namespace
 
 std::vector<std::string> tokenize( const char [] );
 
-void processLine( std::string line,
+void processLine( const char *line,
                   int lineID, bool includeSentenceIdFlag, int &sentenceId,  
-                  PHRASE *phraseSource, PHRASE *phraseTarget, ALIGNMENT *targetToSourceAlignment,
+                  PHRASE &phraseSource, PHRASE &phraseTarget, ALIGNMENT_ID &targetToSourceAlignment,
                   std::string &additionalPropertiesString,
                   float &count, float &pcfgSum );
 void writeCountOfCounts( const std::string &fileNameCountOfCounts );
@@ -239,8 +241,8 @@ int main(int argc, char* argv[])
   std::vector< ExtractionPhrasePair* > phrasePairsWithSameSourceAndTarget; // required for hierarchical rules only, as non-terminal alignments might make the phrases incompatible
 
   int tmpSentenceId;
-  PHRASE *tmpPhraseSource, *tmpPhraseTarget;
-  ALIGNMENT *tmpTargetToSourceAlignment;
+  PHRASE tmpPhraseSource, tmpPhraseTarget;
+  ALIGNMENT_ID tmpTargetToSourceAlignment;
   std::string tmpAdditionalPropertiesString;
   float tmpCount=0.0f, tmpPcfgSum=0.0f;
 
@@ -248,16 +250,13 @@ int main(int argc, char* argv[])
   SAFE_GETLINE( (extractFileP), line, LINE_MAX_LENGTH, '\n', __FILE__ );
   if ( !extractFileP.eof() ) {
     ++i;
-    tmpPhraseSource = new PHRASE();
-    tmpPhraseTarget = new PHRASE();
-    tmpTargetToSourceAlignment = new ALIGNMENT();
-    processLine( std::string(line), 
+    processLine( line, 
                  i, featureManager.includeSentenceId(), tmpSentenceId,
                  tmpPhraseSource, tmpPhraseTarget, tmpTargetToSourceAlignment, 
                  tmpAdditionalPropertiesString,
                  tmpCount, tmpPcfgSum);
     phrasePair = new ExtractionPhrasePair( tmpPhraseSource, tmpPhraseTarget, 
-                                           tmpTargetToSourceAlignment,
+                                           alignmentTable, tmpTargetToSourceAlignment,
                                            tmpCount, tmpPcfgSum );
     phrasePair->AddProperties( tmpAdditionalPropertiesString, tmpCount );
     featureManager.addPropertiesToPhrasePair( *phrasePair, tmpCount, tmpSentenceId );
@@ -284,11 +283,8 @@ int main(int argc, char* argv[])
       strcpy( lastLine, line );
     }
 
-    tmpPhraseSource = new PHRASE();
-    tmpPhraseTarget = new PHRASE();
-    tmpTargetToSourceAlignment = new ALIGNMENT();
     tmpAdditionalPropertiesString.clear();
-    processLine( std::string(line), 
+    processLine( line, 
                  i, featureManager.includeSentenceId(), tmpSentenceId,
                  tmpPhraseSource, tmpPhraseTarget, tmpTargetToSourceAlignment, 
                  tmpAdditionalPropertiesString,
@@ -317,12 +313,8 @@ int main(int argc, char* argv[])
     }
 
     if ( matchesPrevious ) {
-      delete tmpPhraseSource;
-      delete tmpPhraseTarget;
-      if ( !phrasePair->Add( tmpTargetToSourceAlignment,
-                             tmpCount, tmpPcfgSum ) ) {
-        delete tmpTargetToSourceAlignment;
-      }
+      phrasePair->Add( tmpTargetToSourceAlignment,
+                       tmpCount, tmpPcfgSum );
       phrasePair->AddProperties( tmpAdditionalPropertiesString, tmpCount );
       featureManager.addPropertiesToPhrasePair( *phrasePair, tmpCount, tmpSentenceId );
     } else {
@@ -338,6 +330,8 @@ int main(int argc, char* argv[])
         if ( hierarchicalFlag ) {
           phrasePairsWithSameSourceAndTarget.clear();
         }
+        // only the alignment of the current line is still referred to
+        tmpTargetToSourceAlignment = alignmentTable.Reset( tmpTargetToSourceAlignment );
       }
 
       if ( hierarchicalFlag ) {
@@ -348,7 +342,7 @@ int main(int argc, char* argv[])
       }
 
       phrasePair = new ExtractionPhrasePair( tmpPhraseSource, tmpPhraseTarget, 
-                                             tmpTargetToSourceAlignment, 
+                                             alignmentTable, tmpTargetToSourceAlignment, 
                                              tmpCount, tmpPcfgSum );
       phrasePair->AddProperties( tmpAdditionalPropertiesString, tmpCount );
       featureManager.addPropertiesToPhrasePair( *phrasePair, tmpCount, tmpSentenceId );
@@ -383,70 +377,71 @@ int main(int argc, char* argv[])
 }
 
 
-void processLine( std::string line,
+void processLine( const char *line,
                   int lineID, bool includeSentenceIdFlag, int &sentenceId,  
-                  PHRASE *phraseSource, PHRASE *phraseTarget, ALIGNMENT *targetToSourceAlignment,
+                  PHRASE &phraseSource, PHRASE &phraseTarget, ALIGNMENT_ID &targetToSourceAlignment,
                   std::string &additionalPropertiesString,
                   float &count, float &pcfgSum )
 {
-  size_t foundAdditionalProperties = line.find("{{");
-  if (foundAdditionalProperties != std::string::npos) {
-    additionalPropertiesString = line.substr(foundAdditionalProperties);
-    line = line.substr(0,foundAdditionalProperties);
+  // reused for every line: number of target symbols, then the packed alignment points
+  static AlignmentTable::PACKED packedAlignment;
+
+  StringPiece phrases(line);
+  const char *foundAdditionalProperties = strstr(line, "{{");
+  if (foundAdditionalProperties != NULL) {
+    additionalPropertiesString = foundAdditionalProperties;
+    phrases = StringPiece(line, foundAdditionalProperties - line);
   } else {
     additionalPropertiesString.clear();
   }
 
-  phraseSource->clear();
-  phraseTarget->clear();
-  targetToSourceAlignment->clear();
+  phraseSource.clear();
+  phraseTarget.clear();
+  packedAlignment.resize(1);
 
-  std::vector<std::string> token = tokenize( line.c_str() );
+  // tokens point into line, which ends with '\0', so numbers can be parsed in place
   int item = 1;
-  for ( size_t j=0; j<token.size(); ++j ) {
-    if (token[j] == "|||") {
+  for (util::TokenIter<util::AnyCharacter, true> token(phrases, util::AnyCharacter(" \t")); token; ++token) {
+    if (*token == "|||") {
       ++item;
     } else if (item == 1) { // source phrase
-      phraseSource->push_back( vcbS.storeIfNew( token[j] ) );
+      phraseSource.push_back( vcbS.storeIfNew( *token ) );
     } else if (item == 2) { // target phrase
-      phraseTarget->push_back( vcbT.storeIfNew( token[j] ) );
+      phraseTarget.push_back( vcbT.storeIfNew( *token ) );
     } else if (item == 3) { // alignment
-      int s,t;
-      sscanf(token[j].c_str(), "%d-%d", &s, &t);
-      if ((size_t)t >= phraseTarget->size() || (size_t)s >= phraseSource->size()) {
+      char *end;
+      int s = strtol(token->data(), &end, 10);
+      int t = (*end == '-') ? strtol(end + 1, NULL, 10) : -1;
+      if ((size_t)t >= phraseTarget.size() || (size_t)s >= phraseSource.size()) {
         std::cerr << "WARNING: phrase pair " << lineID
                   << " has alignment point (" << s << ", " << t << ")"
-                  << " out of bounds (" << phraseSource->size() << ", " << phraseTarget->size() << ")"
+                  << " out of bounds (" << phraseSource.size() << ", " << phraseTarget.size() << ")"
                   << std::endl;
       } else {
-        // first alignment point? -> initialize
-        if ( targetToSourceAlignment->size() == 0 ) {
-          size_t numberOfTargetSymbols = (hierarchicalFlag ? phraseTarget->size()-1 : phraseTarget->size());
-          targetToSourceAlignment->resize(numberOfTargetSymbols);
-        }
         // add alignment point
-        targetToSourceAlignment->at(t).insert(s);
+        packedAlignment.push_back( ((uint32_t)t << 16) | (uint32_t)s );
       }
     } else if (includeSentenceIdFlag && item == 4) { // optional sentence id
-      sscanf(token[j].c_str(), "%d", &sentenceId);
+      sentenceId = strtol(token->data(), NULL, 10);
     } else if (item + (includeSentenceIdFlag?-1:0) == 4) { // count
-      sscanf(token[j].c_str(), "%f", &count);
+      count = strtof(token->data(), NULL);
     } else if (item + (includeSentenceIdFlag?-1:0) == 5) { // target syntax PCFG score
-      float pcfgScore = std::atof(token[j].c_str());
+      float pcfgScore = std::atof(token->data());
       pcfgSum = pcfgScore * count;
     }
   }
 
-  if ( targetToSourceAlignment->size() == 0 ) {
-    size_t numberOfTargetSymbols = (hierarchicalFlag ? phraseTarget->size()-1 : phraseTarget->size());
-    targetToSourceAlignment->resize(numberOfTargetSymbols);
-  }
+  size_t numberOfTargetSymbols = (hierarchicalFlag ? phraseTarget.size()-1 : phraseTarget.size());
+  packedAlignment[0] = numberOfTargetSymbols;
+  std::sort(packedAlignment.begin() + 1, packedAlignment.end());
+  packedAlignment.erase(std::unique(packedAlignment.begin() + 1, packedAlignment.end()), packedAlignment.end());
+  targetToSourceAlignment = alignmentTable.StoreIfNew( packedAlignment );
 
   if (item + (includeSentenceIdFlag?-1:0) == 3) {
     count = 1.0;
   }
   if (item < 3 || item > 6) {
-    std::cerr << "ERROR: faulty line " << lineID << ": " << line << endl;
+    std::cerr << "ERROR: faulty line " << lineID << ": " << phrases << endl;
   }
 
 }
@@ -659,7 +654,7 @@ void outputPhrasePair(const ExtractionPhrasePair &phrasePair,
     }
   }
 
-  phraseTableFile << std::endl;
+  phraseTableFile << '\n';
 }
 
 
@@ -817,7 +812,7 @@ void LexicalTable::load( const string &fileName )
     double prob = atof( token[2].c_str() );
     WORD_ID wordT = vcbT.storeIfNew( token[0] );
     WORD_ID wordS = vcbS.storeIfNew( token[1] );
-    ltable[ wordS ][ wordT ] = prob;
+    ltable[ std::make_pair( wordS, wordT ) ] = prob;
   }
   std::cerr << std::endl;
 }
@@ -827,8 +822,10 @@ void printSourcePhrase(const PHRASE *phraseSource, const PHRASE *phraseTarget,
                        const ALIGNMENT *targetToSourceAlignment, ostream &out)
 {
   // get corresponding target non-terminal and output pair
-  ALIGNMENT *sourceToTargetAlignment = new ALIGNMENT();
-  invertAlignment(phraseSource, phraseTarget, targetToSourceAlignment, sourceToTargetAlignment);
+  ALIGNMENT sourceToTargetAlignment;
+  if (unpairedExtractFormatFlag) {
+    invertAlignment(phraseSource, phraseTarget, targetToSourceAlignment, &sourceToTargetAlignment);
+  }
   // output source symbols, except root, in rule table format
   for (std::size_t i = 0; i < phraseSource->size()-1; ++i) {
     const std::string &word = vcbS.getWord(phraseSource->at(i));
@@ -836,7 +833,7 @@ void printSourcePhrase(const PHRASE *phraseSource, const PHRASE *phraseTarget,
       out << word << " ";
       continue;
     }
-    const std::set<std::size_t> &alignmentPoints = sourceToTargetAlignment->at(i);
+    const std::set<std::size_t> &alignmentPoints = sourceToTargetAlignment.at(i);
     assert(alignmentPoints.size() == 1);
     size_t j = *(alignmentPoints.begin());
     if (inverseFlag) {
@@ -851,7 +848,6 @@ void printSourcePhrase(const PHRASE *phraseSource, const PHRASE *phraseTarget,
   } else {
     out << vcbS.getWord(phraseSource->back());
   }
-  delete sourceToTargetAlignment;
 }
 
 
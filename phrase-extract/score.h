@@ -8,21 +8,23 @@
  *
  */
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <boost/unordered_map.hpp>
+
 namespace MosesTraining
 {
 class LexicalTable
 {
 public:
-  std::map< WORD_ID, std::map< WORD_ID, double > > ltable;
+  // keyed by (wordS, wordT)
+  boost::unordered_map< std::pair< WORD_ID, WORD_ID >, double > ltable;
   void load( const std::string &filePath );
-  double permissiveLookup( WORD_ID wordS, WORD_ID wordT ) {
-    // cout << endl << vcbS.getWord( wordS ) << "-" << vcbT.getWord( wordT ) << ":";
-    if (ltable.find( wordS ) == ltable.end()) return 1.0;
-    if (ltable[ wordS ].find( wordT ) == ltable[ wordS ].end()) return 1.0;
-    // cout << ltable[ wordS ][ wordT ];
-    return ltable[ wordS ][ wordT ];
+  double permissiveLookup( WORD_ID wordS, WORD_ID wordT ) const {
+    boost::unordered_map< std::pair< WORD_ID, WORD_ID >, double >::const_iterator found = ltable.find( std::make_pair( wordS, wordT ) );
+    if (found == ltable.end()) return 1.0;
+    return found->second;
   }
 };
 
@@ -1,6 +1,7 @@
 // $Id$
 //#include "beammain.h"
 #include "tables-core.h"
+#include "util/string_piece_hash.hh"
 
 #define TABLE_LINE_MAX_LENGTH 1000
 #define UNKNOWNSTR	"UNK"
@@ -40,7 +41,7 @@ bool isNonTerminal( const WORD &symbol )
 
 WORD_ID Vocabulary::storeIfNew( const WORD& word )
 {
-  map<WORD, WORD_ID>::iterator i = lookup.find( word );
+  boost::unordered_map<WORD, WORD_ID>::iterator i = lookup.find( word );
 
   if( i != lookup.end() )
     return i->second;
@@ -51,9 +52,20 @@ WORD_ID Vocabulary::storeIfNew( const WORD& word )
   return id;
 }
 
+// same, without making a string of words that are known already
+WORD_ID Vocabulary::storeIfNew( const StringPiece& word )
+{
+  boost::unordered_map<WORD, WORD_ID>::iterator i = FindStringPiece( lookup, word );
+
+  if( i != lookup.end() )
+    return i->second;
+
+  return storeIfNew( word.as_string() );
+}
+
 WORD_ID Vocabulary::getWordID( const WORD& word )
 {
-  map<WORD, WORD_ID>::iterator i = lookup.find( word );
+  boost::unordered_map<WORD, WORD_ID>::iterator i = lookup.find( word );
   if( i == lookup.end() )
     return 0;
   return i->second;
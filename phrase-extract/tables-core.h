@@ -12,6 +12,10 @@
 #include <map>
 #include <cmath>
 
+#include <boost/unordered_map.hpp>
+
+#include "util/string_piece.hh"
+
 extern std::vector<std::string> tokenize( const char*);
 
 namespace MosesTraining
@@ -23,9 +27,10 @@ typedef unsigned int WORD_ID;
 class Vocabulary
 {
 public:
-  std::map<WORD, WORD_ID>  lookup;
+  boost::unordered_map<WORD, WORD_ID>  lookup;
   std::vector< WORD > vocab;
   WORD_ID storeIfNew( const WORD& );
+  WORD_ID storeIfNew( const StringPiece& );
   WORD_ID getWordID( const WORD& );
   inline WORD &getWord( WORD_ID id ) {
     return vocab[ id ];
@@ -16,8 +16,8 @@ struct NBestConfig {
 
 class Config {
   public:
-    Config(Score lm_weight, unsigned int pop_limit, const NBestConfig &nbest) :
-      lm_weight_(lm_weight), pop_limit_(pop_limit), nbest_(nbest) {}
+    Config(Score lm_weight, unsigned int pop_limit, const NBestConfig &nbest, CompareOtherStates compare_other = NULL) :
+      lm_weight_(lm_weight), pop_limit_(pop_limit), nbest_(nbest), compare_other_(compare_other) {}
 
     Score LMWeight() const { return lm_weight_; }
 
@@ -25,12 +25,17 @@ class Config {
 
     const NBestConfig &GetNBest() const { return nbest_; }
 
+    // NULL unless the decoder passes other states.
+    CompareOtherStates CompareOther() const { return compare_other_; }
+
   private:
     Score lm_weight_;
 
     unsigned int pop_limit_;
 
     NBestConfig nbest_;
+
+    CompareOtherStates compare_other_;
 };
 
 } // namespace search
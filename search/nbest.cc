@@ -12,7 +12,7 @@
 
 namespace search {
 
-NBestList::NBestList(std::vector<PartialEdge> &partials, util::Pool &entry_pool, std::size_t keep) {
+NBestList::NBestList(std::vector<PartialEdge> &partials, util::Pool &entry_pool, std::size_t keep, Origins &origins) : origins_(origins) {
   assert(!partials.empty());
   std::vector<PartialEdge>::iterator end;
   if (partials.size() > keep) {
@@ -89,11 +89,13 @@ void NBestList::MoveTop(util::Pool &pool) {
     *(static_cast<Applied*>(overwrite) + i) = from.in_->Get(pool, from.index_);
   }
   revealed_.push_back(Applied(entry.Base()));
+  origins_[entry.Base()] = this;
 }
 
 NBestComplete NBest::Complete(std::vector<PartialEdge> &partials) {
   assert(!partials.empty());
-  NBestList *list = list_pool_.construct(partials, entry_pool_, config_.keep);
+  // construct() takes at most three arguments
+  NBestList *list = new (list_pool_.malloc()) NBestList(partials, entry_pool_, config_.keep, origins_);
   return NBestComplete(
       list,
       partials.front().CompletedState(), // All partials have the same state
@@ -104,4 +106,10 @@ const std::vector<Applied> &NBest::Extract(History history) {
   return static_cast<NBestList*>(history)->Extract(entry_pool_, config_.size);
 }
 
+const std::vector<Applied> &NBest::Alternatives(Applied applied) {
+  NBestList::Origins::const_iterator found = origins_.find(applied.Base());
+  assert(found != origins_.end());
+  return found->second->Extract(entry_pool_, config_.keep);
+}
+
 } // namespace search
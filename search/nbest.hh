@@ -6,6 +6,7 @@
 #include "search/edge.hh"
 
 #include <boost/pool/object_pool.hpp>
+#include <boost/unordered_map.hpp>
 
 #include <cstddef>
 #include <queue>
@@ -34,7 +35,10 @@ class NBestList {
     typedef GenericApplied<RevealedRef> QueueEntry;
 
   public:
-    NBestList(std::vector<PartialEdge> &existing, util::Pool &entry_pool, std::size_t keep);
+    // Which list each revealed Applied came from, keyed by its Base().
+    typedef boost::unordered_map<const void*, NBestList*> Origins;
+
+    NBestList(std::vector<PartialEdge> &existing, util::Pool &entry_pool, std::size_t keep, Origins &origins);
 
     Score TopAfterConstructor() const;
 
@@ -52,6 +56,8 @@ class NBestList {
 
     typedef std::priority_queue<QueueEntry> Queue;
     Queue queue_;
+
+    Origins &origins_;
 };
 
 class NBest {
@@ -68,9 +74,16 @@ class NBest {
 
     const std::vector<Applied> &Extract(History root);
 
+    // The derivations that were recombined with applied, which came from
+    // Extract or Alternatives: same vertex, same state.  Best first, so the
+    // first is the one the others were recombined into.  At most keep.
+    const std::vector<Applied> &Alternatives(Applied applied);
+
   private:
     const NBestConfig config_;
 
+    NBestList::Origins origins_;
+
     boost::object_pool<NBestList> list_pool_;
 
     util::Pool entry_pool_;
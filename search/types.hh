@@ -1,6 +1,8 @@
 #ifndef SEARCH_TYPES__
 #define SEARCH_TYPES__
 
+#include <cstddef>
+
 #include <stdint.h>
 
 namespace lm { namespace ngram { class ChartState; } }
@@ -17,13 +19,22 @@ union Note {
 
 typedef void *History;
 
+// State of the decoder's features other than the language model, opaque to
+// search.  Hypotheses only recombine if this matches as well as the language
+// model state.  NULL if the decoder has no such features.
+typedef const void *OtherState;
+
+// Orders other states like strcmp.
+typedef int (*CompareOtherStates)(OtherState, OtherState);
+
 struct NBestComplete {
   NBestComplete(History in_history, const lm::ngram::ChartState &in_state, Score in_score) 
-    : history(in_history), state(&in_state), score(in_score) {}
+    : history(in_history), state(&in_state), score(in_score), other(NULL) {}
 
   History history;
   const lm::ngram::ChartState *state;
   Score score;
+  OtherState other;
 };
 
 } // namespace search
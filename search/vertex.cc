@@ -109,6 +109,8 @@ const unsigned char kPolicyOneLeft = 1;
 const unsigned char kPolicyOneRight = 2;
 // Reveal everything in the next branch.  Used to terminate the left/right policies.
 //    static const unsigned char kPolicyEverything = 3;
+// The language model state is the same, so the hypotheses differ in other state: one branch each.
+const unsigned char kPolicyOther = 4;
 
 } // namespace
 
@@ -164,6 +166,8 @@ void VertexNode::FinishedAppending(const unsigned char common_left, const unsign
 
   if (!all_full && !all_non_full) {
     policy_ = kPolicyAlternate;
+  } else if (left.Complete() && right.Complete() && hypos_.size() > 1) {
+    policy_ = kPolicyOther;
   } else if (left.Complete()) {
     policy_ = kPolicyOneRight;
   } else if (right.Complete()) {
@@ -179,22 +183,30 @@ void VertexNode::BuildExtend() {
   if (!extend_.empty()) return;
   // Nothing to build since this is a leaf.
   if (hypos_.size() <= 1) return;
-  bool left_branch = true;
-  switch (policy_) {
-    case kPolicyAlternate:
-      left_branch = (state_.left.length <= state_.right.length);
-      break;
-    case kPolicyOneLeft:
-      left_branch = true;
-      break;
-    case kPolicyOneRight:
-      left_branch = false;
-      break;
-  }
-  if (left_branch) {
-    Split(DivideLeft(state_.left.length), hypos_, extend_);
+  if (policy_ == kPolicyOther) {
+    // Already sorted by score.
+    extend_.resize(hypos_.size());
+    for (std::size_t i = 0; i < hypos_.size(); ++i) {
+      extend_[i].AppendHypothesis(hypos_[i]);
+    }
   } else {
-    Split(DivideRight(state_.right.length), hypos_, extend_);
+    bool left_branch = true;
+    switch (policy_) {
+      case kPolicyAlternate:
+        left_branch = (state_.left.length <= state_.right.length);
+        break;
+      case kPolicyOneLeft:
+        left_branch = true;
+        break;
+      case kPolicyOneRight:
+        left_branch = false;
+        break;
+    }
+    if (left_branch) {
+      Split(DivideLeft(state_.left.length), hypos_, extend_);
+    } else {
+      Split(DivideRight(state_.right.length), hypos_, extend_);
+    }
   }
   for (std::vector<VertexNode>::iterator i = extend_.begin(); i != extend_.end(); ++i) {
     // TODO: provide more here for branching?
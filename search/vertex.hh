@@ -20,6 +20,7 @@ struct HypoState {
   History history;
   lm::ngram::ChartState state;
   Score score;
+  OtherState other;
 };
 
 class VertexNode {
@@ -37,11 +38,12 @@ class VertexNode {
      */
     // Must default construct, call AppendHypothesis 1 or more times then do FinishedAppending.
     void AppendHypothesis(const NBestComplete &best) {
-      assert(hypos_.empty() || !(hypos_.front().state == *best.state));
+      assert(hypos_.empty() || !(hypos_.front().state == *best.state) || hypos_.front().other != best.other);
       HypoState hypo;
       hypo.history = best.history;
       hypo.state = *best.state;
       hypo.score = best.score;
+      hypo.other = best.other;
       hypos_.push_back(hypo);
     }
     void AppendHypothesis(const HypoState &hypo) {
@@ -81,6 +83,12 @@ class VertexNode {
       return hypos_.front().history;
     }
 
+    // Same.
+    OtherState Other() const {
+      assert(hypos_.size() == 1);
+      return hypos_.front().other;
+    }
+
     VertexNode &operator[](size_t index) {
       assert(!extend_.empty());
       return extend_[index];
@@ -144,6 +152,10 @@ class PartialVertex {
       return back_->End();
     }
 
+    OtherState Other() const {
+      return back_->Other();
+    }
+
   private:
     VertexNode *back_;
     unsigned int index_;
@@ -1,10 +1,13 @@
 #ifndef SEARCH_VERTEX_GENERATOR__
 #define SEARCH_VERTEX_GENERATOR__
 
+#include "search/context.hh"
 #include "search/edge.hh"
 #include "search/types.hh"
 #include "search/vertex.hh"
 
+#include <boost/unordered_map.hpp>
+
 namespace lm {
 namespace ngram {
 class ChartState;
@@ -13,21 +16,34 @@ class ChartState;
 
 namespace search {
 
-class ContextBase;
-
 // Output makes the single-best or n-best list.   
 template <class Output> class VertexGenerator {
   public:
     VertexGenerator(ContextBase &context, Vertex &gen, Output &nbest) : context_(context), gen_(gen), nbest_(nbest) {}
 
-    void NewHypothesis(PartialEdge partial) {
-      nbest_.Add(existing_[hash_value(partial.CompletedState())], partial);
+    // other is the state of the decoder's other features, see OtherState.
+    void NewHypothesis(PartialEdge partial, OtherState other = NULL) {
+      uint64_t hash = hash_value(partial.CompletedState());
+      std::pair<typename Existing::iterator, typename Existing::iterator> same_lm(existing_.equal_range(hash));
+      typename Existing::iterator group = same_lm.first;
+      while (group != same_lm.second && other && context_.GetConfig().CompareOther()(group->second.other, other)) {
+        ++group;
+      }
+      if (group == same_lm.second) {
+        group = existing_.insert(std::make_pair(hash, Group(other, partial.GetScore())));
+      } else if (partial.GetScore() > group->second.best) {
+        group->second.other = other;
+        group->second.best = partial.GetScore();
+      }
+      nbest_.Add(group->second.combine, partial);
     }
 
     void FinishedSearch() {
       gen_.root_.InitRoot();
       for (typename Existing::iterator i(existing_.begin()); i != existing_.end(); ++i) {
-        gen_.root_.AppendHypothesis(nbest_.Complete(i->second));
+        NBestComplete complete(nbest_.Complete(i->second.combine));
+        complete.other = i->second.other;
+        gen_.root_.AppendHypothesis(complete);
       }
       existing_.clear();
       gen_.root_.FinishRoot();
@@ -40,7 +56,18 @@ template <class Output> class VertexGenerator {
 
     Vertex &gen_;
 
-    typedef boost::unordered_map<uint64_t, typename Output::Combine> Existing;
+    // Hypotheses that recombine: the same language model state and other state.
+    struct Group {
+      Group(OtherState in_other, Score in_best) : other(in_other), best(in_best) {}
+
+      // That of the best hypothesis, which the others' states compare equal to.
+      OtherState other;
+      Score best;
+      typename Output::Combine combine;
+    };
+
+    // Keyed by the hash of the language model state.
+    typedef boost::unordered_multimap<uint64_t, Group> Existing;
     Existing existing_;
 
     Output &nbest_;
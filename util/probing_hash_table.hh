@@ -21,6 +21,13 @@ class ProbingSizeException : public Exception {
     ~ProbingSizeException() throw() {}
 };
 
+// Hint that address will be read soon.  A no-op where unsupported.
+inline void PrefetchRead(const void *address) {
+#if defined(__GNUC__)
+  __builtin_prefetch(address, 0);
+#endif
+}
+
 // std::identity is an SGI extension :-(
 struct IdentityHash {
   template <class T> T operator()(T arg) const { return arg; }
@@ -139,6 +146,11 @@ template <class EntryT, class HashT, class EqualT = std::equal_to<typename Entry
       }    
     }
 
+    // Start loading the bucket that Find(key) will probe first.
+    template <class Key> void Prefetch(const Key key) const {
+      PrefetchRead(begin_ + (hash_(key) % buckets_));
+    }
+
     // Like Find but we're sure it must be there.
     template <class Key> ConstIterator MustFind(const Key key) const {
       for (ConstIterator i(begin_ + (hash_(key) % buckets_));;) {